@@ -0,0 +1,334 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include "PCCBitstreamCommon.h"
+#include "PCCHighLevelSyntax.h"
+#include "PCCBitstream.h"
+#include "PCCBitstreamReader.h"
+#include <program_options_lite.h>
+#include <chrono>
+#include <random>
+
+using namespace std;
+using namespace pcc;
+
+bool parseParameters( int          argc,
+                      char*        argv[],
+                      size_t&      patchCount,
+                      size_t&      frameCount,
+                      size_t&      iterationCount,
+                      std::string& bitstreamPath ) {
+  namespace po    = df::program_options_lite;
+  bool print_help = false;
+  // clang-format off
+  po::Options opts;
+  opts.addOptions()
+     ( "help",       print_help,     false,          "This help text" )
+     ( "patchCount", patchCount,     patchCount,     "Number of patches per atlas frame" )
+     ( "frameCount", frameCount,     frameCount,     "Number of atlas frames" )
+     ( "iterations", iterationCount, iterationCount, "Number of times each bitstream is written and parsed" )
+     ( "bitstream",  bitstreamPath,  bitstreamPath,  "Compressed bitstream to parse, optional" );
+  // clang-format on
+  po::setDefaults( opts );
+  po::ErrorReporter        err;
+  const list<const char*>& argv_unhandled = po::scanArgv( opts, argc, (const char**)argv, err );
+  for ( const auto arg : argv_unhandled ) { printf( "Unhandled argument ignored: %s \n", arg ); }
+
+  printf( "parseParameters : \n" );
+  printf( "  patchCount = %zu \n", patchCount );
+  printf( "  frameCount = %zu \n", frameCount );
+  printf( "  iterations = %zu \n", iterationCount );
+  printf( "  bitstream  = %s \n", bitstreamPath.c_str() );
+
+  if ( print_help || patchCount == 0 || frameCount == 0 || iterationCount == 0 ) {
+    printf( "Error parameters not correct \n" );
+    po::doHelp( std::cout, opts, 78 );
+    return false;
+  }
+  if ( err.is_errored ) { return false; }
+  return true;
+}
+
+enum SyntaxCode { CODE_U, CODE_S, CODE_UVLC, CODE_SVLC };
+
+struct SyntaxElement {
+  SyntaxCode code;
+  uint8_t    bits;
+  int32_t    value;
+};
+
+// Bit by bit reader and writer, the reference for the fields written and read by PCCBitstream.
+class ReferenceBitstream {
+ public:
+  ReferenceBitstream() : bytes_( 0 ), bits_( 0 ) {}
+  std::vector<uint8_t>& vector() { return data_; }
+  uint64_t              size() { return bytes_ + ( bits_ != 0 ? 1 : 0 ); }
+  void                  beginning() { bytes_ = bits_ = 0; }
+
+  void write( uint32_t value, uint8_t bits ) {
+    if ( bytes_ + bits + 16 >= data_.size() ) { data_.resize( data_.size() + 4096 ); }
+    for ( size_t i = 0; i < bits; i++ ) {
+      data_[bytes_] |= ( ( value >> ( bits - 1 - i ) ) & 1 ) << ( 7 - bits_ );
+      next();
+    }
+  }
+  uint32_t read( uint8_t bits ) {
+    uint32_t value = 0;
+    for ( size_t i = 0; i < bits; i++ ) {
+      value |= ( ( data_[bytes_] >> ( 7 - bits_ ) ) & 1 ) << ( bits - 1 - i );
+      next();
+    }
+    return value;
+  }
+  void writeS( int32_t value, uint8_t bits ) {
+    write( value >= 0 ? uint32_t( value ) : ( ( value & ( ( 1 << ( bits - 1 ) ) - 1 ) ) | ( 1 << ( bits - 1 ) ) ),
+           bits );
+  }
+  int32_t readS( uint8_t bits ) {
+    uint32_t code     = read( bits );
+    uint32_t midPoint = ( 1 << ( bits - 1 ) );
+    return code < midPoint ? int32_t( code ) : int32_t( code ) | ~( midPoint - 1 );
+  }
+  void writeUvlc( uint32_t code ) {
+    uint32_t length = 1, temp = ++code;
+    while ( 1 != temp ) {
+      temp >>= 1;
+      length += 2;
+    }
+    write( 0, length >> 1 );
+    write( code, ( length + 1 ) >> 1 );
+  }
+  uint32_t readUvlc() {
+    uint32_t value = 0, code = read( 1 ), length = 0;
+    if ( 0 == code ) {
+      while ( !( code & 1 ) ) {
+        code = read( 1 );
+        length++;
+      }
+      value = read( length ) + ( 1 << length ) - 1;
+    }
+    return value;
+  }
+  void    writeSvlc( int32_t code ) { writeUvlc( uint32_t( code <= 0 ? -code << 1 : ( code << 1 ) - 1 ) ); }
+  int32_t readSvlc() {
+    uint32_t bits = readUvlc();
+    return ( bits & 1 ) ? int32_t( bits >> 1 ) + 1 : -int32_t( bits >> 1 );
+  }
+
+ private:
+  void next() {
+    if ( ++bits_ == 8 ) {
+      bytes_++;
+      bits_ = 0;
+    }
+  }
+  std::vector<uint8_t> data_;
+  uint64_t             bytes_;
+  uint8_t              bits_;
+};
+
+// Syntax elements of the atlas tile layers and of the SEI messages of an atlas sub-bitstream with
+// patchCount patches per frame: the fixed length fields, the exp-golomb codes and the hashes have the
+// sizes and the value ranges of the patch data units written by the encoder.
+void createSyntax( const size_t patchCount, const size_t frameCount, std::vector<SyntaxElement>& syntax ) {
+  std::mt19937 generator( 0 );
+  auto         u    = [&]( uint8_t bits ) { syntax.push_back( {CODE_U, bits, int32_t( generator() >> ( 32 - bits ) )} ); };
+  auto         ue   = [&]( uint32_t max ) { syntax.push_back( {CODE_UVLC, 0, int32_t( generator() % ( max + 1 ) )} ); };
+  auto         se   = [&]( int32_t max ) {
+    syntax.push_back( {CODE_SVLC, 0, int32_t( generator() % ( 2 * max + 1 ) ) - max} );
+  };
+  auto s = [&]( uint8_t bits ) {
+    syntax.push_back( {CODE_S, bits, int32_t( generator() >> ( 32 - bits ) ) - ( 1 << ( bits - 1 ) )} );
+  };
+  for ( size_t frame = 0; frame < frameCount; frame++ ) {
+    // atlas tile header
+    ue( 63 );
+    u( 8 );
+    ue( 4 );
+    u( 1 );
+    u( 8 );
+    ue( 8 );
+    for ( size_t patch = 0; patch < patchCount; patch++ ) {
+      ue( 7 );  // patch mode
+      if ( frame == 0 || ( patch & 3 ) == 0 ) {
+        // patch data unit
+        ue( 255 );
+        ue( 255 );
+        ue( 127 );
+        ue( 127 );
+        u( 10 );
+        u( 10 );
+        u( 6 );
+        u( 4 );
+        u( 3 );
+        u( 3 );
+        u( 1 );
+      } else {
+        // inter patch data unit
+        ue( 15 );
+        se( 16 );
+        se( 8 );
+        se( 8 );
+        se( 4 );
+        se( 4 );
+        se( 32 );
+        se( 32 );
+        se( 4 );
+        s( 12 );
+      }
+    }
+    // decoded atlas information hash SEI: payload type and size, md5 of the frame and of each tile
+    u( 8 );
+    u( 8 );
+    u( 8 );
+    for ( size_t i = 0; i < 16; i++ ) { u( 8 ); }
+    for ( size_t i = 0; i < 8; i++ ) { u( 32 ); }
+  }
+}
+
+template <typename Bitstream>
+void writeSyntax( Bitstream& bitstream, const std::vector<SyntaxElement>& syntax ) {
+  for ( const auto& element : syntax ) {
+    switch ( element.code ) {
+      case CODE_U: bitstream.write( uint32_t( element.value ), element.bits ); break;
+      case CODE_S: bitstream.writeS( element.value, element.bits ); break;
+      case CODE_UVLC: bitstream.writeUvlc( uint32_t( element.value ) ); break;
+      case CODE_SVLC: bitstream.writeSvlc( element.value ); break;
+    }
+  }
+}
+
+template <typename Bitstream>
+size_t readSyntax( Bitstream& bitstream, const std::vector<SyntaxElement>& syntax ) {
+  size_t errorCount = 0;
+  for ( const auto& element : syntax ) {
+    int32_t value = 0;
+    switch ( element.code ) {
+      case CODE_U: value = int32_t( bitstream.read( element.bits ) ); break;
+      case CODE_S: value = bitstream.readS( element.bits ); break;
+      case CODE_UVLC: value = int32_t( bitstream.readUvlc() ); break;
+      case CODE_SVLC: value = bitstream.readSvlc(); break;
+    }
+    errorCount += value != element.value;
+  }
+  return errorCount;
+}
+
+// Times the writing and the parsing of the syntax elements with PCCBitstream and with the bit by bit
+// reference and checks that both give the same bytes and the same values.
+int benchmarkSyntax( const size_t patchCount, const size_t frameCount, const size_t iterationCount ) {
+  using namespace std::chrono;
+  std::vector<SyntaxElement> syntax;
+  createSyntax( patchCount, frameCount, syntax );
+  PCCBitstream       bitstream;
+  ReferenceBitstream reference;
+  double             times[4] = {0.0, 0.0, 0.0, 0.0};
+  size_t             errorCount = 0;
+  for ( size_t i = 0; i < iterationCount; i++ ) {
+    bitstream.clear();
+    reference = ReferenceBitstream();
+    auto start = steady_clock::now();
+    writeSyntax( bitstream, syntax );
+    auto end = steady_clock::now();
+    times[0] += duration<double, std::milli>( end - start ).count();
+    start = steady_clock::now();
+    writeSyntax( reference, syntax );
+    end = steady_clock::now();
+    times[1] += duration<double, std::milli>( end - start ).count();
+    bitstream.beginning();
+    start = steady_clock::now();
+    errorCount += readSyntax( bitstream, syntax );
+    end = steady_clock::now();
+    times[2] += duration<double, std::milli>( end - start ).count();
+    reference.beginning();
+    start = steady_clock::now();
+    errorCount += readSyntax( reference, syntax );
+    end = steady_clock::now();
+    times[3] += duration<double, std::milli>( end - start ).count();
+  }
+  const size_t size = reference.size();
+  if ( bitstream.vector().size() < size || reference.vector().size() < size ||
+       memcmp( bitstream.buffer(), reference.vector().data(), size ) != 0 ) {
+    printf( "Error: PCCBitstream bytes differ from the reference ones \n" );
+    errorCount++;
+  }
+  printf( "Atlas data and SEI: %zu syntax elements, %zu bytes \n", syntax.size(), size );
+  const char* names[4] = {"write", "write (bit by bit)", "read", "read (bit by bit)"};
+  for ( size_t i = 0; i < 4; i++ ) {
+    printf( "  %-18s %10.3f ms/frame \n", names[i], times[i] / iterationCount / frameCount );
+  }
+  if ( errorCount != 0 ) { printf( "Error: %zu syntax elements differ \n", errorCount ); }
+  return errorCount == 0 ? 0 : -1;
+}
+
+// Times the parsing of a compressed bitstream with PCCBitstreamReader.
+int benchmarkParser( const std::string& bitstreamPath, const size_t iterationCount ) {
+  using namespace std::chrono;
+  double time = 0.0;
+  for ( size_t i = 0; i < iterationCount; i++ ) {
+    PCCBitstream     bitstream;
+    PCCBitstreamStat bitstreamStat;
+    if ( !bitstream.initialize( bitstreamPath ) ) {
+      printf( "Error: can't read %s \n", bitstreamPath.c_str() );
+      return -1;
+    }
+    bitstreamStat.setHeader( bitstream.size() );
+    auto                start = steady_clock::now();
+    SampleStreamV3CUnit ssvu;
+    PCCBitstreamReader::read( bitstream, ssvu );
+    bool bMoreData = true;
+    while ( bMoreData ) {
+      PCCBitstreamReader bitstreamReader;
+      PCCHighLevelSyntax context;
+      context.setBitstreamStat( bitstreamStat );
+      if ( bitstreamReader.decode( ssvu, context ) == 0 ) { break; }
+      bMoreData = ( ssvu.getV3CUnitCount() > 0 );
+    }
+    time += duration<double, std::milli>( steady_clock::now() - start ).count();
+  }
+  printf( "Parsing %s: %10.3f ms \n", bitstreamPath.c_str(), time / iterationCount );
+  return 0;
+}
+
+int main( int argc, char* argv[] ) {
+  std::cout << "PccAppBitstreamBenchmark v" << TMC2_VERSION_MAJOR << "." << TMC2_VERSION_MINOR << std::endl
+            << std::endl;
+  size_t      patchCount = 4096, frameCount = 32, iterationCount = 10;
+  std::string bitstreamPath;
+  if ( !parseParameters( argc, argv, patchCount, frameCount, iterationCount, bitstreamPath ) ) { return -1; }
+  int ret = benchmarkSyntax( patchCount, frameCount, iterationCount );
+  if ( !bitstreamPath.empty() && benchmarkParser( bitstreamPath, iterationCount ) != 0 ) { ret = -1; }
+  return ret;
+}
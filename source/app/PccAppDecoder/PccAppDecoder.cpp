@@ -43,7 +43,9 @@
 #include "PCCFrameContext.h"
 #include "PCCBitstream.h"
 #include "PCCGroupOfFrames.h"
+#include "PCCTaskScheduler.h"
 #include "PCCBitstreamReader.h"
+#include "PCCSampleStreamV3CUnitReader.h"
 #include "PCCDecoderParameters.h"
 #include "PCCMetricsParameters.h"
 #include "PCCConformanceParameters.h"
@@ -96,11 +98,15 @@ bool parseParameters( int                       argc,
     ( "compressedStreamPath",
       decoderParams.compressedStreamPath_,
       decoderParams.compressedStreamPath_,
-    "Output(encoder)/Input(decoder) compressed bitstream")
+    "Output(encoder)/Input(decoder) compressed bitstream (\"-\" for stdin)")
     ( "reconstructedDataPath",
       decoderParams.reconstructedDataPath_,
       decoderParams.reconstructedDataPath_,
     "Output decoded pointcloud. Multi-frame sequences may be represented by %04i")
+    ( "reconstructedDataInt16",
+      decoderParams.reconstructedDataInt16_,
+      decoderParams.reconstructedDataInt16_,
+    "Write the coordinates of the decoded pointclouds as int16 instead of float")
 
     // sequence configuration
     ( "startFrameNumber",
@@ -149,6 +155,10 @@ bool parseParameters( int                       argc,
       decoderParams.nbThread_,
       decoderParams.nbThread_,
     "Number of thread used for parallel processing")
+    ( "cpuAffinity",
+      decoderParams.cpuAffinity_,
+      decoderParams.cpuAffinity_,
+      "List of cpus the processing threads are pinned to (e.g. \"0-7,16-23\"), empty to disable pinning" )
     ( "attributeTransferFilterType",
       decoderParams.attrTransferFilterType_,
       decoderParams.attrTransferFilterType_,
@@ -277,17 +287,17 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
                      const PCCMetricsParameters& metricsParams,
                      PCCConformanceParameters&   conformanceParams,
                      StopwatchUserTime&          clock ) {
-  PCCBitstream     bitstream;
-  PCCBitstreamStat bitstreamStat;
-  PCCLogger        logger;
+  PCCSampleStreamV3CUnitReader streamReader;
+  PCCBitstreamStat             bitstreamStat;
+  PCCLogger                    logger;
   logger.initilalize( removeFileExtension( decoderParams.compressedStreamPath_ ), false );
 #if defined( BITSTREAM_TRACE ) || defined( CONFORMANCE_TRACE )
-  bitstream.setLogger( logger );
-  bitstream.setTrace( true );
+  streamReader.setLogger( logger );
 #endif
-  if ( !bitstream.initialize( decoderParams.compressedStreamPath_ ) ) { return -1; }
-  bitstream.computeMD5();
-  bitstreamStat.setHeader( bitstream.size() );
+  // the V3C units are read one GOF ahead of the decoding: "-" reads the
+  // bitstream from stdin.
+  SampleStreamV3CUnit ssvu;
+  if ( !streamReader.open( decoderParams.compressedStreamPath_, ssvu ) ) { return -1; }
   size_t         frameNumber = decoderParams.startFrameNumber_;
   PCCMetrics     metrics;
   PCCChecksum    checksum;
@@ -299,11 +309,9 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
   decoder.setLogger( logger );
   decoder.setParameters( decoderParams );
 
-  SampleStreamV3CUnit ssvu;
-  size_t              headerSize = pcc::PCCBitstreamReader::read( bitstream, ssvu );
-  bitstreamStat.incrHeader( headerSize );
   bool bMoreData = true;
   while ( bMoreData ) {
+    if ( !streamReader.read( ssvu ) ) { return -1; }
     PCCGroupOfFrames reconstructs;
     PCCContext       context;
     context.setBitstreamStat( bitstreamStat );
@@ -359,13 +367,15 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
 #endif
 
       if ( !decoderParams.reconstructedDataPath_.empty() ) {
-        reconstructs.write( decoderParams.reconstructedDataPath_, frameNumber, decoderParams.nbThread_, false );
+        reconstructs.write( decoderParams.reconstructedDataPath_, frameNumber, false,
+                            decoderParams.reconstructedDataInt16_ );
       } else {
         frameNumber += reconstructs.getFrameCount();
       }
       bMoreData = ( ssvu.getV3CUnitCount() > 0 );
     }
   }
+  bitstreamStat.setHeader( streamReader.size() + streamReader.getHeaderSize() );
   bitstreamStat.trace();
   if ( metricsParams.computeMetrics_ ) { metrics.display(); }
   bool validChecksum = true;
@@ -380,7 +390,7 @@ int main( int argc, char* argv[] ) {
   PCCMetricsParameters     metricsParams;
   PCCConformanceParameters conformanceParams;
   if ( !parseParameters( argc, argv, decoderParams, metricsParams, conformanceParams ) ) { return -1; }
-  if ( decoderParams.nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( decoderParams.nbThread_ ) ); }
+  PCCTaskScheduler::getInstance().configure( decoderParams.nbThread_, decoderParams.cpuAffinity_ );
 
   // Timers to count elapsed wall/user time
   pcc::chrono::Stopwatch<std::chrono::steady_clock> clockWall;
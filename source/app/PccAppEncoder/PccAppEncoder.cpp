@@ -43,6 +43,7 @@
 #include "PCCFrameContext.h"
 #include "PCCBitstream.h"
 #include "PCCGroupOfFrames.h"
+#include "PCCTaskScheduler.h"
 #include "PCCEncoderParameters.h"
 #include "PCCBitstreamWriter.h"
 #include "PCCMetricsParameters.h"
@@ -227,6 +228,14 @@ bool parseParameters( int                   argc,
       encoderParams.searchRadiusRefineSegmentation_,
       encoderParams.searchRadiusRefineSegmentation_,
       "Search radius for segmentation refinement" )
+    ( "temporalRefineSegmentation",
+      encoderParams.temporalRefineSegmentation_,
+      encoderParams.temporalRefineSegmentation_,
+      "Reuse the refined segmentation of the previous frame for the points that did not move" )
+    ( "maxDist2TemporalRefineSegmentation",
+      encoderParams.maxDist2TemporalRefineSegmentation_,
+      encoderParams.maxDist2TemporalRefineSegmentation_,
+      "Maximum squared distance to the previous frame of a point that reuses its segmentation" )
     ( "occupancyResolution",
       encoderParams.occupancyResolution_,
       encoderParams.occupancyResolution_,
@@ -585,6 +594,15 @@ bool parseParameters( int                   argc,
       encoderParams.nbThread_,
       encoderParams.nbThread_,
       "Number of thread used for parallel processing" )
+    ( "cpuAffinity",
+      encoderParams.cpuAffinity_,
+      encoderParams.cpuAffinity_,
+      "List of cpus the processing threads are pinned to (e.g. \"0-7,16-23\"), empty to disable pinning" )
+    ( "gofPipelineDepth",
+      encoderParams.gofPipelineDepth_,
+      encoderParams.gofPipelineDepth_,
+      "Number of GOFs processed concurrently by the load/segment/code/write pipeline (1: sequential; the stages "
+      "overlap only with nbThread != 1)" )
     ( "keepIntermediateFiles",
       encoderParams.keepIntermediateFiles_,
       encoderParams.keepIntermediateFiles_,
@@ -1003,12 +1021,30 @@ bool parseParameters( int                   argc,
   return true;
 }
 
+struct PCCGofEncodingJob {
+  size_t               contextIndex_;
+  size_t               startFrameNumber_;
+  size_t               endFrameNumber_;
+  PCCContext           context_;
+  PCCGroupOfFrames     sources_;
+  PCCGroupOfFrames     reconstructs_;
+  PCCEncoderParameters params_;
+  int                  ret_ = 0;
+};
+
 int compressVideo( const PCCEncoderParameters& encoderParams,
                    const PCCMetricsParameters& metricsParams,
                    StopwatchUserTime&          clock ) {
   const size_t startFrameNumber0        = encoderParams.startFrameNumber_;
   size_t       endFrameNumber0          = encoderParams.startFrameNumber_ + encoderParams.frameCount_;
   const size_t groupOfFramesSize0       = ( std::max )( size_t( 1 ), encoderParams.groupOfFramesSize_ );
+#if defined( CODEC_TRACE ) || defined( BITSTREAM_TRACE ) || defined( CONFORMANCE_TRACE )
+  // the stages write their traces in the same log: one group of frames at a time
+  const size_t gofPipelineDepth = 1;
+#else
+  const size_t gofPipelineDepth = ( std::max )( size_t( 1 ), encoderParams.gofPipelineDepth_ );
+#endif
+  const bool   overlapped               = gofPipelineDepth > 1;
   size_t       startFrameNumber         = startFrameNumber0;
   size_t       reconstructedFrameNumber = encoderParams.startFrameNumber_;
 
@@ -1017,70 +1053,111 @@ int compressVideo( const PCCEncoderParameters& encoderParams,
   std::unique_ptr<uint8_t> buffer;
   size_t                   contextIndex = 0;
   PCCEncoder               encoder;
+  PCCEncoder               videoEncoder;
   PCCMetrics               metrics;
   PCCChecksum              checksum;
   PCCBitstreamStat         bitstreamStat;
   SampleStreamV3CUnit      ssvu;
+  std::atomic<int>         ret( 0 );
   encoder.setLogger( logger );
   encoder.setParameters( encoderParams );
+  videoEncoder.setLogger( logger );
   metrics.setParameters( metricsParams );
   checksum.setParameters( metricsParams );
 
-  // Place to get/set default values for gof metadata enabled flags (in sequence level).
-  while ( startFrameNumber < endFrameNumber0 ) {
-    size_t     endFrameNumber = min( startFrameNumber + groupOfFramesSize0, endFrameNumber0 );
-    PCCContext context;
-    context.setBitstreamStat( bitstreamStat );
-    context.addV3CParameterSet( contextIndex );
-    context.setActiveVpsId( contextIndex );
-    PCCGroupOfFrames sources;
-    PCCGroupOfFrames reconstructs;
-    clock.start();
-    if ( !sources.load( encoderParams.uncompressedDataPath_, startFrameNumber, endFrameNumber,
-                        encoderParams.colorTransform_, false, encoderParams.nbThread_ ) ) {
-      return -1;
+  // The GOFs go through four in-order stages (load, segmentation and packing, video and bitstream coding,
+  // metrics/write): up to gofPipelineDepth GOFs are in flight, so GOF N+1 is loaded and segmented while the videos
+  // of GOF N are coded. Each stage sees the GOFs in the sequential order and the video stage uses the parameters
+  // produced by the segmentation of its GOF, so the bitstream and the reconstructions are identical to the
+  // sequential processing.
+  auto load = [&]( tbb::flow_control& fc ) -> std::shared_ptr<PCCGofEncodingJob> {
+    if ( ret != 0 || startFrameNumber >= endFrameNumber0 ) {
+      fc.stop();
+      return nullptr;
     }
-    if ( sources.getFrameCount() < endFrameNumber - startFrameNumber ) {
-      endFrameNumber  = startFrameNumber + sources.getFrameCount();
-      endFrameNumber0 = endFrameNumber;
+    if ( !overlapped ) { clock.start(); }
+    auto job               = std::make_shared<PCCGofEncodingJob>();
+    job->contextIndex_     = contextIndex;
+    job->startFrameNumber_ = startFrameNumber;
+    job->endFrameNumber_   = min( startFrameNumber + groupOfFramesSize0, endFrameNumber0 );
+    if ( !job->sources_.load( encoderParams.uncompressedDataPath_, job->startFrameNumber_, job->endFrameNumber_,
+                              encoderParams.colorTransform_ ) ) {
+      ret = -1;
+      fc.stop();
+      return nullptr;
     }
-    std::cout << "Compressing " << contextIndex << " frames " << startFrameNumber << " -> " << endFrameNumber << "..."
-              << std::endl;
-    int                ret = encoder.encode( sources, context, reconstructs );
+    if ( job->sources_.getFrameCount() < job->endFrameNumber_ - job->startFrameNumber_ ) {
+      job->endFrameNumber_ = job->startFrameNumber_ + job->sources_.getFrameCount();
+      endFrameNumber0      = job->endFrameNumber_;
+    }
+    startFrameNumber = job->endFrameNumber_;
+    contextIndex++;
+    return job;
+  };
+  auto encodeAtlas = [&]( std::shared_ptr<PCCGofEncodingJob> job ) -> std::shared_ptr<PCCGofEncodingJob> {
+    if ( ret != 0 ) { return job; }
+    std::cout << "Compressing " << job->contextIndex_ << " frames " << job->startFrameNumber_ << " -> "
+              << job->endFrameNumber_ << "..." << std::endl;
+    job->context_.setBitstreamStat( bitstreamStat );
+    job->context_.addV3CParameterSet( job->contextIndex_ );
+    job->context_.setActiveVpsId( job->contextIndex_ );
+    job->ret_ = encoder.encodeAtlas( job->sources_, job->context_, job->params_ );
+    return job;
+  };
+  auto encodeVideo = [&]( std::shared_ptr<PCCGofEncodingJob> job ) -> std::shared_ptr<PCCGofEncodingJob> {
+    if ( ret != 0 || job->ret_ != 0 ) { return job; }
+    videoEncoder.setParameters( job->params_ );
+    job->ret_ = videoEncoder.encodeVideo( job->sources_, job->context_, job->reconstructs_ );
     PCCBitstreamWriter bitstreamWriter;
 #ifdef BITSTREAM_TRACE
     bitstreamWriter.setLogger( logger );
 #endif
-    ret |= bitstreamWriter.encode( context, ssvu );
-    clock.stop();
+    job->ret_ |= bitstreamWriter.encode( job->context_, ssvu );
+    if ( !overlapped ) { clock.stop(); }
+    return job;
+  };
+  auto write = [&]( std::shared_ptr<PCCGofEncodingJob> job ) {
+    if ( ret != 0 ) { return; }
     PCCGroupOfFrames normals;
     if ( metricsParams.computeMetrics_ ) {
       bool bRunMetric = true;
       if ( !metricsParams.normalDataPath_.empty() ) {
-        if ( !normals.load( metricsParams.normalDataPath_, startFrameNumber, endFrameNumber, COLOR_TRANSFORM_NONE,
-                            true ) ) {
+        if ( !normals.load( metricsParams.normalDataPath_, job->startFrameNumber_, job->endFrameNumber_,
+                            COLOR_TRANSFORM_NONE, true ) ) {
           bRunMetric = false;
         }
       }
-      if ( bRunMetric ) { metrics.compute( sources, reconstructs, normals ); }
+      if ( bRunMetric ) { metrics.compute( job->sources_, job->reconstructs_, normals ); }
     }
     if ( metricsParams.computeChecksum_ ) {
       if ( encoderParams.rawPointsPatch_ && encoderParams.reconstructRawType_ != 0 ) {
-        checksum.computeSource( sources );
-        checksum.computeReordered( reconstructs );
+        checksum.computeSource( job->sources_ );
+        checksum.computeReordered( job->reconstructs_ );
       }
-      checksum.computeReconstructed( reconstructs );
+      checksum.computeReconstructed( job->reconstructs_ );
+    }
+    if ( job->ret_ != 0 ) {
+      ret = job->ret_;
+      return;
     }
-    if ( ret != 0 ) { return ret; }
     if ( !encoderParams.reconstructedDataPath_.empty() ) {
-      reconstructs.write( encoderParams.reconstructedDataPath_, reconstructedFrameNumber );
+      job->reconstructs_.write( encoderParams.reconstructedDataPath_, reconstructedFrameNumber );
     }
-    normals.clear();
-    sources.clear();
-    reconstructs.clear();
-    startFrameNumber = endFrameNumber;
-    contextIndex++;
-  }
+  };
+
+  if ( overlapped ) { clock.start(); }
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_pipeline(
+        gofPipelineDepth,
+        tbb::make_filter<void, std::shared_ptr<PCCGofEncodingJob>>( tbb::filter::serial_in_order, load ) &
+            tbb::make_filter<std::shared_ptr<PCCGofEncodingJob>, std::shared_ptr<PCCGofEncodingJob>>(
+                tbb::filter::serial_in_order, encodeAtlas ) &
+            tbb::make_filter<std::shared_ptr<PCCGofEncodingJob>, std::shared_ptr<PCCGofEncodingJob>>(
+                tbb::filter::serial_in_order, encodeVideo ) &
+            tbb::make_filter<std::shared_ptr<PCCGofEncodingJob>, void>( tbb::filter::serial_in_order, write ) );
+  } );
+  if ( overlapped ) { clock.stop(); }
+  if ( ret != 0 ) { return ret; }
 
   PCCBitstream bitstream;
 #if defined( BITSTREAM_TRACE ) || defined( CONFORMANCE_TRACE )
@@ -1114,7 +1191,7 @@ int main( int argc, char* argv[] ) {
   PCCEncoderParameters encoderParams;
   PCCMetricsParameters metricsParams;
   if ( !parseParameters( argc, argv, encoderParams, metricsParams ) ) { return -1; }
-  if ( encoderParams.nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( encoderParams.nbThread_ ) ); }
+  PCCTaskScheduler::getInstance().configure( encoderParams.nbThread_, encoderParams.cpuAffinity_ );
 
   // Timers to count elapsed wall/user time
   pcc::chrono::Stopwatch<std::chrono::steady_clock> clockWall;
@@ -0,0 +1,150 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include "PCCCommon.h"
+#include "PCCChrono.h"
+#include "PCCImage.h"
+#include "PCCImageKernels.h"
+#include <program_options_lite.h>
+#include <random>
+
+using namespace std;
+using namespace pcc;
+
+bool parseParameters( int argc, char* argv[], size_t& width, size_t& height, size_t& frameCount, size_t& nbyte ) {
+  namespace po    = df::program_options_lite;
+  bool print_help = false;
+  // clang-format off
+  po::Options opts;
+  opts.addOptions()
+     ( "help",       print_help, false,      "This help text" )
+     ( "width",      width,      width,      "Image width" )
+     ( "height",     height,     height,     "Image height" )
+     ( "frameCount", frameCount, frameCount, "Number of times each conversion is done" )
+     ( "nbyte",      nbyte,      nbyte,      "Sample size: 1 (8-bit) or 2 (16-bit)" );
+  // clang-format on
+  po::setDefaults( opts );
+  po::ErrorReporter        err;
+  const list<const char*>& argv_unhandled = po::scanArgv( opts, argc, (const char**)argv, err );
+  for ( const auto arg : argv_unhandled ) { printf( "Unhandled argument ignored: %s \n", arg ); }
+
+  printf( "parseParameters : \n" );
+  printf( "  width      = %zu \n", width );
+  printf( "  height     = %zu \n", height );
+  printf( "  frameCount = %zu \n", frameCount );
+  printf( "  nbyte      = %zu \n", nbyte );
+
+  if ( print_help || width == 0 || height == 0 || ( width & 1 ) != 0 || ( height & 1 ) != 0 || frameCount == 0 ||
+       ( nbyte != 1 && nbyte != 2 ) ) {
+    printf( "Error parameters not correct \n" );
+    po::doHelp( std::cout, opts, 78 );
+    return false;
+  }
+  if ( err.is_errored ) { return false; }
+  return true;
+}
+
+// Times the conversions of PCCImage with the kernels dispatched to the given instruction set and returns the MD5 of
+// the converted images, to check that all the instruction sets give the same images.
+template <typename T>
+std::string benchmark( const PCCImage<T, 3>& source, const size_t frameCount, const int bitdepth ) {
+  using namespace std::chrono;
+  pcc::chrono::Stopwatch<steady_clock> clocks[6];
+  PCCImage<T, 3>                       image420, image444, imageBitdepth, block;
+  block.resize( source.getWidth() / 2, source.getHeight() / 2, YUV444 );
+  for ( size_t i = 0; i < frameCount; i++ ) {
+    clocks[0].start();
+    image420.convertYUV444ToYUV420( source );
+    clocks[0].stop();
+    clocks[1].start();
+    image444.convertYUV420ToYUV444( image420 );
+    clocks[1].stop();
+    imageBitdepth = source;
+    clocks[2].start();
+    imageBitdepth.convertBitdepth( bitdepth, bitdepth - 2, true );
+    clocks[2].stop();
+    clocks[3].start();
+    imageBitdepth.convertBitdepth( bitdepth - 2, bitdepth, true );
+    clocks[3].stop();
+    clocks[4].start();
+    imageBitdepth.convertBitdepth( bitdepth, bitdepth - 1, false );
+    clocks[4].stop();
+    clocks[5].start();
+    image444.copyBlock( source.getHeight() / 4, source.getWidth() / 4, block.getWidth(), block.getHeight(), block );
+    clocks[5].stop();
+  }
+  const char* names[6] = {"YUV444ToYUV420", "YUV420ToYUV444", "bitdepth >>", "bitdepth <<", "bitdepth clip",
+                          "copyBlock"};
+  for ( size_t i = 0; i < 6; i++ ) {
+    printf( "  %-16s %10.3f ms/frame \n", names[i],
+            duration_cast<microseconds>( clocks[i].count() ).count() / 1000.0 / frameCount );
+  }
+  return image420.computeMD5( 1 ) + image444.computeMD5( 1 ) + imageBitdepth.computeMD5( 0 ) + block.computeMD5( 0 );
+}
+
+template <typename T>
+int benchmark( const size_t width, const size_t height, const size_t frameCount ) {
+  const int       bitdepth = sizeof( T ) == 1 ? 8 : 10;
+  std::mt19937    generator( 0 );
+  PCCImage<T, 3>  source;
+  source.resize( width, height, YUV444 );
+  for ( size_t c = 0; c < 3; c++ ) {
+    for ( auto& sample : source[c] ) { sample = T( generator() & ( ( 1 << bitdepth ) - 1 ) ); }
+  }
+  const char*        levelNames[3] = {"scalar", "SSE4.1", "AVX2"};
+  const PCCSimdLevel supported     = getSupportedSimdLevel();
+  std::string        reference;
+  int                ret = 0;
+  for ( int level = SIMD_NONE; level <= supported; level++ ) {
+    setSimdLevel( PCCSimdLevel( level ) );
+    printf( "%s: %zux%zu %zu-bit \n", levelNames[level], width, height, sizeof( T ) * 8 );
+    const std::string md5 = benchmark( source, frameCount, bitdepth );
+    if ( level == SIMD_NONE ) {
+      reference = md5;
+    } else if ( md5 != reference ) {
+      printf( "Error: %s images differ from the scalar ones \n", levelNames[level] );
+      ret = -1;
+    }
+  }
+  return ret;
+}
+
+int main( int argc, char* argv[] ) {
+  std::cout << "PccAppImageBenchmark v" << TMC2_VERSION_MAJOR << "." << TMC2_VERSION_MINOR << std::endl << std::endl;
+  size_t width = 2048, height = 2048, frameCount = 30, nbyte = 2;
+  if ( !parseParameters( argc, argv, width, height, frameCount, nbyte ) ) { return -1; }
+  return nbyte == 1 ? benchmark<uint8_t>( width, height, frameCount )
+                    : benchmark<uint16_t>( width, height, frameCount );
+}
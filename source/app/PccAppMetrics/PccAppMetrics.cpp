@@ -36,6 +36,7 @@
 #include "PCCCommon.h"
 #include "PCCChrono.h"
 #include "PCCGroupOfFrames.h"
+#include "PCCTaskScheduler.h"
 #include "PCCMetrics.h"
 #include "PCCMetricsParameters.h"
 #include <program_options_lite.h>
@@ -162,7 +163,7 @@ int main( int argc, char* argv[] ) {
 
   PCCMetricsParameters metricsParams;
   if ( !parseParameters( argc, argv, metricsParams ) ) { return -1; }
-  if ( metricsParams.nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( metricsParams.nbThread_ ) ); }
+  PCCTaskScheduler::getInstance().configure( metricsParams.nbThread_ );
 
   // Timers to count elapsed wall/user time
   pcc::chrono::Stopwatch<std::chrono::steady_clock> clockWall;
@@ -37,6 +37,7 @@
 #include "PCCMath.h"
 #include "PCCKdTree.h"
 #include "PCCGroupOfFrames.h"
+#include "PCCTaskScheduler.h"
 #include "PCCNormalsGenerator.h"
 #include <program_options_lite.h>
 #include <tbb/tbb.h>
@@ -316,7 +317,7 @@ int main( int argc, char* argv[] ) {
                          nbThread, normalParams ) ) {
     return -1;
   }
-  if ( nbThread > 0 ) { tbb::task_scheduler_init init( static_cast<int>( nbThread ) ); }
+  PCCTaskScheduler::getInstance().configure( nbThread );
   int ret = generateNormal( uncompressedDataPath, reconstructedDataPath, startFrameNumber, frameCount, nbThread,
                             normalParams );
   return ret;
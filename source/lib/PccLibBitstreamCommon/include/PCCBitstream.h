@@ -185,6 +185,7 @@ class PCCBitstream {
   void copyFrom( PCCBitstream& dataBitstream, const uint64_t startByte, const uint64_t bitstreamSize );
   void copyTo( PCCBitstream& dataBitstream, uint64_t startByte, uint64_t outputSize );
   void writeVideoStream( PCCVideoBitstream& videoBitstream );
+  // takes the buffer of the bitstream, left empty, when the video stream runs to its end
   void readVideoStream( PCCVideoBitstream& videoBitstream, size_t videoStreamSize );
   bool byteAligned() { return ( position_.bits_ == 0 ); }
   bool moreData() { return position_.bytes_ < data_.size(); }
@@ -268,13 +269,14 @@ class PCCBitstream {
     bool     traceStartingValue = trace_;
     trace_                      = false;
 #endif
-    uint32_t length = 1, temp = ++code;
-    while ( 1 != temp ) {
-      temp >>= 1;
-      length += 2;
+    // code + 1 on length bits, preceded by length - 1 zeros
+    const uint32_t length = floorLog2( ++code ) + 1;
+    if ( 2 * length - 1 <= 32 ) {
+      write( code, 2 * length - 1 );
+    } else {
+      write( 0, length - 1 );
+      write( code, length );
     }
-    write( 0, length >> 1 );
-    write( code, ( length + 1 ) >> 1 );
 #ifdef BITSTREAM_TRACE
     trace_ = traceStartingValue;
     trace( "  CodeUvlc: %4zu \n", orgCode );
@@ -287,15 +289,24 @@ class PCCBitstream {
     trace_                  = false;
 #endif
     uint32_t value = 0, code = 0, length = 0;
-    code = read( 1 );
-    if ( 0 == code ) {
-      length = 0;
-      while ( !( code & 1 ) ) {
-        code = read( 1 );
-        length++;
+    // the leading zeros and the code are read at once when they fit in the bits cached from the position
+    const uint64_t word = peek( position_ );
+    const int      zero = 31 - floorLog2( static_cast<uint32_t>( word >> 32 ) );
+    if ( zero <= 28 ) {
+      length = 2 * zero + 1;
+      value  = static_cast<uint32_t>( word >> ( 64 - length ) ) - 1;
+      skip( length, position_ );
+    } else {
+      code = read( 1 );
+      if ( 0 == code ) {
+        length = 0;
+        while ( !( code & 1 ) ) {
+          code = read( 1 );
+          length++;
+        }
+        value = read( length );
+        value += ( 1 << length ) - 1;
       }
-      value = read( length );
-      value += ( 1 << length ) - 1;
     }
 #ifdef BITSTREAM_TRACE
     trace_ = traceStartingValue;
@@ -347,31 +358,44 @@ class PCCBitstream {
 #endif
  private:
   inline void realloc( const size_t size = 4096 ) { data_.resize( data_.size() + ( ( ( size / 4096 ) + 1 ) * 4096 ) ); }
-  inline uint32_t read( uint8_t bits, PCCBistreamPosition& pos ) {
-    uint32_t value = 0;
-    for ( size_t i = 0; i < bits; i++ ) {
-      value |= ( ( data_[pos.bytes_] >> ( 7 - pos.bits_ ) ) & 1 ) << ( bits - 1 - i );
-      if ( pos.bits_ == 7 ) {
-        pos.bytes_++;
-        pos.bits_ = 0;
-      } else {
-        pos.bits_++;
+  // the 64 bits following the position, msb first: at least 57 bits of the stream, zeros past its end
+  inline uint64_t peek( const PCCBistreamPosition& pos ) const {
+    uint64_t word = 0;
+    if ( pos.bytes_ + 8 <= data_.size() ) {
+      const uint8_t* data = data_.data() + pos.bytes_;
+      for ( size_t i = 0; i < 8; i++ ) { word = ( word << 8 ) | data[i]; }
+    } else {
+      for ( uint64_t i = pos.bytes_; i < pos.bytes_ + 8; i++ ) {
+        word = ( word << 8 ) | ( i < data_.size() ? data_[i] : 0 );
       }
     }
+    return word << pos.bits_;
+  }
+
+  inline void skip( uint32_t bits, PCCBistreamPosition& pos ) {
+    pos.bytes_ += ( pos.bits_ + bits ) >> 3;
+    pos.bits_ = ( pos.bits_ + bits ) & 7;
+  }
+
+  inline uint32_t read( uint8_t bits, PCCBistreamPosition& pos ) {
+    assert( bits <= 32 );
+    if ( bits == 0 ) { return 0; }
+    const uint32_t value = static_cast<uint32_t>( peek( pos ) >> ( 64 - bits ) );
+    skip( bits, pos );
     return value;
   }
 
+  // the field is shifted to the position in a 64-bit word and or-ed in the bytes it covers
   inline void write( uint32_t value, uint8_t bits, PCCBistreamPosition& pos ) {
+    assert( bits <= 32 );
     if ( pos.bytes_ + bits + 16 >= data_.size() ) { realloc(); }
-    for ( size_t i = 0; i < bits; i++ ) {
-      data_[pos.bytes_] |= ( ( value >> ( bits - 1 - i ) ) & 1 ) << ( 7 - pos.bits_ );
-      if ( pos.bits_ == 7 ) {
-        pos.bytes_++;
-        pos.bits_ = 0;
-      } else {
-        pos.bits_++;
-      }
-    }
+    if ( bits == 0 ) { return; }
+    const uint64_t field = ( static_cast<uint64_t>( value ) & ( ( uint64_t( 1 ) << bits ) - 1 ) )
+                           << ( 64 - bits - pos.bits_ );
+    uint8_t*     data  = data_.data() + pos.bytes_;
+    const size_t count = ( pos.bits_ + bits + 7 ) >> 3;
+    for ( size_t i = 0; i < count; i++ ) { data[i] |= static_cast<uint8_t>( field >> ( 56 - 8 * i ) ); }
+    skip( bits, pos );
   }
 
   std::vector<uint8_t> data_;
@@ -51,7 +51,7 @@
 #include <queue>
 #include <algorithm>
 #include <map>
-#include "PCCConfig.h"
+#include "PCCBitstreamConfig.h"
 #if defined( WIN32 )
 #include <windows.h>
 #endif
@@ -0,0 +1,93 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCC_BITSTREAM_SAMPLESTREAMV3CUNITREADER_H
+#define PCC_BITSTREAM_SAMPLESTREAMV3CUNITREADER_H
+
+#include "PCCBitstreamCommon.h"
+#include "PCCSampleStreamV3CUnit.h"
+
+class MD5;
+
+namespace pcc {
+
+// Incremental reader of a sample stream V3C bitstream (Annex C.2): the V3C
+// units are pulled from a file or a pipe ("-" for stdin) one GOF at a time,
+// so that only the units of the GOF being decoded are held in memory.
+class PCCSampleStreamV3CUnitReader {
+ public:
+  PCCSampleStreamV3CUnitReader();
+  ~PCCSampleStreamV3CUnitReader();
+
+  bool   open( const std::string& compressedStreamPath, SampleStreamV3CUnit& ssvu );
+  bool   read( SampleStreamV3CUnit& ssvu );
+  void   close();
+  bool   moreData() { return !eof_; }
+  size_t size() { return size_; }
+  size_t getHeaderSize() { return headerSize_; }
+  // traces the MD5 of the bytes read so far: the bitstream is hashed as it is read, whatever the input (file,
+  // pipe or stdin), and read() traces its MD5 when it reaches the end of the stream
+  void   computeMD5();
+#if defined( BITSTREAM_TRACE ) || defined( CONFORMANCE_TRACE )
+  void setLogger( PCCLogger& logger ) { logger_ = &logger; }
+#endif
+
+ private:
+  bool readBytes( uint8_t* buffer, size_t size );
+#ifdef BITSTREAM_TRACE
+  // the lines of PCCBitstream::trace(), at the position of the bytes and bits read in the stream
+  template <typename... Args>
+  void trace( const uint64_t bytes, const uint8_t bits, const char* format, Args... args ) {
+    if ( logger_ != nullptr ) {
+      logger_->traceStream( "[%6llu - %2u]: ", bytes, bits );
+      logger_->traceStream( format, args... );
+    }
+  }
+#endif
+
+  std::ifstream        file_;
+  std::istream*        stream_;
+  std::unique_ptr<MD5> md5_;
+  uint32_t             precisionBytes_;
+  size_t               size_;
+  size_t               headerSize_;
+  size_t               unitCount_;
+  bool                 eof_;
+#if defined( BITSTREAM_TRACE ) || defined( CONFORMANCE_TRACE )
+  PCCLogger* logger_ = nullptr;
+#endif
+};
+
+};  // namespace pcc
+
+#endif  //~PCC_BITSTREAM_SAMPLESTREAMV3CUNITREADER_H
@@ -37,17 +37,29 @@
 #include "PCCBitstreamCommon.h"
 namespace pcc {
 
+// The video data can be the tail of a buffer taken over from a V3C unit: the bytes
+// before offset_ are dropped only when the vector itself is requested.
 class PCCVideoBitstream {
  public:
-  PCCVideoBitstream( PCCVideoType type ) : type_( type ) { data_.clear(); }
+  PCCVideoBitstream( PCCVideoType type ) : offset_( 0 ), type_( type ) { data_.clear(); }
   ~PCCVideoBitstream() { data_.clear(); }
 
-  PCCVideoBitstream&    operator=( const PCCVideoBitstream& ) = default;
-  void                  resize( size_t size ) { data_.resize( size ); }
-  std::vector<uint8_t>& vector() { return data_; }
-  uint8_t*              buffer() { return data_.data(); }
-  size_t                size() { return data_.size(); }
-  PCCVideoType          type() { return type_; }
+  PCCVideoBitstream& operator=( const PCCVideoBitstream& ) = default;
+  void               resize( size_t size ) {
+    compact();
+    data_.resize( size );
+  }
+  std::vector<uint8_t>& vector() {
+    compact();
+    return data_;
+  }
+  uint8_t*     buffer() { return data_.data() + offset_; }
+  size_t       size() { return data_.size() - offset_; }
+  PCCVideoType type() { return type_; }
+  void         assign( std::vector<uint8_t>& data, size_t offset ) {
+    data_.swap( data );
+    offset_ = offset;
+  }
 
   void trace() { std::cout << "      " << toString( type_ ) << " ->" << size() << " B " << std::endl; }
 
@@ -68,11 +80,67 @@ class PCCVideoBitstream {
                                  bool   changeStartCodeSize      = true );
 
  private:
+  void compact() {
+    if ( offset_ != 0 ) {
+      data_.erase( data_.begin(), data_.begin() + offset_ );
+      offset_ = 0;
+    }
+  }
   size_t               getEndOfNaluPosition( size_t startIndex );
   std::vector<uint8_t> data_;
+  size_t               offset_;
   PCCVideoType         type_;
 };
 
+// std::streambuf reading the video bitstream in place: used to feed the HM/VTM
+// library decoders without copying the payload into a std::string.
+class PCCVideoBitstreamInputBuffer : public std::streambuf {
+ public:
+  PCCVideoBitstreamInputBuffer( PCCVideoBitstream& bitstream ) {
+    char* begin = reinterpret_cast<char*>( bitstream.buffer() );
+    setg( begin, begin, begin + bitstream.size() );
+  }
+
+ protected:
+  pos_type seekoff( off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which ) override {
+    if ( ( which & std::ios_base::in ) == 0 ) { return pos_type( off_type( -1 ) ); }
+    off_type pos = off;
+    if ( dir == std::ios_base::cur ) {
+      pos += gptr() - eback();
+    } else if ( dir == std::ios_base::end ) {
+      pos += egptr() - eback();
+    }
+    if ( pos < 0 || pos > egptr() - eback() ) { return pos_type( off_type( -1 ) ); }
+    setg( eback(), eback() + pos, egptr() );
+    return pos_type( pos );
+  }
+  pos_type seekpos( pos_type pos, std::ios_base::openmode which ) override {
+    return seekoff( off_type( pos ), std::ios_base::beg, which );
+  }
+};
+
+// std::streambuf appending the NAL units written by the HM/VTM library encoders
+// directly at the end of the video bitstream.
+class PCCVideoBitstreamOutputBuffer : public std::streambuf {
+ public:
+  PCCVideoBitstreamOutputBuffer( PCCVideoBitstream& bitstream ) : data_( bitstream.vector() ) {}
+
+ protected:
+  int_type overflow( int_type value ) override {
+    if ( traits_type::eq_int_type( value, traits_type::eof() ) ) { return traits_type::not_eof( value ); }
+    data_.push_back( static_cast<uint8_t>( value ) );
+    return value;
+  }
+  std::streamsize xsputn( const char* buffer, std::streamsize count ) override {
+    data_.insert( data_.end(), reinterpret_cast<const uint8_t*>( buffer ),
+                  reinterpret_cast<const uint8_t*>( buffer ) + count );
+    return count;
+  }
+
+ private:
+  std::vector<uint8_t>& data_;
+};
+
 }  // namespace pcc
 
 #endif /* PCC_BITSTREAM_VIDEOBITSTREAM_H */
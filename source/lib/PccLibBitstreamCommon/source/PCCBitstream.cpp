@@ -90,8 +90,14 @@ void PCCBitstream::readVideoStream( PCCVideoBitstream& videoBitstream, size_t vi
   trace( "%s \n", "Code: PCCVideoBitstream" );
   trace( "Code: size = %zu \n", videoStreamSize );
 #endif
-  videoBitstream.resize( videoStreamSize );
-  memcpy( videoBitstream.buffer(), data_.data() + position_.bytes_, videoStreamSize );
+  if ( position_.bits_ == 0 && position_.bytes_ + videoStreamSize == data_.size() ) {
+    // the video sub-bitstream ends the V3C unit: its buffer is handed over and the data viewed in place
+    videoBitstream.assign( data_, position_.bytes_ );
+    data_.clear();
+  } else {
+    videoBitstream.resize( videoStreamSize );
+    memcpy( videoBitstream.buffer(), data_.data() + position_.bytes_, videoStreamSize );
+  }
   videoBitstream.trace();
   position_.bytes_ += videoStreamSize;
 }
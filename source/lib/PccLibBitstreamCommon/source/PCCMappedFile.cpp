@@ -0,0 +1,107 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCBitstreamCommon.h"
+#include "PCCMappedFile.h"
+#if !defined( WIN32 )
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace pcc;
+
+#if defined( WIN32 )
+PCCMappedFile::PCCMappedFile() : data_( nullptr ), size_( 0 ), file_( nullptr ), mapping_( nullptr ) {}
+#else
+PCCMappedFile::PCCMappedFile() : data_( nullptr ), size_( 0 ) {}
+#endif
+
+PCCMappedFile::~PCCMappedFile() { close(); }
+
+bool PCCMappedFile::open( const std::string& path ) {
+  close();
+#if defined( WIN32 )
+  HANDLE file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, nullptr );
+  if ( file == INVALID_HANDLE_VALUE ) { return false; }
+  LARGE_INTEGER fileSize;
+  if ( !GetFileSizeEx( file, &fileSize ) || fileSize.QuadPart == 0 ) {
+    CloseHandle( file );
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+  if ( mapping == nullptr ) {
+    CloseHandle( file );
+    return false;
+  }
+  void* data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+  if ( data == nullptr ) {
+    CloseHandle( mapping );
+    CloseHandle( file );
+    return false;
+  }
+  file_    = file;
+  mapping_ = mapping;
+  size_    = static_cast<size_t>( fileSize.QuadPart );
+#else
+  int fd = ::open( path.c_str(), O_RDONLY );
+  if ( fd < 0 ) { return false; }
+  struct stat fileStat;
+  if ( fstat( fd, &fileStat ) != 0 || fileStat.st_size == 0 ) {
+    ::close( fd );
+    return false;
+  }
+  void* data = mmap( nullptr, static_cast<size_t>( fileStat.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+  ::close( fd );
+  if ( data == MAP_FAILED ) { return false; }
+  size_ = static_cast<size_t>( fileStat.st_size );
+  madvise( data, size_, MADV_WILLNEED );
+#endif
+  data_ = static_cast<const uint8_t*>( data );
+  return true;
+}
+
+void PCCMappedFile::close() {
+  if ( data_ == nullptr ) { return; }
+#if defined( WIN32 )
+  UnmapViewOfFile( data_ );
+  CloseHandle( static_cast<HANDLE>( mapping_ ) );
+  CloseHandle( static_cast<HANDLE>( file_ ) );
+  mapping_ = nullptr;
+  file_    = nullptr;
+#else
+  munmap( const_cast<uint8_t*>( data_ ), size_ );
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
@@ -0,0 +1,162 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCBitstreamCommon.h"
+#include "PCCSampleStreamV3CUnitReader.h"
+#include "MD5.h"
+
+using namespace pcc;
+
+PCCSampleStreamV3CUnitReader::PCCSampleStreamV3CUnitReader() :
+    stream_( nullptr ),
+    md5_( new MD5 ),
+    precisionBytes_( 0 ),
+    size_( 0 ),
+    headerSize_( 0 ),
+    unitCount_( 0 ),
+    eof_( true ) {}
+
+PCCSampleStreamV3CUnitReader::~PCCSampleStreamV3CUnitReader() { close(); }
+
+// C.2.1 Sample stream V3C header syntax
+bool PCCSampleStreamV3CUnitReader::open( const std::string& compressedStreamPath, SampleStreamV3CUnit& ssvu ) {
+  close();
+  if ( compressedStreamPath == "-" ) {
+    stream_ = &std::cin;
+  } else {
+    file_.open( compressedStreamPath, std::ios::binary );
+    if ( !file_.is_open() ) { return false; }
+    stream_ = &file_;
+  }
+  md5_.reset( new MD5 );
+  size_       = 0;
+  headerSize_ = 0;
+  unitCount_  = 0;
+  eof_        = false;
+
+#ifdef BITSTREAM_TRACE
+  trace( 0, 0, "%s \n", "PCCBitstreamXXcoder: SampleStream Vpcc Unit start" );
+  trace( 0, 0, "%s \n", "sampleStreamV3CHeader" );
+#endif
+  uint8_t header = 0;
+  if ( !readBytes( &header, 1 ) ) { return false; }
+  ssvu.setSsvhUnitSizePrecisionBytesMinus1( header >> 5 );  // u(3) + u(5)
+  precisionBytes_ = ssvu.getSsvhUnitSizePrecisionBytesMinus1() + 1;
+  headerSize_++;
+#ifdef BITSTREAM_TRACE
+  trace( 0, 3, "  CodU[%2u]: %4zu \n", 3, static_cast<size_t>( header >> 5 ) );
+  trace( 1, 0, "  CodU[%2u]: %4zu \n", 5, static_cast<size_t>( header & 31 ) );
+  trace( 1, 0, "UnitSizePrecisionBytesMinus1 %d <=> bytesToRead %d\n", ssvu.getSsvhUnitSizePrecisionBytesMinus1(),
+         ( 8 * ( ssvu.getSsvhUnitSizePrecisionBytesMinus1() + 1 ) ) );
+#endif
+  return true;
+}
+
+// C.2.2 Sample stream V3C unit syntax: the units are appended to ssvu up to
+// the V3C parameter set that starts the next GOF (left in ssvu) or the end of
+// the stream. The trace builds read the whole stream at once, so that the sample
+// stream traces precede the traces of the decoding as for a bitstream read at once.
+bool PCCSampleStreamV3CUnitReader::read( SampleStreamV3CUnit& ssvu ) {
+#ifdef BITSTREAM_TRACE
+  const size_t maxVPS = ( std::numeric_limits<size_t>::max )();
+#else
+  const size_t maxVPS = 2;
+#endif
+  size_t numVPS = 0;
+  for ( auto& unit : ssvu.getV3CUnit() ) { numVPS += unit.getType() == V3C_VPS ? 1 : 0; }
+  printf( "PCCSampleStreamV3CUnitReader read: \n" );
+  while ( !eof_ && numVPS < maxVPS ) {
+    if ( stream_->peek() == std::char_traits<char>::eof() ) {
+      eof_ = true;
+#ifdef BITSTREAM_TRACE
+      trace( size_, 0, "%s \n", "PCCBitstreamXXcoder: SampleStream Vpcc Unit start done" );
+#endif
+      computeMD5();
+      break;
+    }
+#ifdef BITSTREAM_TRACE
+    trace( size_, 0, "%s \n", "sampleStreamV3CUnit" );
+#endif
+    uint8_t sizeBytes[8];
+    size_t  unitSize = 0;
+    if ( !readBytes( sizeBytes, precisionBytes_ ) ) { return false; }
+    for ( size_t i = 0; i < precisionBytes_; i++ ) { unitSize = ( unitSize << 8 ) | sizeBytes[i]; }  // u(v)
+    headerSize_ += precisionBytes_;
+#ifdef BITSTREAM_TRACE
+    trace( size_, 0, "  CodU[%2u]: %4zu \n", static_cast<uint8_t>( 8 * precisionBytes_ ), unitSize );
+#endif
+    if ( unitSize == 0 ) { return false; }
+    auto& v3cUnit = ssvu.addV3CUnit();
+    v3cUnit.setSize( unitSize );
+    v3cUnit.allocate();
+    if ( !readBytes( v3cUnit.getBitstream().buffer(), unitSize ) ) { return false; }
+    auto v3cUnitType = static_cast<V3CUnitType>( v3cUnit.getBitstream().buffer()[0] >> 3 );
+    v3cUnit.setType( v3cUnitType );
+#ifdef BITSTREAM_TRACE
+    trace( size_, 0, "V3CUnitType: %hhu V3CUnitSize: %zu\n", v3cUnitType, v3cUnit.getSize() );
+    trace( size_, 0, "V3C Unit Size(%zuth/%zu)  = %zu \n", unitCount_, unitCount_ + 1, v3cUnit.getSize() );
+#endif
+    unitCount_++;
+    printf( "  v3cUnit: size = %8zu type = %2hhu %s \n", v3cUnit.getSize(), v3cUnitType,
+            toString( V3CUnitType( v3cUnitType ) ).c_str() );
+    if ( v3cUnitType == V3C_VPS ) { numVPS++; }
+  }
+  return true;
+}
+
+void PCCSampleStreamV3CUnitReader::close() {
+  if ( file_.is_open() ) { file_.close(); }
+  stream_ = nullptr;
+  eof_    = true;
+}
+
+void PCCSampleStreamV3CUnitReader::computeMD5() {
+  std::vector<uint8_t> tmp_digest;
+  tmp_digest.resize( 16 );
+  TRACE_BITSTRMD5( "%s", "BITSTRMD5 = " )
+  md5_->finalize( tmp_digest.data() );
+  for ( auto& bitStr : tmp_digest ) TRACE_BITSTRMD5( "%02x", bitStr );
+  std::cout << std::endl;
+}
+
+bool PCCSampleStreamV3CUnitReader::readBytes( uint8_t* buffer, size_t size ) {
+  stream_->read( reinterpret_cast<char*>( buffer ), size );
+  size_t count = static_cast<size_t>( stream_->gcount() );
+  md5_->update( buffer, static_cast<unsigned>( count ) );
+  size_ += count;
+  if ( count != size ) {
+    printf( "PCCSampleStreamV3CUnitReader: truncated bitstream (%zu/%zu bytes read) \n", count, size );
+    eof_ = true;
+    return false;
+  }
+  return true;
+}
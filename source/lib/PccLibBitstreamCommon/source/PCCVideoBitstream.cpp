@@ -60,7 +60,7 @@ std::string PCCVideoBitstream::getExtension() {
 bool PCCVideoBitstream::write( const std::string& filename ) {
   std::ofstream file( filename, std::ios::binary );
   if ( !file.good() ) { return false; }
-  file.write( reinterpret_cast<char*>( data_.data() ), data_.size() );
+  file.write( reinterpret_cast<char*>( buffer() ), size() );
   file.close();
   return true;
 }
@@ -69,6 +69,7 @@ bool PCCVideoBitstream::read( const std::string& filename ) {
   std::ifstream file( filename, std::ios::binary | std::ios::ate );
   if ( !file.good() ) { return false; }
   const uint64_t fileSize = file.tellg();
+  offset_                 = 0;
   resize( (size_t)fileSize );
   file.clear();
   file.seekg( 0 );
@@ -82,33 +83,64 @@ bool PCCVideoBitstream::_read( const std::string& filename ) { return read( file
 bool PCCVideoBitstream::_write( const std::string& filename ) { return write( filename ); }
 #endif
 
+// Copies the nal unit payload, inserting the emulation prevention bytes: only counts the bytes if dst is null.
+static size_t addEmulationPreventionBytes( const uint8_t* src, size_t size, uint8_t* dst ) {
+  size_t count = 0;
+  for ( size_t i = 0, zeroCount = 0; i < size; i++ ) {
+    if ( zeroCount == 3 && src[i] <= 0x03 ) {
+      if ( dst ) { dst[count] = 0x03; }
+      count++;
+      zeroCount = 0;
+    }
+    zeroCount = ( src[i] == 0x00 ) ? zeroCount + 1 : 0;
+    if ( dst ) { dst[count] = src[i]; }
+    count++;
+  }
+  return count;
+}
+
+// Copies the nal unit payload, removing the emulation prevention bytes.
+static size_t removeEmulationPreventionBytes( const uint8_t* src, size_t size, uint8_t* dst ) {
+  size_t count = 0;
+  for ( size_t i = 0, zeroCount = 0; i < size; i++ ) {
+    if ( ( zeroCount == 3 ) && ( src[i] <= 3 ) ) {
+      zeroCount = 0;
+    } else {
+      zeroCount    = ( src[i] == 0 ) ? zeroCount + 1 : 0;
+      dst[count++] = src[i];
+    }
+  }
+  return count;
+}
+
 void PCCVideoBitstream::byteStreamToSampleStream( size_t precision, bool emulationPreventionBytes ) {
-  size_t               startIndex = 0, endIndex = 0;
-  std::vector<uint8_t> data;
+  // nal units [start, end) without their start codes: the sample stream is at most precision bytes per
+  // nal unit larger and is written in a single buffer of that size
+  const uint8_t*                         src        = buffer();
+  size_t                                 startIndex = 0, endIndex = 0, sampleStreamSize = 0;
+  std::vector<std::pair<size_t, size_t>> nalus;
   do {
-    size_t sizeStartCode = data_[startIndex + 2] == 0x00 ? 4 : 3;
+    size_t sizeStartCode = src[startIndex + 2] == 0x00 ? 4 : 3;
     endIndex             = getEndOfNaluPosition( startIndex + sizeStartCode );
-    size_t headerIndex   = data.size();
-    for ( size_t i = 0; i < precision; i++ ) { data.push_back( 0 ); }  // reserve nalu size
+    nalus.emplace_back( startIndex + sizeStartCode, endIndex );
+    sampleStreamSize += precision + endIndex - ( startIndex + sizeStartCode );
+    startIndex = endIndex;
+  } while ( endIndex < size() );
+  std::vector<uint8_t> data( sampleStreamSize );
+  uint8_t*             dst = data.data();
+  for ( const auto& nalu : nalus ) {
+    size_t naluSize = nalu.second - nalu.first;
     if ( emulationPreventionBytes ) {
-      for ( size_t i = startIndex + sizeStartCode, zeroCount = 0; i < endIndex; i++ ) {
-        if ( ( zeroCount == 3 ) && ( data_[i] <= 3 ) ) {
-          zeroCount = 0;
-        } else {
-          zeroCount = ( data_[i] == 0 ) ? zeroCount + 1 : 0;
-          data.push_back( data_[i] );
-        }
-      }
+      naluSize = removeEmulationPreventionBytes( src + nalu.first, naluSize, dst + precision );
     } else {
-      for ( size_t i = startIndex + sizeStartCode; i < endIndex; i++ ) { data.push_back( data_[i] ); }
-    }
-    size_t naluSize = data.size() - ( headerIndex + precision );
-    for ( size_t i = 0; i < precision; i++ ) {
-      data[headerIndex + i] = ( naluSize >> ( 8 * ( precision - ( i + 1 ) ) ) ) & 0xff;
+      memcpy( dst + precision, src + nalu.first, naluSize );
     }
-    startIndex = endIndex;
-  } while ( endIndex < data_.size() );
+    for ( size_t i = 0; i < precision; i++ ) { dst[i] = ( naluSize >> ( 8 * ( precision - ( i + 1 ) ) ) ) & 0xff; }
+    dst += precision + naluSize;
+  }
+  data.resize( dst - data.data() );
   data_.swap( data );
+  offset_ = 0;
 }
 
 void PCCVideoBitstream::sampleStreamToByteStream( bool   isAvc,
@@ -116,30 +148,29 @@ void PCCVideoBitstream::sampleStreamToByteStream( bool   isAvc,
                                                   size_t precision,
                                                   bool   emulationPreventionBytes,
                                                   bool   changeStartCodeSize ) {
-  size_t               sizeStartCode = 4, startIndex = 0, endIndex = 0;
-  std::vector<uint8_t> data;
-  bool                 newFrame = true;
+  struct Nalu {
+    size_t start;
+    size_t end;
+    size_t sizeStartCode;
+  };
+  const uint8_t*    src           = buffer();
+  const size_t      size          = this->size();
+  size_t            sizeStartCode = 4, startIndex = 0, endIndex = 0, byteStreamSize = 0;
+  std::vector<Nalu> nalus;
+  bool              newFrame = true;
   printf( "isAvc = %d isVvc = %d \n", isAvc, isVvc );
+  // the nal units and their start codes are found first to write the byte stream in a buffer of its size
   do {
     int32_t naluSize = 0;
-    for ( size_t i = 0; i < precision; i++ ) { naluSize = ( naluSize << 8 ) + data_[startIndex + i]; }
+    for ( size_t i = 0; i < precision; i++ ) { naluSize = ( naluSize << 8 ) + src[startIndex + i]; }
     endIndex = startIndex + precision + naluSize;
-    for ( size_t i = 0; i < sizeStartCode - 1; i++ ) { data.push_back( 0 ); }
-    data.push_back( 1 );
-    if ( emulationPreventionBytes ) {
-      for ( size_t i = startIndex + precision, zeroCount = 0; i < endIndex; i++ ) {
-        if ( zeroCount == 3 && data_[i] <= 0x03 ) {
-          data.push_back( 0x03 );
-          zeroCount = 0;
-        }
-        zeroCount = ( data_[i] == 0x00 ) ? zeroCount + 1 : 0;
-        data.push_back( data_[i] );
-      }
-    } else {
-      for ( size_t i = startIndex + precision; i < endIndex; i++ ) { data.push_back( data_[i] ); }
-    }
+    nalus.push_back( {startIndex + precision, endIndex, sizeStartCode} );
+    byteStreamSize += sizeStartCode;
+    byteStreamSize += emulationPreventionBytes
+                          ? addEmulationPreventionBytes( src + startIndex + precision, naluSize, nullptr )
+                          : naluSize;
     startIndex = endIndex;
-    if ( ( startIndex + precision ) < data_.size() ) {
+    if ( ( startIndex + precision ) < size ) {
       int  naluType         = 0;
       bool useLongStartCode = false;
       newFrame              = false;
@@ -157,28 +188,44 @@ void PCCVideoBitstream::sampleStreamToByteStream( bool   isAvc,
       if ( isAvc ) {
         useLongStartCode = true;
       } else if ( isVvc ) {
-        naluType         = ( ( ( data_[startIndex + precision + 1] ) & 248 ) >> 3 );
+        naluType         = ( ( ( src[startIndex + precision + 1] ) & 248 ) >> 3 );
         useLongStartCode = newFrame || ( naluType >= 12 && naluType < 20 );
         if ( naluType < 12 ) { newFrame = true; }
       } else {
-        naluType         = ( ( ( data_[startIndex + precision] ) & 126 ) >> 1 );
+        naluType         = ( ( ( src[startIndex + precision] ) & 126 ) >> 1 );
         useLongStartCode = newFrame || ( naluType >= 32 && naluType < 41 );
         if ( naluType < 12 ) { newFrame = true; }
       }
       sizeStartCode = useLongStartCode ? 4 : 3;
     }
-  } while ( endIndex < data_.size() );
+  } while ( endIndex < size );
+  std::vector<uint8_t> data( byteStreamSize, 0 );
+  uint8_t*             dst = data.data();
+  for ( const auto& nalu : nalus ) {
+    dst[nalu.sizeStartCode - 1] = 1;
+    dst += nalu.sizeStartCode;
+    if ( emulationPreventionBytes ) {
+      dst += addEmulationPreventionBytes( src + nalu.start, nalu.end - nalu.start, dst );
+    } else {
+      memcpy( dst, src + nalu.start, nalu.end - nalu.start );
+      dst += nalu.end - nalu.start;
+    }
+  }
   data_.swap( data );
+  offset_ = 0;
 }
 
 size_t PCCVideoBitstream::getEndOfNaluPosition( size_t startIndex ) {
-  const size_t size = data_.size();
+  const uint8_t* data = buffer();
+  const size_t   size = this->size();
   if ( size < startIndex + 4 ) { return size; }
-  for ( size_t i = startIndex; i < size - 4; i++ ) {
-    if ( ( data_[i + 0] == 0x00 ) && ( data_[i + 1] == 0x00 ) &&
-         ( ( data_[i + 2] == 0x01 ) || ( ( data_[i + 2] == 0x00 ) && ( data_[i + 3] == 0x01 ) ) ) ) {
-      return i;
-    }
+  // the start codes are found from their 0x01 bytes, the first one preceded by two or three zeros
+  for ( const uint8_t* one = data + startIndex + 2;
+        ( one = static_cast<const uint8_t*>( memchr( one, 0x01, data + size - one ) ) ) != nullptr; one++ ) {
+    size_t i = one - data;
+    if ( data[i - 1] != 0x00 || data[i - 2] != 0x00 ) { continue; }
+    i -= ( i >= startIndex + 3 && data[i - 3] == 0x00 ) ? 3 : 2;
+    return i < size - 4 ? i : size;
   }
   return size;
 }
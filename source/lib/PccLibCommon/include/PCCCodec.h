@@ -37,6 +37,7 @@
 #include "PCCCommon.h"
 #include "PCCImage.h"
 #include "PCCMath.h"
+#include "PCCSparseGridIndex.h"
 #include "PCCVideo.h"
 #include "PCCContext.h"
 
@@ -239,20 +240,22 @@ class PCCCodec {
                          const int               threshold,
                          const bool              projectionMode );
 
-  std::vector<PCCPoint3D> generatePoints( const GeneratePointCloudParameters&  params,
-                                          PCCFrameContext&                     tile,
-                                          const std::vector<PCCVideoGeometry>& videoMultiple,
-                                          const size_t                         videoFrameIndex,
-                                          const size_t                         patchIndex,
-                                          const size_t                         u,
-                                          const size_t                         v,
-                                          const size_t                         x,
-                                          const size_t                         y,
-                                          const bool                           interpolate = 0,
-                                          const bool                           filling     = 0,
-                                          const size_t                         minD1       = 0,
-                                          const size_t                         neighbor    = 0 );
-  void                    generateAfti( PCCContext& context, size_t frameIndex, AtlasFrameTileInformation& afti );
+  // createdPoints is cleared and filled with the points of the pixel: reusing it avoids an allocation per pixel
+  void generatePoints( const GeneratePointCloudParameters&  params,
+                       PCCFrameContext&                     tile,
+                       const std::vector<PCCVideoGeometry>& videoMultiple,
+                       const size_t                         videoFrameIndex,
+                       const size_t                         patchIndex,
+                       const size_t                         u,
+                       const size_t                         v,
+                       const size_t                         x,
+                       const size_t                         y,
+                       std::vector<PCCPoint3D>&             createdPoints,
+                       const bool                           interpolate = 0,
+                       const bool                           filling     = 0,
+                       const size_t                         minD1       = 0,
+                       const size_t                         neighbor    = 0 );
+  void generateAfti( PCCContext& context, size_t frameIndex, AtlasFrameTileInformation& afti );
 
   inline double entropy( std::vector<uint8_t>& Data, int N ) {
     std::vector<size_t> count;
@@ -341,25 +344,44 @@ class PCCCodec {
   PCCLogger* logger_ = nullptr;
 
  private:
+  // points of the patches without eom codes: counted, then written in parallel at the offsets of the patches.
+  // singleMap: one point per occupied pixel, without plr, pixel interleaving nor second map.
+  template <bool singleMap>
+  void generateRegularPoints( PCCPointSet3&                       reconstruct,
+                              PCCContext&                         context,
+                              size_t                              tileIndex,
+                              const GeneratePointCloudParameters& params,
+                              std::vector<uint32_t>&              partition,
+                              const std::vector<uint32_t>&        patchOrder,
+                              const std::vector<PCCColor3B>&      patchColors,
+                              size_t                              videoFrameIndex,
+                              PCCFrameContext&                    tile );
+  // returns the point count of the patch, written from pointIndex if fill
+  template <bool singleMap, bool fill>
+  size_t generatePatchPoints( PCCPointSet3&                       reconstruct,
+                              uint32_t*                           partition,
+                              size_t                              pointIndex,
+                              std::vector<PCCPoint3D>&            createdPoints,
+                              PCCContext&                         context,
+                              size_t                              tileIndex,
+                              const GeneratePointCloudParameters& params,
+                              size_t                              patchIndex,
+                              const PCCColor3B&                   color,
+                              size_t                              videoFrameIndex,
+                              PCCFrameContext&                    tile );
+
   void smoothPointCloud( PCCPointSet3&                      reconstruct,
                          const std::vector<uint32_t>&       partition,
                          const GeneratePointCloudParameters params );
 
-  void smoothPointCloudGrid( PCCPointSet3&                       reconstruct,
-                             const std::vector<uint32_t>&        partition,
-                             const GeneratePointCloudParameters& params,
-                             uint16_t                            gridWidth,
-                             std::vector<int>&                   cellIndex );
-
-  void addGridCentroid( PCCPoint3D&                     point,
-                        uint32_t                        patchIdx,
-                        std::vector<uint16_t>&          count,
-                        std::vector<PCCVector3<float>>& center,
-                        std::vector<uint32_t>&          partition,
-                        std::vector<bool>&              doSmooth,
-                        uint8_t                         gridSize,
-                        uint16_t                        gridWidth,
-                        int                             cellId );
+  void smoothPointCloudGrid( PCCPointSet3&                         reconstruct,
+                             const std::vector<uint32_t>&          partition,
+                             const GeneratePointCloudParameters&   params,
+                             const std::vector<uint16_t>&          gridCount,
+                             const std::vector<PCCVector3<float>>& center,
+                             const std::vector<uint8_t>&           doSmooth,
+                             uint16_t                              gridWidth,
+                             const PCCSparseGridIndex<int>&        cellIndex );
 
   void addGridColorCentroid( PCCPoint3D&                             point,
                              PCCVector3D&                            color,
@@ -379,6 +401,7 @@ class PCCCodec {
                            std::vector<uint16_t>&              colorGridCount,
                            std::vector<PCCVector3<float>>&     colorCenterGrid,
                            std::vector<bool>&                  colorDoSmooth,
+                           std::vector<std::vector<uint16_t>>& colorLum,
                            uint8_t                             gridSize,
                            PCCVector3D&                        curPosColor,
                            const GeneratePointCloudParameters& params,
@@ -386,19 +409,23 @@ class PCCCodec {
 
   void smoothPointCloudColorLC( PCCPointSet3&                       reconstruct,
                                 const GeneratePointCloudParameters& params,
+                                std::vector<uint16_t>&              colorGridCount,
+                                std::vector<PCCVector3<float>>&     colorCenter,
+                                std::vector<bool>&                  colorDoSmooth,
+                                std::vector<std::vector<uint16_t>>& colorLum,
                                 std::vector<int>&                   cellIndex );
 
-  bool gridFiltering( const std::vector<uint32_t>&    partition,
-                      PCCPointSet3&                   pointCloud,
-                      PCCPoint3D&                     curPoint,
-                      PCCVector3D&                    centroid,
-                      int&                            count,
-                      std::vector<uint16_t>&          gridCount,
-                      std::vector<PCCVector3<float>>& center,
-                      std::vector<bool>&              doSmooth,
-                      uint8_t                         gridSize,
-                      uint16_t                        gridWidth,
-                      std::vector<int>&               cellIndex );
+  bool gridFiltering( const std::vector<uint32_t>&          partition,
+                      PCCPointSet3&                         pointCloud,
+                      PCCPoint3D&                           curPoint,
+                      PCCVector3D&                          centroid,
+                      int&                                  count,
+                      const std::vector<uint16_t>&          gridCount,
+                      const std::vector<PCCVector3<float>>& center,
+                      const std::vector<uint8_t>&           doSmooth,
+                      uint8_t                               gridSize,
+                      uint16_t                              gridWidth,
+                      const PCCSparseGridIndex<int>&        cellIndex );
 
   void identifyBoundaryPoints( const std::vector<uint32_t>& occupancyMap,
                                const size_t                 x,
@@ -412,15 +439,6 @@ class PCCCodec {
 #ifdef CODEC_TRACE
   void printChecksum( PCCPointSet3& ePointcloud, std::string eString );
 #endif
-  std::vector<uint16_t>                  geoSmoothingCount_;
-  std::vector<PCCVector3<float>>         geoSmoothingCenter_;
-  std::vector<bool>                      geoSmoothingDoSmooth_;
-  std::vector<uint32_t>                  geoSmoothingPartition_;
-  std::vector<uint16_t>                  colorSmoothingCount_;
-  std::vector<PCCVector3<float>>         colorSmoothingCenter_;
-  std::vector<bool>                      colorSmoothingDoSmooth_;
-  std::vector<std::pair<size_t, size_t>> colorSmoothingPartition_;
-  std::vector<std::vector<uint16_t>>     colorSmoothingLum_;
 };
 
 };  // namespace pcc
@@ -154,6 +154,25 @@ static inline PCCEndianness PCCSystemEndianness() {
   return ( *( reinterpret_cast<char*>( &num ) ) == 1 ) ? PCC_LITTLE_ENDIAN : PCC_BIG_ENDIAN;
 }
 
+// Codecs linked in the process (HM, VTM and JM libraries, FFMPEG) rely on global state: they are run one at a
+// time. Only the codecs run as external applications code the video sub-streams concurrently.
+static inline bool PCCIsLibraryVideoCodec( const PCCCodecId codecId ) {
+  bool isLibrary = false;
+#ifdef USE_JMLIB_VIDEO_CODEC
+  isLibrary = isLibrary || codecId == JMLIB;
+#endif
+#ifdef USE_HMLIB_VIDEO_CODEC
+  isLibrary = isLibrary || codecId == HMLIB;
+#endif
+#ifdef USE_VTMLIB_VIDEO_CODEC
+  isLibrary = isLibrary || codecId == VTMLIB;
+#endif
+#ifdef USE_FFMPEG_VIDEO_CODEC
+  isLibrary = isLibrary || codecId == FFMPEG;
+#endif
+  return isLibrary;
+}
+
 static inline void PCCDivideRange( const size_t         start,
                                    const size_t         end,
                                    const size_t         chunckCount,
@@ -35,44 +35,74 @@
 #define PCCGroupOfFrames_h
 
 #include "PCCCommon.h"
+#include <atomic>
+#include <mutex>
 
 namespace pcc {
 class PCCPointSet3;
+class PCCKdTree;
+struct PCCKdTreeCacheEntry;
 class PCCGroupOfFrames {
  public:
   PCCGroupOfFrames();
   PCCGroupOfFrames( size_t value );
+  PCCGroupOfFrames( const PCCGroupOfFrames& groupOfFrames );
+  PCCGroupOfFrames& operator=( const PCCGroupOfFrames& groupOfFrames );
   ~PCCGroupOfFrames();
 
-  void                clear() { frames_.clear(); }
-  size_t              getFrameCount() const { return frames_.size(); }
-  void                setFrameCount( size_t n ) { frames_.resize( n ); }
+  void clear() {
+    clearKdTrees();
+    frames_.clear();
+  }
+  size_t getFrameCount() const { return frames_.size(); }
+  void   setFrameCount( size_t n ) {
+    clearKdTrees();
+    frames_.resize( n );
+  }
   const PCCPointSet3& operator[]( const size_t index ) const {
     assert( index < frames_.size() );
     return frames_[index];
   }
   PCCPointSet3& operator[]( const size_t index ) {
     assert( index < frames_.size() );
+    clearKdTrees();
     return frames_[index];
   }
-  std::vector<PCCPointSet3>&          getFrames() { return frames_; }
-  std::vector<PCCPointSet3>::iterator begin() { return frames_.begin(); }
+  std::vector<PCCPointSet3>& getFrames() {
+    clearKdTrees();
+    return frames_;
+  }
+  std::vector<PCCPointSet3>::iterator begin() {
+    clearKdTrees();
+    return frames_.begin();
+  }
   std::vector<PCCPointSet3>::iterator end() { return frames_.end(); }
 
+  // k-d tree of the positions of a frame, built on the first request and shared (read-only) by the
+  // next ones. The cached trees are released as soon as the frames are accessed for modification.
+  const PCCKdTree& getKdTree( const size_t index ) const;
+
   bool load( const std::string&      uncompressedDataPath,
              const size_t            startFrameNumber,
              const size_t            endFrameNumber,
              const PCCColorTransform colorTransform,
-             const bool              readNormals = false,
-             const size_t            nbThread    = 1 );
+             const bool              readNormals = false );
 
   bool write( const std::string& reconstructedDataPath,
               size_t&            frameNumber,
-              const size_t       nbThread = 1,
-              const bool         isAscii  = true );
+              const bool         isAscii = true,
+              const bool         isInt16 = false );
 
  private:
-  std::vector<PCCPointSet3> frames_;
+  void clearKdTrees() {
+    if ( hasKdTrees_ ) { releaseKdTrees(); }
+  }
+  void releaseKdTrees();
+
+  std::vector<PCCPointSet3>                                 frames_;
+  mutable std::vector<std::shared_ptr<PCCKdTreeCacheEntry>> kdtrees_;
+  mutable std::mutex                                        kdtreesMutex_;
+  mutable std::atomic<bool>                                 hasKdTrees_;
 };
 }  // namespace pcc
 
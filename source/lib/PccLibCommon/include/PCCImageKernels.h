@@ -0,0 +1,68 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCImageKernels_h
+#define PCCImageKernels_h
+
+#include "PCCCommon.h"
+
+namespace pcc {
+
+// Instruction sets the image kernels can be dispatched to.
+enum PCCSimdLevel { SIMD_NONE = 0, SIMD_SSE41 = 1, SIMD_AVX2 = 2 };
+
+// Widest instruction set supported by the processor.
+PCCSimdLevel getSupportedSimdLevel();
+
+// Instruction set used by the kernels: the supported one unless it has been lowered by setSimdLevel().
+PCCSimdLevel getSimdLevel();
+void         setSimdLevel( PCCSimdLevel level );
+
+// Averages the 2x2 blocks of a width x height plane into a plane of width / 2 samples per row.
+template <typename T>
+void downsamplePlane2x2( const T* src, T* dst, const size_t width, const size_t height );
+
+// Duplicates the samples of a plane of width / 2 samples per row into the 2x2 blocks of a width x height plane.
+template <typename T>
+void upsamplePlane2x2( const T* src, T* dst, const size_t width, const size_t height );
+
+// Bit depth conversion of count consecutive samples.
+template <typename T>
+void shiftRightPlane( T* data, const size_t count, const int shift );
+template <typename T>
+void shiftLeftPlane( T* data, const size_t count, const int shift );
+template <typename T>
+void clipPlane( T* data, const size_t count, const T maxValue );
+
+}  // namespace pcc
+
+#endif /* PCCImageKernels_h */
@@ -82,6 +82,8 @@ class PCCNNResult {
   std::vector<double> dist_;
 };
 
+// Nearest neighbor search in a set of integer voxel positions. The neighbors are sorted by distance then by
+// index, the distances are the squared euclidean distances.
 class PCCKdTree {
  public:
   PCCKdTree();
@@ -94,6 +96,13 @@ class PCCKdTree {
                      const double      radius,
                      PCCNNResult&      results ) const;
 
+  // k nearest neighbors of a list of points, searched in parallel. Returns the number of neighbors n of each
+  // point, min( num_results, size of the cloud ): the neighbors of points[i] are stored from i * n.
+  size_t search( const std::vector<PCCPoint3D>& points,
+                 const size_t                   num_results,
+                 std::vector<uint32_t>&         indices,
+                 std::vector<double>&           dists ) const;
+
  private:
   void  clear();
   void* kdtree_;
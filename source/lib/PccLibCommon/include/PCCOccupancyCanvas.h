@@ -0,0 +1,120 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCOccupancyCanvas_h
+#define PCCOccupancyCanvas_h
+
+#include "PCCCommon.h"
+
+namespace pcc {
+
+// Block occupancy of the canvas the patches are packed in. The blocks are indexed as in the
+// std::vector<bool> it replaces (u + sizeU * v) but they are stored in 64-bit words, so the
+// footprint of a patch is tested against a row of the canvas a word at a time.
+class PCCOccupancyCanvas {
+ public:
+  class reference {
+   public:
+    reference( uint64_t& word, const uint64_t bit ) : word_( word ), bit_( bit ) {}
+    operator bool() const { return ( word_ & bit_ ) != 0; }
+    reference& operator=( const bool value ) {
+      word_ = value ? ( word_ | bit_ ) : ( word_ & ~bit_ );
+      return *this;
+    }
+    reference& operator=( const reference& value ) { return *this = bool( value ); }
+
+   private:
+    uint64_t& word_;
+    uint64_t  bit_;
+  };
+
+  PCCOccupancyCanvas() : size_( 0 ) {}
+  ~PCCOccupancyCanvas() = default;
+
+  size_t    size() const { return size_; }
+  bool      operator[]( const size_t pos ) const { return ( ( words_[pos >> 6] >> ( pos & 63 ) ) & 1 ) != 0; }
+  reference operator[]( const size_t pos ) { return reference( words_[pos >> 6], uint64_t( 1 ) << ( pos & 63 ) ); }
+
+  // The blocks kept are unchanged and the new ones are set to value, as std::vector<bool>::resize().
+  void resize( const size_t size, const bool value = false ) {
+    const size_t prevSize = size_;
+    words_.resize( ( size + 63 ) >> 6, 0 );
+    size_ = size;
+    if ( value ) {
+      for ( size_t pos = prevSize; pos < size_; ++pos ) { ( *this )[pos] = true; }
+    }
+    // the bits past the end stay cleared so that getWord() can read whole words
+    if ( ( size_ & 63 ) != 0 ) { words_.back() &= ( uint64_t( 1 ) << ( size_ & 63 ) ) - 1; }
+  }
+
+  // 64 consecutive blocks from pos, the blocks past the end of the canvas are empty.
+  uint64_t getWord( const size_t pos ) const {
+    const size_t index = pos >> 6;
+    const size_t shift = pos & 63;
+    if ( index >= words_.size() ) { return 0; }
+    uint64_t word = words_[index] >> shift;
+    if ( shift != 0 && index + 1 < words_.size() ) { word |= words_[index + 1] << ( 64 - shift ); }
+    return word;
+  }
+
+  // True if one of the blocks of the count mask words placed at pos is occupied.
+  bool intersects( const uint64_t* mask, const size_t count, const size_t pos ) const {
+    for ( size_t i = 0; i < count; ++i ) {
+      if ( ( getWord( pos + 64 * i ) & mask[i] ) != 0 ) { return true; }
+    }
+    return false;
+  }
+
+  // Number of consecutive positions from pos, pos included, at which the count mask words are known to
+  // intersect the occupied blocks. The last occupied block under the mask at pos stays under the run of
+  // set mask bits that ends on it while the mask moves right by less than the length of the run.
+  size_t intersectionSpan( const uint64_t* mask, const size_t count, const size_t pos ) const {
+    for ( size_t i = count; i-- > 0; ) {
+      const uint64_t hits = getWord( pos + 64 * i ) & mask[i];
+      if ( hits == 0 ) { continue; }
+      size_t last = 64 * i + 63;
+      while ( ( ( hits >> ( last & 63 ) ) & 1 ) == 0 ) { --last; }
+      size_t first = last;
+      while ( first > 0 && ( ( mask[( first - 1 ) >> 6] >> ( ( first - 1 ) & 63 ) ) & 1 ) != 0 ) { --first; }
+      return last - first + 1;
+    }
+    return 0;
+  }
+
+ private:
+  size_t                size_;
+  std::vector<uint64_t> words_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCOccupancyCanvas_h */
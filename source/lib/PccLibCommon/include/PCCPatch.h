@@ -36,6 +36,7 @@
 
 #include "PCCCommon.h"
 #include "PCCPointSet.h"
+#include "PCCOccupancyCanvas.h"
 
 namespace pcc {
 
@@ -70,10 +71,29 @@ struct GPAPatchData {
   }
 };
 
+// Footprint of a patch on the packing canvas for one orientation, dilated by the safeguard
+// distance: one row of 64-bit words per row of blocks of the canvas.
+struct PCCPatchCanvasMask {
+  size_t                orientation_;
+  size_t                sizeU0_;
+  size_t                sizeV0_;
+  bool                  precedence_;
+  int                   safeguard_;
+  size_t                width_;
+  size_t                height_;
+  size_t                wordCount_;
+  std::vector<uint64_t> words_;
+};
+
 class PCCPatch {
  public:
   PCCPatch();
   ~PCCPatch();
+  // the patches are moved when the lists of patches are sorted or reordered, without copying their maps
+  PCCPatch( const PCCPatch& ) = default;
+  PCCPatch( PCCPatch&& )      = default;
+  PCCPatch& operator=( const PCCPatch& ) = default;
+  PCCPatch& operator=( PCCPatch&& ) = default;
   size_t                      getEOMCount() const { return eomCount_; }
   size_t                      getEOMandD1Count() const { return eomandD1Count_; }
   size_t                      getD0Count() const { return d0Count_; }
@@ -141,10 +161,16 @@ class PCCPatch {
   void setNormalAxis( size_t value ) { normalAxis_ = value; }
   void setTangentAxis( size_t value ) { tangentAxis_ = value; }
   void setBitangentAxis( size_t value ) { bitangentAxis_ = value; }
-  void setOccupancy( const std::vector<bool>& occupancy ) { occupancy_ = occupancy; }
+  void setOccupancy( const std::vector<bool>& occupancy ) {
+    occupancy_ = occupancy;
+    clearCanvasMasks();
+  }
   void setDepth( size_t i, const std::vector<int16_t>& depth ) { depth_[i] = depth; }
   void setDepth( size_t i, size_t j, int16_t value ) { depth_[i][j] = value; }
-  void setOccupancy( size_t i, bool value ) { occupancy_[i] = value; }
+  void setOccupancy( size_t i, bool value ) {
+    occupancy_[i] = value;
+    clearCanvasMasks();
+  }
   void setDepth0PccIdx( size_t i, int64_t value ) { depth0PCidx_[i] = value; }
   void setDepthEOM( size_t i, int16_t value ) { depthEOM_[i] = value; }
   void setAxisOfAdditionalPlane( size_t value ) { axisOfAdditionalPlane_ = value; }
@@ -168,10 +194,16 @@ class PCCPatch {
   void setPatchSize2DYInPixel( size_t value ) { size2DYInPixel_ = value; }
 
   void allocDepth( size_t i, size_t size, int16_t value ) { depth_[i].resize( size, value ); }
-  void allocOccupancy( size_t size, bool value ) { occupancy_.resize( size, value ); }
+  void allocOccupancy( size_t size, bool value ) {
+    occupancy_.resize( size, value );
+    clearCanvasMasks();
+  }
   void allocDepth0PccIdx( size_t size, int64_t value ) { depth0PCidx_.resize( size, value ); }
   void allocDepthEOM( size_t size, int16_t value ) { depthEOM_.resize( size, value ); }
-  void clearOccupancy() { occupancy_.clear(); }
+  void clearOccupancy() {
+    occupancy_.clear();
+    clearCanvasMasks();
+  }
   void clearDepth( size_t i ) { depth_[i].clear(); }
 
   inline double generateNormalCoordinate( const uint16_t depth ) const {
@@ -216,12 +248,15 @@ class PCCPatch {
                                  size_t       canvasHeightBlk,
                                  const Tile   tile = Tile() ) const;
 
-  bool checkFitPatchCanvas( std::vector<bool> canvas,
-                            size_t            canvasStrideBlk,
-                            size_t            canvasHeightBlk,
-                            bool              bPrecedence,
-                            int               safeguard = 0,
-                            const Tile        tile      = Tile() );
+  // When the patch does not fit, span is set to the number of positions from u0 on the row, u0 included,
+  // where it is known not to fit: the scans of the canvas can skip them without changing the position found.
+  bool checkFitPatchCanvas( const PCCOccupancyCanvas& canvas,
+                            size_t                    canvasStrideBlk,
+                            size_t                    canvasHeightBlk,
+                            bool                      bPrecedence,
+                            int                       safeguard = 0,
+                            const Tile                tile      = Tile(),
+                            size_t*                   span      = nullptr );
 
   bool        smallerRefFirst( const PCCPatch& rhs );
   bool        gt( const PCCPatch& rhs );
@@ -261,21 +296,21 @@ class PCCPatch {
                       std::vector<int>& rightHorizon,
                       std::vector<int>& leftHorizon );
 
-  GPAPatchData& getPreGPAPatchData() { return preGPAPatchData_; }
-  GPAPatchData  getPreGPAPatchData() const { return preGPAPatchData_; }
-  GPAPatchData& getCurGPAPatchData() { return curGPAPatchData_; }
-  GPAPatchData  getCurGPAPatchData() const { return curGPAPatchData_; }
+  GPAPatchData&       getPreGPAPatchData() { return preGPAPatchData_; }
+  GPAPatchData        getPreGPAPatchData() const { return preGPAPatchData_; }
+  GPAPatchData&       getCurGPAPatchData() { return curGPAPatchData_; }
+  const GPAPatchData& getCurGPAPatchData() const { return curGPAPatchData_; }
 
   int patchBlock2CanvasBlockForGPA( const size_t uBlk,
                                     const size_t vBlk,
                                     size_t       canvasStrideBlk,
                                     size_t       canvasHeightBlk ) const;
 
-  bool checkFitPatchCanvasForGPA( std::vector<bool> canvas,
-                                  size_t            canvasStrideBlk,
-                                  size_t            canvasHeightBlk,
-                                  bool              bPrecedence,
-                                  int               safeguard = 0 );
+  bool checkFitPatchCanvasForGPA( const PCCOccupancyCanvas& canvas,
+                                  size_t                    canvasStrideBlk,
+                                  size_t                    canvasHeightBlk,
+                                  bool                      bPrecedence,
+                                  int                       safeguard = 0 );
 
   void     allocOneLayerData();
   uint8_t& getPointLocalReconstructionLevel() { return pointLocalReconstructionLevel_; }
@@ -350,6 +385,24 @@ class PCCPatch {
                   std::vector<PCCPatch>& patches );
 
  private:
+  static bool patchBlock2CanvasOffset( const size_t orientation,
+                                       const size_t sizeU0,
+                                       const size_t sizeV0,
+                                       const size_t uBlk,
+                                       const size_t vBlk,
+                                       size_t&      x,
+                                       size_t&      y );
+  void        updateCanvasMask( PCCPatchCanvasMask& mask,
+                                const size_t        orientation,
+                                const size_t        sizeU0,
+                                const size_t        sizeV0,
+                                const bool          bPrecedence,
+                                const int           safeguard ) const;
+  void        clearCanvasMasks() {
+    canvasMasks_.clear();
+    gpaCanvasMask_.words_.clear();
+  }
+
   size_t                  index_;          // patch index
   size_t                  originalIndex_;  // patch original index
   size_t                  frameIndex_;     // Frame index
@@ -406,6 +459,9 @@ class PCCPatch {
   std::vector<int16_t>    depthMap_;            // Depth map
   std::vector<uint8_t>    occupancyMap_;        // Occupancy map
   std::vector<PCCPoint3D> borderPoints_;        // 3D points created from borders of the patch
+
+  std::vector<PCCPatchCanvasMask> canvasMasks_;    // footprints on the packing canvas, by orientation
+  PCCPatchCanvasMask              gpaCanvasMask_;  // footprint of the global patch allocation data
 };
 
 class PatchBlockFiltering {
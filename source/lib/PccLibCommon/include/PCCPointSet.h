@@ -39,6 +39,21 @@
 
 namespace pcc {
 
+class PCCKdTree;
+
+// Per-point normal, tile/patch and parent indexes of the point sets. The compact layout
+// (USE_COMPACT_POINTSET) stores the normals in single precision and the indexes on 32 bits, which
+// divides by two the memory used by these attributes.
+#ifdef USE_COMPACT_POINTSET
+typedef PCCVector3<float>             PCCPointNormal3;
+typedef std::pair<uint32_t, uint32_t> PCCPointPatchIndex;
+typedef uint32_t                      PCCPointParentIndex;
+#else
+typedef PCCNormal3D               PCCPointNormal3;
+typedef std::pair<size_t, size_t> PCCPointPatchIndex;
+typedef uint64_t                  PCCPointParentIndex;
+#endif
+
 class PCCPointSet3 {
  public:
   PCCPointSet3() : withNormals_( false ), withColors_( false ), withReflectances_( false ) {}
@@ -55,14 +70,14 @@ class PCCPointSet3 {
     return positions_[index];
   }
   size_t appendPointSet( PCCPointSet3& pointSet ) {
-    std::vector<PCCPoint3D>::iterator                itPositions;
-    std::vector<PCCColor3B>::iterator                itColors;
-    std::vector<PCCColor16bit>::iterator             itColors16bit;
-    std::vector<uint16_t>::iterator                  itReflectances;
-    std::vector<uint16_t>::iterator                  itBoundaryPointTypes;
-    std::vector<std::pair<size_t, size_t>>::iterator itPointPatchIndexes;
-    std::vector<uint8_t>::iterator                   itTypes;
-    std::vector<PCCNormal3D>::iterator               itNormals;
+    std::vector<PCCPoint3D>::iterator         itPositions;
+    std::vector<PCCColor3B>::iterator         itColors;
+    std::vector<PCCColor16bit>::iterator      itColors16bit;
+    std::vector<uint16_t>::iterator           itReflectances;
+    std::vector<uint16_t>::iterator           itBoundaryPointTypes;
+    std::vector<PCCPointPatchIndex>::iterator itPointPatchIndexes;
+    std::vector<uint8_t>::iterator            itTypes;
+    std::vector<PCCPointNormal3>::iterator    itNormals;
 
     itPositions          = positions_.end();
     itColors             = colors_.end();
@@ -177,12 +192,12 @@ class PCCPointSet3 {
     assert( index < boundaryPointTypes_.size() );
     boundaryPointTypes_[index] = BoundaryPointType;
   }
-  std::vector<std::pair<size_t, size_t>>& getPointPatchIndexes() { return pointPatchIndexes_; }
-  std::pair<size_t, size_t>               getPointPatchIndex( const size_t index ) const {
+  std::vector<PCCPointPatchIndex>& getPointPatchIndexes() { return pointPatchIndexes_; }
+  PCCPointPatchIndex               getPointPatchIndex( const size_t index ) const {
     assert( index < pointPatchIndexes_.size() );
     return pointPatchIndexes_[index];
   }
-  std::pair<size_t, size_t>& getPointPatchIndex( const size_t index ) {
+  PCCPointPatchIndex& getPointPatchIndex( const size_t index ) {
     assert( index < pointPatchIndexes_.size() );
     return pointPatchIndexes_[index];
   }
@@ -191,9 +206,9 @@ class PCCPointSet3 {
     pointPatchIndexes_[index].first  = tileIndex;
     pointPatchIndexes_[index].second = patchIndex;
   }
-  std::vector<uint64_t>& getParentPointIndex() { return parentPointIndex_; }
-  uint64_t&              getParentPointIndex( const size_t index ) { return parentPointIndex_[index]; }
-  void                   setParentPointIndex( const size_t index, const uint64_t parentIndex ) {
+  std::vector<PCCPointParentIndex>& getParentPointIndex() { return parentPointIndex_; }
+  PCCPointParentIndex&              getParentPointIndex( const size_t index ) { return parentPointIndex_[index]; }
+  void                              setParentPointIndex( const size_t index, const uint64_t parentIndex ) {
     assert( index < parentPointIndex_.size() );
     parentPointIndex_[index] = parentIndex;
   }
@@ -254,9 +269,13 @@ class PCCPointSet3 {
     withColors_ = false;
     colors16bit_.resize( 0 );
   }
-  const std::vector<PCCNormal3D>& getNormals() const { return normals_; }
-  bool                            hasNormals() const { return withNormals_; }
-  void                            addNormals() {
+  const std::vector<PCCPointNormal3>& getNormals() const { return normals_; }
+  PCCNormal3D                         getNormal( const size_t index ) const {
+    assert( index < normals_.size() && withNormals_ );
+    return normals_[index];
+  }
+  bool hasNormals() const { return withNormals_; }
+  void addNormals() {
     withNormals_ = true;
     resize( getPointCount() );
   }
@@ -285,23 +304,24 @@ class PCCPointSet3 {
     fflush( stdout );
   }
 
-  bool transferColors( PCCPointSet3& target,
-                       const int32_t searchRange,
-                       const bool    losslessAttribute                       = false,
-                       const int     numNeighborsColorTransferFwd            = 1,
-                       const int     numNeighborsColorTransferBwd            = 1,
-                       const bool    useDistWeightedAverageFwd               = true,
-                       const bool    useDistWeightedAverageBwd               = true,
-                       const bool    skipAvgIfIdenticalSourcePointPresentFwd = true,
-                       const bool    skipAvgIfIdenticalSourcePointPresentBwd = true,
-                       const double  distOffsetFwd                           = 0.0001,
-                       const double  distOffsetBwd                           = 0.0001,
-                       double        maxGeometryDist2Fwd                     = 10000.0,
-                       double        maxGeometryDist2Bwd                     = 10000.0,
-                       double        maxColorDist2Fwd                        = 10000.0,
-                       double        maxColorDist2Bwd                        = 10000.0,
-                       const bool    excludeColorOutlier                     = false,
-                       const double  thresholdColorOutlierDist               = 10.0 ) const;
+  bool transferColors( PCCPointSet3&    target,
+                       const int32_t    searchRange,
+                       const bool       losslessAttribute                       = false,
+                       const int        numNeighborsColorTransferFwd            = 1,
+                       const int        numNeighborsColorTransferBwd            = 1,
+                       const bool       useDistWeightedAverageFwd               = true,
+                       const bool       useDistWeightedAverageBwd               = true,
+                       const bool       skipAvgIfIdenticalSourcePointPresentFwd = true,
+                       const bool       skipAvgIfIdenticalSourcePointPresentBwd = true,
+                       const double     distOffsetFwd                           = 0.0001,
+                       const double     distOffsetBwd                           = 0.0001,
+                       double           maxGeometryDist2Fwd                     = 10000.0,
+                       double           maxGeometryDist2Bwd                     = 10000.0,
+                       double           maxColorDist2Fwd                        = 10000.0,
+                       double           maxColorDist2Bwd                        = 10000.0,
+                       const bool       excludeColorOutlier                     = false,
+                       const double     thresholdColorOutlierDist               = 10.0,
+                       const PCCKdTree* sourceKdTree                            = nullptr ) const;
 
   bool transferColors16bitBP( PCCPointSet3& target,
                               const int     filterType,
@@ -475,7 +495,7 @@ class PCCPointSet3 {
     if ( !buf.empty() ) tokens.push_back( buf );
     return !tokens.empty();
   }
-  bool write( const std::string& fileName, const bool asAscii = false );
+  bool write( const std::string& fileName, const bool asAscii = false, const bool asInt16 = false );
   bool read( const std::string& fileName, const bool readNormals = false );
   void convertRGBToYUV();
   void convertRGBToYUVClosedLoop();
@@ -483,6 +503,9 @@ class PCCPointSet3 {
 
   void removeDuplicate();
   void distanceGeo( const PCCPointSet3& pointcloud, float& distPAB, float& distPBA ) const;
+  // mean squared distance of the points to their nearest neighbors in the point cloud indexed by kdtree: the
+  // index of a point cloud compared with several others is built once.
+  void distance( const PCCKdTree& kdtree, float& distP ) const;
   void distanceGeoColor( const PCCPointSet3& pointcloud,
                          float&              distPAB,
                          float&              distPBA,
@@ -517,18 +540,18 @@ class PCCPointSet3 {
   void distance( const PCCPointSet3& pointcloud, float& distP ) const;
   std::vector<uint8_t> computeMd5();
 
-  std::vector<PCCPoint3D>                positions_;
-  std::vector<PCCColor3B>                colors_;
-  std::vector<PCCColor16bit>             colors16bit_;
-  std::vector<uint16_t>                  reflectances_;
-  std::vector<uint16_t>                  boundaryPointTypes_;
-  std::vector<std::pair<size_t, size_t>> pointPatchIndexes_;
-  std::vector<uint64_t>                  parentPointIndex_;
-  std::vector<uint8_t>                   types_;
-  std::vector<PCCNormal3D>               normals_;
-  bool                                   withNormals_;
-  bool                                   withColors_;
-  bool                                   withReflectances_;
+  std::vector<PCCPoint3D>          positions_;
+  std::vector<PCCColor3B>          colors_;
+  std::vector<PCCColor16bit>       colors16bit_;
+  std::vector<uint16_t>            reflectances_;
+  std::vector<uint16_t>            boundaryPointTypes_;
+  std::vector<PCCPointPatchIndex>  pointPatchIndexes_;
+  std::vector<PCCPointParentIndex> parentPointIndex_;
+  std::vector<uint8_t>             types_;
+  std::vector<PCCPointNormal3>     normals_;
+  bool                             withNormals_;
+  bool                             withColors_;
+  bool                             withReflectances_;
 };
 }  // namespace pcc
 
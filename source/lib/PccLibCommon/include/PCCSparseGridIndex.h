@@ -0,0 +1,106 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCSparseGridIndex_h
+#define PCCSparseGridIndex_h
+
+#include "PCCCommon.h"
+
+namespace pcc {
+
+// Index of the occupied cells of a 3D grid: maps the cell ids (x + y * w + z * w * w) to the
+// indexes 0..size()-1, in insertion order. Only the occupied cells are stored, in an open
+// addressing table, so the memory doesn't grow with the grid resolution as a dense w^3 array.
+// find() can be called from several threads once the index is built. T is the signed integer
+// type of the cell ids, int64_t when w^3 doesn't fit in an int.
+template <typename T>
+class PCCSparseGridIndex {
+ public:
+  PCCSparseGridIndex() : size_( 0 ), shift_( 64 ) {}
+  ~PCCSparseGridIndex() = default;
+
+  size_t size() const { return size_; }
+
+  void reserve( const size_t count ) {
+    size_t capacity = 16;
+    while ( capacity < 2 * count ) { capacity *= 2; }
+    if ( capacity > slots_.size() ) { rehash( capacity ); }
+  }
+
+  // Index of the cell, added at the end of the index if not present.
+  int insert( const T cellId ) {
+    if ( 2 * ( size_ + 1 ) > slots_.size() ) { rehash( (std::max)( slots_.size() * 2, size_t( 16 ) ) ); }
+    size_t slot = hash( cellId );
+    while ( slots_[slot].first != -1 ) {
+      if ( slots_[slot].first == cellId ) { return slots_[slot].second; }
+      slot = ( slot + 1 ) & ( slots_.size() - 1 );
+    }
+    slots_[slot] = std::make_pair( cellId, static_cast<int>( size_ ) );
+    return static_cast<int>( size_++ );
+  }
+
+  // Index of the cell, -1 if the cell is not in the index.
+  int find( const T cellId ) const {
+    if ( size_ == 0 ) { return -1; }
+    size_t slot = hash( cellId );
+    while ( slots_[slot].first != -1 ) {
+      if ( slots_[slot].first == cellId ) { return slots_[slot].second; }
+      slot = ( slot + 1 ) & ( slots_.size() - 1 );
+    }
+    return -1;
+  }
+
+ private:
+  size_t hash( const T cellId ) const {
+    return static_cast<size_t>( ( static_cast<uint64_t>( cellId ) * 0x9E3779B97F4A7C15ULL ) >> shift_ );
+  }
+  void rehash( const size_t capacity ) {
+    std::vector<std::pair<T, int>> slots( capacity, std::make_pair( T( -1 ), -1 ) );
+    std::swap( slots, slots_ );
+    shift_ = 64;
+    for ( size_t c = capacity; c > 1; c >>= 1 ) { shift_--; }
+    for ( auto& cell : slots ) {
+      if ( cell.first == -1 ) { continue; }
+      size_t slot = hash( cell.first );
+      while ( slots_[slot].first != -1 ) { slot = ( slot + 1 ) & ( capacity - 1 ); }
+      slots_[slot] = cell;
+    }
+  }
+
+  size_t                         size_;
+  int                            shift_;
+  std::vector<std::pair<T, int>> slots_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCSparseGridIndex_h */
@@ -0,0 +1,111 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCTaskScheduler_h
+#define PCCTaskScheduler_h
+
+#include "PCCCommon.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#ifndef TBB_PREVIEW_GLOBAL_CONTROL
+#define TBB_PREVIEW_GLOBAL_CONTROL 1
+#endif
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
+
+namespace pcc {
+
+class PCCAffinityObserver;
+
+// Process-wide TBB scheduler shared by all the encoder and decoder stages. The
+// thread budget and the cpu affinity are set once by the applications (or by
+// PCCEncoder::encode/PCCDecoder::decode) and every parallel stage submits its work
+// through execute() so the limit applies to the whole process. The arena is never
+// replaced while an execute() is running: a reconfiguration requested at that time
+// is refused and the current configuration is kept.
+class PCCTaskScheduler {
+ public:
+  static PCCTaskScheduler& getInstance();
+
+  // nbThread = 0: use all the available cores.
+  // cpuAffinity: list of cpus ("0-7,16-23") the worker threads are pinned to, empty to disable pinning.
+  // Returns false if the scheduler is in use with another configuration.
+  bool               configure( const size_t nbThread, const std::string& cpuAffinity = "" );
+  size_t             getThreadCount() const { return threadCount_; }
+  const std::string& getCpuAffinity() const { return cpuAffinity_; }
+
+  template <typename Function>
+  void execute( const Function& function ) {
+    Execution execution( *this );
+    arena_->execute( function );
+  }
+
+  // Runs independent tasks concurrently and waits for all of them. With CONFORMANCE_TRACE or
+  // concurrent = false, the tasks run one after the other in their order on the calling thread.
+  void executeTasks( const std::vector<std::function<void()>>& tasks, const bool concurrent = true );
+
+  static bool parseCpuList( const std::string& cpuList, std::vector<int>& cpus );
+
+ private:
+  PCCTaskScheduler();
+  ~PCCTaskScheduler();
+  PCCTaskScheduler( const PCCTaskScheduler& ) = delete;
+  PCCTaskScheduler& operator=( const PCCTaskScheduler& ) = delete;
+  void              acquire();
+  void              release() { executionCount_--; }
+  void              configureLocked( const size_t nbThread, const std::string& cpuAffinity );
+  void              clear();
+
+  // counts the running execute() calls for the lifetime of the arena they use
+  class Execution {
+   public:
+    Execution( PCCTaskScheduler& scheduler ) : scheduler_( scheduler ) { scheduler_.acquire(); }
+    ~Execution() { scheduler_.release(); }
+
+   private:
+    PCCTaskScheduler& scheduler_;
+  };
+
+  std::mutex                           mutex_;
+  size_t                               threadCount_;
+  std::string                          cpuAffinity_;
+  std::atomic<bool>                    configured_;
+  std::atomic<size_t>                  executionCount_;
+  std::unique_ptr<tbb::task_arena>     arena_;
+  std::unique_ptr<PCCAffinityObserver> observer_;
+  std::unique_ptr<tbb::global_control> globalControl_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCTaskScheduler_h */
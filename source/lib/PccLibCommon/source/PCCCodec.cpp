@@ -37,15 +37,37 @@
 #include "PCCPointSet.h"
 #include "tbb/tbb.h"
 #include "PCCKdTree.h"
+#include "PCCTaskScheduler.h"
 #include "PCCContext.h"
 #include "PCCFrameContext.h"
 #include "PCCGroupOfFrames.h"
 #include "PCCPatch.h"
 
 #include "PCCCodec.h"
+#include <random>
 
 using namespace pcc;
 
+// Sum of the points of a geometry smoothing grid cell and range of their patch indexes.
+struct PCCGridCellSum {
+  int64_t  sum_[3]      = {0, 0, 0};
+  uint32_t count_       = 0;
+  uint32_t minPatchIdx_ = ( std::numeric_limits<uint32_t>::max )();
+  uint32_t maxPatchIdx_ = 0;
+  void     add( const PCCVector3<int>& point, uint32_t patchIdx ) {
+    for ( size_t k = 0; k < 3; k++ ) { sum_[k] += point[k]; }
+    count_++;
+    minPatchIdx_ = ( std::min )( minPatchIdx_, patchIdx );
+    maxPatchIdx_ = ( std::max )( maxPatchIdx_, patchIdx );
+  }
+  void add( const PCCGridCellSum& cell ) {
+    for ( size_t k = 0; k < 3; k++ ) { sum_[k] += cell.sum_[k]; }
+    count_ += cell.count_;
+    minPatchIdx_ = ( std::min )( minPatchIdx_, cell.minPatchIdx_ );
+    maxPatchIdx_ = ( std::max )( maxPatchIdx_, cell.maxPatchIdx_ );
+  }
+};
+
 PCCCodec::PCCCodec() {}
 PCCCodec::~PCCCodec() = default;
 
@@ -78,14 +100,13 @@ void PCCCodec::smoothPointCloudPostprocess( PCCPointSet3&
       const size_t w =
           ( maxSize + static_cast<int>( params.gridSize_ ) - 1 ) / ( static_cast<int>( params.gridSize_ ) );
 
-      // identify boundary cells
-      size_t           pointCount = reconstruct.getPointCount();
-      std::vector<int> cellIndex;
-      cellIndex.resize( w * w * w );
-      std::fill( cellIndex.begin(), cellIndex.end(), -1 );
-      size_t    numBoundaryCells = 0;
-      const int disth            = ( std::max )( static_cast<int>( params.gridSize_ ) / 2, 1 );
-      const int th               = params.gridSize_ * w;
+      // identify boundary cells: only the cells around the boundary points are indexed, the grid is not
+      // allocated densely
+      size_t                  pointCount = reconstruct.getPointCount();
+      PCCSparseGridIndex<int> cellIndex;
+      const int               disth      = ( std::max )( static_cast<int>( params.gridSize_ ) / 2, 1 );
+      const int               th         = params.gridSize_ * w;
+      int                     prevCellId = -1;
       for ( size_t n = 0; n < pointCount; ++n ) {
         if ( reconstruct.getBoundaryPointType( n ) == 1 ) {
           PCCVector3<int> P = reconstruct[n];
@@ -97,46 +118,67 @@ void PCCCodec::smoothPointCloudPostprocess( PCCPointSet3&
           PCCVector3<int> Q( P2[0] + ( ( P[0] % params.gridSize_ < params.gridSize_ / 2 ) ? -1 : 0 ),
                              P2[1] + ( ( P[1] % params.gridSize_ < params.gridSize_ / 2 ) ? -1 : 0 ),
                              P2[2] + ( ( P[2] % params.gridSize_ < params.gridSize_ / 2 ) ? -1 : 0 ) );
+          // the neighbouring points mostly share their cells, skip the lookups when they are already indexed
+          if ( Q[0] + Q[1] * w + Q[2] * w * w == prevCellId ) { continue; }
+          prevCellId = Q[0] + Q[1] * w + Q[2] * w * w;
           for ( int ix = 0; ix < 2; ix++ ) {
             for ( int iy = 0; iy < 2; iy++ ) {
               for ( int iz = 0; iz < 2; iz++ ) {
                 int cellId = ( Q[0] + ix ) + ( Q[1] + iy ) * w + ( Q[2] + iz ) * w * w;
-                if ( cellIndex[cellId] == -1 ) {
-                  cellIndex[cellId] = numBoundaryCells;
-                  numBoundaryCells++;
-                }
+                cellIndex.insert( cellId );
               }
             }
           }
         }
       }
-      geoSmoothingCenter_.resize( numBoundaryCells );
-      geoSmoothingCount_.resize( numBoundaryCells );
-      geoSmoothingPartition_.resize( numBoundaryCells );
-      geoSmoothingDoSmooth_.resize( numBoundaryCells );
-      int size = static_cast<int>( geoSmoothingCount_.size() );
-      geoSmoothingCount_.resize( 0 );
-      geoSmoothingCount_.resize( size, 0 );
-      for ( int j = 0; j < reconstruct.getPointCount(); j++ ) {
-        PCCPoint3D      point = reconstruct[j];
-        PCCVector3<int> P     = point;
-        if ( P[0] < disth || P[1] < disth || P[2] < disth || th <= P[0] + disth || th <= P[1] + disth ||
-             th <= P[2] + disth ) {
-          continue;
-        }
-        PCCVector3<int> P2     = point / params.gridSize_;
-        int             cellId = P2[0] + P2[1] * w + P2[2] * w * w;
-        if ( cellIndex[cellId] != -1 ) {
-          addGridCentroid( reconstruct[j], partition[j] + 1, geoSmoothingCount_, geoSmoothingCenter_,
-                           geoSmoothingPartition_, geoSmoothingDoSmooth_, static_cast<int>( params.gridSize_ ), w,
-                           cellIndex[cellId] );
-        }
-      }
-      for ( int i = 0; i < geoSmoothingCount_.size(); i++ ) {
-        if ( geoSmoothingCount_[i] != 0U ) { geoSmoothingCenter_[i] /= geoSmoothingCount_[i]; }
-      }
-      smoothPointCloudGrid( reconstruct, partition, params, w, cellIndex );
-      cellIndex.clear();
+      const size_t numBoundaryCells = cellIndex.size();
+
+      // accumulate the cell centroids: each thread sums its points in its own copy of the cells. The
+      // coordinates are integers, the sums don't depend on the order of the points.
+      const std::vector<PCCGridCellSum>                            emptyCells( numBoundaryCells );
+      tbb::enumerable_thread_specific<std::vector<PCCGridCellSum>> cellSums( emptyCells );
+      const tbb::blocked_range<size_t>                             blocks( 0, pointCount, 4096 );
+      PCCTaskScheduler::getInstance().execute( [&] {
+        tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+          auto& sums = cellSums.local();
+          for ( size_t j = r.begin(); j < r.end(); j++ ) {
+            PCCPoint3D      point = reconstruct[j];
+            PCCVector3<int> P     = point;
+            if ( P[0] < disth || P[1] < disth || P[2] < disth || th <= P[0] + disth || th <= P[1] + disth ||
+                 th <= P[2] + disth ) {
+              continue;
+            }
+            PCCVector3<int> P2     = point / params.gridSize_;
+            int             cellId = P2[0] + P2[1] * w + P2[2] * w * w;
+            int             index  = cellIndex.find( cellId );
+            if ( index != -1 ) { sums[index].add( P, partition[j] + 1 ); }
+          }
+        } );
+      } );
+      // the smoothing grid is local to the call, several point clouds can be smoothed at the same time.
+      std::vector<PCCVector3<float>>   geoSmoothingCenter( numBoundaryCells );
+      std::vector<uint16_t>            geoSmoothingCount( numBoundaryCells, 0 );
+      std::vector<uint8_t>             geoSmoothingDoSmooth( numBoundaryCells, 0 );
+      const tbb::blocked_range<size_t> cells( 0, numBoundaryCells, 1024 );
+      PCCTaskScheduler::getInstance().execute( [&] {
+        tbb::parallel_for( cells, [&]( const tbb::blocked_range<size_t>& r ) {
+          for ( size_t i = r.begin(); i < r.end(); i++ ) {
+            PCCGridCellSum cell;
+            for ( auto& sums : cellSums ) { cell.add( sums[i] ); }
+            geoSmoothingCount[i] = static_cast<uint16_t>( cell.count_ );
+            if ( geoSmoothingCount[i] != 0U ) {
+              // a cell is smoothed when its points belong to several patches
+              geoSmoothingDoSmooth[i] = cell.minPatchIdx_ != cell.maxPatchIdx_ ? 1 : 0;
+              geoSmoothingCenter[i]   = PCCVector3<float>( static_cast<float>( cell.sum_[0] ),
+                                                         static_cast<float>( cell.sum_[1] ),
+                                                         static_cast<float>( cell.sum_[2] ) );
+              geoSmoothingCenter[i] /= geoSmoothingCount[i];
+            }
+          }
+        } );
+      } );
+      smoothPointCloudGrid( reconstruct, partition, params, geoSmoothingCount, geoSmoothingCenter,
+                            geoSmoothingDoSmooth, w, cellIndex );
     } else {
       if ( !params.pbfEnableFlag_ ) { smoothPointCloud( reconstruct, partition, params ); }
     }
@@ -193,18 +235,12 @@ void PCCCodec::colorSmoothing( PCCPointSet3&                       reconstruct,
       }
     }
   }
-  colorSmoothingCenter_.resize( numBoundaryCells );
-  colorSmoothingCount_.resize( numBoundaryCells );
-  colorSmoothingPartition_.resize( numBoundaryCells );
-  colorSmoothingDoSmooth_.resize( numBoundaryCells );
-  std::fill( colorSmoothingCenter_.begin(), colorSmoothingCenter_.end(), 0 );
-  std::fill( colorSmoothingCount_.begin(), colorSmoothingCount_.end(), 0 );
-  std::pair<size_t, size_t> initPair;
-  initPair.first = initPair.second = 0;
-  std::fill( colorSmoothingPartition_.begin(), colorSmoothingPartition_.end(), initPair );
-  std::fill( colorSmoothingDoSmooth_.begin(), colorSmoothingDoSmooth_.end(), 0 );
-  colorSmoothingLum_.clear();
-  colorSmoothingLum_.resize( numBoundaryCells );
+  // the smoothing grid is local to the call, several point clouds can be smoothed at the same time.
+  std::vector<PCCVector3<float>>         colorSmoothingCenter( numBoundaryCells, PCCVector3<float>( 0.F ) );
+  std::vector<uint16_t>                  colorSmoothingCount( numBoundaryCells, 0 );
+  std::vector<std::pair<size_t, size_t>> colorSmoothingPartition( numBoundaryCells, std::make_pair( 0, 0 ) );
+  std::vector<bool>                      colorSmoothingDoSmooth( numBoundaryCells, false );
+  std::vector<std::vector<uint16_t>>     colorSmoothingLum( numBoundaryCells );
   for ( int k = 0; k < reconstruct.getPointCount(); k++ ) {
     PCCPoint3D      point  = reconstruct[k];
     PCCVector3<int> P2     = reconstruct[k] / gridSize;
@@ -216,23 +252,14 @@ void PCCCodec::colorSmoothing( PCCPointSet3&                       reconstruct,
         PCCVector3D clr                   = reconstruct.getColor16bit( k );
         auto        tilePatchIndexPlusOne = reconstruct.getPointPatchIndex( k );
         tilePatchIndexPlusOne.second      = tilePatchIndexPlusOne.second + 1;
-        addGridColorCentroid( reconstruct[k], clr, tilePatchIndexPlusOne, colorSmoothingCount_, colorSmoothingCenter_,
-                              colorSmoothingPartition_, colorSmoothingDoSmooth_, gridSize, colorSmoothingLum_, params,
+        addGridColorCentroid( reconstruct[k], clr, tilePatchIndexPlusOne, colorSmoothingCount, colorSmoothingCenter,
+                              colorSmoothingPartition, colorSmoothingDoSmooth, gridSize, colorSmoothingLum, params,
                               cellIndex[cellId] );
       }
     }
   }
-  smoothPointCloudColorLC( reconstruct, params, cellIndex );
-  colorSmoothingCenter_.resize( 0 );
-  colorSmoothingCenter_.shrink_to_fit();
-  colorSmoothingCount_.resize( 0 );
-  colorSmoothingCount_.shrink_to_fit();
-  colorSmoothingPartition_.resize( 0 );
-  colorSmoothingPartition_.shrink_to_fit();
-  colorSmoothingDoSmooth_.resize( 0 );
-  colorSmoothingDoSmooth_.shrink_to_fit();
-  colorSmoothingLum_.resize( 0 );
-  colorSmoothingLum_.shrink_to_fit();
+  smoothPointCloudColorLC( reconstruct, params, colorSmoothingCount, colorSmoothingCenter, colorSmoothingDoSmooth,
+                           colorSmoothingLum, cellIndex );
 }
 
 int PCCCodec::getDeltaNeighbors( const PCCImageGeometry& frame,
@@ -324,23 +351,24 @@ void PCCCodec::identifyBoundaryPoints( const std::vector<uint32_t>& occupancyMap
   }
 }
 
-std::vector<PCCPoint3D> PCCCodec::generatePoints( const GeneratePointCloudParameters&  params,
-                                                  PCCFrameContext&                     tile,
-                                                  const std::vector<PCCVideoGeometry>& videoGeometryMultiple,
-                                                  const size_t                         videoFrameIndex,
-                                                  const size_t                         patchIndex,
-                                                  const size_t                         u,
-                                                  const size_t                         v,
-                                                  const size_t                         x,
-                                                  const size_t                         y,
-                                                  const bool                           interpolate,
-                                                  const bool                           filling,
-                                                  const size_t                         minD1,
-                                                  const size_t                         neighbor ) {
-  const auto&             patch  = tile.getPatch( patchIndex );
-  auto&                   frame0 = videoGeometryMultiple[0].getFrame( videoFrameIndex );
-  std::vector<PCCPoint3D> createdPoints;
-  PCCPoint3D              point0;
+void PCCCodec::generatePoints( const GeneratePointCloudParameters&  params,
+                               PCCFrameContext&                     tile,
+                               const std::vector<PCCVideoGeometry>& videoGeometryMultiple,
+                               const size_t                         videoFrameIndex,
+                               const size_t                         patchIndex,
+                               const size_t                         u,
+                               const size_t                         v,
+                               const size_t                         x,
+                               const size_t                         y,
+                               std::vector<PCCPoint3D>&             createdPoints,
+                               const bool                           interpolate,
+                               const bool                           filling,
+                               const size_t                         minD1,
+                               const size_t                         neighbor ) {
+  const auto& patch  = tile.getPatch( patchIndex );
+  auto&       frame0 = videoGeometryMultiple[0].getFrame( videoFrameIndex );
+  PCCPoint3D  point0;
+  createdPoints.clear();
   if ( params.pbfEnableFlag_ ) {
     point0 = patch.generatePoint( u, v, patch.getDepthMap( u, v ) );
   } else {
@@ -432,7 +460,7 @@ std::vector<PCCPoint3D> PCCCodec::generatePoints( const GeneratePointCloudParame
         if ( depthNeighbors[3] > maximumDepth ) { maximumDepth = depthNeighbors[3]; }
       }
     }
-    if ( count == 0 ) { return createdPoints; }
+    if ( count == 0 ) { return; }
     if ( ( x + y ) % 2 == 1 ) {
       depth1 = point0[patch.getNormalAxis()];
       PCCPoint3D interpolateD0( point0 );
@@ -511,7 +539,157 @@ std::vector<PCCPoint3D> PCCCodec::generatePoints( const GeneratePointCloudParame
       createdPoints.push_back( point1 );
     }  // if ( params.mapCountMinus1_ > 0 ) {
   }    // fi (pointLocalReconstruction)
-  return createdPoints;
+}
+
+template <bool singleMap, bool fill>
+size_t PCCCodec::generatePatchPoints( PCCPointSet3&                       reconstruct,
+                                      uint32_t*                           partition,
+                                      size_t                              pointIndex,
+                                      std::vector<PCCPoint3D>&            createdPoints,
+                                      PCCContext&                         context,
+                                      size_t                              tileIndex,
+                                      const GeneratePointCloudParameters& params,
+                                      size_t                              patchIndex,
+                                      const PCCColor3B&                   color,
+                                      size_t                              videoFrameIndex,
+                                      PCCFrameContext&                    tile ) {
+  auto&        videoGeometryMultiple = context.getVideoGeometryMultiple();
+  const auto&  frame0                = videoGeometryMultiple[0].getFrame( videoFrameIndex );
+  auto&        patch                 = tile.getPatch( patchIndex );
+  auto&        blockToPatch          = tile.getBlockToPatch();
+  auto&        occupancyMap          = tile.getOccupancyMap();
+  auto&        pointToPixel          = tile.getPointToPixel();
+  const size_t tileWidth             = tile.getWidth();
+  const size_t tileHeight            = tile.getHeight();
+  const size_t blockToPatchWidth     = tileWidth / params.occupancyResolution_;
+  const size_t blockToPatchHeight    = tileHeight / params.occupancyResolution_;
+  const size_t patchIndexPlusOne     = patchIndex + 1;
+  size_t       pointCount            = 0;
+  if ( singleMap ) { createdPoints.resize( 1 ); }
+  for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
+    for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
+      const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
+      if ( blockToPatch[blockIndex] != patchIndexPlusOne ) { continue; }
+      for ( size_t v1 = 0; v1 < patch.getOccupancyResolution(); ++v1 ) {
+        const size_t v = v0 * patch.getOccupancyResolution() + v1;
+        for ( size_t u1 = 0; u1 < patch.getOccupancyResolution(); ++u1 ) {
+          const size_t u = u0 * patch.getOccupancyResolution() + u1;
+          size_t       x;
+          size_t       y;
+          const size_t canvasIndex   = patch.patch2Canvas( u, v, tileWidth, tileHeight, x, y );
+          const size_t xInVideoFrame = x + tile.getLeftTopXInFrame();
+          const size_t yInVideoFrame = y + tile.getLeftTopYInFrame();
+          if ( params.pbfEnableFlag_ ? patch.getOccupancyMap( u, v ) == 0 : occupancyMap[canvasIndex] == 0 ) {
+            continue;
+          }
+          if ( singleMap && !fill ) {
+            pointCount++;
+            continue;
+          }
+          if ( singleMap ) {
+            if ( params.pbfEnableFlag_ ) {
+              createdPoints[0] = patch.generatePoint( u, v, patch.getDepthMap( u, v ) );
+            } else {
+              createdPoints[0] = patch.generatePoint( u, v, frame0.getValue( 0, xInVideoFrame, yInVideoFrame ) );
+            }
+          } else if ( params.pointLocalReconstruction_ ) {
+            auto& mode = context.getPointLocalReconstructionMode( patch.getPointLocalReconstructionMode( u0, v0 ) );
+            generatePoints( params, tile, videoGeometryMultiple, videoFrameIndex, patchIndex, u, v, xInVideoFrame,
+                            yInVideoFrame, createdPoints, mode.interpolate_, mode.filling_, mode.minD1_,
+                            mode.neighbor_ );
+          } else {
+            generatePoints( params, tile, videoGeometryMultiple, videoFrameIndex, patchIndex, u, v, xInVideoFrame,
+                            yInVideoFrame, createdPoints );
+          }
+          const bool isBoundary = fill && params.pbfEnableFlag_ && patch.isBorder( u, v );
+          for ( size_t i = 0; i < createdPoints.size(); i++ ) {
+            if ( params.removeDuplicatePoints_ && i != 0 && createdPoints[i] == createdPoints[0] ) { continue; }
+            if ( fill ) {
+              const size_t index = pointIndex + pointCount;
+              if ( patch.getAxisOfAdditionalPlane() == 0 ) {
+                reconstruct.setPosition( index, createdPoints[i] );
+              } else {
+                PCCVector3D tmp;
+                inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(), params.geometryBitDepth3D_,
+                                                     createdPoints[i], tmp );
+                reconstruct.setPosition( index, PCCPoint3D( tmp[0], tmp[1], tmp[2] ) );
+              }
+              reconstruct.setPointPatchIndex( index, tileIndex, patchIndex );
+              reconstruct.setColor( index, color );
+              if ( params.pbfEnableFlag_ ) { reconstruct.setBoundaryPointType( index, isBoundary ); }
+              size_t layer;
+              if ( params.singleMapPixelInterleaving_ ) {
+                layer = i == 0 ? ( x + y ) % 2 : i == 1 ? ( x + y + 1 ) % 2 : g_intermediateLayerIndex;
+              } else if ( params.pointLocalReconstruction_ ) {
+                layer = i == 0 ? 0 : i == 1 ? g_intermediateLayerIndex : g_intermediateLayerIndex + 1;
+              } else {
+                layer = i < 2 ? i : g_intermediateLayerIndex + 1;
+              }
+              if ( PCC_SAVE_POINT_TYPE == 1 ) {
+                const size_t flag = params.singleMapPixelInterleaving_ ? layer : ( std::min )( i, size_t( 2 ) );
+                reconstruct.setType( index, flag == 0 ? POINT_D0 : flag == 1 ? POINT_D1 : POINT_DF );
+              }
+              partition[index]    = uint32_t( patchIndex );
+              pointToPixel[index] = PCCVector3<size_t>( x, y, layer );
+            }
+            pointCount++;
+          }
+        }
+      }
+    }
+  }
+  return pointCount;
+}
+
+template <bool singleMap>
+void PCCCodec::generateRegularPoints( PCCPointSet3&                       reconstruct,
+                                      PCCContext&                         context,
+                                      size_t                              tileIndex,
+                                      const GeneratePointCloudParameters& params,
+                                      std::vector<uint32_t>&              partition,
+                                      const std::vector<uint32_t>&        patchOrder,
+                                      const std::vector<PCCColor3B>&      patchColors,
+                                      size_t                              videoFrameIndex,
+                                      PCCFrameContext&                    tile ) {
+  const size_t                                             patchCount = patchOrder.size();
+  std::vector<size_t>                                      pointIndexes( patchCount + 1, 0 );
+  tbb::enumerable_thread_specific<std::vector<PCCPoint3D>> createdPoints;
+  assert( reconstruct.getPointCount() == 0 && tile.getPointToPixel().empty() );
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( size_t( 0 ), patchCount, [&]( const size_t index ) {
+      const size_t patchIndex = patchOrder[index];
+      pointIndexes[index + 1] =
+          generatePatchPoints<singleMap, false>( reconstruct, nullptr, 0, createdPoints.local(), context, tileIndex,
+                                                 params, patchIndex, patchColors[patchIndex], videoFrameIndex, tile );
+    } );
+  } );
+  for ( size_t index = 0; index < patchCount; index++ ) { pointIndexes[index + 1] += pointIndexes[index]; }
+  for ( size_t index = 0; index < patchCount; index++ ) {
+    const size_t patchIndex = patchOrder[index];
+    const auto&  patch      = tile.getPatch( patchIndex );
+    TRACE_CODEC(
+        "P%2lu/%2lu: 2D=(%2lu,%2lu)*(%2lu,%2lu) 3D(%4zu,%4zu,%4zu)*(%4zu,%4zu) A=(%zu,%zu,%zu) Or=%zu P=%zu => %zu "
+        "AxisOfAdditionalPlane = %zu \n",
+        patchIndex, patchCount, patch.getU0(), patch.getV0(), patch.getSizeU0(), patch.getSizeV0(), patch.getU1(),
+        patch.getV1(), patch.getD1(), patch.getSizeU0() * patch.getOccupancyResolution(),
+        patch.getSizeV0() * patch.getOccupancyResolution(), patch.getNormalAxis(), patch.getTangentAxis(),
+        patch.getBitangentAxis(), patch.getPatchOrientation(), patch.getProjectionMode(), pointIndexes[index],
+        patch.getAxisOfAdditionalPlane() );
+  }
+  // the partition of the tile follows the ones of the previous tiles
+  const size_t partitionIndex = partition.size();
+  reconstruct.resize( pointIndexes[patchCount] );
+  tile.getPointToPixel().resize( pointIndexes[patchCount] );
+  partition.resize( partitionIndex + pointIndexes[patchCount] );
+  uint32_t* partitionData = partition.data() + partitionIndex;
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( size_t( 0 ), patchCount, [&]( const size_t index ) {
+      const size_t patchIndex = patchOrder[index];
+      generatePatchPoints<singleMap, true>( reconstruct, partitionData, pointIndexes[index], createdPoints.local(),
+                                            context, tileIndex, params, patchIndex, patchColors[patchIndex],
+                                            videoFrameIndex, tile );
+    } );
+  } );
 }
 
 void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstruct,
@@ -625,11 +803,36 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
   eomPointsPerPatch.resize( totalPatchCount );
   uint32_t   index;
   const bool patchPrecedenceOrderFlag = context.getAtlasSequenceParameterSet( 0 ).getPatchPrecedenceOrderFlag();
+  std::vector<uint32_t>   patchOrder( totalPatchCount );
+  std::vector<PCCColor3B> patchColors( totalPatchCount, PCCColor3B( uint8_t( 0 ) ) );
   for ( index = 0; index < patches.size(); index++ ) {
-    patchIndex                     = ( bDecoder && patchPrecedenceOrderFlag ) ? ( totalPatchCount - index - 1 ) : index;
+    patchIndex        = ( bDecoder && patchPrecedenceOrderFlag ) ? ( totalPatchCount - index - 1 ) : index;
+    patchOrder[index] = patchIndex;
+    auto& color       = patchColors[patchIndex];
+    // The frames and the tiles are generated concurrently: the colors are drawn from a generator local to
+    // the patch so the decoded output does not depend on the thread timing.
+    std::seed_seq seed{uint32_t( frameIndex ), uint32_t( tileIndex ), uint32_t( patchIndex )};
+    std::mt19937  generator( seed );
+    while ( color[0] == color[1] || color[2] == color[1] || color[2] == color[0] ) {
+      color[0] = static_cast<uint8_t>( generator() % 32 ) * 8;
+      color[1] = static_cast<uint8_t>( generator() % 32 ) * 8;
+      color[2] = static_cast<uint8_t>( generator() % 32 ) * 8;
+    }
+  }
+  if ( !params.enhancedOccupancyMapCode_ ) {
+    if ( !params.pointLocalReconstruction_ && !params.singleMapPixelInterleaving_ && params.mapCountMinus1_ == 0 ) {
+      generateRegularPoints<true>( reconstruct, context, tileIndex, params, partition, patchOrder, patchColors,
+                                   videoFrameIndex, tile );
+    } else {
+      generateRegularPoints<false>( reconstruct, context, tileIndex, params, partition, patchOrder, patchColors,
+                                    videoFrameIndex, tile );
+    }
+  }
+  for ( index = 0; index < patches.size() && params.enhancedOccupancyMapCode_; index++ ) {
+    patchIndex                     = patchOrder[index];
     const size_t patchIndexPlusOne = patchIndex + 1;
     auto&        patch             = patches[patchIndex];
-    PCCColor3B   color( uint8_t( 0 ) );
+    const auto&  color             = patchColors[patchIndex];
     TRACE_CODEC(
         "P%2lu/%2lu: 2D=(%2lu,%2lu)*(%2lu,%2lu) 3D(%4zu,%4zu,%4zu)*(%4zu,%4zu) A=(%zu,%zu,%zu) Or=%zu P=%zu => %zu "
         "AxisOfAdditionalPlane = %zu \n",
@@ -638,12 +841,6 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
         patch.getSizeV0() * patch.getOccupancyResolution(), patch.getNormalAxis(), patch.getTangentAxis(),
         patch.getBitangentAxis(), patch.getPatchOrientation(), patch.getProjectionMode(), reconstruct.getPointCount(),
         patch.getAxisOfAdditionalPlane() );
-
-    while ( color[0] == color[1] || color[2] == color[1] || color[2] == color[0] ) {
-      color[0] = static_cast<uint8_t>( rand() % 32 ) * 8;
-      color[1] = static_cast<uint8_t>( rand() % 32 ) * 8;
-      color[2] = static_cast<uint8_t>( rand() % 32 ) * 8;
-    }
     for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
       for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
         const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
@@ -658,180 +855,122 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
               size_t       canvasIndex   = patch.patch2Canvas( u, v, tileWidth, tileHeight, x, y );
               size_t       xInVideoFrame = x + tile.getLeftTopXInFrame();
               size_t       yInVideoFrame = y + tile.getLeftTopYInFrame();
-              bool         isBoundary    = false;
               if ( params.pbfEnableFlag_ ) {
                 occupancy = patch.getOccupancyMap( u, v ) != 0;
-                if ( occupancy ) { isBoundary = patch.isBorder( u, v ); }
               } else {
                 occupancy = occupancyMap[canvasIndex] != 0;
               }
               if ( !occupancy ) { continue; }
-              if ( params.enhancedOccupancyMapCode_ ) {
-                // D0
-                PCCPoint3D point0 = patch.generatePoint( u, v, frame0.getValue( 0, xInVideoFrame, yInVideoFrame ) );
-                size_t     pointIndex0;  // = reconstruct.addPoint(point0);
-                if ( patch.getAxisOfAdditionalPlane() == 0 ) {
-                  pointIndex0 = reconstruct.addPoint( point0 );
-                } else {
-                  PCCVector3D tmp;
-                  inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(), params.geometryBitDepth3D_,
-                                                       point0, tmp );
-                  pointIndex0 = reconstruct.addPoint( tmp );
+              // D0
+              PCCPoint3D point0 = patch.generatePoint( u, v, frame0.getValue( 0, xInVideoFrame, yInVideoFrame ) );
+              size_t     pointIndex0;  // = reconstruct.addPoint(point0);
+              if ( patch.getAxisOfAdditionalPlane() == 0 ) {
+                pointIndex0 = reconstruct.addPoint( point0 );
+              } else {
+                PCCVector3D tmp;
+                inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(), params.geometryBitDepth3D_,
+                                                     point0, tmp );
+                pointIndex0 = reconstruct.addPoint( tmp );
+              }
+              reconstruct.setPointPatchIndex( pointIndex0, tileIndex, patchIndex );
+              reconstruct.setColor( pointIndex0, color );
+              if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex0, POINT_D0 ); }
+              partition.push_back( uint32_t( patchIndex ) );
+              pointToPixel.emplace_back( x, y, 0 );
+              uint16_t    eomCode = 0;
+              size_t      d1pos   = 0;
+              const auto& frame0  = params.multipleStreams_ ? videoGeometryMultiple[0].getFrame( videoFrameIndex )
+                                                           : videoGeometry.getFrame( videoFrameIndex );
+              const auto& indx = patch.patch2Canvas( u, v, tileWidth, tileHeight, x, y );
+              if ( params.mapCountMinus1_ > 0 ) {
+                const auto& frame1 = params.multipleStreams_ ? videoGeometryMultiple[1].getFrame( videoFrameIndex )
+                                                             : videoGeometry.getFrame( videoFrameIndex + 1 );
+                int16_t diff = params.absoluteD1_
+                                   ? ( static_cast<int16_t>( frame1.getValue( 0, xInVideoFrame, yInVideoFrame ) ) -
+                                       static_cast<int16_t>( frame0.getValue( 0, xInVideoFrame, yInVideoFrame ) ) )
+                                   : static_cast<int16_t>( frame1.getValue( 0, xInVideoFrame, yInVideoFrame ) );
+                assert( diff >= 0 );
+                // Convert occupancy map to eomCode
+                if ( diff == 0 ) {
+                  eomCode = 0;
+                } else if ( diff == 1 ) {
+                  d1pos   = 1;
+                  eomCode = 1;
+                } else if ( diff > 0 ) {
+                  uint16_t bits = diff - 1;
+                  uint16_t symbol =
+                      ( 1 << bits ) - occupancyMap[patch.patch2Canvas( u, v, tileWidth, tileHeight, x, y )];
+                  eomCode = symbol | ( 1 << bits );
+                  d1pos   = ( bits );
                 }
-                reconstruct.setPointPatchIndex( pointIndex0, tileIndex, patchIndex );
-                reconstruct.setColor( pointIndex0, color );
-                if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex0, POINT_D0 ); }
-                partition.push_back( uint32_t( patchIndex ) );
-                pointToPixel.emplace_back( x, y, 0 );
-                uint16_t    eomCode = 0;
-                size_t      d1pos   = 0;
-                const auto& frame0  = params.multipleStreams_ ? videoGeometryMultiple[0].getFrame( videoFrameIndex )
-                                                             : videoGeometry.getFrame( videoFrameIndex );
-                const auto& indx = patch.patch2Canvas( u, v, tileWidth, tileHeight, x, y );
-                if ( params.mapCountMinus1_ > 0 ) {
-                  const auto& frame1 = params.multipleStreams_ ? videoGeometryMultiple[1].getFrame( videoFrameIndex )
-                                                               : videoGeometry.getFrame( videoFrameIndex + 1 );
-                  int16_t diff = params.absoluteD1_
-                                     ? ( static_cast<int16_t>( frame1.getValue( 0, xInVideoFrame, yInVideoFrame ) ) -
-                                         static_cast<int16_t>( frame0.getValue( 0, xInVideoFrame, yInVideoFrame ) ) )
-                                     : static_cast<int16_t>( frame1.getValue( 0, xInVideoFrame, yInVideoFrame ) );
-                  assert( diff >= 0 );
-                  // Convert occupancy map to eomCode
-                  if ( diff == 0 ) {
-                    eomCode = 0;
-                  } else if ( diff == 1 ) {
-                    d1pos   = 1;
-                    eomCode = 1;
-                  } else if ( diff > 0 ) {
-                    uint16_t bits = diff - 1;
-                    uint16_t symbol =
-                        ( 1 << bits ) - occupancyMap[patch.patch2Canvas( u, v, tileWidth, tileHeight, x, y )];
-                    eomCode = symbol | ( 1 << bits );
-                    d1pos   = ( bits );
+              } else {  // params.mapCountMinus1_ == 0
+                eomCode = ( 1 << params.EOMFixBitCount_ ) - occupancyMap[indx];
+              }
+              PCCPoint3D point1( point0 );
+              if ( eomCode == 0 ) {
+                if ( !params.removeDuplicatePoints_ ) {
+                  size_t pointIndex1;  // = reconstruct.addPoint(point1);
+                  if ( patch.getAxisOfAdditionalPlane() == 0 ) {
+                    pointIndex1 = reconstruct.addPoint( point1 );
+                  } else {
+                    PCCVector3D tmp;
+                    inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(), params.geometryBitDepth3D_,
+                                                         point1, tmp );
+                    pointIndex1 = reconstruct.addPoint( tmp );
                   }
-                } else {  // params.mapCountMinus1_ == 0
-                  eomCode = ( 1 << params.EOMFixBitCount_ ) - occupancyMap[indx];
+                  reconstruct.setPointPatchIndex( pointIndex1, tileIndex, patchIndex );
+                  reconstruct.setColor( pointIndex1, color );
+                  if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex1, POINT_D1 ); }
+                  partition.push_back( uint32_t( patchIndex ) );
+                  pointToPixel.emplace_back( x, y, 1 );
+                }
+              } else {  // eomCode != 0
+                uint16_t addedPointCount = 0;
+                size_t   pointIndex1     = 0;
+                for ( uint16_t i = 0; i < 10; i++ ) {
+                  if ( ( eomCode & ( 1 << i ) ) != 0 ) { d1pos = i; }
                 }
-                PCCPoint3D point1( point0 );
-                if ( eomCode == 0 ) {
-                  if ( !params.removeDuplicatePoints_ ) {
-                    size_t pointIndex1;  // = reconstruct.addPoint(point1);
-                    if ( patch.getAxisOfAdditionalPlane() == 0 ) {
-                      pointIndex1 = reconstruct.addPoint( point1 );
+                for ( uint16_t i = 0; i < 10; i++ ) {
+                  if ( ( eomCode & ( 1 << i ) ) != 0 ) {
+                    uint8_t deltaDCur = ( i + 1 );
+                    if ( patch.getProjectionMode() == 0 ) {
+                      point1[patch.getNormalAxis()] =
+                          static_cast<double>( point0[patch.getNormalAxis()] + deltaDCur );
                     } else {
-                      PCCVector3D tmp;
-                      inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(), params.geometryBitDepth3D_,
-                                                           point1, tmp );
-                      pointIndex1 = reconstruct.addPoint( tmp );
+                      point1[patch.getNormalAxis()] =
+                          static_cast<double>( point0[patch.getNormalAxis()] - deltaDCur );
                     }
-                    reconstruct.setPointPatchIndex( pointIndex1, tileIndex, patchIndex );
-                    reconstruct.setColor( pointIndex1, color );
-                    if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex1, POINT_D1 ); }
-                    partition.push_back( uint32_t( patchIndex ) );
-                    pointToPixel.emplace_back( x, y, 1 );
-                  }
-                } else {  // eomCode != 0
-                  uint16_t addedPointCount = 0;
-                  size_t   pointIndex1     = 0;
-                  for ( uint16_t i = 0; i < 10; i++ ) {
-                    if ( ( eomCode & ( 1 << i ) ) != 0 ) { d1pos = i; }
-                  }
-                  for ( uint16_t i = 0; i < 10; i++ ) {
-                    if ( ( eomCode & ( 1 << i ) ) != 0 ) {
-                      uint8_t deltaDCur = ( i + 1 );
-                      if ( patch.getProjectionMode() == 0 ) {
-                        point1[patch.getNormalAxis()] =
-                            static_cast<double>( point0[patch.getNormalAxis()] + deltaDCur );
-                      } else {
-                        point1[patch.getNormalAxis()] =
-                            static_cast<double>( point0[patch.getNormalAxis()] - deltaDCur );
-                      }
-                      if ( ( eomCode == 1 || i == d1pos ) && ( params.mapCountMinus1_ > 0 ) ) {  // d1
-                        if ( patch.getAxisOfAdditionalPlane() == 0 ) {
-                          pointIndex1 = reconstruct.addPoint( point1 );
-                        } else {
-                          PCCVector3D tmp;
-                          inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(),
-                                                               params.geometryBitDepth3D_, point1, tmp );
-                          pointIndex1 = reconstruct.addPoint( tmp );
-                        }
-                        reconstruct.setPointPatchIndex( pointIndex1, tileIndex, patchIndex );
-                        reconstruct.setColor( pointIndex1, color );
-                        if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex1, POINT_D1 ); }
-                        partition.push_back( uint32_t( patchIndex ) );
-                        pointToPixel.emplace_back( x, y, 1 );
-                      } else {
-                        if ( patch.getAxisOfAdditionalPlane() == 0 ) {
-                          eomPointsPerPatch[patchIndex].push_back( point1 );
-                        } else {
-                          PCCVector3D tmp;
-                          inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(),
-                                                               params.geometryBitDepth3D_, point1, tmp );
-                          eomPointsPerPatch[patchIndex].push_back( PCCPoint3D( tmp[0], tmp[1], tmp[2] ) );
-                        }
-                      }
-                      addedPointCount++;
-                    }
-                  }  // for each bit of EOM code
-                  if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex1, POINT_D1 ); }
-                  // Without "Identify boundary points" & "1st Extension boundary region" as EOM code is only for
-                  // lossless coding now
-                }       // if (eomCode == 0)
-              } else {  // not params.enhancedOccupancyMapCode_
-                std::vector<PCCPoint3D> createdPoints;
-                if ( params.pointLocalReconstruction_ ) {
-                  auto& mode =
-                      context.getPointLocalReconstructionMode( patch.getPointLocalReconstructionMode( u0, v0 ) );
-                  createdPoints = generatePoints( params, tile, videoGeometryMultiple, videoFrameIndex, patchIndex, u,
-                                                  v, xInVideoFrame, yInVideoFrame, mode.interpolate_, mode.filling_,
-                                                  mode.minD1_, mode.neighbor_ );
-                } else {
-                  createdPoints = generatePoints( params, tile, videoGeometryMultiple, videoFrameIndex, patchIndex, u,
-                                                  v, xInVideoFrame, yInVideoFrame );
-                }
-                if ( !createdPoints.empty() ) {
-                  for ( size_t i = 0; i < createdPoints.size(); i++ ) {
-                    if ( ( !params.removeDuplicatePoints_ ) ||
-                         ( ( i == 0 ) || ( createdPoints[i] != createdPoints[0] ) ) ) {
-                      size_t pointindex = 0;
+                    if ( ( eomCode == 1 || i == d1pos ) && ( params.mapCountMinus1_ > 0 ) ) {  // d1
                       if ( patch.getAxisOfAdditionalPlane() == 0 ) {
-                        pointindex = reconstruct.addPoint( createdPoints[i] );
-                        reconstruct.setPointPatchIndex( pointindex, tileIndex, patchIndex );
+                        pointIndex1 = reconstruct.addPoint( point1 );
                       } else {
                         PCCVector3D tmp;
                         inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(),
-                                                             params.geometryBitDepth3D_, createdPoints[i], tmp );
-                        pointindex = reconstruct.addPoint( tmp );
-                        reconstruct.setPointPatchIndex( pointindex, tileIndex, patchIndex );
-                      }
-                      const size_t pointindex_1 = pointindex;
-                      reconstruct.setColor( pointindex_1, color );
-                      if ( params.pbfEnableFlag_ ) { reconstruct.setBoundaryPointType( pointindex_1, isBoundary ); }
-                      if ( PCC_SAVE_POINT_TYPE == 1 ) {
-                        if ( params.singleMapPixelInterleaving_ ) {
-                          size_t flag;
-                          flag = ( i == 0 ) ? ( x + y ) % 2 : ( i == 1 ) ? ( x + y + 1 ) % 2 : g_intermediateLayerIndex;
-                          reconstruct.setType( pointindex_1, flag == 0 ? POINT_D0 : flag == 1 ? POINT_D1 : POINT_DF );
-                        } else {
-                          reconstruct.setType( pointindex_1, i == 0 ? POINT_D0 : i == 1 ? POINT_D1 : POINT_DF );
-                        }
+                                                             params.geometryBitDepth3D_, point1, tmp );
+                        pointIndex1 = reconstruct.addPoint( tmp );
                       }
+                      reconstruct.setPointPatchIndex( pointIndex1, tileIndex, patchIndex );
+                      reconstruct.setColor( pointIndex1, color );
+                      if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex1, POINT_D1 ); }
                       partition.push_back( uint32_t( patchIndex ) );
-                      if ( params.singleMapPixelInterleaving_ ) {
-                        pointToPixel.emplace_back(
-                            x, y,
-                            i == 0 ? ( static_cast<size_t>( x + y ) % 2 )
-                                   : i == 1 ? ( static_cast<size_t>( x + y + 1 ) % 2 ) : g_intermediateLayerIndex );
-                      } else if ( params.pointLocalReconstruction_ ) {
-                        pointToPixel.emplace_back(
-                            x, y, i == 0 ? 0 : i == 1 ? g_intermediateLayerIndex : g_intermediateLayerIndex + 1 );
+                      pointToPixel.emplace_back( x, y, 1 );
+                    } else {
+                      if ( patch.getAxisOfAdditionalPlane() == 0 ) {
+                        eomPointsPerPatch[patchIndex].push_back( point1 );
                       } else {
-                        pointToPixel.emplace_back( x, y, i < 2 ? i : g_intermediateLayerIndex + 1 );
+                        PCCVector3D tmp;
+                        inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(),
+                                                             params.geometryBitDepth3D_, point1, tmp );
+                        eomPointsPerPatch[patchIndex].push_back( PCCPoint3D( tmp[0], tmp[1], tmp[2] ) );
                       }
                     }
+                    addedPointCount++;
                   }
-                }
-              }
+                }  // for each bit of EOM code
+                if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex1, POINT_D1 ); }
+                // Without "Identify boundary points" & "1st Extension boundary region" as EOM code is only for
+                // lossless coding now
+              }  // if (eomCode == 0)
             }
           }
         }
@@ -840,7 +979,7 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
   }
   tile.setTotalNumberOfRegularPoints( reconstruct.getPointCount() );
   printf( "frame %zu, tile %zu: regularPoints %zu\n", frameIndex, tileIndex, reconstruct.getPointCount() );
-  patchIndex                         = index;
+  patchIndex                         = static_cast<uint32_t>( totalPatchCount );
   size_t       totalEOMPointsInFrame = 0;
   PCCPointSet3 eomSavedPoints;
   if ( params.enhancedOccupancyMapCode_ ) {
@@ -977,37 +1116,17 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
 #endif
 }
 
-void PCCCodec::addGridCentroid( PCCPoint3D&                     point,
-                                uint32_t                        patchIdx,
-                                std::vector<uint16_t>&          count,
-                                std::vector<PCCVector3<float>>& centerGrid,
-                                std::vector<uint32_t>&          gpartition,
-                                std::vector<bool>&              doSmooth,
-                                uint8_t                         gridSize,
-                                uint16_t                        gridWidth,
-                                int                             cellId ) {
-  if ( count[cellId] == 0 ) {
-    gpartition[cellId] = patchIdx;
-    centerGrid[cellId] = {0., 0., 0.};
-    doSmooth[cellId]   = false;
-  } else if ( !doSmooth[cellId] && gpartition[cellId] != patchIdx ) {
-    doSmooth[cellId] = true;
-  }
-  centerGrid[cellId] += PCCVector3<float>( point );
-  count[cellId]++;
-}
-
-bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
-                              PCCPointSet3&                   pointCloud,
-                              PCCPoint3D&                     curPoint,
-                              PCCVector3D&                    centroid,
-                              int&                            count,
-                              std::vector<uint16_t>&          gridCount,
-                              std::vector<PCCVector3<float>>& center,
-                              std::vector<bool>&              doSmooth,
-                              uint8_t                         gridSize,
-                              uint16_t                        gridWidth,
-                              std::vector<int>&               cellIndex ) {
+bool PCCCodec::gridFiltering( const std::vector<uint32_t>&          partition,
+                              PCCPointSet3&                         pointCloud,
+                              PCCPoint3D&                           curPoint,
+                              PCCVector3D&                          centroid,
+                              int&                                  count,
+                              const std::vector<uint16_t>&          gridCount,
+                              const std::vector<PCCVector3<float>>& center,
+                              const std::vector<uint8_t>&           doSmooth,
+                              uint8_t                               gridSize,
+                              uint16_t                              gridWidth,
+                              const PCCSparseGridIndex<int>&        cellIndex ) {
   const uint16_t  gridSizeHalf           = gridSize / 2;
   bool            otherClusterPointCount = false;
   PCCVector3<int> P                      = curPoint;
@@ -1020,8 +1139,10 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
     for ( int dy = 0; dy < 2; dy++ ) {
       for ( int dx = 0; dx < 2; dx++ ) {
         int tmp         = ( S[0] + dx ) + ( S[1] + dy ) * gridWidth + ( S[2] + dz ) * gridWidth * gridWidth;
-        idx[dz][dy][dx] = tmp;
-        if ( doSmooth[cellIndex[tmp]] && ( gridCount[cellIndex[tmp]] != 0U ) ) { otherClusterPointCount = true; }
+        idx[dz][dy][dx] = cellIndex.find( tmp );
+        if ( ( doSmooth[idx[dz][dy][dx]] != 0U ) && ( gridCount[idx[dz][dy][dx]] != 0U ) ) {
+          otherClusterPointCount = true;
+        }
       }
     }
   }
@@ -1029,18 +1150,13 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
   PCCVector3D     centroid3[2][2][2] = {};
   PCCVector3D     curVector          = P;
   int             gridSize2          = gridSize * 2;
-  int             gridWidth3         = gridWidth * gridWidth * gridWidth;
   PCCVector3<int> S2                 = S * gridSize;
   PCCVector3<int> W                  = ( P - S2 - gridSizeHalf ) * 2 + 1;
   for ( int dz = 0; dz < 2; dz++ ) {
     for ( int dy = 0; dy < 2; dy++ ) {
       for ( int dx = 0; dx < 2; dx++ ) {
-        if ( ( dx == 0 && dy == 0 && dz == 0 ) || ( idx[dz][dy][dx] < gridWidth3 ) ) {
-          auto index            = cellIndex[idx[dz][dy][dx]];
-          centroid3[dz][dy][dx] = gridCount[index] > 0 ? PCCVector3<double>( center[index] ) : curVector;
-        } else {
-          centroid3[dz][dy][dx] = curVector;
-        }
+        auto index            = idx[dz][dy][dx];
+        centroid3[dz][dy][dx] = gridCount[index] > 0 ? PCCVector3<double>( center[index] ) : curVector;
       }
     }
   }
@@ -1052,7 +1168,7 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
       for ( int dx = 0, a = Q[0]; dx < 2; dx++, a = W[0] ) {
         centroid3[dz][dy][dx] *= a * b * c;
         centroid4 += centroid3[dz][dy][dx];
-        count += a * b * c * gridCount[cellIndex[idx[dz][dy][dx]]];
+        count += a * b * c * gridCount[idx[dz][dy][dx]];
       }
     }
   }
@@ -1062,44 +1178,51 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
   return otherClusterPointCount;
 }
 
-void PCCCodec::smoothPointCloudGrid( PCCPointSet3&                       reconstruct,
-                                     const std::vector<uint32_t>&        partition,
-                                     const GeneratePointCloudParameters& params,
-                                     uint16_t                            gridWidth,
-                                     std::vector<int>&                   cellIndex ) {
+void PCCCodec::smoothPointCloudGrid( PCCPointSet3&                         reconstruct,
+                                     const std::vector<uint32_t>&          partition,
+                                     const GeneratePointCloudParameters&   params,
+                                     const std::vector<uint16_t>&          gridCount,
+                                     const std::vector<PCCVector3<float>>& center,
+                                     const std::vector<uint8_t>&           doSmooth,
+                                     uint16_t                              gridWidth,
+                                     const PCCSparseGridIndex<int>&        cellIndex ) {
   TRACE_CODEC( "%s \n", "smoothPointCloudGrid start" );
-  const size_t pointCount = reconstruct.getPointCount();
-  const int    gridSize   = static_cast<int>( params.gridSize_ );
-  const int    disth      = ( std::max )( gridSize / 2, 1 );
-  const int    th         = gridSize * gridWidth;
-  for ( int c = 0; c < pointCount; c++ ) {
-    PCCPoint3D      curPoint = reconstruct[c];
-    PCCVector3<int> P        = curPoint;
-    if ( P[0] < disth || P[1] < disth || P[2] < disth || th <= P[0] + disth || th <= P[1] + disth ||
-         th <= P[2] + disth ) {
-      continue;
-    }
-    PCCVector3D centroid( 0.0 );
-    PCCVector3D curVector              = P;
-    int         count                  = 0;
-    bool        otherClusterPointCount = false;
-    PCCVector3D color( 0, 0, 0 );
-    if ( reconstruct.getBoundaryPointType( c ) == 1 ) {
-      otherClusterPointCount =
-          gridFiltering( partition, reconstruct, curPoint, centroid, count, geoSmoothingCount_, geoSmoothingCenter_,
-                         geoSmoothingDoSmooth_, gridSize, gridWidth, cellIndex );
-    }
-    if ( otherClusterPointCount ) {
-      double dist2 = ( ( curVector * count - centroid ).getNorm2() ) / static_cast<double>( count ) + 0.5;
-      if ( dist2 >= ( std::max )( static_cast<int>( params.thresholdSmoothing_ ), count ) * 2 ) {
-        centroid = centroid / static_cast<double>( count ) + 0.5;
-        for ( size_t k = 0; k < 3; ++k ) { centroid[k] = double( int64_t( centroid[k] ) ); }
-        reconstruct[c] = centroid;
-        if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( c, POINT_SMOOTH ); }
-        reconstruct.setBoundaryPointType( c, static_cast<uint16_t>( 3 ) );
+  const size_t                     pointCount = reconstruct.getPointCount();
+  const int                        gridSize   = static_cast<int>( params.gridSize_ );
+  const int                        disth      = ( std::max )( gridSize / 2, 1 );
+  const int                        th         = gridSize * gridWidth;
+  const tbb::blocked_range<size_t> blocks( 0, pointCount, 1024 );
+  // each point is smoothed from the cell centroids only, the points are processed in parallel
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      for ( size_t c = r.begin(); c < r.end(); c++ ) {
+        PCCPoint3D      curPoint = reconstruct[c];
+        PCCVector3<int> P        = curPoint;
+        if ( P[0] < disth || P[1] < disth || P[2] < disth || th <= P[0] + disth || th <= P[1] + disth ||
+             th <= P[2] + disth ) {
+          continue;
+        }
+        PCCVector3D centroid( 0.0 );
+        PCCVector3D curVector              = P;
+        int         count                  = 0;
+        bool        otherClusterPointCount = false;
+        if ( reconstruct.getBoundaryPointType( c ) == 1 ) {
+          otherClusterPointCount = gridFiltering( partition, reconstruct, curPoint, centroid, count, gridCount,
+                                                  center, doSmooth, gridSize, gridWidth, cellIndex );
+        }
+        if ( otherClusterPointCount ) {
+          double dist2 = ( ( curVector * count - centroid ).getNorm2() ) / static_cast<double>( count ) + 0.5;
+          if ( dist2 >= ( std::max )( static_cast<int>( params.thresholdSmoothing_ ), count ) * 2 ) {
+            centroid = centroid / static_cast<double>( count ) + 0.5;
+            for ( size_t k = 0; k < 3; ++k ) { centroid[k] = double( int64_t( centroid[k] ) ); }
+            reconstruct[c] = centroid;
+            if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( c, POINT_SMOOTH ); }
+            reconstruct.setBoundaryPointType( c, static_cast<uint16_t>( 3 ) );
+          }
+        }
       }
-    }
-  }
+    } );
+  } );
   TRACE_CODEC( "%s \n", "smoothPointCloudGrid done" );
 }
 
@@ -1111,8 +1234,7 @@ void PCCCodec::smoothPointCloud( PCCPointSet3&                      reconstruct,
   PCCKdTree    kdtree( reconstruct );
   PCCPointSet3 temp;
   temp.resize( pointCount );
-  tbb::task_arena limited( static_cast<int>( params.nbThread_ ) );
-  limited.execute( [&] {
+  PCCTaskScheduler::getInstance().execute( [&] {
     tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
       const size_t clusterindex_ = partition[i];
       PCCNNResult  result;
@@ -1151,7 +1273,7 @@ void PCCCodec::smoothPointCloud( PCCPointSet3&                      reconstruct,
       }
     } );
   } );
-  limited.execute(
+  PCCTaskScheduler::getInstance().execute(
       [&] { tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) { reconstruct[i] = temp[i]; } ); } );
   TRACE_CODEC( "%s \n", "smoothPointCloud done" );
 }
@@ -1185,6 +1307,7 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
                                    std::vector<uint16_t>&              colorGridCount,
                                    std::vector<PCCVector3<float>>&     colorCenter,
                                    std::vector<bool>&                  colorDoSmooth,
+                                   std::vector<std::vector<uint16_t>>& colorLum,
                                    uint8_t                             gridSize,
                                    PCCVector3D&                        curPosColor,
                                    const GeneratePointCloudParameters& params,
@@ -1226,8 +1349,8 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
           }
           if ( dx == 0 && dy == 0 && dz == 0 ) {
             if ( colorGridCount[index] > 1 ) {
-              double meanY   = mean( colorSmoothingLum_[index], int( colorGridCount[index] ) );
-              double medianY = median( colorSmoothingLum_[index], int( colorGridCount[index] ) );
+              double meanY   = mean( colorLum[index], int( colorGridCount[index] ) );
+              double medianY = median( colorLum[index], int( colorGridCount[index] ) );
               if ( abs( meanY - medianY ) > mmThresh ) {
                 colorCentroid = curPosColor;
                 colorCount    = 1;
@@ -1237,8 +1360,8 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
           } else {
             if ( abs( Y0 - dst[0] ) > yThresh ) { dst = curPosColor; }
             if ( colorGridCount[index] > 1 ) {
-              double meanY   = mean( colorSmoothingLum_[index], int( colorGridCount[index] ) );
-              double medianY = median( colorSmoothingLum_[index], int( colorGridCount[index] ) );
+              double meanY   = mean( colorLum[index], int( colorGridCount[index] ) );
+              double medianY = median( colorLum[index], int( colorGridCount[index] ) );
               if ( abs( meanY - medianY ) > mmThresh ) { dst = curPosColor; }
             }
           }
@@ -1267,6 +1390,10 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
 
 void PCCCodec::smoothPointCloudColorLC( PCCPointSet3&                       reconstruct,
                                         const GeneratePointCloudParameters& params,
+                                        std::vector<uint16_t>&              colorGridCount,
+                                        std::vector<PCCVector3<float>>&     colorCenter,
+                                        std::vector<bool>&                  colorDoSmooth,
+                                        std::vector<std::vector<uint16_t>>& colorLum,
                                         std::vector<int>&                   cellIndex ) {
   const size_t pointCount = reconstruct.getPointCount();
   const int    gridSize   = params.occupancyPrecision_;
@@ -1287,8 +1414,8 @@ void PCCCodec::smoothPointCloudColorLC( PCCPointSet3&                       reco
     PCCVector3D curPosColor            = reconstruct.getColor16bit( i );
     if ( reconstruct.getBoundaryPointType( i ) == 1 ) {
       otherClusterPointCount =
-          gridFilteringColor( curPos, colorCentroid, colorCount, colorSmoothingCount_, colorSmoothingCenter_,
-                              colorSmoothingDoSmooth_, gridSize, curPosColor, params, cellIndex );
+          gridFilteringColor( curPos, colorCentroid, colorCount, colorGridCount, colorCenter, colorDoSmooth, colorLum,
+                              gridSize, curPosColor, params, cellIndex );
     }
     if ( otherClusterPointCount ) {
       colorCentroid = ( colorCentroid + static_cast<double>( colorCount ) / 2.0 ) / static_cast<double>( colorCount );
@@ -1494,8 +1621,6 @@ void PCCCodec::generateRawPointsGeometryfromVideo( PCCContext& context, PCCFrame
 }
 
 void PCCCodec::generateRawPointsAttributefromVideo( PCCContext& context, size_t frameIndex ) {
-  auto& videoRawPointsAttribute = context.getVideoRawPointsAttribute();
-  videoRawPointsAttribute.resize( context.size() );
   TRACE_CODEC( "%s \n", "generateRawPointsAttributefromVideo" );
   for ( size_t tileIdx = 0; tileIdx < context.getFrame( frameIndex ).getNumTilesInAtlasFrame(); tileIdx++ ) {
     auto& tile = context.getFrame( frameIndex ).getTile( tileIdx );
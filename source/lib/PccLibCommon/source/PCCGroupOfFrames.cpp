@@ -32,26 +32,67 @@
  */
 #include "PCCCommon.h"
 #include "PCCPointSet.h"
+#include "PCCKdTree.h"
 #include "PCCGroupOfFrames.h"
+#include "PCCTaskScheduler.h"
 #include "tbb/tbb.h"
 
 using namespace pcc;
 
-PCCGroupOfFrames::PCCGroupOfFrames() = default;
-PCCGroupOfFrames::PCCGroupOfFrames( size_t value ) { frames_.resize( value ); }
-PCCGroupOfFrames::~PCCGroupOfFrames() { frames_.clear(); }
+namespace pcc {
+struct PCCKdTreeCacheEntry {
+  std::once_flag built_;
+  PCCKdTree      kdtree_;
+};
+}  // namespace pcc
+
+PCCGroupOfFrames::PCCGroupOfFrames() : hasKdTrees_( false ) {}
+PCCGroupOfFrames::PCCGroupOfFrames( size_t value ) : hasKdTrees_( false ) { frames_.resize( value ); }
+PCCGroupOfFrames::PCCGroupOfFrames( const PCCGroupOfFrames& groupOfFrames ) :
+    frames_( groupOfFrames.frames_ ),
+    hasKdTrees_( false ) {}
+PCCGroupOfFrames& PCCGroupOfFrames::operator=( const PCCGroupOfFrames& groupOfFrames ) {
+  if ( this != &groupOfFrames ) {
+    clearKdTrees();
+    frames_ = groupOfFrames.frames_;
+  }
+  return *this;
+}
+PCCGroupOfFrames::~PCCGroupOfFrames() {
+  releaseKdTrees();
+  frames_.clear();
+}
+
+const PCCKdTree& PCCGroupOfFrames::getKdTree( const size_t index ) const {
+  assert( index < frames_.size() );
+  std::shared_ptr<PCCKdTreeCacheEntry> entry;
+  {
+    std::lock_guard<std::mutex> lock( kdtreesMutex_ );
+    if ( kdtrees_.size() != frames_.size() ) { kdtrees_.resize( frames_.size() ); }
+    if ( !kdtrees_[index] ) { kdtrees_[index] = std::make_shared<PCCKdTreeCacheEntry>(); }
+    entry       = kdtrees_[index];
+    hasKdTrees_ = true;
+  }
+  std::call_once( entry->built_, [&] { entry->kdtree_.init( frames_[index] ); } );
+  return entry->kdtree_;
+}
+
+void PCCGroupOfFrames::releaseKdTrees() {
+  std::lock_guard<std::mutex> lock( kdtreesMutex_ );
+  kdtrees_.clear();
+  hasKdTrees_ = false;
+}
 
 bool PCCGroupOfFrames::load( const std::string&      uncompressedDataPath,
                              const size_t            startFrameNumber,
                              const size_t            endFrameNumber,
                              const PCCColorTransform colorTransform,
-                             const bool              readNormals,
-                             const size_t            nbThread ) {
+                             const bool              readNormals ) {
   if ( endFrameNumber < startFrameNumber ) { return false; }
   const size_t frameCount = endFrameNumber - startFrameNumber;
+  clearKdTrees();
   frames_.resize( frameCount );
-  tbb::task_arena limited( static_cast<int>( nbThread ) );
-  limited.execute( [&] {
+  PCCTaskScheduler::getInstance().execute( [&] {
     tbb::parallel_for( size_t( startFrameNumber ), endFrameNumber, [&]( const size_t frameNumber ) {
       char fileName[4096];
       sprintf( fileName, uncompressedDataPath.c_str(), frameNumber );
@@ -70,16 +111,15 @@ bool PCCGroupOfFrames::load( const std::string&      uncompressedDataPath,
 
 bool PCCGroupOfFrames::write( const std::string& reconstructedDataPath,
                               size_t&            frameNumber,
-                              const size_t       nbThread,
-                              const bool         isAscii ) {
-  bool            ret = true;
-  tbb::task_arena limited( static_cast<int>( nbThread ) );
-  limited.execute( [&] {
+                              const bool         isAscii,
+                              const bool         isInt16 ) {
+  bool ret = true;
+  PCCTaskScheduler::getInstance().execute( [&] {
     tbb::parallel_for( size_t( 0 ), frames_.size(), [&]( const size_t i ) {
       char  fileName[4096];
       auto& pointSet = frames_[i];
       sprintf( fileName, reconstructedDataPath.c_str(), frameNumber + i );
-      if ( !pointSet.write( fileName, isAscii ) ) { ret = false; }
+      if ( !pointSet.write( fileName, isAscii, isInt16 ) ) { ret = false; }
     } );
   } );
   frameNumber += frames_.size();
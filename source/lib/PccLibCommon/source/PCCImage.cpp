@@ -32,6 +32,7 @@
  */
 
 #include "PCCImage.h"
+#include "PCCImageKernels.h"
 #include "MD5.h"
 
 using namespace pcc;
@@ -96,14 +97,7 @@ void PCCImage<T, N>::convertYUV444ToYUV420( const PCCImage<T, 3>& src ) {
   resize( src.getWidth(), src.getHeight(), PCCCOLORFORMAT::YUV420 );
   std::copy( src.channels_[0].begin(), src.channels_[0].end(), channels_[0].begin() );
   for ( size_t c = 1; c < N; ++c ) {
-    for ( size_t y = 0, y2 = 0; y < height_; y += 2, y2 += 1 ) {
-      const T* const buffer1 = src.channels_[c].data() + y * width_;
-      const T* const buffer2 = buffer1 + width_;
-      for ( size_t x = 0, x2 = y2 * ( width_ >> 1 ); x < width_; x += 2, x2 += 1 ) {
-        const uint64_t sum = buffer1[x] + buffer1[x + 1] + buffer2[x] + buffer2[x + 1];
-        channels_[c][x2]   = T( ( sum + 2 ) / 4 );
-      }
-    }
+    downsamplePlane2x2( src.channels_[c].data(), channels_[c].data(), width_, height_ );
   }
 }
 
@@ -118,19 +112,8 @@ void PCCImage<T, N>::convertYUV420ToYUV444( const PCCImage<T, 3>& image ) {
   }
   resize( image.getWidth(), image.getHeight(), PCCCOLORFORMAT::YUV444 );
   std::copy( image.channels_[0].begin(), image.channels_[0].end(), channels_[0].begin() );
-  const size_t width2 = width_ / 2;
   for ( size_t c = 1; c < N; ++c ) {
-    auto&    dst = channels_[c];
-    const T* src = image.channels_[c].data();
-    for ( size_t y = 0; y < height_; y += 2 ) {
-      T* const buffer = dst.data() + y * width_;
-      for ( size_t x2 = 0; x2 < width2; ++x2, src++ ) {
-        const size_t x = x2 * 2;
-        buffer[x]      = *src;
-        buffer[x + 1]  = *src;
-      }
-      memcpy( (char*)( buffer + width_ ), (char*)buffer, width_ * sizeof( T ) );
-    }
+    upsamplePlane2x2( image.channels_[c].data(), channels_[c].data(), width_, height_ );
   }
 }
 
@@ -205,6 +188,13 @@ template <typename T, size_t N>
 bool PCCImage<T, N>::copyBlock( size_t top, size_t left, size_t width, size_t height, PCCImage& block ) {
   assert( top >= 0 && left >= 0 && ( width + left ) <= width_ && ( height + top ) <= height_ );
   for ( size_t cc = 0; cc < N; cc++ ) {
+    if ( cc == 0 || ( format_ != YUV420 && block.format_ != YUV420 ) ) {
+      for ( size_t i = 0; i < height; i++ ) {
+        const T* src = channels_[cc].data() + ( top + i ) * width_ + left;
+        std::copy( src, src + width, block.channels_[cc].data() + i * block.width_ );
+      }
+      continue;
+    }
     for ( size_t i = top; i < top + height; i++ ) {
       for ( size_t j = left; j < left + width; j++ ) {
         block.setValue( cc, ( j - left ), ( i - top ), getValue( cc, j, i ) );
@@ -217,6 +207,13 @@ template <typename T, size_t N>
 bool PCCImage<T, N>::setBlock( size_t top, size_t left, PCCImage& block ) {
   assert( top >= 0 && left >= 0 && ( block.getWidth() + left ) < width_ && ( block.getHeight() + top ) < height_ );
   for ( size_t cc = 0; cc < N; cc++ ) {
+    if ( cc == 0 || ( format_ != YUV420 && block.format_ != YUV420 ) ) {
+      for ( size_t i = 0; i < block.height_; i++ ) {
+        const T* src = block.channels_[cc].data() + i * block.width_;
+        std::copy( src, src + block.width_, channels_[cc].data() + ( top + i ) * width_ + left );
+      }
+      continue;
+    }
     for ( size_t i = top; i < top + block.getHeight(); i++ ) {
       for ( size_t j = left; j < left + block.getWidth(); j++ ) {
         setValue( cc, j, i, block.getValue( cc, ( j - left ), ( i - top ) ) );
@@ -268,6 +265,19 @@ void PCCImage<T, N>::convertBitdepth( uint8_t bitdepthInput, uint8_t bitdepthOut
     exit( -1 );
   }
   int bitDiff = (int)bitdepthInput - (int)bitdepthOutput;
+  if ( format_ != YUV420 ) {
+    // the samples of each channel are converted in place, as the per pixel loops below do
+    for ( auto& channel : channels_ ) {
+      if ( bitDiff >= 0 && msbAlignFlag ) {
+        shiftRightPlane( channel.data(), channel.size(), bitDiff );
+      } else if ( bitDiff >= 0 ) {
+        clipPlane( channel.data(), channel.size(), ( T )( ( 1 << bitdepthOutput ) - 1 ) );
+      } else if ( msbAlignFlag ) {
+        shiftLeftPlane( channel.data(), channel.size(), -bitDiff );
+      }
+    }
+    return;
+  }
   if ( bitDiff >= 0 ) {
     if ( msbAlignFlag ) {
       for ( size_t cc = 0; cc < N; cc++ ) {
@@ -361,15 +371,7 @@ void PCCImage<T, N>::upsample( size_t rate ) {
     for ( size_t c = 0; c < N; ++c ) {
       size_t width  = format_ != YUV420 || c == 0 ? width_ * 2 : width_ * 2 / 2;
       size_t height = format_ != YUV420 || c == 0 ? height_ * 2 : height_ * 2 / 2;
-      T*     src    = channels_[c].data();
-      T*     dst    = up.channels_[c].data();
-      for ( size_t y = 0; y < height; y += 2, dst += width * 2 ) {
-        for ( size_t x = 0; x < width; x += 2, src++ ) {
-          dst[x]     = *src;
-          dst[x + 1] = *src;
-        }
-        memcpy( (char*)( dst + width ), (char*)dst, width * sizeof( T ) );
-      }
+      upsamplePlane2x2( channels_[c].data(), up.channels_[c].data(), width, height );
     }
     swap( up );
   }
@@ -0,0 +1,443 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PCCImageKernels.h"
+
+#if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+#define PCC_SIMD_X86
+#include <immintrin.h>
+#if defined( _MSC_VER )
+#include <intrin.h>
+#define PCC_TARGET_SSE41
+#define PCC_TARGET_AVX2
+#else
+#define PCC_TARGET_SSE41 __attribute__( ( target( "sse4.1" ) ) )
+#define PCC_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#endif
+#endif
+
+using namespace pcc;
+
+PCCSimdLevel pcc::getSupportedSimdLevel() {
+#if defined( PCC_SIMD_X86 ) && defined( _MSC_VER )
+  int info[4];
+  __cpuid( info, 0 );
+  const int maxLeaf = info[0];
+  __cpuid( info, 1 );
+  const bool sse41   = ( info[2] & ( 1 << 19 ) ) != 0;
+  const bool osxsave = ( info[2] & ( 1 << 27 ) ) != 0;
+  const bool avx     = ( info[2] & ( 1 << 28 ) ) != 0;
+  bool       avx2    = false;
+  if ( maxLeaf >= 7 && osxsave && avx && ( _xgetbv( 0 ) & 6 ) == 6 ) {
+    __cpuidex( info, 7, 0 );
+    avx2 = ( info[1] & ( 1 << 5 ) ) != 0;
+  }
+  return avx2 ? SIMD_AVX2 : sse41 ? SIMD_SSE41 : SIMD_NONE;
+#elif defined( PCC_SIMD_X86 )
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports( "avx2" ) ) { return SIMD_AVX2; }
+  if ( __builtin_cpu_supports( "sse4.1" ) ) { return SIMD_SSE41; }
+  return SIMD_NONE;
+#else
+  return SIMD_NONE;
+#endif
+}
+
+static PCCSimdLevel& simdLevel() {
+  static PCCSimdLevel level = getSupportedSimdLevel();
+  return level;
+}
+
+PCCSimdLevel pcc::getSimdLevel() { return simdLevel(); }
+
+void pcc::setSimdLevel( PCCSimdLevel level ) { simdLevel() = ( std::min )( level, getSupportedSimdLevel() ); }
+
+#if defined( PCC_SIMD_X86 )
+
+// The vector kernels process the first samples of a row and return how many they processed, the remaining ones are
+// processed by the scalar loops of the callers. They give the same results as the scalar loops.
+
+PCC_TARGET_SSE41 static size_t downsampleRowSSE41( const uint8_t* row0,
+                                                   const uint8_t* row1,
+                                                   uint8_t*       dst,
+                                                   const size_t   width ) {
+  const __m128i one   = _mm_set1_epi8( 1 );
+  const __m128i round = _mm_set1_epi16( 2 );
+  size_t        x     = 0;
+  for ( ; x + 32 <= width; x += 32, dst += 16 ) {
+    __m128i sum[2];
+    for ( size_t i = 0; i < 2; i++ ) {
+      const __m128i a = _mm_loadu_si128( (const __m128i*)( row0 + x + 16 * i ) );
+      const __m128i b = _mm_loadu_si128( (const __m128i*)( row1 + x + 16 * i ) );
+      sum[i]          = _mm_add_epi16( _mm_maddubs_epi16( a, one ), _mm_maddubs_epi16( b, one ) );
+      sum[i]          = _mm_srli_epi16( _mm_add_epi16( sum[i], round ), 2 );
+    }
+    _mm_storeu_si128( (__m128i*)dst, _mm_packus_epi16( sum[0], sum[1] ) );
+  }
+  return x;
+}
+
+PCC_TARGET_SSE41 static size_t downsampleRowSSE41( const uint16_t* row0,
+                                                   const uint16_t* row1,
+                                                   uint16_t*       dst,
+                                                   const size_t    width ) {
+  const __m128i mask  = _mm_set1_epi32( 0xFFFF );
+  const __m128i round = _mm_set1_epi32( 2 );
+  size_t        x     = 0;
+  for ( ; x + 16 <= width; x += 16, dst += 8 ) {
+    __m128i sum[2];
+    for ( size_t i = 0; i < 2; i++ ) {
+      const __m128i a = _mm_loadu_si128( (const __m128i*)( row0 + x + 8 * i ) );
+      const __m128i b = _mm_loadu_si128( (const __m128i*)( row1 + x + 8 * i ) );
+      sum[i]          = _mm_add_epi32( _mm_and_si128( a, mask ), _mm_srli_epi32( a, 16 ) );
+      sum[i]          = _mm_add_epi32( sum[i], _mm_add_epi32( _mm_and_si128( b, mask ), _mm_srli_epi32( b, 16 ) ) );
+      sum[i]          = _mm_srli_epi32( _mm_add_epi32( sum[i], round ), 2 );
+    }
+    _mm_storeu_si128( (__m128i*)dst, _mm_packus_epi32( sum[0], sum[1] ) );
+  }
+  return x;
+}
+
+PCC_TARGET_AVX2 static size_t downsampleRowAVX2( const uint8_t* row0,
+                                                 const uint8_t* row1,
+                                                 uint8_t*       dst,
+                                                 const size_t   width ) {
+  const __m256i one   = _mm256_set1_epi8( 1 );
+  const __m256i round = _mm256_set1_epi16( 2 );
+  size_t        x     = 0;
+  for ( ; x + 64 <= width; x += 64, dst += 32 ) {
+    __m256i sum[2];
+    for ( size_t i = 0; i < 2; i++ ) {
+      const __m256i a = _mm256_loadu_si256( (const __m256i*)( row0 + x + 32 * i ) );
+      const __m256i b = _mm256_loadu_si256( (const __m256i*)( row1 + x + 32 * i ) );
+      sum[i]          = _mm256_add_epi16( _mm256_maddubs_epi16( a, one ), _mm256_maddubs_epi16( b, one ) );
+      sum[i]          = _mm256_srli_epi16( _mm256_add_epi16( sum[i], round ), 2 );
+    }
+    // the packing is done in each 128-bit lane: the 64-bit blocks are put back in order
+    const __m256i pack = _mm256_packus_epi16( sum[0], sum[1] );
+    _mm256_storeu_si256( (__m256i*)dst, _mm256_permute4x64_epi64( pack, 0xD8 ) );
+  }
+  return x;
+}
+
+PCC_TARGET_AVX2 static size_t downsampleRowAVX2( const uint16_t* row0,
+                                                 const uint16_t* row1,
+                                                 uint16_t*       dst,
+                                                 const size_t    width ) {
+  const __m256i mask  = _mm256_set1_epi32( 0xFFFF );
+  const __m256i round = _mm256_set1_epi32( 2 );
+  size_t        x     = 0;
+  for ( ; x + 32 <= width; x += 32, dst += 16 ) {
+    __m256i sum[2];
+    for ( size_t i = 0; i < 2; i++ ) {
+      const __m256i a = _mm256_loadu_si256( (const __m256i*)( row0 + x + 16 * i ) );
+      const __m256i b = _mm256_loadu_si256( (const __m256i*)( row1 + x + 16 * i ) );
+      sum[i]          = _mm256_add_epi32( _mm256_and_si256( a, mask ), _mm256_srli_epi32( a, 16 ) );
+      sum[i] = _mm256_add_epi32( sum[i], _mm256_add_epi32( _mm256_and_si256( b, mask ), _mm256_srli_epi32( b, 16 ) ) );
+      sum[i] = _mm256_srli_epi32( _mm256_add_epi32( sum[i], round ), 2 );
+    }
+    const __m256i pack = _mm256_packus_epi32( sum[0], sum[1] );
+    _mm256_storeu_si256( (__m256i*)dst, _mm256_permute4x64_epi64( pack, 0xD8 ) );
+  }
+  return x;
+}
+
+PCC_TARGET_SSE41 static size_t upsampleRowSSE41( const uint8_t* src, uint8_t* dst, const size_t width2 ) {
+  size_t x2 = 0;
+  for ( ; x2 + 16 <= width2; x2 += 16 ) {
+    const __m128i v = _mm_loadu_si128( (const __m128i*)( src + x2 ) );
+    _mm_storeu_si128( (__m128i*)( dst + 2 * x2 ), _mm_unpacklo_epi8( v, v ) );
+    _mm_storeu_si128( (__m128i*)( dst + 2 * x2 + 16 ), _mm_unpackhi_epi8( v, v ) );
+  }
+  return x2;
+}
+
+PCC_TARGET_SSE41 static size_t upsampleRowSSE41( const uint16_t* src, uint16_t* dst, const size_t width2 ) {
+  size_t x2 = 0;
+  for ( ; x2 + 8 <= width2; x2 += 8 ) {
+    const __m128i v = _mm_loadu_si128( (const __m128i*)( src + x2 ) );
+    _mm_storeu_si128( (__m128i*)( dst + 2 * x2 ), _mm_unpacklo_epi16( v, v ) );
+    _mm_storeu_si128( (__m128i*)( dst + 2 * x2 + 8 ), _mm_unpackhi_epi16( v, v ) );
+  }
+  return x2;
+}
+
+PCC_TARGET_AVX2 static size_t upsampleRowAVX2( const uint8_t* src, uint8_t* dst, const size_t width2 ) {
+  size_t x2 = 0;
+  for ( ; x2 + 32 <= width2; x2 += 32 ) {
+    // the unpacking is done in each 128-bit lane: the 64-bit blocks are first put in the order it reads them
+    const __m256i v = _mm256_permute4x64_epi64( _mm256_loadu_si256( (const __m256i*)( src + x2 ) ), 0xD8 );
+    _mm256_storeu_si256( (__m256i*)( dst + 2 * x2 ), _mm256_unpacklo_epi8( v, v ) );
+    _mm256_storeu_si256( (__m256i*)( dst + 2 * x2 + 32 ), _mm256_unpackhi_epi8( v, v ) );
+  }
+  return x2;
+}
+
+PCC_TARGET_AVX2 static size_t upsampleRowAVX2( const uint16_t* src, uint16_t* dst, const size_t width2 ) {
+  size_t x2 = 0;
+  for ( ; x2 + 16 <= width2; x2 += 16 ) {
+    const __m256i v = _mm256_permute4x64_epi64( _mm256_loadu_si256( (const __m256i*)( src + x2 ) ), 0xD8 );
+    _mm256_storeu_si256( (__m256i*)( dst + 2 * x2 ), _mm256_unpacklo_epi16( v, v ) );
+    _mm256_storeu_si256( (__m256i*)( dst + 2 * x2 + 16 ), _mm256_unpackhi_epi16( v, v ) );
+  }
+  return x2;
+}
+
+// The 8-bit samples are shifted as 16-bit words, the bits crossing from one sample to the other are masked out.
+PCC_TARGET_SSE41 static size_t shiftRightSSE41( uint8_t* data, const size_t count, const int shift ) {
+  const __m128i bits = _mm_cvtsi32_si128( shift );
+  const __m128i mask = _mm_set1_epi8( char( 0xFF >> shift ) );
+  size_t        i    = 0;
+  for ( ; i + 16 <= count; i += 16 ) {
+    const __m128i v = _mm_loadu_si128( (const __m128i*)( data + i ) );
+    _mm_storeu_si128( (__m128i*)( data + i ), _mm_and_si128( _mm_srl_epi16( v, bits ), mask ) );
+  }
+  return i;
+}
+
+PCC_TARGET_SSE41 static size_t shiftRightSSE41( uint16_t* data, const size_t count, const int shift ) {
+  const __m128i bits = _mm_cvtsi32_si128( shift );
+  size_t        i    = 0;
+  for ( ; i + 8 <= count; i += 8 ) {
+    const __m128i v = _mm_loadu_si128( (const __m128i*)( data + i ) );
+    _mm_storeu_si128( (__m128i*)( data + i ), _mm_srl_epi16( v, bits ) );
+  }
+  return i;
+}
+
+PCC_TARGET_SSE41 static size_t shiftLeftSSE41( uint8_t* data, const size_t count, const int shift ) {
+  const __m128i bits = _mm_cvtsi32_si128( shift );
+  const __m128i mask = _mm_set1_epi8( char( ( 0xFF << shift ) & 0xFF ) );
+  size_t        i    = 0;
+  for ( ; i + 16 <= count; i += 16 ) {
+    const __m128i v = _mm_loadu_si128( (const __m128i*)( data + i ) );
+    _mm_storeu_si128( (__m128i*)( data + i ), _mm_and_si128( _mm_sll_epi16( v, bits ), mask ) );
+  }
+  return i;
+}
+
+PCC_TARGET_SSE41 static size_t shiftLeftSSE41( uint16_t* data, const size_t count, const int shift ) {
+  const __m128i bits = _mm_cvtsi32_si128( shift );
+  size_t        i    = 0;
+  for ( ; i + 8 <= count; i += 8 ) {
+    const __m128i v = _mm_loadu_si128( (const __m128i*)( data + i ) );
+    _mm_storeu_si128( (__m128i*)( data + i ), _mm_sll_epi16( v, bits ) );
+  }
+  return i;
+}
+
+PCC_TARGET_SSE41 static size_t clipSSE41( uint8_t* data, const size_t count, const uint8_t maxValue ) {
+  const __m128i max = _mm_set1_epi8( char( maxValue ) );
+  size_t        i   = 0;
+  for ( ; i + 16 <= count; i += 16 ) {
+    const __m128i v = _mm_loadu_si128( (const __m128i*)( data + i ) );
+    _mm_storeu_si128( (__m128i*)( data + i ), _mm_min_epu8( v, max ) );
+  }
+  return i;
+}
+
+PCC_TARGET_SSE41 static size_t clipSSE41( uint16_t* data, const size_t count, const uint16_t maxValue ) {
+  const __m128i max = _mm_set1_epi16( short( maxValue ) );
+  size_t        i   = 0;
+  for ( ; i + 8 <= count; i += 8 ) {
+    const __m128i v = _mm_loadu_si128( (const __m128i*)( data + i ) );
+    _mm_storeu_si128( (__m128i*)( data + i ), _mm_min_epu16( v, max ) );
+  }
+  return i;
+}
+
+PCC_TARGET_AVX2 static size_t shiftRightAVX2( uint8_t* data, const size_t count, const int shift ) {
+  const __m128i bits = _mm_cvtsi32_si128( shift );
+  const __m256i mask = _mm256_set1_epi8( char( 0xFF >> shift ) );
+  size_t        i    = 0;
+  for ( ; i + 32 <= count; i += 32 ) {
+    const __m256i v = _mm256_loadu_si256( (const __m256i*)( data + i ) );
+    _mm256_storeu_si256( (__m256i*)( data + i ), _mm256_and_si256( _mm256_srl_epi16( v, bits ), mask ) );
+  }
+  return i;
+}
+
+PCC_TARGET_AVX2 static size_t shiftRightAVX2( uint16_t* data, const size_t count, const int shift ) {
+  const __m128i bits = _mm_cvtsi32_si128( shift );
+  size_t        i    = 0;
+  for ( ; i + 16 <= count; i += 16 ) {
+    const __m256i v = _mm256_loadu_si256( (const __m256i*)( data + i ) );
+    _mm256_storeu_si256( (__m256i*)( data + i ), _mm256_srl_epi16( v, bits ) );
+  }
+  return i;
+}
+
+PCC_TARGET_AVX2 static size_t shiftLeftAVX2( uint8_t* data, const size_t count, const int shift ) {
+  const __m128i bits = _mm_cvtsi32_si128( shift );
+  const __m256i mask = _mm256_set1_epi8( char( ( 0xFF << shift ) & 0xFF ) );
+  size_t        i    = 0;
+  for ( ; i + 32 <= count; i += 32 ) {
+    const __m256i v = _mm256_loadu_si256( (const __m256i*)( data + i ) );
+    _mm256_storeu_si256( (__m256i*)( data + i ), _mm256_and_si256( _mm256_sll_epi16( v, bits ), mask ) );
+  }
+  return i;
+}
+
+PCC_TARGET_AVX2 static size_t shiftLeftAVX2( uint16_t* data, const size_t count, const int shift ) {
+  const __m128i bits = _mm_cvtsi32_si128( shift );
+  size_t        i    = 0;
+  for ( ; i + 16 <= count; i += 16 ) {
+    const __m256i v = _mm256_loadu_si256( (const __m256i*)( data + i ) );
+    _mm256_storeu_si256( (__m256i*)( data + i ), _mm256_sll_epi16( v, bits ) );
+  }
+  return i;
+}
+
+PCC_TARGET_AVX2 static size_t clipAVX2( uint8_t* data, const size_t count, const uint8_t maxValue ) {
+  const __m256i max = _mm256_set1_epi8( char( maxValue ) );
+  size_t        i   = 0;
+  for ( ; i + 32 <= count; i += 32 ) {
+    const __m256i v = _mm256_loadu_si256( (const __m256i*)( data + i ) );
+    _mm256_storeu_si256( (__m256i*)( data + i ), _mm256_min_epu8( v, max ) );
+  }
+  return i;
+}
+
+PCC_TARGET_AVX2 static size_t clipAVX2( uint16_t* data, const size_t count, const uint16_t maxValue ) {
+  const __m256i max = _mm256_set1_epi16( short( maxValue ) );
+  size_t        i   = 0;
+  for ( ; i + 16 <= count; i += 16 ) {
+    const __m256i v = _mm256_loadu_si256( (const __m256i*)( data + i ) );
+    _mm256_storeu_si256( (__m256i*)( data + i ), _mm256_min_epu16( v, max ) );
+  }
+  return i;
+}
+
+#endif
+
+template <typename T>
+void pcc::downsamplePlane2x2( const T* src, T* dst, const size_t width, const size_t height ) {
+#if defined( PCC_SIMD_X86 )
+  const PCCSimdLevel level = getSimdLevel();
+#endif
+  for ( size_t y = 0, y2 = 0; y < height; y += 2, y2 += 1 ) {
+    const T* const buffer1 = src + y * width;
+    const T* const buffer2 = buffer1 + width;
+    T* const       buffer  = dst + y2 * ( width >> 1 );
+    size_t         x       = 0;
+#if defined( PCC_SIMD_X86 )
+    if ( level == SIMD_AVX2 ) {
+      x = downsampleRowAVX2( buffer1, buffer2, buffer, width );
+    } else if ( level == SIMD_SSE41 ) {
+      x = downsampleRowSSE41( buffer1, buffer2, buffer, width );
+    }
+#endif
+    for ( size_t x2 = x >> 1; x < width; x += 2, x2 += 1 ) {
+      const uint64_t sum = buffer1[x] + buffer1[x + 1] + buffer2[x] + buffer2[x + 1];
+      buffer[x2]         = T( ( sum + 2 ) / 4 );
+    }
+  }
+}
+
+template <typename T>
+void pcc::upsamplePlane2x2( const T* src, T* dst, const size_t width, const size_t height ) {
+#if defined( PCC_SIMD_X86 )
+  const PCCSimdLevel level = getSimdLevel();
+#endif
+  const size_t width2 = width / 2;
+  for ( size_t y = 0; y < height; y += 2, src += width2 ) {
+    T* const buffer = dst + y * width;
+    size_t   x2     = 0;
+#if defined( PCC_SIMD_X86 )
+    if ( level == SIMD_AVX2 ) {
+      x2 = upsampleRowAVX2( src, buffer, width2 );
+    } else if ( level == SIMD_SSE41 ) {
+      x2 = upsampleRowSSE41( src, buffer, width2 );
+    }
+#endif
+    for ( ; x2 < width2; ++x2 ) {
+      const size_t x = x2 * 2;
+      buffer[x]      = src[x2];
+      buffer[x + 1]  = src[x2];
+    }
+    memcpy( (char*)( buffer + width ), (char*)buffer, width * sizeof( T ) );
+  }
+}
+
+template <typename T>
+void pcc::shiftRightPlane( T* data, const size_t count, const int shift ) {
+  size_t i = 0;
+#if defined( PCC_SIMD_X86 )
+  const PCCSimdLevel level = getSimdLevel();
+  if ( level == SIMD_AVX2 ) {
+    i = shiftRightAVX2( data, count, shift );
+  } else if ( level == SIMD_SSE41 ) {
+    i = shiftRightSSE41( data, count, shift );
+  }
+#endif
+  for ( ; i < count; i++ ) { data[i] = T( data[i] >> shift ); }
+}
+
+template <typename T>
+void pcc::shiftLeftPlane( T* data, const size_t count, const int shift ) {
+  size_t i = 0;
+#if defined( PCC_SIMD_X86 )
+  const PCCSimdLevel level = getSimdLevel();
+  if ( level == SIMD_AVX2 ) {
+    i = shiftLeftAVX2( data, count, shift );
+  } else if ( level == SIMD_SSE41 ) {
+    i = shiftLeftSSE41( data, count, shift );
+  }
+#endif
+  for ( ; i < count; i++ ) { data[i] = T( data[i] << shift ); }
+}
+
+template <typename T>
+void pcc::clipPlane( T* data, const size_t count, const T maxValue ) {
+  size_t i = 0;
+#if defined( PCC_SIMD_X86 )
+  const PCCSimdLevel level = getSimdLevel();
+  if ( level == SIMD_AVX2 ) {
+    i = clipAVX2( data, count, maxValue );
+  } else if ( level == SIMD_SSE41 ) {
+    i = clipSSE41( data, count, maxValue );
+  }
+#endif
+  for ( ; i < count; i++ ) { data[i] = ( std::min )( data[i], maxValue ); }
+}
+
+template void pcc::downsamplePlane2x2<uint8_t>( const uint8_t*, uint8_t*, const size_t, const size_t );
+template void pcc::downsamplePlane2x2<uint16_t>( const uint16_t*, uint16_t*, const size_t, const size_t );
+template void pcc::upsamplePlane2x2<uint8_t>( const uint8_t*, uint8_t*, const size_t, const size_t );
+template void pcc::upsamplePlane2x2<uint16_t>( const uint16_t*, uint16_t*, const size_t, const size_t );
+template void pcc::shiftRightPlane<uint8_t>( uint8_t*, const size_t, const int );
+template void pcc::shiftRightPlane<uint16_t>( uint16_t*, const size_t, const int );
+template void pcc::shiftLeftPlane<uint8_t>( uint8_t*, const size_t, const int );
+template void pcc::shiftLeftPlane<uint16_t>( uint16_t*, const size_t, const int );
+template void pcc::clipPlane<uint8_t>( uint8_t*, const size_t, const uint8_t );
+template void pcc::clipPlane<uint16_t>( uint16_t*, const size_t, const uint16_t );
@@ -34,12 +34,282 @@
 
 #include "PCCPointSet.h"
 #include "PCCKdTree.h"
-
-#include "KDTreeVectorOfVectorsAdaptor.h"
+#include "PCCSparseGridIndex.h"
+#include "PCCTaskScheduler.h"
+#include "tbb/tbb.h"
 
 using namespace pcc;
 
-typedef KDTreeVectorOfVectorsAdaptor<PCCPointSet3, PCCType, float, 3, metric_L2_Simple_2, size_t> KdTreeAdaptor;
+namespace {
+
+// squared distance and index of a neighbor, ordered by distance then index so the results don't depend on
+// the order the points are visited in.
+typedef std::pair<int64_t, uint32_t> PCCNeighbor;
+
+// Spatial index of the integer voxel positions: the points are sorted in Morton order and grouped in cubic
+// blocks of 2^blockShift_ voxels, the occupied blocks are found with a hash of their Morton code and each
+// block is linked to its 26 adjacent blocks. The k-NN queries visit the blocks by shells of increasing
+// distance around the block of the query point and the radius queries the blocks overlapping the search
+// box, the blocks too far from the query are skipped.
+class PCCVoxelIndex {
+ public:
+  PCCVoxelIndex( const PCCPointSet3& pointCloud );
+  ~PCCVoxelIndex() = default;
+
+  size_t size() const { return points_.size(); }
+  void   search( const PCCPoint3D& point, const size_t num_results, std::vector<PCCNeighbor>& neighbors ) const;
+  void   searchRadius( const PCCPoint3D& point, const double radius, std::vector<PCCNeighbor>& neighbors ) const;
+
+  // Morton code of a query point, clamped to the bounding box of the index
+  uint64_t getMortonCode( const PCCPoint3D& point ) const {
+    int32_t pos[3];
+    for ( size_t k = 0; k < 3; ++k ) { pos[k] = ( std::min )( ( std::max )( point[k] - origin_[k], 0 ), 0xffff ); }
+    return mortonCode( pos[0], pos[1], pos[2] );
+  }
+
+ private:
+  struct Block {
+    int32_t  pos[3];
+    uint32_t start;
+    uint32_t end;
+  };
+  static uint64_t spreadBits( uint64_t value ) {
+    value &= 0x1fffff;
+    value = ( value | value << 32 ) & 0x1f00000000ffffULL;
+    value = ( value | value << 16 ) & 0x1f0000ff0000ffULL;
+    value = ( value | value << 8 ) & 0x100f00f00f00f00fULL;
+    value = ( value | value << 4 ) & 0x10c30c30c30c30c3ULL;
+    value = ( value | value << 2 ) & 0x1249249249249249ULL;
+    return value;
+  }
+  static uint64_t mortonCode( const int32_t x, const int32_t y, const int32_t z ) {
+    return spreadBits( x ) | ( spreadBits( y ) << 1 ) | ( spreadBits( z ) << 2 );
+  }
+  int32_t toBlock( const int32_t pos ) const {
+    return pos >= 0 ? pos >> blockShift_ : -( ( -pos + ( 1 << blockShift_ ) - 1 ) >> blockShift_ );
+  }
+  int64_t boxDistance( const Block& block, const int32_t* pos ) const {
+    int64_t dist2 = 0;
+    for ( size_t k = 0; k < 3; ++k ) {
+      const int32_t lo = block.pos[k] << blockShift_;
+      const int32_t hi = lo + ( 1 << blockShift_ ) - 1;
+      const int64_t d  = pos[k] < lo ? lo - pos[k] : ( pos[k] > hi ? pos[k] - hi : 0 );
+      dist2 += d * d;
+    }
+    return dist2;
+  }
+  int findBlock( const int32_t x, const int32_t y, const int32_t z ) const {
+    if ( x < 0 || y < 0 || z < 0 || x > blockMax_[0] || y > blockMax_[1] || z > blockMax_[2] ) { return -1; }
+    return blockIndex_.find( static_cast<int64_t>( mortonCode( x, y, z ) ) );
+  }
+
+  int32_t                     origin_[3];
+  int32_t                     blockMax_[3];
+  int32_t                     blockShift_;
+  std::vector<PCCPoint3D>     points_;
+  std::vector<uint32_t>       indices_;
+  std::vector<Block>          blocks_;
+  std::vector<int32_t>        links_;
+  PCCSparseGridIndex<int64_t> blockIndex_;
+};
+
+PCCVoxelIndex::PCCVoxelIndex( const PCCPointSet3& pointCloud ) : blockShift_( 1 ) {
+  const size_t pointCount = pointCloud.getPointCount();
+  for ( size_t k = 0; k < 3; ++k ) {
+    origin_[k]   = 0;
+    blockMax_[k] = -1;
+  }
+  if ( pointCount == 0 ) { return; }
+  for ( size_t k = 0; k < 3; ++k ) { origin_[k] = pointCloud[0][k]; }
+  for ( size_t i = 1; i < pointCount; ++i ) {
+    for ( size_t k = 0; k < 3; ++k ) { origin_[k] = ( std::min )( origin_[k], int32_t( pointCloud[i][k] ) ); }
+  }
+  std::vector<std::pair<uint64_t, uint32_t>> codes( pointCount );
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    const auto& point = pointCloud[i];
+    codes[i] = std::make_pair( mortonCode( point[0] - origin_[0], point[1] - origin_[1], point[2] - origin_[2] ),
+                               static_cast<uint32_t>( i ) );
+  }
+  std::sort( codes.begin(), codes.end() );
+
+  // smallest blocks holding 8 points on average
+  for ( blockShift_ = 1; blockShift_ < 6; ++blockShift_ ) {
+    const size_t shift      = 3 * blockShift_;
+    size_t       blockCount = 1;
+    for ( size_t i = 1; i < pointCount; ++i ) {
+      blockCount += ( codes[i].first >> shift ) != ( codes[i - 1].first >> shift );
+    }
+    if ( pointCount >= 8 * blockCount ) { break; }
+  }
+
+  const size_t shift = 3 * blockShift_;
+  points_.resize( pointCount );
+  indices_.resize( pointCount );
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    indices_[i] = codes[i].second;
+    points_[i]  = pointCloud[codes[i].second];
+    if ( i == 0 || ( codes[i].first >> shift ) != ( codes[i - 1].first >> shift ) ) {
+      Block block;
+      for ( size_t k = 0; k < 3; ++k ) {
+        block.pos[k] = ( points_[i][k] - origin_[k] ) >> blockShift_;
+        blockMax_[k] = ( std::max )( blockMax_[k], block.pos[k] );
+      }
+      block.start = block.end = static_cast<uint32_t>( i );
+      blockIndex_.insert( static_cast<int64_t>( codes[i].first >> shift ) );
+      blocks_.push_back( block );
+    }
+    blocks_.back().end++;
+  }
+  links_.resize( 27 * blocks_.size() );
+  for ( size_t b = 0; b < blocks_.size(); ++b ) {
+    const auto& pos = blocks_[b].pos;
+    for ( int32_t l = 0; l < 27; ++l ) {
+      links_[27 * b + l] = findBlock( pos[0] + l % 3 - 1, pos[1] + ( l / 3 ) % 3 - 1, pos[2] + l / 9 - 1 );
+    }
+  }
+}
+
+void PCCVoxelIndex::search( const PCCPoint3D&         point,
+                            const size_t              num_results,
+                            std::vector<PCCNeighbor>& neighbors ) const {
+  neighbors.clear();
+  const size_t count = ( std::min )( num_results, points_.size() );
+  if ( count == 0 ) { return; }
+  const int32_t pos[3]    = {point[0] - origin_[0], point[1] - origin_[1], point[2] - origin_[2]};
+  const int32_t center[3] = {toBlock( pos[0] ), toBlock( pos[1] ), toBlock( pos[2] )};
+  auto isFar = [&]( const int64_t dist2 ) { return neighbors.size() == count && dist2 > neighbors[0].first; };
+  auto visit = [&]( const Block& block ) {
+    for ( uint32_t i = block.start; i < block.end; ++i ) {
+      const auto&   q     = points_[i];
+      const int64_t dx    = q[0] - point[0];
+      const int64_t dy    = q[1] - point[1];
+      const int64_t dz    = q[2] - point[2];
+      const int64_t dist2 = dx * dx + dy * dy + dz * dz;
+      if ( isFar( dist2 ) ) { continue; }
+      const PCCNeighbor neighbor( dist2, indices_[i] );
+      if ( neighbors.size() < count ) {
+        neighbors.push_back( neighbor );
+        std::push_heap( neighbors.begin(), neighbors.end() );
+      } else if ( neighbor < neighbors[0] ) {
+        std::pop_heap( neighbors.begin(), neighbors.end() );
+        neighbors.back() = neighbor;
+        std::push_heap( neighbors.begin(), neighbors.end() );
+      }
+    }
+  };
+
+  // distance from the query point to the faces of its block
+  int32_t gap = ( 1 << blockShift_ ) - 1;
+  for ( size_t k = 0; k < 3; ++k ) {
+    const int32_t offset = pos[k] - ( center[k] << blockShift_ );
+    gap                  = ( std::min )( gap, ( std::min )( offset, ( 1 << blockShift_ ) - 1 - offset ) );
+  }
+  // the blocks of a shell are visited by increasing distance to skip the ones farther than the k-th neighbor
+  const int                                 own = findBlock( center[0], center[1], center[2] );
+  std::vector<std::pair<int64_t, uint32_t>> shell;
+  shell.reserve( 27 );
+  for ( int32_t r = 0;; ++r ) {
+    const int64_t side       = 2 * r + 1;
+    const int64_t shellCount = r == 0 ? 1 : side * side * side - ( side - 2 ) * ( side - 2 ) * ( side - 2 );
+    if ( shellCount > static_cast<int64_t>( blocks_.size() ) ) {
+      // the shells are larger than the cloud: the remaining blocks are visited by increasing distance
+      std::vector<std::pair<int64_t, uint32_t>> remaining;
+      for ( size_t b = 0; b < blocks_.size(); ++b ) {
+        const auto& block = blocks_[b];
+        if ( std::abs( block.pos[0] - center[0] ) < r && std::abs( block.pos[1] - center[1] ) < r &&
+             std::abs( block.pos[2] - center[2] ) < r ) {
+          continue;
+        }
+        const int64_t dist2 = boxDistance( block, pos );
+        if ( !isFar( dist2 ) ) { remaining.emplace_back( dist2, static_cast<uint32_t>( b ) ); }
+      }
+      std::sort( remaining.begin(), remaining.end() );
+      for ( const auto& block : remaining ) {
+        if ( isFar( block.first ) ) { break; }
+        visit( blocks_[block.second] );
+      }
+      break;
+    }
+    shell.clear();
+    if ( r <= 1 && own >= 0 ) {
+      const int32_t* links = links_.data() + 27 * own;
+      for ( int32_t l = 0; l < 27; ++l ) {
+        if ( links[l] >= 0 && ( l == 13 ) == ( r == 0 ) ) {
+          shell.emplace_back( boxDistance( blocks_[links[l]], pos ), links[l] );
+        }
+      }
+    } else {
+      for ( int32_t dz = -r; dz <= r; ++dz ) {
+        for ( int32_t dy = -r; dy <= r; ++dy ) {
+          const bool    face = std::abs( dz ) == r || std::abs( dy ) == r;
+          const int32_t step = face ? 1 : ( std::max )( 2 * r, 1 );
+          for ( int32_t dx = -r; dx <= r; dx += step ) {
+            const int b = findBlock( center[0] + dx, center[1] + dy, center[2] + dz );
+            if ( b >= 0 ) { shell.emplace_back( boxDistance( blocks_[b], pos ), b ); }
+          }
+        }
+      }
+    }
+    std::sort( shell.begin(), shell.end() );
+    for ( const auto& block : shell ) {
+      if ( isFar( block.first ) ) { break; }
+      visit( blocks_[block.second] );
+    }
+    bool covered = true;
+    for ( size_t k = 0; k < 3; ++k ) { covered &= center[k] - r <= 0 && center[k] + r >= blockMax_[k]; }
+    if ( covered ) { break; }
+    if ( neighbors.size() == count ) {
+      // the points of the next shells are at least at this distance on one axis
+      const int64_t bound = ( static_cast<int64_t>( r ) << blockShift_ ) + gap + 1;
+      if ( neighbors[0].first < bound * bound ) { break; }
+    }
+  }
+  std::sort_heap( neighbors.begin(), neighbors.end() );
+}
+
+void PCCVoxelIndex::searchRadius( const PCCPoint3D&         point,
+                                  const double              radius,
+                                  std::vector<PCCNeighbor>& neighbors ) const {
+  neighbors.clear();
+  if ( points_.empty() || radius <= 0.0 ) { return; }
+  const int32_t pos[3] = {point[0] - origin_[0], point[1] - origin_[1], point[2] - origin_[2]};
+  const int32_t extent = static_cast<int32_t>( std::ceil( std::sqrt( ( std::min )( radius, 1e10 ) ) ) );
+  int32_t       lo[3];
+  int32_t       hi[3];
+  int64_t       boxCount = 1;
+  for ( size_t k = 0; k < 3; ++k ) {
+    lo[k] = ( std::max )( toBlock( pos[k] - extent ), 0 );
+    hi[k] = ( std::min )( toBlock( pos[k] + extent ), blockMax_[k] );
+    if ( lo[k] > hi[k] ) { return; }
+    boxCount *= hi[k] - lo[k] + 1;
+  }
+  auto visit = [&]( const Block& block ) {
+    if ( static_cast<double>( boxDistance( block, pos ) ) >= radius ) { return; }
+    for ( uint32_t i = block.start; i < block.end; ++i ) {
+      const auto&   q     = points_[i];
+      const int64_t dx    = q[0] - point[0];
+      const int64_t dy    = q[1] - point[1];
+      const int64_t dz    = q[2] - point[2];
+      const int64_t dist2 = dx * dx + dy * dy + dz * dz;
+      if ( static_cast<double>( dist2 ) < radius ) { neighbors.emplace_back( dist2, indices_[i] ); }
+    }
+  };
+  if ( boxCount <= static_cast<int64_t>( blocks_.size() ) ) {
+    for ( int32_t z = lo[2]; z <= hi[2]; ++z ) {
+      for ( int32_t y = lo[1]; y <= hi[1]; ++y ) {
+        for ( int32_t x = lo[0]; x <= hi[0]; ++x ) {
+          const int b = findBlock( x, y, z );
+          if ( b >= 0 ) { visit( blocks_[b] ); }
+        }
+      }
+    }
+  } else {
+    for ( const auto& block : blocks_ ) { visit( block ); }
+  }
+  std::sort( neighbors.begin(), neighbors.end() );
+}
+
+}  // namespace
 
 PCCKdTree::PCCKdTree() : kdtree_( nullptr ) {}
 
@@ -48,32 +318,69 @@ PCCKdTree::PCCKdTree( const PCCPointSet3& pointCloud ) : kdtree_( nullptr ) { in
 PCCKdTree::~PCCKdTree() { clear(); }
 void PCCKdTree::clear() {
   if ( kdtree_ != nullptr ) {
-    delete ( static_cast<KdTreeAdaptor*>( kdtree_ ) );
+    delete ( static_cast<PCCVoxelIndex*>( kdtree_ ) );
     kdtree_ = nullptr;
   }
 }
 
 void PCCKdTree::init( const PCCPointSet3& pointCloud ) {
   clear();
-  kdtree_ = new KdTreeAdaptor( 3, pointCloud, 10 );
+  kdtree_ = new PCCVoxelIndex( pointCloud );
 }
 
 void PCCKdTree::search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const {
-  if ( num_results != results.size() ) { results.resize( num_results ); }
-  auto retSize = ( static_cast<KdTreeAdaptor*>( kdtree_ ) )
-                     ->index->knnSearch( &point[0], num_results, results.indices(), results.dist() );
-  assert( retSize == results.size() );
+  std::vector<PCCNeighbor> neighbors;
+  neighbors.reserve( num_results );
+  ( static_cast<PCCVoxelIndex*>( kdtree_ ) )->search( point, num_results, neighbors );
+  if ( neighbors.size() != results.size() ) { results.resize( neighbors.size() ); }
+  for ( size_t i = 0; i < neighbors.size(); ++i ) {
+    results.indices( i ) = neighbors[i].second;
+    results.dist( i )    = static_cast<double>( neighbors[i].first );
+  }
 }
 
 void PCCKdTree::searchRadius( const PCCPoint3D& point,
                               const size_t      num_results,
                               const double      radius,
                               PCCNNResult&      results ) const {
-  std::vector<std::pair<size_t, double> > ret;
-  nanoflann::SearchParams                 params;
-  size_t retSize = ( static_cast<KdTreeAdaptor*>( kdtree_ ) )->index->radiusSearch( &point[0], radius, ret, params );
-  if ( retSize > num_results ) { retSize = num_results; }
-  ret.resize( retSize );
+  std::vector<PCCNeighbor> neighbors;
+  ( static_cast<PCCVoxelIndex*>( kdtree_ ) )->searchRadius( point, radius, neighbors );
+  const size_t retSize = ( std::min )( num_results, neighbors.size() );
   results.reserve( retSize );
-  for ( const auto& result : ret ) { results.pushBack( result ); }
+  for ( size_t i = 0; i < retSize; ++i ) {
+    results.pushBack( std::make_pair( size_t( neighbors[i].second ), static_cast<double>( neighbors[i].first ) ) );
+  }
+}
+
+size_t PCCKdTree::search( const std::vector<PCCPoint3D>& points,
+                          const size_t                   num_results,
+                          std::vector<uint32_t>&         indices,
+                          std::vector<double>&           dists ) const {
+  const auto*  index = static_cast<PCCVoxelIndex*>( kdtree_ );
+  const size_t count = ( std::min )( num_results, index->size() );
+  indices.resize( points.size() * count );
+  dists.resize( points.size() * count );
+
+  // the queries are processed in Morton order, the successive queries visit the same blocks
+  std::vector<std::pair<uint64_t, uint32_t>> order( points.size() );
+  for ( size_t i = 0; i < points.size(); ++i ) {
+    order[i] = std::make_pair( index->getMortonCode( points[i] ), static_cast<uint32_t>( i ) );
+  }
+  std::sort( order.begin(), order.end() );
+  const tbb::blocked_range<size_t> blocks( 0, points.size(), 1024 );
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& block ) {
+      std::vector<PCCNeighbor> neighbors;
+      neighbors.reserve( count );
+      for ( size_t o = block.begin(); o < block.end(); ++o ) {
+        const size_t i = order[o].second;
+        index->search( points[i], count, neighbors );
+        for ( size_t j = 0; j < count; ++j ) {
+          indices[i * count + j] = neighbors[j].second;
+          dists[i * count + j]   = static_cast<double>( neighbors[j].first );
+        }
+      }
+    } );
+  } );
+  return count;
 }
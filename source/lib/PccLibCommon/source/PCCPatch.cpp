@@ -250,51 +250,64 @@ size_t PCCPatch::patch2Canvas( const size_t u,
   return ( x + canvasStride * y );
 }
 
-int PCCPatch::patchBlock2CanvasBlock( const size_t uBlk,
-                                      const size_t vBlk,
-                                      size_t       canvasStrideBlk,
-                                      size_t       canvasHeightBlk,
-                                      const Tile   tile ) const {
-  size_t x, y;
-  switch ( patchOrientation_ ) {
+bool PCCPatch::patchBlock2CanvasOffset( const size_t orientation,
+                                        const size_t sizeU0,
+                                        const size_t sizeV0,
+                                        const size_t uBlk,
+                                        const size_t vBlk,
+                                        size_t&      x,
+                                        size_t&      y ) {
+  switch ( orientation ) {
     case PATCH_ORIENTATION_DEFAULT:
-      x = uBlk + u0_;
-      y = vBlk + v0_;
+      x = uBlk;
+      y = vBlk;
       break;
     case PATCH_ORIENTATION_ROT90:
-      x = ( sizeV0_ - 1 - vBlk ) + u0_;
-      y = uBlk + v0_;
+      x = ( sizeV0 - 1 - vBlk );
+      y = uBlk;
       break;
     case PATCH_ORIENTATION_ROT180:
-      x = ( sizeU0_ - 1 - uBlk ) + u0_;
-      y = ( sizeV0_ - 1 - vBlk ) + v0_;
+      x = ( sizeU0 - 1 - uBlk );
+      y = ( sizeV0 - 1 - vBlk );
       break;
     case PATCH_ORIENTATION_ROT270:
-      x = vBlk + u0_;
-      y = ( sizeU0_ - 1 - uBlk ) + v0_;
+      x = vBlk;
+      y = ( sizeU0 - 1 - uBlk );
       break;
     case PATCH_ORIENTATION_MIRROR:
-      x = ( sizeU0_ - 1 - uBlk ) + u0_;
-      y = vBlk + v0_;
+      x = ( sizeU0 - 1 - uBlk );
+      y = vBlk;
       break;
     case PATCH_ORIENTATION_MROT90:
-      x = ( sizeV0_ - 1 - vBlk ) + u0_;
-      y = ( sizeU0_ - 1 - uBlk ) + v0_;
+      x = ( sizeV0 - 1 - vBlk );
+      y = ( sizeU0 - 1 - uBlk );
       break;
     case PATCH_ORIENTATION_MROT180:
-      x = uBlk + u0_;
-      y = ( sizeV0_ - 1 - vBlk ) + v0_;
+      x = uBlk;
+      y = ( sizeV0 - 1 - vBlk );
       break;
     case PATCH_ORIENTATION_MROT270:
-      x = vBlk + u0_;
-      y = uBlk + v0_;
+      x = vBlk;
+      y = uBlk;
       break;
     case PATCH_ORIENTATION_SWAP:  // swapAxis
-      x = vBlk + u0_;
-      y = uBlk + v0_;
+      x = vBlk;
+      y = uBlk;
       break;
-    default: return -1; break;
+    default: return false; break;
   }
+  return true;
+}
+
+int PCCPatch::patchBlock2CanvasBlock( const size_t uBlk,
+                                      const size_t vBlk,
+                                      size_t       canvasStrideBlk,
+                                      size_t       canvasHeightBlk,
+                                      const Tile   tile ) const {
+  size_t x, y;
+  if ( !patchBlock2CanvasOffset( patchOrientation_, sizeU0_, sizeV0_, uBlk, vBlk, x, y ) ) { return -1; }
+  x += u0_;
+  y += v0_;
   // checking the results are within canvasHeightBlk boundary (missing y check)
   if ( x >= canvasStrideBlk ) { return -1; }
   if ( y >= canvasHeightBlk ) { return -1; }
@@ -307,33 +320,78 @@ int PCCPatch::patchBlock2CanvasBlock( const size_t uBlk,
   return int( x + canvasStrideBlk * y );
 }
 
-bool PCCPatch::checkFitPatchCanvas( std::vector<bool> canvas,
-                                    size_t            canvasStrideBlk,
-                                    size_t            canvasHeightBlk,
-                                    bool              bPrecedence,
-                                    int               safeguard,
-                                    const Tile        tile ) {
-  for ( size_t v0 = 0; v0 < sizeV0_; ++v0 ) {
-    for ( size_t u0 = 0; u0 < sizeU0_; ++u0 ) {
-      for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
-        for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
-          int pos = patchBlock2CanvasBlock( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk, tile );
-          if ( pos < 0 ) {
-            return false;
-          } else {
-            if ( bPrecedence ) {
-              if ( canvas[pos] && occupancy_[u0 + sizeU0_ * v0] ) { return false; }
-            } else {
-              if ( canvas[pos] ) { return false; }
-            }
-          }
-        }
-      }
-    }
-  }
-  return true;
-}
-
+void PCCPatch::updateCanvasMask( PCCPatchCanvasMask& mask,
+                                 const size_t        orientation,
+                                 const size_t        sizeU0,
+                                 const size_t        sizeV0,
+                                 const bool          bPrecedence,
+                                 const int           safeguard ) const {
+  if ( !mask.words_.empty() && mask.orientation_ == orientation && mask.sizeU0_ == sizeU0 &&
+       mask.sizeV0_ == sizeV0 && mask.precedence_ == bPrecedence && mask.safeguard_ == safeguard ) {
+    return;
+  }
+  const bool switched = !( orientation == PATCH_ORIENTATION_DEFAULT || orientation == PATCH_ORIENTATION_ROT180 ||
+                           orientation == PATCH_ORIENTATION_MIRROR || orientation == PATCH_ORIENTATION_MROT180 );
+  const size_t dilation = 2 * size_t( safeguard ) + 1;
+  mask.orientation_     = orientation;
+  mask.sizeU0_          = sizeU0;
+  mask.sizeV0_          = sizeV0;
+  mask.precedence_      = bPrecedence;
+  mask.safeguard_       = safeguard;
+  mask.width_           = ( switched ? sizeV0 : sizeU0 ) + dilation - 1;
+  mask.height_          = ( switched ? sizeU0 : sizeV0 ) + dilation - 1;
+  mask.wordCount_       = ( mask.width_ + 63 ) / 64;
+  mask.words_.assign( mask.height_ * mask.wordCount_, 0 );
+  // with bPrecedence only the occupied blocks of the patch are kept
+  assert( !bPrecedence || occupancy_.size() >= sizeU0_ * ( sizeV0 - 1 ) + sizeU0 );
+  for ( size_t v0 = 0; v0 < sizeV0; ++v0 ) {
+    for ( size_t u0 = 0; u0 < sizeU0; ++u0 ) {
+      size_t x, y;
+      if ( ( bPrecedence && !occupancy_[u0 + sizeU0_ * v0] ) ||
+           !patchBlock2CanvasOffset( orientation, sizeU0, sizeV0, u0, v0, x, y ) ) {
+        continue;
+      }
+      for ( size_t dy = 0; dy < dilation; ++dy ) {
+        uint64_t* row = mask.words_.data() + ( y + dy ) * mask.wordCount_;
+        for ( size_t dx = 0; dx < dilation; ++dx ) { row[( x + dx ) >> 6] |= uint64_t( 1 ) << ( ( x + dx ) & 63 ); }
+      }
+    }
+  }
+}
+
+bool PCCPatch::checkFitPatchCanvas( const PCCOccupancyCanvas& canvas,
+                                    size_t                    canvasStrideBlk,
+                                    size_t                    canvasHeightBlk,
+                                    bool                      bPrecedence,
+                                    int                       safeguard,
+                                    const Tile                tile,
+                                    size_t*                   span ) {
+  if ( span != nullptr ) { *span = 1; }
+  if ( sizeU0_ == 0 || sizeV0_ == 0 || safeguard < 0 ) { return true; }
+  if ( patchOrientation_ > PATCH_ORIENTATION_MROT270 ) { return false; }
+  if ( canvasMasks_.size() <= patchOrientation_ ) { canvasMasks_.resize( patchOrientation_ + 1 ); }
+  auto& mask = canvasMasks_[patchOrientation_];
+  updateCanvasMask( mask, patchOrientation_, sizeU0_, sizeV0_, bPrecedence, safeguard );
+  // the footprint of the patch, dilated by the safeguard distance, must be inside the canvas and the tile
+  const size_t x0 = u0_ - safeguard;
+  const size_t y0 = v0_ - safeguard;
+  if ( u0_ < size_t( safeguard ) || x0 > canvasStrideBlk || mask.width_ > canvasStrideBlk - x0 ) { return false; }
+  if ( v0_ < size_t( safeguard ) || y0 > canvasHeightBlk || mask.height_ > canvasHeightBlk - y0 ) { return false; }
+  if ( tile.minU != -1 ) {
+    if ( x0 < size_t( tile.minU ) || x0 + mask.width_ - 1 > size_t( tile.maxU ) ) { return false; }
+    if ( y0 < size_t( tile.minV ) || y0 + mask.height_ - 1 > size_t( tile.maxV ) ) { return false; }
+  }
+  const uint64_t* words = mask.words_.data();
+  for ( size_t y = 0; y < mask.height_; ++y, words += mask.wordCount_ ) {
+    const size_t pos = ( y0 + y ) * canvasStrideBlk + x0;
+    if ( canvas.intersects( words, mask.wordCount_, pos ) ) {
+      if ( span != nullptr ) { *span = canvas.intersectionSpan( words, mask.wordCount_, pos ); }
+      return false;
+    }
+  }
+  return true;
+}
+
 bool PCCPatch::smallerRefFirst( const PCCPatch& rhs ) {
   if ( bestMatchIdx_ == -1 && rhs.getBestMatchIdx() == -1 ) {
     return gt( rhs );
@@ -664,33 +722,28 @@ int PCCPatch::patchBlock2CanvasBlockForGPA( const size_t uBlk,
   return int( x + canvasStrideBlk * y );
 }
 
-bool PCCPatch::checkFitPatchCanvasForGPA( std::vector<bool> canvas,
-                                          size_t            canvasStrideBlk,
-                                          size_t            canvasHeightBlk,
-                                          bool              bPrecedence,
-                                          int               safeguard ) {
-  for ( size_t v0 = 0; v0 < curGPAPatchData_.sizeV0_; ++v0 ) {
-    for ( size_t u0 = 0; u0 < curGPAPatchData_.sizeU0_; ++u0 ) {
-      for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
-        for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
-          int pos = patchBlock2CanvasBlockForGPA( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk );
-          if ( pos < 0 ) {
-            return false;
-          } else {
-            if ( bPrecedence ) {
-              if ( canvas[pos] && occupancy_[u0 + sizeU0_ * v0] ) { return false; }
-            } else {
-              if ( canvas[pos] ) { return false; }
-            }
-          }
-        }
-      }
-    }
-  }
-
-  return true;
-}
-
+bool PCCPatch::checkFitPatchCanvasForGPA( const PCCOccupancyCanvas& canvas,
+                                          size_t                    canvasStrideBlk,
+                                          size_t                    canvasHeightBlk,
+                                          bool                      bPrecedence,
+                                          int                       safeguard ) {
+  const auto& gpa = curGPAPatchData_;
+  if ( gpa.sizeU0_ == 0 || gpa.sizeV0_ == 0 || safeguard < 0 ) { return true; }
+  if ( gpa.patchOrientation_ > PATCH_ORIENTATION_MROT270 ) { return false; }
+  // the blocks of the global patch are those of the patch, the footprint is tested as in checkFitPatchCanvas()
+  updateCanvasMask( gpaCanvasMask_, gpa.patchOrientation_, gpa.sizeU0_, gpa.sizeV0_, bPrecedence, safeguard );
+  const auto&  mask = gpaCanvasMask_;
+  const size_t x0   = gpa.u0_ - safeguard;
+  const size_t y0   = gpa.v0_ - safeguard;
+  if ( gpa.u0_ < size_t( safeguard ) || x0 > canvasStrideBlk || mask.width_ > canvasStrideBlk - x0 ) { return false; }
+  if ( gpa.v0_ < size_t( safeguard ) || y0 > canvasHeightBlk || mask.height_ > canvasHeightBlk - y0 ) { return false; }
+  const uint64_t* words = mask.words_.data();
+  for ( size_t y = 0; y < mask.height_; ++y, words += mask.wordCount_ ) {
+    if ( canvas.intersects( words, mask.wordCount_, ( y0 + y ) * canvasStrideBlk + x0 ) ) { return false; }
+  }
+  return true;
+}
+
 void PCCPatch::allocOneLayerData() {
   pointLocalReconstructionLevel_       = 0;
   pointLocalReconstructionModeByPatch_ = 0;
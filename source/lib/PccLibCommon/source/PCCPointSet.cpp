@@ -36,7 +36,10 @@
 #include "PCCMath.h"
 #include "KDTreeVectorOfVectorsAdaptor.h"
 #include "PCCKdTree.h"
+#include "PCCMappedFile.h"
+#include "PCCTaskScheduler.h"
 #include <numeric>
+#include <tbb/tbb.h>
 
 using namespace pcc;
 
@@ -108,16 +111,16 @@ void PCCPointSet3::distance( const PCCPointSet3& pointcloud,
   distY = 0.F;
   distU = 0.F;
   distV = 0.F;
-  PCCKdTree   kdtree( pointcloud );
-  PCCNNResult result;
-
+  PCCKdTree             kdtree( pointcloud );
+  std::vector<uint32_t> indices;
+  std::vector<double>   dists;
+  kdtree.search( positions_, 1, indices, dists );
   for ( size_t i = 0; i < positions_.size(); ++i ) {
-    kdtree.search( positions_[i], 1, result );
-    distP += result.dist( 0 );
+    distP += dists[i];
     float yuvA[3];
     float yuvB[3];
     convertRGBtoYUV_BT709( colors_[i], yuvA );
-    convertRGBtoYUV_BT709( pointcloud.colors_[result.indices( 0 )], yuvB );
+    convertRGBtoYUV_BT709( pointcloud.colors_[indices[i]], yuvB );
     distY += pow( yuvA[0] - yuvB[0], 2.F );
     distU += pow( yuvA[1] - yuvB[1], 2.F );
     distV += pow( yuvA[2] - yuvB[2], 2.F );
@@ -130,13 +133,16 @@ void PCCPointSet3::distance( const PCCPointSet3& pointcloud,
 }
 
 void PCCPointSet3::distance( const PCCPointSet3& pointcloud, float& distP ) const {
+  PCCKdTree kdtree( pointcloud );
+  distance( kdtree, distP );
+}
+
+void PCCPointSet3::distance( const PCCKdTree& kdtree, float& distP ) const {
   distP = 0.F;
-  PCCKdTree   kdtree( pointcloud );
-  PCCNNResult result;
-  for ( const auto& position : positions_ ) {
-    kdtree.search( position, 1, result );
-    distP += result.dist( 0 );
-  }
+  std::vector<uint32_t> indices;
+  std::vector<double>   dists;
+  kdtree.search( positions_, 1, indices, dists );
+  for ( const auto& dist : dists ) { distP += dist; }
   distP /= static_cast<float>( positions_.size() );
 }
 
@@ -356,64 +362,55 @@ bool PCCPointSet3::isRawPointsBboxEmpty( std::vector<size_t> rawPoints, PCCBox3D
   return true;
 }
 
-bool PCCPointSet3::write( const std::string& fileName, const bool asAscii ) {
-  std::ofstream fout( fileName, std::ofstream::out );
+bool PCCPointSet3::write( const std::string& fileName, const bool asAscii, const bool asInt16 ) {
+  std::ofstream fout( fileName, asAscii ? std::ofstream::out : std::ofstream::binary | std::ofstream::out );
   if ( !fout.is_open() ) { return false; }
-  const size_t pointCount = getPointCount();
-  fout << "ply" << std::endl;
-
+  const size_t      pointCount   = getPointCount();
+  const std::string positionType = asInt16 ? "int16" : "float";
+  fout << "ply\n";
   if ( asAscii ) {
-    fout << "format ascii 1.0" << std::endl;
+    fout << "format ascii 1.0\n";
   } else {
     PCCEndianness endianess = PCCSystemEndianness();
     if ( endianess == PCC_BIG_ENDIAN ) {
-      fout << "format binary_big_endian 1.0" << std::endl;
+      fout << "format binary_big_endian 1.0\n";
     } else {
-      fout << "format binary_little_endian 1.0" << std::endl;
+      fout << "format binary_little_endian 1.0\n";
     }
   }
-  fout << "element vertex " << pointCount << std::endl;
-  if ( asAscii ) {
-    fout << "property float x" << std::endl;
-    fout << "property float y" << std::endl;
-    fout << "property float z" << std::endl;
-  } else {
-    // fout << "property int16 x" << std::endl;
-    // fout << "property int16 y" << std::endl;
-    // fout << "property int16 z" << std::endl;
-    fout << "property float x" << std::endl;
-    fout << "property float y" << std::endl;
-    fout << "property float z" << std::endl;
-  }
+  fout << "element vertex " << pointCount << "\n";
+  fout << "property " << positionType << " x\n";
+  fout << "property " << positionType << " y\n";
+  fout << "property " << positionType << " z\n";
   if ( hasNormals() ) {
-    fout << "property float nx" << std::endl;
-    fout << "property float ny" << std::endl;
-    fout << "property float nz" << std::endl;
+    fout << "property float nx\n";
+    fout << "property float ny\n";
+    fout << "property float nz\n";
   }
   if ( hasColors() ) {
-    fout << "property uchar red" << std::endl;
-    fout << "property uchar green" << std::endl;
-    fout << "property uchar blue" << std::endl;
+    fout << "property uchar red\n";
+    fout << "property uchar green\n";
+    fout << "property uchar blue\n";
   }
-  if ( hasReflectances() ) { fout << "property uint16 refc" << std::endl; }
+  if ( hasReflectances() ) { fout << "property uint16 refc\n"; }
   if ( PCC_SAVE_POINT_TYPE != 0u ) {
-    fout << "property uchar type" << std::endl;
+    fout << "property uchar type\n";
     switch ( PCC_SAVE_POINT_TYPE ) {
-      case 1: fout << "comment POINT_TYPE: Unset D0 D1 Filling Smooth InBetween" << std::endl; break;
-      case 2: fout << "comment POINT_TYPE: type0 type1 type2  " << std::endl; break;
+      case 1: fout << "comment POINT_TYPE: Unset D0 D1 Filling Smooth InBetween\n"; break;
+      case 2: fout << "comment POINT_TYPE: type0 type1 type2  \n"; break;
       default: break;
     }
   }
-  fout << "element face 0" << std::endl;
-  fout << "property list uint8 int32 vertex_index" << std::endl;
-  fout << "end_header" << std::endl;
+  fout << "element face 0\n";
+  fout << "property list uint8 int32 vertex_index\n";
+  fout << "end_header\n";
   if ( asAscii ) {
     fout << std::setprecision( std::numeric_limits<double>::max_digits10 );
     for ( size_t i = 0; i < pointCount; ++i ) {
       const PCCPoint3D& position = ( *this )[i];
       fout << position.x() << " " << position.y() << " " << position.z();
       if ( hasNormals() ) {
-        const PCCNormal3D& normal = getNormals()[i];
+        const auto& normal = getNormals()[i];
         fout << " " << static_cast<float>( normal[0] ) << " " << static_cast<float>( normal[1] ) << " "
              << static_cast<float>( normal[2] );
       }
@@ -424,43 +421,78 @@ bool PCCPointSet3::write( const std::string& fileName, const bool asAscii ) {
       }
       if ( hasReflectances() ) { fout << " " << static_cast<int>( getReflectance( i ) ); }
       if ( PCC_SAVE_POINT_TYPE != 0u ) { fout << " " << static_cast<int>( types_[i] ); }
-      fout << std::endl;
+      fout << "\n";
     }
   } else {
-    fout.clear();
-    fout.close();
-    fout.open( fileName, std::ofstream::binary | std::ofstream::out | std::ofstream::app );
-    for ( size_t i = 0; i < pointCount; ++i ) {
-      const PCCPoint3D& position = ( *this )[i];
-      // fout.write( reinterpret_cast<const char* const>( &position ), sizeof( PCCType ) * 3 );
-      float value[3];
-      value[0] = position[0];
-      value[1] = position[1];
-      value[2] = position[2];
-      fout.write( reinterpret_cast<const char*>( &value ), sizeof( float ) * 3 );
-      if ( hasNormals() ) {
-        const PCCNormal3D& normal = getNormals()[i];
-        value[0]                  = normal[0];
-        value[1]                  = normal[1];
-        value[2]                  = normal[2];
-        fout.write( reinterpret_cast<const char*>( &value ), sizeof( float ) * 3 );
-      }
-      if ( hasColors() ) {
-        const PCCColor3B& color = getColor( i );
-        fout.write( reinterpret_cast<const char*>( &color ), sizeof( uint8_t ) * 3 );
-      }
-      if ( hasReflectances() ) {
-        const uint16_t& reflectance = getReflectance( i );
-        fout.write( reinterpret_cast<const char*>( &reflectance ), sizeof( uint16_t ) );
-      }
-      if ( PCC_SAVE_POINT_TYPE != 0u ) {
-        fout.write( reinterpret_cast<const char* const>( &types_[i] ), sizeof( uint8_t ) );
-      }
-    }
+    // the points are serialized in a single buffer, by blocks processed in parallel, and the buffer
+    // is written at once.
+    const size_t positionSize = asInt16 ? sizeof( int16_t ) * 3 : sizeof( float ) * 3;
+    const size_t normalOffset = positionSize;
+    const size_t colorOffset  = normalOffset + ( hasNormals() ? sizeof( float ) * 3 : 0 );
+    const size_t refcOffset   = colorOffset + ( hasColors() ? sizeof( uint8_t ) * 3 : 0 );
+    const size_t typeOffset   = refcOffset + ( hasReflectances() ? sizeof( uint16_t ) : 0 );
+    const size_t stride       = typeOffset + ( PCC_SAVE_POINT_TYPE != 0u ? sizeof( uint8_t ) : 0 );
+    const tbb::blocked_range<size_t> blocks( 0, pointCount, 65536 );
+    std::vector<uint8_t>             buffer( pointCount * stride );
+    PCCTaskScheduler::getInstance().execute( [&] {
+      tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+        uint8_t* dst = buffer.data() + r.begin() * stride;
+        for ( size_t i = r.begin(); i < r.end(); ++i, dst += stride ) {
+          const PCCPoint3D& position = positions_[i];
+          if ( asInt16 ) {
+            int16_t value[3] = {position[0], position[1], position[2]};
+            memcpy( dst, value, sizeof( value ) );
+          } else {
+            float value[3] = {static_cast<float>( position[0] ), static_cast<float>( position[1] ),
+                              static_cast<float>( position[2] )};
+            memcpy( dst, value, sizeof( value ) );
+          }
+          if ( hasNormals() ) {
+            const auto& normal   = normals_[i];
+            float       value[3] = {static_cast<float>( normal[0] ), static_cast<float>( normal[1] ),
+                                    static_cast<float>( normal[2] )};
+            memcpy( dst + normalOffset, value, sizeof( value ) );
+          }
+          if ( hasColors() ) { memcpy( dst + colorOffset, &colors_[i], sizeof( uint8_t ) * 3 ); }
+          if ( hasReflectances() ) { memcpy( dst + refcOffset, &reflectances_[i], sizeof( uint16_t ) ); }
+          if ( PCC_SAVE_POINT_TYPE != 0u ) { dst[typeOffset] = types_[i]; }
+        }
+      } );
+    } );
+    fout.write( reinterpret_cast<const char*>( buffer.data() ), buffer.size() );
   }
   fout.close();
-  return true;
+  return !fout.fail();
 }
+
+template <typename T, typename V>
+static void readPlyValues( const uint8_t*  src,
+                           const size_t    stride,
+                           const size_t    component,
+                           const size_t    start,
+                           const size_t    end,
+                           std::vector<V>& values ) {
+  for ( size_t i = start; i < end; ++i, src += stride ) {
+    T value;
+    memcpy( &value, src, sizeof( T ) );
+    values[i][component] = value;
+  }
+}
+
+template <typename T>
+static void readPlyValues( const uint8_t*         src,
+                           const size_t           stride,
+                           const size_t           component,
+                           const size_t           start,
+                           const size_t           end,
+                           std::vector<uint16_t>& values ) {
+  for ( size_t i = start; i < end; ++i, src += stride ) {
+    T value;
+    memcpy( &value, src, sizeof( T ) );
+    values[i] = value;
+  }
+}
+
 bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
   std::ifstream ifs( fileName, std::ifstream::in );
   if ( !ifs.is_open() ) { return false; }
@@ -644,114 +676,57 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
     }
   } else {
     ifs.close();
-    ifs.open( fileName, std::ifstream::binary | std::ifstream::in );
-    ifs.read( tmp, MAX_BUFFER_SIZE );
-    char* str       = strstr( tmp, "end_header" );
-    str             = strstr( str, "\n" );
-    int headerCount = str - tmp + 1;
-    ifs.close();
-    ifs.open( fileName, std::ifstream::binary | std::ifstream::in );
-    ifs.read( tmp, headerCount );
-    for ( size_t pointCounter = 0; pointCounter < pointCount && !ifs.eof(); ++pointCounter ) {
-      auto& position = positions_[pointCounter];
-      for ( size_t a = 0; a < attributeCount && !ifs.eof(); ++a ) {
-        const auto& attributeInfo = attributesInfo[a];
-        if ( a == indexX ) {
-          if ( attributeInfo.byteCount == 2 ) {
-            uint16_t x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( uint16_t ) );
-            position[0] = x;
-          } else if ( attributeInfo.byteCount == 4 ) {
-            float x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( float ) );
-            position[0] = x;
-          } else {
-            double x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( double ) );
-            position[0] = x;
-          }
-        } else if ( a == indexY ) {
-          if ( attributeInfo.byteCount == 2 ) {
-            uint16_t y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( uint16_t ) );
-            position[1] = y;
-          } else if ( attributeInfo.byteCount == 4 ) {
-            float y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( float ) );
-            position[1] = y;
-          } else {
-            double y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( double ) );
-            position[1] = y;
-          }
-        } else if ( a == indexZ ) {
-          if ( attributeInfo.byteCount == 2 ) {
-            uint16_t z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( uint16_t ) );
-            position[2] = z;
-          } else if ( attributeInfo.byteCount == 4 ) {
-            float z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( float ) );
-            position[2] = z;
-          } else {
-            double z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( double ) );
-            position[2] = z;
-          }
-        } else if ( a == indexR && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[0] ), sizeof( uint8_t ) );
-        } else if ( a == indexG && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[1] ), sizeof( uint8_t ) );
-        } else if ( a == indexB && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[2] ), sizeof( uint8_t ) );
-        } else if ( a == indexNX ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float nx;
-            ifs.read( reinterpret_cast<char*>( &nx ), sizeof( float ) );
-            normals_[pointCounter][0] = nx;
-          } else {
-            double nx;
-            ifs.read( reinterpret_cast<char*>( &nx ), sizeof( double ) );
-            normals_[pointCounter][0] = nx;
-          }
-        } else if ( a == indexNY ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float ny;
-            ifs.read( reinterpret_cast<char*>( &ny ), sizeof( float ) );
-            normals_[pointCounter][1] = ny;
-          } else {
-            double ny;
-            ifs.read( reinterpret_cast<char*>( &ny ), sizeof( double ) );
-            normals_[pointCounter][1] = ny;
-          }
-        } else if ( a == indexNZ ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float nz;
-            ifs.read( reinterpret_cast<char*>( &nz ), sizeof( float ) );
-            normals_[pointCounter][2] = nz;
-          } else {
-            double nz;
-            ifs.read( reinterpret_cast<char*>( &nz ), sizeof( double ) );
-            normals_[pointCounter][2] = nz;
-          }
-        } else if ( a == indexReflectance && attributeInfo.byteCount <= 2 ) {
-          if ( indexReflectance == 1 ) {
-            uint8_t reflectance;
-            ifs.read( reinterpret_cast<char*>( &reflectance ), sizeof( uint8_t ) );
-            reflectances_[pointCounter] = reflectance;
-          } else {
-            auto& reflectance = reflectances_[pointCounter];
-            ifs.read( reinterpret_cast<char*>( reflectance ), sizeof( uint16_t ) );
-          }
-        } else {
-          char buffer[128];
-          ifs.read( buffer, attributeInfo.byteCount );
-        }
-      }
+    PCCMappedFile file;
+    if ( !file.open( fileName ) ) { return false; }
+    const char*    endHeader = "end_header";
+    const uint8_t* fileEnd   = file.data() + file.size();
+    const uint8_t* str       = std::search( file.data(), fileEnd, endHeader, endHeader + strlen( endHeader ) );
+    str                      = std::find( str, fileEnd, '\n' );
+    if ( str == fileEnd ) {
+      std::cout << "Error: corrupted header!" << std::endl;
+      return false;
     }
+    const uint8_t*      data = str + 1;
+    std::vector<size_t> offsets( attributeCount + 1, 0 );
+    for ( size_t a = 0; a < attributeCount; ++a ) { offsets[a + 1] = offsets[a] + attributesInfo[a].byteCount; }
+    const size_t stride    = offsets[attributeCount];
+    const size_t readCount = ( std::min )( pointCount, static_cast<size_t>( fileEnd - data ) / stride );
+
+    auto readValues = [&]( const size_t a, const size_t c, const size_t start, const size_t end, auto& values ) {
+      const uint8_t* src = data + start * stride + offsets[a];
+      switch ( attributesInfo[a].type ) {
+        case ATTRIBUTE_TYPE_FLOAT64: readPlyValues<double>( src, stride, c, start, end, values ); break;
+        case ATTRIBUTE_TYPE_FLOAT32: readPlyValues<float>( src, stride, c, start, end, values ); break;
+        case ATTRIBUTE_TYPE_UINT64: readPlyValues<uint64_t>( src, stride, c, start, end, values ); break;
+        case ATTRIBUTE_TYPE_UINT32: readPlyValues<uint32_t>( src, stride, c, start, end, values ); break;
+        case ATTRIBUTE_TYPE_UINT16: readPlyValues<uint16_t>( src, stride, c, start, end, values ); break;
+        case ATTRIBUTE_TYPE_UINT8: readPlyValues<uint8_t>( src, stride, c, start, end, values ); break;
+        case ATTRIBUTE_TYPE_INT64: readPlyValues<int64_t>( src, stride, c, start, end, values ); break;
+        case ATTRIBUTE_TYPE_INT32: readPlyValues<int32_t>( src, stride, c, start, end, values ); break;
+        case ATTRIBUTE_TYPE_INT16: readPlyValues<int16_t>( src, stride, c, start, end, values ); break;
+        case ATTRIBUTE_TYPE_INT8: readPlyValues<int8_t>( src, stride, c, start, end, values ); break;
+      }
+    };
+    // the points are decoded straight from the mapped file by blocks processed in parallel, one
+    // property after the other to keep the loops free of branches.
+    PCCTaskScheduler::getInstance().execute( [&] {
+      tbb::parallel_for( tbb::blocked_range<size_t>( 0, readCount, 65536 ), [&]( const tbb::blocked_range<size_t>& r ) {
+        readValues( indexX, 0, r.begin(), r.end(), positions_ );
+        readValues( indexY, 1, r.begin(), r.end(), positions_ );
+        readValues( indexZ, 2, r.begin(), r.end(), positions_ );
+        if ( hasColors() ) {
+          readValues( indexR, 0, r.begin(), r.end(), colors_ );
+          readValues( indexG, 1, r.begin(), r.end(), colors_ );
+          readValues( indexB, 2, r.begin(), r.end(), colors_ );
+        }
+        if ( hasNormals() ) {
+          readValues( indexNX, 0, r.begin(), r.end(), normals_ );
+          readValues( indexNY, 1, r.begin(), r.end(), normals_ );
+          readValues( indexNZ, 2, r.begin(), r.end(), normals_ );
+        }
+        if ( hasReflectances() ) { readValues( indexReflectance, 0, r.begin(), r.end(), reflectances_ ); }
+      } );
+    } );
   }
   return true;
 }
@@ -804,33 +779,67 @@ void PCCPointSet3::convertYUVToRGB() {  // BT709
   }
 }
 
-bool PCCPointSet3::transferColors( PCCPointSet3& target,
-                                   const int32_t searchRange,
-                                   const bool    losslessAttribute,
-                                   const int     numNeighborsColorTransferFwd,
-                                   const int     numNeighborsColorTransferBwd,
-                                   const bool    useDistWeightedAverageFwd,
-                                   const bool    useDistWeightedAverageBwd,
-                                   const bool    skipAvgIfIdenticalSourcePointPresentFwd,
-                                   const bool    skipAvgIfIdenticalSourcePointPresentBwd,
-                                   const double  distOffsetFwd,
-                                   const double  distOffsetBwd,
-                                   double        maxGeometryDist2Fwd,
-                                   double        maxGeometryDist2Bwd,
-                                   double        maxColorDist2Fwd,
-                                   double        maxColorDist2Bwd,
-                                   const bool    excludeColorOutlier,
-                                   const double  thresholdColorOutlierDist ) const {
+// Searches the nearest neighbors of the points accepted by the filter concurrently. The neighbors of
+// the point index are stored in the slots [index * num, index * num + counts[index]) so that they can
+// then be consumed in the order of the points.
+template <typename Filter>
+static void searchNeighbors( const PCCKdTree&     kdtree,
+                             const PCCPointSet3&  points,
+                             const size_t         num,
+                             Filter               filter,
+                             std::vector<size_t>& counts,
+                             std::vector<size_t>& indices,
+                             std::vector<double>& dists ) {
+  const size_t                     pointCount = points.getPointCount();
+  const tbb::blocked_range<size_t> blocks( 0, pointCount, 1024 );
+  counts.assign( pointCount, 0 );
+  indices.resize( pointCount * num );
+  dists.resize( pointCount * num );
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      PCCNNResult result;
+      for ( size_t index = r.begin(); index < r.end(); ++index ) {
+        if ( !filter( index ) ) { continue; }
+        kdtree.search( points[index], num, result );
+        counts[index] = result.size();
+        std::copy( result.indices(), result.indices() + result.size(), indices.begin() + index * num );
+        std::copy( result.dist(), result.dist() + result.size(), dists.begin() + index * num );
+      }
+    } );
+  } );
+}
+
+bool PCCPointSet3::transferColors( PCCPointSet3&    target,
+                                   const int32_t    searchRange,
+                                   const bool       losslessAttribute,
+                                   const int        numNeighborsColorTransferFwd,
+                                   const int        numNeighborsColorTransferBwd,
+                                   const bool       useDistWeightedAverageFwd,
+                                   const bool       useDistWeightedAverageBwd,
+                                   const bool       skipAvgIfIdenticalSourcePointPresentFwd,
+                                   const bool       skipAvgIfIdenticalSourcePointPresentBwd,
+                                   const double     distOffsetFwd,
+                                   const double     distOffsetBwd,
+                                   double           maxGeometryDist2Fwd,
+                                   double           maxGeometryDist2Bwd,
+                                   double           maxColorDist2Fwd,
+                                   double           maxColorDist2Bwd,
+                                   const bool       excludeColorOutlier,
+                                   const double     thresholdColorOutlierDist,
+                                   const PCCKdTree* sourceKdTree ) const {
   printf( "transferColors \n" );
   const auto&  source           = *this;
   const size_t pointCountSource = source.getPointCount();
   const size_t pointCountTarget = target.getPointCount();
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
   PCCKdTree kdtreeTarget( target );
-  PCCKdTree kdtreeSource( source );
+  PCCKdTree kdtreeSourceLocal;
+  if ( sourceKdTree == nullptr ) { kdtreeSourceLocal.init( source ); }
+  const PCCKdTree& kdtreeSource = sourceKdTree != nullptr ? *sourceKdTree : kdtreeSourceLocal;
   target.addColors();
   std::vector<PCCColor3B> refinedColors1;
   refinedColors1.resize( pointCountTarget );
+  const tbb::blocked_range<size_t> blocks( 0, pointCountTarget, 256 );
   maxGeometryDist2Fwd = ( maxGeometryDist2Fwd < 512 ) ? maxGeometryDist2Fwd : std::numeric_limits<double>::max();
   maxGeometryDist2Bwd = ( maxGeometryDist2Bwd < 512 ) ? maxGeometryDist2Bwd : std::numeric_limits<double>::max();
   maxColorDist2Fwd    = ( maxColorDist2Fwd < 512 ) ? maxColorDist2Fwd : std::numeric_limits<double>::max();
@@ -841,94 +850,99 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-    // keep the points that satisfy geometry dist threshold
-    while ( true ) {
-      if ( result.size() == 1 ) { break; }
-      if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-      result.popBack();
-    }
-    bool isDone = false;
-    if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-      if ( result.dist( 0 ) < 0.0001 ) {
-        refinedColors1[index] = source.getColor( result.indices( 0 ) );
-        isDone                = true;
-      }
-    }
-    if ( !isDone ) {
-      int nNN = static_cast<int>( result.size() );
-      while ( nNN > 0 && !isDone ) {
-        if ( nNN == 1 ) {
-          refinedColors1[index] = source.getColor( result.indices( 0 ) );
-          isDone                = true;
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      PCCNNResult              result;
+      std::vector<PCCVector3D> colors;
+      for ( size_t index = r.begin(); index < r.end(); ++index ) {
+        kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
+        // keep the points that satisfy geometry dist threshold
+        while ( true ) {
+          if ( result.size() <= 1 ) { break; }
+          if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+          result.popBack();
         }
-        if ( !isDone ) {
-          std::vector<PCCVector3D> colors;
-          colors.resize( 0 );
-          colors.resize( nNN );
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor( result.indices( i ) )[k] ); }
+        bool isDone = false;
+        if ( skipAvgIfIdenticalSourcePointPresentFwd && result.size() > 0 ) {
+          if ( result.dist( 0 ) < 0.0001 ) {
+            refinedColors1[index] = source.getColor( result.indices( 0 ) );
+            isDone                = true;
           }
-          double maxColorDist2 = std::numeric_limits<double>::min();
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int j = i + 1; j < nNN; ++j ) {
-              const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-              if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( result.size() );
+          while ( nNN > 0 && !isDone ) {
+            if ( nNN == 1 ) {
+              refinedColors1[index] = source.getColor( result.indices( 0 ) );
+              isDone                = true;
             }
-          }
-          if ( maxColorDist2 <= maxColorDist2Fwd ) {
-            PCCVector3D refinedColor( 0.0 );
-            if ( useDistWeightedAverageFwd ) {
-              double sumWeights{0.0};
+            if ( !isDone ) {
+              colors.resize( nNN );
               for ( int i = 0; i < nNN; ++i ) {
-                const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k] * weight; }
-                sumWeights += weight;
+                for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor( result.indices( i ) )[k] ); }
               }
-              refinedColor /= sumWeights;
-              if ( excludeColorOutlier ) {
-                PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                size_t      excludeCount = 0;
-                sumWeights               = 0.0;
-                for ( int i = 0; i < nNN; ++i ) {
-                  double      dist     = 0.0;
-                  PCCColor3B  tmpColor = source.getColor( result.indices( i ) );
-                  PCCVector3D sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                  dist = ( sourceColor - refinedColor ).getNorm2();
-                  if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
-                    excludeCount += 1;
-                    continue;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+                }
+              }
+              if ( maxColorDist2 <= maxColorDist2Fwd ) {
+                PCCVector3D refinedColor( 0.0 );
+                if ( useDistWeightedAverageFwd ) {
+                  double sumWeights{0.0};
+                  for ( int i = 0; i < nNN; ++i ) {
+                    const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                    for ( int k = 0; k < 3; ++k ) {
+                      refinedColor[k] += source.getColor( result.indices( i ) )[k] * weight;
+                    }
+                    sumWeights += weight;
                   }
-                  const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                  for ( int k = 0; k < 3; ++k ) {
-                    excludeOutlierRefinedColor[k] += source.getColor( result.indices( i ) )[k] * weight;
+                  refinedColor /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( int i = 0; i < nNN; ++i ) {
+                      double      dist     = 0.0;
+                      PCCColor3B  tmpColor = source.getColor( result.indices( i ) );
+                      PCCVector3D sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                      dist = ( sourceColor - refinedColor ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                      for ( int k = 0; k < 3; ++k ) {
+                        excludeOutlierRefinedColor[k] += source.getColor( result.indices( i ) )[k] * weight;
+                      }
+                      sumWeights += weight;
+                    }
+
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      refinedColor = excludeOutlierRefinedColor / sumWeights;
+                    }
                   }
-                  sumWeights += weight;
+                } else {
+                  for ( int i = 0; i < nNN; ++i ) {
+                    for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k]; }
+                  }
+                  refinedColor /= nNN;
                 }
-
-                if ( excludeCount != nNN && excludeCount != 0 ) {
-                  refinedColor = excludeOutlierRefinedColor / sumWeights;
+                for ( int k = 0; k < 3; ++k ) {
+                  refinedColors1[index][k] = uint8_t( PCCClip( round( refinedColor[k] ), 0.0, 255.0 ) );
                 }
+                isDone = true;
+              } else {
+                --nNN;
               }
-            } else {
-              for ( int i = 0; i < nNN; ++i ) {
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k]; }
-              }
-              refinedColor /= nNN;
-            }
-            for ( int k = 0; k < 3; ++k ) {
-              refinedColors1[index][k] = uint8_t( PCCClip( round( refinedColor[k] ), 0.0, 255.0 ) );
             }
-            isDone = true;
-          } else {
-            --nNN;
           }
         }
       }
-    }
-  }
+    } );
+  } );
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -940,186 +954,201 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   std::vector<std::vector<DistColor8Bit>> refinedColorsDists2;
   refinedColorsDists2.resize( pointCountTarget );
   // populate refinedColorsDists2
+  std::vector<size_t> counts;
+  std::vector<size_t> indices;
+  std::vector<double> dists;
+  searchNeighbors( kdtreeTarget, source, numNeighborsColorTransferBwd, []( const size_t ) { return true; }, counts,
+                   indices, dists );
   for ( size_t index = 0; index < pointCountSource; ++index ) {
     const PCCColor3B color = source.getColor( index );
-    kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
+    const size_t* nnIndices = indices.data() + index * numNeighborsColorTransferBwd;
+    const double* nnDists   = dists.data() + index * numNeighborsColorTransferBwd;
     // keep the points that satisfy geometry dist threshold
-    for ( int i = 0; i < result.size(); ++i ) {
-      if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-        refinedColorsDists2[result.indices( i )].push_back( DistColor8Bit{result.dist( i ), color} );
+    for ( int i = 0; i < counts[index]; ++i ) {
+      if ( nnDists[i] <= maxGeometryDist2Bwd ) {
+        refinedColorsDists2[nnIndices[i]].push_back( DistColor8Bit{nnDists[i], color} );
       }
     }
   }
   // sort refinedColorsDists2 according to distance
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-               []( DistColor8Bit& dc1, DistColor8Bit& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
-  // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    const PCCColor3B color1       = refinedColors1[index];       // refined color derived in forward direction
-    auto&            colorsDists2 = refinedColorsDists2[index];  // set of candidate points
-                                                                 // derived in backward
-                                                                 // direction
-    if ( colorsDists2.empty() || losslessAttribute ) {
-      target.setColor( index, color1 );
-    } else {
-      bool              isDone = false;
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-        if ( colorsDists2[0].dist < 0.0001 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
-          for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-          isDone = true;
-        }
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      for ( size_t index = r.begin(); index < r.end(); ++index ) {
+        std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
+                   []( DistColor8Bit& dc1, DistColor8Bit& dc2 ) { return dc1.dist < dc2.dist; } );
       }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( colorsDists2.size() );
-        while ( nNN > 0 && !isDone ) {
-          nNN = static_cast<int>( colorsDists2.size() );
-          if ( nNN == 1 ) {
-            auto temp = colorsDists2[0];
-            colorsDists2.clear();
-            colorsDists2.push_back( temp );
-            for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-            isDone = true;
+    } );
+  } );
+  // compute centroid2
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      std::vector<PCCVector3D> colors;
+      for ( size_t index = r.begin(); index < r.end(); ++index ) {
+        const PCCColor3B color1       = refinedColors1[index];       // refined color derived in forward direction
+        auto&            colorsDists2 = refinedColorsDists2[index];  // set of candidate points
+                                                                     // derived in backward
+                                                                     // direction
+        if ( colorsDists2.empty() || losslessAttribute ) {
+          target.setColor( index, color1 );
+        } else {
+          bool              isDone = false;
+          const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+          PCCVector3D       centroid2( 0.0 );
+          if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+            if ( colorsDists2[0].dist < 0.0001 ) {
+              auto temp = colorsDists2[0];
+              colorsDists2.clear();
+              colorsDists2.push_back( temp );
+              for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+              isDone = true;
+            }
           }
           if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
-            }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            int nNN = static_cast<int>( colorsDists2.size() );
+            while ( nNN > 0 && !isDone ) {
+              nNN = static_cast<int>( colorsDists2.size() );
+              if ( nNN == 1 ) {
+                auto temp = colorsDists2[0];
+                colorsDists2.clear();
+                colorsDists2.push_back( temp );
+                for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+                isDone = true;
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Bwd ) {
-              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-              if ( useDistWeightedAverageBwd ) {
-                double sumWeights{0.0};
-                for ( auto& i : colorsDists2 ) {
-                  const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                  sumWeights += weight;
+              if ( !isDone ) {
+                colors.resize( nNN );
+                for ( int i = 0; i < nNN; ++i ) {
+                  for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
                 }
-                centroid2 /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierCentroid2( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
-                  for ( auto& i : colorsDists2 ) {
-                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                    double      dist = ( sourceColor - centroid2 ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
-                      excludeCount += 1;
-                      continue;
-                    }
-                    const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
-                    sumWeights += weight;
+                double maxColorDist2 = std::numeric_limits<double>::min();
+                for ( int i = 0; i < nNN; ++i ) {
+                  for ( int j = i + 1; j < nNN; ++j ) {
+                    const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                    if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                   }
-
-                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
                 }
-              } else {
-                for ( auto& coldist : colorsDists2 ) {
-                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                if ( maxColorDist2 <= maxColorDist2Bwd ) {
+                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+                  if ( useDistWeightedAverageBwd ) {
+                    double sumWeights{0.0};
+                    for ( auto& i : colorsDists2 ) {
+                      const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                      for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
+                      sumWeights += weight;
+                    }
+                    centroid2 /= sumWeights;
+                    if ( excludeColorOutlier ) {
+                      PCCVector3D excludeOutlierCentroid2( 0.0 );
+                      size_t      excludeCount = 0;
+                      sumWeights               = 0.0;
+                      for ( auto& i : colorsDists2 ) {
+                        PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
+                        double      dist = ( sourceColor - centroid2 ).getNorm2();
+                        if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
+                          excludeCount += 1;
+                          continue;
+                        }
+                        const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                        for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                        sumWeights += weight;
+                      }
+
+                      if ( excludeCount != nNN && excludeCount != 0 ) {
+                        centroid2 = excludeOutlierCentroid2 / sumWeights;
+                      }
+                    }
+                  } else {
+                    for ( auto& coldist : colorsDists2 ) {
+                      for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                    }
+                    centroid2 /= colorsDists2.size();
+                  }
+                  isDone = true;
+                } else {
+                  colorsDists2.pop_back();
                 }
-                centroid2 /= colorsDists2.size();
               }
-              isDone = true;
-            } else {
-              colorsDists2.pop_back();
             }
           }
-        }
-      }
-      auto   H  = double( colorsDists2.size() );
-      double D2 = 0.0;
-      for ( const auto& color2dist : colorsDists2 ) {
-        auto color2 = color2dist.color;
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
-        }
-      }
-      const double r      = double( pointCountTarget ) / double( pointCountSource );
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
-
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
-
-        if ( !fixWeight ) {
-          const double alpha = D2 / delta2;
-          const double a     = H * r - 1.0;
-          const double c     = alpha * r - 1.0;
-          if ( fabs( a ) < eps ) {
-            w = -0.5 * c;
-          } else {
-            const double delta = 1.0 - a * c;
-            if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+          auto   H  = double( colorsDists2.size() );
+          double D2 = 0.0;
+          for ( const auto& color2dist : colorsDists2 ) {
+            auto color2 = color2dist.color;
+            for ( size_t k = 0; k < 3; ++k ) {
+              const double d2 = centroid2[k] - color2[k];
+              D2 += d2 * d2;
+            }
           }
-        }
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 255.0 );
-        }
-        const double rSource  = 1.0 / double( pointCountSource );
-        const double rTarget  = 1.0 / double( pointCountTarget );
-        const double maxValue = std::numeric_limits<uint8_t>::max();
-        double       minError = std::numeric_limits<double>::max();
-        PCCVector3D  bestColor( color0 );
-        PCCVector3D  color;
-        for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
-          color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
-          for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
-            color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
-            for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
-              color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
-
-              double e1 = 0.0;
-              for ( size_t k = 0; k < 3; ++k ) {
-                const double d = color[k] - color1[k];
-                e1 += d * d;
-              }
-              e1 *= rTarget;
-
-              double e2 = 0.0;
-              for ( const auto& color2dist : colorsDists2 ) {
-                auto color2 = color2dist.color;
-                for ( size_t k = 0; k < 3; ++k ) {
-                  const double d = color[k] - color2[k];
-                  e2 += d * d;
-                }
+          const double r      = double( pointCountTarget ) / double( pointCountSource );
+          const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+          const double eps    = 0.000001;
+
+          const bool fixWeight = true;        // m42538
+          if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+            double w = 0.0;
+
+            if ( !fixWeight ) {
+              const double alpha = D2 / delta2;
+              const double a     = H * r - 1.0;
+              const double c     = alpha * r - 1.0;
+              if ( fabs( a ) < eps ) {
+                w = -0.5 * c;
+              } else {
+                const double delta = 1.0 - a * c;
+                if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
               }
-              e2 *= rSource;
+            }
+            const double oneMinusW = 1.0 - w;
+            PCCVector3D  color0;
+            for ( size_t k = 0; k < 3; ++k ) {
+              color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 255.0 );
+            }
+            const double rSource  = 1.0 / double( pointCountSource );
+            const double rTarget  = 1.0 / double( pointCountTarget );
+            const double maxValue = std::numeric_limits<uint8_t>::max();
+            double       minError = std::numeric_limits<double>::max();
+            PCCVector3D  bestColor( color0 );
+            PCCVector3D  color;
+            for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
+              color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
+              for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
+                color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
+                for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
+                  color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
+
+                  double e1 = 0.0;
+                  for ( size_t k = 0; k < 3; ++k ) {
+                    const double d = color[k] - color1[k];
+                    e1 += d * d;
+                  }
+                  e1 *= rTarget;
+
+                  double e2 = 0.0;
+                  for ( const auto& color2dist : colorsDists2 ) {
+                    auto color2 = color2dist.color;
+                    for ( size_t k = 0; k < 3; ++k ) {
+                      const double d = color[k] - color2[k];
+                      e2 += d * d;
+                    }
+                  }
+                  e2 *= rSource;
 
-              const double error = std::max( e1, e2 );
-              if ( error < minError ) {
-                minError  = error;
-                bestColor = color;
+                  const double error = std::max( e1, e2 );
+                  if ( error < minError ) {
+                    minError  = error;
+                    bestColor = color;
+                  }
+                }
               }
             }
+            target.setColor( index,
+                             PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
+          } else {  // centroid2 == centroid1
+            target.setColor( index, color1 );
           }
         }
-        target.setColor( index,
-                         PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor( index, color1 );
       }
-    }
-  }
+    } );
+  } );
   return true;
 }
 
@@ -1150,6 +1179,7 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
   target.addColors16bit();
   std::vector<PCCColor16bit> refinedColors1;
   refinedColors1.resize( pointCountTarget );
+  const tbb::blocked_range<size_t> blocks( 0, pointCountTarget, 256 );
   maxGeometryDist2Fwd = ( maxGeometryDist2Fwd < 512 ) ? maxGeometryDist2Fwd : std::numeric_limits<double>::max();
   maxGeometryDist2Bwd = ( maxGeometryDist2Bwd < 512 ) ? maxGeometryDist2Bwd : std::numeric_limits<double>::max();
   maxColorDist2Fwd    = ( maxColorDist2Fwd < 131072 ) ? maxColorDist2Fwd : std::numeric_limits<double>::max();
@@ -1161,106 +1191,121 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    PCCColor16bit colorT16bit = target.getColor16bit( index );
-    for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
-    if ( target.getBoundaryPointType( index ) == 3 ) {
-      kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-      if ( filterType == 1 ) {
-        for ( size_t rI = 0; rI < result.size(); ++rI ) {
-          auto indexInSource = result.indices( rI );
-          auto partIndex2    = partSource.addPoint( source[indexInSource] );
-          partSource.setColor( partIndex2, source.getColor( indexInSource ) );
-          partSource.setColor16bit( partIndex2, source.getColor16bit( indexInSource ) );
-          partSource.setParentPointIndex( partIndex2, indexInSource );
-        }
-      }
-      // keep the points that satisfy geometry dist threshold
-      while ( true ) {
-        if ( result.size() == 1 ) { break; }
-        if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-        result.popBack();
-      }
-      bool isDone = false;
-      if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-        if ( result.dist( 0 ) < 0.0001 ) {
-          refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-          isDone                = true;
-        }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( result.count() );
-        while ( nNN > 0 && !isDone ) {
-          if ( nNN == 1 ) {
-            refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-            isDone                = true;
+  // the neighbors of the boundary points are appended to partSource in the order of the target points
+  std::vector<size_t> partCounts( filterType == 1 ? pointCountTarget : 0, 0 );
+  std::vector<size_t> partIndices( partCounts.size() * numNeighborsColorTransferFwd );
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      PCCNNResult              result;
+      std::vector<PCCVector3D> colors;
+      for ( size_t index = r.begin(); index < r.end(); ++index ) {
+        PCCColor16bit colorT16bit = target.getColor16bit( index );
+        for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
+        if ( target.getBoundaryPointType( index ) == 3 ) {
+          kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
+          if ( filterType == 1 ) {
+            partCounts[index] = result.size();
+            std::copy( result.indices(), result.indices() + result.size(),
+                       partIndices.begin() + index * numNeighborsColorTransferFwd );
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
+          // keep the points that satisfy geometry dist threshold
+          while ( true ) {
+            if ( result.size() <= 1 ) { break; }
+            if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+            result.popBack();
+          }
+          bool isDone = false;
+          if ( skipAvgIfIdenticalSourcePointPresentFwd && result.size() > 0 ) {
+            if ( result.dist( 0 ) < 0.0001 ) {
+              refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+              isDone                = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+          }
+          if ( !isDone ) {
+            int nNN = static_cast<int>( result.count() );
+            while ( nNN > 0 && !isDone ) {
+              if ( nNN == 1 ) {
+                refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+                isDone                = true;
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Fwd ) {
-              PCCVector3D refinedColor( 0.0 );
-              if ( useDistWeightedAverageFwd ) {
-                double sumWeights{0.0};
+              if ( !isDone ) {
+                colors.resize( nNN );
                 for ( int i = 0; i < nNN; ++i ) {
-                  const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
                   for ( int k = 0; k < 3; ++k ) {
-                    refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                    colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] );
                   }
-                  sumWeights += weight;
                 }
-                refinedColor /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
-                  for ( int i = 0; i < nNN; ++i ) {
-                    PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
-                    PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                    double        dist = ( sourceColor - refinedColor ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
+                double maxColorDist2 = std::numeric_limits<double>::min();
+                for ( int i = 0; i < nNN; ++i ) {
+                  for ( int j = i + 1; j < nNN; ++j ) {
+                    const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                    if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+                  }
+                }
+                if ( maxColorDist2 <= maxColorDist2Fwd ) {
+                  PCCVector3D refinedColor( 0.0 );
+                  if ( useDistWeightedAverageFwd ) {
+                    double sumWeights{0.0};
+                    for ( int i = 0; i < nNN; ++i ) {
+                      const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                      for ( int k = 0; k < 3; ++k ) {
+                        refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      }
+                      sumWeights += weight;
                     }
-                    const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                    for ( int k = 0; k < 3; ++k ) {
-                      excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                    refinedColor /= sumWeights;
+                    if ( excludeColorOutlier ) {
+                      PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                      size_t      excludeCount = 0;
+                      sumWeights               = 0.0;
+                      for ( int i = 0; i < nNN; ++i ) {
+                        PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
+                        PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                        double        dist = ( sourceColor - refinedColor ).getNorm2();
+                        if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                          excludeCount += 1;
+                          continue;
+                        }
+                        const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                        for ( int k = 0; k < 3; ++k ) {
+                          excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                        }
+                        sumWeights += weight;
+                      }
+
+                      if ( excludeCount != nNN && excludeCount != 0 ) {
+                        refinedColor = excludeOutlierRefinedColor / sumWeights;
+                      }
                     }
-                    sumWeights += weight;
+                  } else {
+                    for ( int i = 0; i < nNN; ++i ) {
+                      for ( int k = 0; k < 3; ++k ) {
+                        refinedColor[k] += source.getColor16bit( result.indices( i ) )[k];
+                      }
+                    }
+                    refinedColor /= nNN;
                   }
-
-                  if ( excludeCount != nNN && excludeCount != 0 ) {
-                    refinedColor = excludeOutlierRefinedColor / sumWeights;
+                  for ( int k = 0; k < 3; ++k ) {
+                    refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
                   }
+                  isDone = true;
+                } else {
+                  --nNN;
                 }
-              } else {
-                for ( int i = 0; i < nNN; ++i ) {
-                  for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
-                }
-                refinedColor /= nNN;
               }
-              for ( int k = 0; k < 3; ++k ) {
-                refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
-              }
-              isDone = true;
-            } else {
-              --nNN;
             }
           }
         }
       }
+    } );
+  } );
+  for ( size_t index = 0; index < partCounts.size(); ++index ) {
+    for ( size_t rI = 0; rI < partCounts[index]; ++rI ) {
+      auto indexInSource = partIndices[index * numNeighborsColorTransferFwd + rI];
+      auto partIndex2    = partSource.addPoint( source[indexInSource] );
+      partSource.setColor( partIndex2, source.getColor( indexInSource ) );
+      partSource.setColor16bit( partIndex2, source.getColor16bit( indexInSource ) );
+      partSource.setParentPointIndex( partIndex2, indexInSource );
     }
   }
   // ==========================================================================================
@@ -1272,215 +1317,237 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
   // the
   // std of remaining colors in it is smaller than a threshold.
   std::vector<std::vector<DistColor>> refinedColorsDists2;
+  std::vector<size_t> counts;
+  std::vector<size_t> indices;
+  std::vector<double> dists;
   if ( filterType == 1 ) {
     refinedColorsDists2.resize( pointCountTarget );
     // populate refinedColorsDists2
     auto sampleSetPointCount = partSource.getPointCount();
+    searchNeighbors( kdtreeTarget, partSource, numNeighborsColorTransferBwd, []( const size_t ) { return true; },
+                     counts, indices, dists );
     for ( size_t index = 0; index < sampleSetPointCount; ++index ) {
       const PCCColor16bit color = partSource.getColor16bit( index );
-      kdtreeTarget.search( partSource[index], numNeighborsColorTransferBwd, result );
+      const size_t* nnIndices = indices.data() + index * numNeighborsColorTransferBwd;
+      const double* nnDists   = dists.data() + index * numNeighborsColorTransferBwd;
       // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.size(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          if ( std::abs( color[0] - target.getColor16bit()[result.indices( i )][0] ) < 40 &&
-               std::abs( color[1] - target.getColor16bit()[result.indices( i )][1] ) < 40 &&
-               std::abs( color[2] - target.getColor16bit()[result.indices( i )][2] ) < 40 )
-            refinedColorsDists2[result.indices( i )].push_back( DistColor{
-                result.dist( i ), color, target[result.indices( i )], partSource.getParentPointIndex( index ), index} );
+      for ( int i = 0; i < counts[index]; ++i ) {
+        if ( nnDists[i] <= maxGeometryDist2Bwd ) {
+          if ( std::abs( color[0] - target.getColor16bit()[nnIndices[i]][0] ) < 40 &&
+               std::abs( color[1] - target.getColor16bit()[nnIndices[i]][1] ) < 40 &&
+               std::abs( color[2] - target.getColor16bit()[nnIndices[i]][2] ) < 40 )
+            refinedColorsDists2[nnIndices[i]].push_back( DistColor{
+                nnDists[i], color, target[nnIndices[i]], partSource.getParentPointIndex( index ), index} );
         }
       }
     }
 
     // sort refinedColorsDists2 according to distance
-    for ( size_t index = 0; index < pointCountTarget; ++index ) {
-      std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-                 []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-    }
+    PCCTaskScheduler::getInstance().execute( [&] {
+      tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+        for ( size_t index = r.begin(); index < r.end(); ++index ) {
+          std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
+                     []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
+        }
+      } );
+    } );
   } else {
     // populate refinedColorsDists2
     refinedColorsDists2.resize( pointCountTarget );
+    searchNeighbors( kdtreeTarget, source, numNeighborsColorTransferBwd, []( const size_t ) { return true; }, counts,
+                     indices, dists );
     for ( size_t index = 0; index < pointCountSource; ++index ) {
       const PCCColor16bit color = source.getColor16bit( index );
-      kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
+      const size_t* nnIndices = indices.data() + index * numNeighborsColorTransferBwd;
+      const double* nnDists   = dists.data() + index * numNeighborsColorTransferBwd;
       // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.size(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
+      for ( int i = 0; i < counts[index]; ++i ) {
+        if ( nnDists[i] <= maxGeometryDist2Bwd ) {
+          refinedColorsDists2[nnIndices[i]].push_back( DistColor{nnDists[i], color} );
         }
       }
     }
     // sort refinedColorsDists2 according to distance
-    for ( size_t index = 0; index < pointCountTarget; ++index ) {
-      std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-                 []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-    }
+    PCCTaskScheduler::getInstance().execute( [&] {
+      tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+        for ( size_t index = r.begin(); index < r.end(); ++index ) {
+          std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
+                     []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
+        }
+      } );
+    } );
   }
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    if ( filterType == 1 && target.getBoundaryPointType( index ) != 3 ) continue;
-    const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
-    auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
-                                                                    // derived in backward
-                                                                    // direction
-    if ( colorsDists2.empty() || losslessAttribute ) {
-      target.setColor16bit( index, color1 );
-    } else {
-      bool              isDone = false;
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-        if ( colorsDists2[0].dist < 0.0001 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
-          for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-          isDone = true;
-        }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( colorsDists2.size() );
-        while ( nNN > 0 && !isDone ) {
-          nNN = static_cast<int>( colorsDists2.size() );
-          if ( nNN == 1 ) {
-            auto temp = colorsDists2[0];
-            colorsDists2.clear();
-            colorsDists2.push_back( temp );
-            for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-            isDone = true;
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      std::vector<PCCVector3D> colors;
+      for ( size_t index = r.begin(); index < r.end(); ++index ) {
+        if ( filterType == 1 && target.getBoundaryPointType( index ) != 3 ) continue;
+        const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
+        auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
+                                                                        // derived in backward
+                                                                        // direction
+        if ( colorsDists2.empty() || losslessAttribute ) {
+          target.setColor16bit( index, color1 );
+        } else {
+          bool              isDone = false;
+          const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+          PCCVector3D       centroid2( 0.0 );
+          if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+            if ( colorsDists2[0].dist < 0.0001 ) {
+              auto temp = colorsDists2[0];
+              colorsDists2.clear();
+              colorsDists2.push_back( temp );
+              for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+              isDone = true;
+            }
           }
           if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
-            }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            int nNN = static_cast<int>( colorsDists2.size() );
+            while ( nNN > 0 && !isDone ) {
+              nNN = static_cast<int>( colorsDists2.size() );
+              if ( nNN == 1 ) {
+                auto temp = colorsDists2[0];
+                colorsDists2.clear();
+                colorsDists2.push_back( temp );
+                for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+                isDone = true;
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Bwd ) {
-              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-              if ( useDistWeightedAverageBwd ) {
-                double sumWeights{0.0};
-                for ( auto& i : colorsDists2 ) {
-                  const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                  sumWeights += weight;
+              if ( !isDone ) {
+                colors.resize( nNN );
+                for ( int i = 0; i < nNN; ++i ) {
+                  for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
                 }
-                centroid2 /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierCentroid2( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
-                  for ( auto& i : colorsDists2 ) {
-                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                    double      dist = ( sourceColor - centroid2 ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
-                    }
-                    const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
-                    sumWeights += weight;
+                double maxColorDist2 = std::numeric_limits<double>::min();
+                for ( int i = 0; i < nNN; ++i ) {
+                  for ( int j = i + 1; j < nNN; ++j ) {
+                    const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                    if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                   }
-
-                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
                 }
-              } else {
-                for ( auto& coldist : colorsDists2 ) {
-                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                if ( maxColorDist2 <= maxColorDist2Bwd ) {
+                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+                  if ( useDistWeightedAverageBwd ) {
+                    double sumWeights{0.0};
+                    for ( auto& i : colorsDists2 ) {
+                      const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                      for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
+                      sumWeights += weight;
+                    }
+                    centroid2 /= sumWeights;
+                    if ( excludeColorOutlier ) {
+                      PCCVector3D excludeOutlierCentroid2( 0.0 );
+                      size_t      excludeCount = 0;
+                      sumWeights               = 0.0;
+                      for ( auto& i : colorsDists2 ) {
+                        PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
+                        double      dist = ( sourceColor - centroid2 ).getNorm2();
+                        if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                          excludeCount += 1;
+                          continue;
+                        }
+                        const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                        for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                        sumWeights += weight;
+                      }
+
+                      if ( excludeCount != nNN && excludeCount != 0 ) {
+                        centroid2 = excludeOutlierCentroid2 / sumWeights;
+                      }
+                    }
+                  } else {
+                    for ( auto& coldist : colorsDists2 ) {
+                      for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                    }
+                    centroid2 /= colorsDists2.size();
+                  }
+                  isDone = true;
+                } else {
+                  colorsDists2.pop_back();
                 }
-                centroid2 /= colorsDists2.size();
               }
-              isDone = true;
-            } else {
-              colorsDists2.pop_back();
             }
           }
-        }
-      }
-      auto   H  = double( colorsDists2.size() );
-      double D2 = 0.0;
-      for ( const auto& color2dist : colorsDists2 ) {
-        auto color2 = color2dist.color;
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
-        }
-      }
-      const double r      = double( pointCountTarget ) / double( pointCountSource );
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
-
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
-
-        if ( !fixWeight ) {
-          const double alpha = D2 / delta2;
-          const double a     = H * r - 1.0;
-          const double c     = alpha * r - 1.0;
-          if ( fabs( a ) < eps ) {
-            w = -0.5 * c;
-          } else {
-            const double delta = 1.0 - a * c;
-            if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+          auto   H  = double( colorsDists2.size() );
+          double D2 = 0.0;
+          for ( const auto& color2dist : colorsDists2 ) {
+            auto color2 = color2dist.color;
+            for ( size_t k = 0; k < 3; ++k ) {
+              const double d2 = centroid2[k] - color2[k];
+              D2 += d2 * d2;
+            }
           }
-        }
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
-        }
-        const double rSource  = 1.0 / double( pointCountSource );
-        const double rTarget  = 1.0 / double( pointCountTarget );
-        const double maxValue = std::numeric_limits<uint16_t>::max();
-        double       minError = std::numeric_limits<double>::max();
-        PCCVector3D  bestColor( color0 );
-        PCCVector3D  color;
-        for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
-          color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
-          for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
-            color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
-            for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
-              color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
-
-              double e1 = 0.0;
-              for ( size_t k = 0; k < 3; ++k ) {
-                const double d = color[k] - color1[k];
-                e1 += d * d;
-              }
-              e1 *= rTarget;
-
-              double e2 = 0.0;
-              for ( const auto& color2dist : colorsDists2 ) {
-                auto color2 = color2dist.color;
-                for ( size_t k = 0; k < 3; ++k ) {
-                  const double d = color[k] - color2[k];
-                  e2 += d * d;
-                }
+          const double r      = double( pointCountTarget ) / double( pointCountSource );
+          const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+          const double eps    = 0.000001;
+
+          const bool fixWeight = true;        // m42538
+          if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+            double w = 0.0;
+
+            if ( !fixWeight ) {
+              const double alpha = D2 / delta2;
+              const double a     = H * r - 1.0;
+              const double c     = alpha * r - 1.0;
+              if ( fabs( a ) < eps ) {
+                w = -0.5 * c;
+              } else {
+                const double delta = 1.0 - a * c;
+                if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
               }
-              e2 *= rSource;
+            }
+            const double oneMinusW = 1.0 - w;
+            PCCVector3D  color0;
+            for ( size_t k = 0; k < 3; ++k ) {
+              color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
+            }
+            const double rSource  = 1.0 / double( pointCountSource );
+            const double rTarget  = 1.0 / double( pointCountTarget );
+            const double maxValue = std::numeric_limits<uint16_t>::max();
+            double       minError = std::numeric_limits<double>::max();
+            PCCVector3D  bestColor( color0 );
+            PCCVector3D  color;
+            for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
+              color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
+              for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
+                color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
+                for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
+                  color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
+
+                  double e1 = 0.0;
+                  for ( size_t k = 0; k < 3; ++k ) {
+                    const double d = color[k] - color1[k];
+                    e1 += d * d;
+                  }
+                  e1 *= rTarget;
+
+                  double e2 = 0.0;
+                  for ( const auto& color2dist : colorsDists2 ) {
+                    auto color2 = color2dist.color;
+                    for ( size_t k = 0; k < 3; ++k ) {
+                      const double d = color[k] - color2[k];
+                      e2 += d * d;
+                    }
+                  }
+                  e2 *= rSource;
 
-              const double error = std::max( e1, e2 );
-              if ( error < minError ) {
-                minError  = error;
-                bestColor = color;
+                  const double error = std::max( e1, e2 );
+                  if ( error < minError ) {
+                    minError  = error;
+                    bestColor = color;
+                  }
+                }
               }
             }
+            target.setColor16bit(
+                index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
+          } else {  // centroid2 == centroid1
+            target.setColor16bit( index, color1 );
           }
         }
-        target.setColor16bit(
-            index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor16bit( index, color1 );
       }
-    }
-  }
+    } );
+  } );
   return true;
 }
 
@@ -1517,11 +1584,11 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
   // ==========================================================================================
   // backward search first
   // ==========================================================================================
-  PCCNNResult       result;
-  std::vector<bool> newValueDecided;
+  std::vector<uint8_t> newValueDecided;
   newValueDecided.resize( pointCountTarget, false );
   std::vector<PCCColor16bit> refinedColors1;
   refinedColors1.resize( pointCountTarget );
+  const tbb::blocked_range<size_t> blocks( 0, pointCountTarget, 256 );
 
   PCCPointSet3 partTarget;
   partTarget.addColors();
@@ -1542,133 +1609,149 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
   std::vector<std::vector<DistColor>> refinedColorsDists2;
   // populate refinedColorsDists2
   refinedColorsDists2.resize( pointCountTarget );
+  std::vector<size_t> counts;
+  std::vector<size_t> indices;
+  std::vector<double> dists;
+  searchNeighbors(
+      filterType == 9 ? kdtreePartTarget : kdtreeTarget, source, numNeighborsColorTransferBwd,
+      [&]( const size_t index ) { return target.getBoundaryPointType( index ) == 3; }, counts, indices, dists );
   for ( size_t index = 0; index < pointCountSource; ++index ) {
     const PCCColor16bit color = source.getColor16bit( index );
     if ( target.getBoundaryPointType( index ) != 3 ) continue;
+    const size_t* nnIndices = indices.data() + index * numNeighborsColorTransferBwd;
+    const double* nnDists   = dists.data() + index * numNeighborsColorTransferBwd;
     if ( filterType == 9 ) {
-      kdtreePartTarget.search( source[index], numNeighborsColorTransferBwd, result );
-      for ( int i = 0; i < result.count(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd &&
-             ( std::abs( color[0] - partTarget.getColor16bit()[result.indices( i )][0] ) < 40 &&
-               std::abs( color[1] - partTarget.getColor16bit()[result.indices( i )][1] ) < 40 &&
-               std::abs( color[2] - partTarget.getColor16bit()[result.indices( i )][2] ) < 40 ) ) {
-          auto indexInTarget = partTarget.getParentPointIndex( result.indices( i ) );
+      for ( int i = 0; i < counts[index]; ++i ) {
+        if ( nnDists[i] <= maxGeometryDist2Bwd &&
+             ( std::abs( color[0] - partTarget.getColor16bit()[nnIndices[i]][0] ) < 40 &&
+               std::abs( color[1] - partTarget.getColor16bit()[nnIndices[i]][1] ) < 40 &&
+               std::abs( color[2] - partTarget.getColor16bit()[nnIndices[i]][2] ) < 40 ) ) {
+          auto indexInTarget = partTarget.getParentPointIndex( nnIndices[i] );
           if ( target.getBoundaryPointType( indexInTarget ) != 3 ) {
             printf( "something wrong!!\n" );
             assert( 0 );
             exit( 0 );
           }
           refinedColorsDists2[indexInTarget].push_back(
-              DistColor{result.dist( i ), color, partTarget[result.indices( i )], indexInTarget, result.indices( i )} );
+              DistColor{nnDists[i], color, partTarget[nnIndices[i]], indexInTarget, nnIndices[i]} );
         }
       }
     } else {
-      kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
       // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.count(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
+      for ( int i = 0; i < counts[index]; ++i ) {
+        if ( nnDists[i] <= maxGeometryDist2Bwd ) {
+          refinedColorsDists2[nnIndices[i]].push_back( DistColor{nnDists[i], color} );
         }
       }
     }
   }
 
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-               []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      for ( size_t index = r.begin(); index < r.end(); ++index ) {
+        std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
+                   []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
+      }
+    } );
+  } );
 
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    if ( target.getBoundaryPointType( index ) != 3 ) {
-      newValueDecided[index] = true;
-      continue;
-    }
-    if ( refinedColorsDists2[index].empty() ) { continue; }
-    auto&       colorsDists2 = refinedColorsDists2[index];
-    bool        isDone       = false;
-    PCCVector3D centroid2( 0.0 );
-    if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-      if ( colorsDists2[0].dist < 0.0001 ) {
-        auto temp = colorsDists2[0];
-        colorsDists2.clear();
-        colorsDists2.push_back( temp );
-        for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-        isDone = true;
-      }
-    }
-    if ( !isDone ) {
-      int nNN = static_cast<int>( colorsDists2.size() );
-      while ( nNN > 0 && !isDone ) {
-        nNN = static_cast<int>( colorsDists2.size() );
-        if ( nNN == 1 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
-          for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-          isDone = true;
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      std::vector<PCCVector3D> colors;
+      for ( size_t index = r.begin(); index < r.end(); ++index ) {
+        if ( target.getBoundaryPointType( index ) != 3 ) {
+          newValueDecided[index] = true;
+          continue;
         }
-        if ( !isDone ) {
-          std::vector<PCCVector3D> colors;
-          colors.resize( 0 );
-          colors.resize( nNN );
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
+        if ( refinedColorsDists2[index].empty() ) { continue; }
+        auto&       colorsDists2 = refinedColorsDists2[index];
+        bool        isDone       = false;
+        PCCVector3D centroid2( 0.0 );
+        if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+          if ( colorsDists2[0].dist < 0.0001 ) {
+            auto temp = colorsDists2[0];
+            colorsDists2.clear();
+            colorsDists2.push_back( temp );
+            for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+            isDone = true;
           }
-          double maxColorDist2 = std::numeric_limits<double>::min();
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int j = i + 1; j < nNN; ++j ) {
-              const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-              if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( colorsDists2.size() );
+          while ( nNN > 0 && !isDone ) {
+            nNN = static_cast<int>( colorsDists2.size() );
+            if ( nNN == 1 ) {
+              auto temp = colorsDists2[0];
+              colorsDists2.clear();
+              colorsDists2.push_back( temp );
+              for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+              isDone = true;
             }
-          }
-          if ( maxColorDist2 <= maxColorDist2Bwd ) {
-            for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-            if ( useDistWeightedAverageBwd ) {
-              double sumWeights{0.0};
-              for ( auto& i : colorsDists2 ) {
-                const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                sumWeights += weight;
+            if ( !isDone ) {
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
               }
-              centroid2 /= sumWeights;
-              if ( excludeColorOutlier ) {
-                PCCVector3D excludeOutlierCentroid2( 0.0 );
-                size_t      excludeCount = 0;
-                sumWeights               = 0.0;
-                for ( auto& i : colorsDists2 ) {
-                  PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                  double      dist = ( sourceColor - centroid2 ).getNorm2();
-                  if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                    excludeCount += 1;
-                    continue;
-                  }
-                  const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
-                  sumWeights += weight;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                 }
-
-                if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
               }
-            } else {
-              for ( auto& coldist : colorsDists2 ) {
-                for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+              if ( maxColorDist2 <= maxColorDist2Bwd ) {
+                for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+                if ( useDistWeightedAverageBwd ) {
+                  double sumWeights{0.0};
+                  for ( auto& i : colorsDists2 ) {
+                    const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                    for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
+                    sumWeights += weight;
+                  }
+                  centroid2 /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierCentroid2( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( auto& i : colorsDists2 ) {
+                      PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
+                      double      dist = ( sourceColor - centroid2 ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                      for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                      sumWeights += weight;
+                    }
+
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      centroid2 = excludeOutlierCentroid2 / sumWeights;
+                    }
+                  }
+                } else {
+                  for ( auto& coldist : colorsDists2 ) {
+                    for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                  }
+                  centroid2 /= colorsDists2.size();
+                }
+                isDone = true;
+              } else {
+                colorsDists2.pop_back();
               }
-              centroid2 /= colorsDists2.size();
             }
-            isDone = true;
-          } else {
-            colorsDists2.pop_back();
           }
         }
-      }
-    }
 
-    PCCVector3D color0;
-    for ( size_t k = 0; k < 3; ++k ) { color0[k] = PCCClip( round( centroid2[k] ), 0.0, 65535.0 ); }
-    target.setColor16bit( index, PCCColor16bit( uint16_t( color0[0] ), uint16_t( color0[1] ), uint16_t( color0[2] ) ) );
-    newValueDecided[index] = true;
-  }
+        PCCVector3D color0;
+        for ( size_t k = 0; k < 3; ++k ) { color0[k] = PCCClip( round( centroid2[k] ), 0.0, 65535.0 ); }
+        target.setColor16bit(
+            index, PCCColor16bit( uint16_t( color0[0] ), uint16_t( color0[1] ), uint16_t( color0[2] ) ) );
+        newValueDecided[index] = true;
+      }
+    } );
+  } );
 
   // ==========================================================================================
   //                                     Forward direction
@@ -1676,102 +1759,110 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
 
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    PCCColor16bit colorT16bit = target.getColor16bit( index );
-    for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
-    if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[index] == false ) {
-      kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-      // keep the points that satisfy geometry dist threshold
-      while ( true ) {
-        if ( result.count() == 1 ) { break; }
-        if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-        result.popBack();
-      }
-      bool isDone = false;
-      if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-        if ( result.dist( 0 ) < 0.0001 ) {
-          refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-          isDone                = true;
-        }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( result.count() );
-        while ( nNN > 0 && !isDone ) {
-          if ( nNN == 1 ) {
-            refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-            isDone                = true;
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      PCCNNResult              result;
+      std::vector<PCCVector3D> colors;
+      for ( size_t index = r.begin(); index < r.end(); ++index ) {
+        PCCColor16bit colorT16bit = target.getColor16bit( index );
+        for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
+        if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[index] == false ) {
+          kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
+          // keep the points that satisfy geometry dist threshold
+          while ( true ) {
+            if ( result.size() <= 1 ) { break; }
+            if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+            result.popBack();
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
+          bool isDone = false;
+          if ( skipAvgIfIdenticalSourcePointPresentFwd && result.size() > 0 ) {
+            if ( result.dist( 0 ) < 0.0001 ) {
+              refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+              isDone                = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+          }
+          if ( !isDone ) {
+            int nNN = static_cast<int>( result.count() );
+            while ( nNN > 0 && !isDone ) {
+              if ( nNN == 1 ) {
+                refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+                isDone                = true;
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Fwd ) {
-              PCCVector3D refinedColor( 0.0 );
-              if ( useDistWeightedAverageFwd ) {
-                double sumWeights{0.0};
+              if ( !isDone ) {
+                colors.resize( nNN );
                 for ( int i = 0; i < nNN; ++i ) {
-                  const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
                   for ( int k = 0; k < 3; ++k ) {
-                    refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                    colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] );
                   }
-                  sumWeights += weight;
                 }
-                refinedColor /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
-                  for ( int i = 0; i < nNN; ++i ) {
-                    PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
-                    PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                    double        dist = ( sourceColor - refinedColor ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
+                double maxColorDist2 = std::numeric_limits<double>::min();
+                for ( int i = 0; i < nNN; ++i ) {
+                  for ( int j = i + 1; j < nNN; ++j ) {
+                    const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                    if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+                  }
+                }
+                if ( maxColorDist2 <= maxColorDist2Fwd ) {
+                  PCCVector3D refinedColor( 0.0 );
+                  if ( useDistWeightedAverageFwd ) {
+                    double sumWeights{0.0};
+                    for ( int i = 0; i < nNN; ++i ) {
+                      const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                      for ( int k = 0; k < 3; ++k ) {
+                        refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      }
+                      sumWeights += weight;
                     }
-                    const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                    for ( int k = 0; k < 3; ++k ) {
-                      excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                    refinedColor /= sumWeights;
+                    if ( excludeColorOutlier ) {
+                      PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                      size_t      excludeCount = 0;
+                      sumWeights               = 0.0;
+                      for ( int i = 0; i < nNN; ++i ) {
+                        PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
+                        PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                        double        dist = ( sourceColor - refinedColor ).getNorm2();
+                        if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                          excludeCount += 1;
+                          continue;
+                        }
+                        const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                        for ( int k = 0; k < 3; ++k ) {
+                          excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                        }
+                        sumWeights += weight;
+                      }
+
+                      if ( excludeCount != nNN && excludeCount != 0 ) {
+                        refinedColor = excludeOutlierRefinedColor / sumWeights;
+                      }
                     }
-                    sumWeights += weight;
+                  } else {
+                    for ( int i = 0; i < nNN; ++i ) {
+                      for ( int k = 0; k < 3; ++k ) {
+                        refinedColor[k] += source.getColor16bit( result.indices( i ) )[k];
+                      }
+                    }
+                    refinedColor /= nNN;
                   }
-
-                  if ( excludeCount != nNN && excludeCount != 0 ) {
-                    refinedColor = excludeOutlierRefinedColor / sumWeights;
+                  for ( int k = 0; k < 3; ++k ) {
+                    refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
                   }
+                  isDone = true;
+                } else {
+                  --nNN;
                 }
-              } else {
-                for ( int i = 0; i < nNN; ++i ) {
-                  for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
-                }
-                refinedColor /= nNN;
               }
-              for ( int k = 0; k < 3; ++k ) {
-                refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
-              }
-              isDone = true;
-            } else {
-              --nNN;
-            }
-          }
-        }  // while
-      }    //! isDone
+            }  // while
+          }    //! isDone
 
-      target.setColor16bit( index,
-                            PCCColor16bit( uint16_t( refinedColors1[index][0] ), uint16_t( refinedColors1[index][1] ),
-                                           uint16_t( refinedColors1[index][2] ) ) );
-    }  // if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[ index ] == false )
-  }    // index
+          target.setColor16bit( index, PCCColor16bit( uint16_t( refinedColors1[index][0] ),
+                                                      uint16_t( refinedColors1[index][1] ),
+                                                      uint16_t( refinedColors1[index][2] ) ) );
+        }  // if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[ index ] == false )
+      }    // index
+    } );
+  } );
 
   return true;
 }
@@ -1802,6 +1893,7 @@ bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
   target.addColors16bit();
   std::vector<PCCColor16bit> refinedColors1;
   refinedColors1.resize( pointCountTarget );
+  const tbb::blocked_range<size_t> blocks( 0, pointCountTarget, 256 );
   maxGeometryDist2Fwd = ( maxGeometryDist2Fwd < 512 ) ? maxGeometryDist2Fwd : std::numeric_limits<double>::max();
   maxGeometryDist2Bwd = ( maxGeometryDist2Bwd < 512 ) ? maxGeometryDist2Bwd : std::numeric_limits<double>::max();
   maxColorDist2Fwd    = ( maxColorDist2Fwd < 131072 ) ? maxColorDist2Fwd : std::numeric_limits<double>::max();
@@ -1812,95 +1904,100 @@ bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-    // keep the points that satisfy geometry dist threshold
-    while ( true ) {
-      if ( result.size() == 1 ) { break; }
-      if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-      result.popBack();
-    }
-    bool isDone = false;
-    if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-      if ( result.dist( 0 ) < 0.0001 ) {
-        refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-        isDone                = true;
-      }
-    }
-    if ( !isDone ) {
-      int nNN = static_cast<int>( result.size() );
-      while ( nNN > 0 && !isDone ) {
-        if ( nNN == 1 ) {
-          refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-          isDone                = true;
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      PCCNNResult              result;
+      std::vector<PCCVector3D> colors;
+      for ( size_t index = r.begin(); index < r.end(); ++index ) {
+        kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
+        // keep the points that satisfy geometry dist threshold
+        while ( true ) {
+          if ( result.size() <= 1 ) { break; }
+          if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+          result.popBack();
         }
-        if ( !isDone ) {
-          std::vector<PCCVector3D> colors;
-          colors.resize( 0 );
-          colors.resize( nNN );
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
+        bool isDone = false;
+        if ( skipAvgIfIdenticalSourcePointPresentFwd && result.size() > 0 ) {
+          if ( result.dist( 0 ) < 0.0001 ) {
+            refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+            isDone                = true;
           }
-          double maxColorDist2 = std::numeric_limits<double>::min();
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int j = i + 1; j < nNN; ++j ) {
-              const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-              if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( result.size() );
+          while ( nNN > 0 && !isDone ) {
+            if ( nNN == 1 ) {
+              refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+              isDone                = true;
             }
-          }
-          if ( maxColorDist2 <= maxColorDist2Fwd ) {
-            PCCVector3D refinedColor( 0.0 );
-            if ( useDistWeightedAverageFwd ) {
-              double sumWeights{0.0};
+            if ( !isDone ) {
+              colors.resize( nNN );
               for ( int i = 0; i < nNN; ++i ) {
-                const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
                 for ( int k = 0; k < 3; ++k ) {
-                  refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                  colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] );
                 }
-                sumWeights += weight;
               }
-              refinedColor /= sumWeights;
-              if ( excludeColorOutlier ) {
-                PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                size_t      excludeCount = 0;
-                sumWeights               = 0.0;
-                for ( int i = 0; i < nNN; ++i ) {
-                  PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
-                  PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                  double        dist = ( sourceColor - refinedColor ).getNorm2();
-                  if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                    excludeCount += 1;
-                    continue;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+                }
+              }
+              if ( maxColorDist2 <= maxColorDist2Fwd ) {
+                PCCVector3D refinedColor( 0.0 );
+                if ( useDistWeightedAverageFwd ) {
+                  double sumWeights{0.0};
+                  for ( int i = 0; i < nNN; ++i ) {
+                    const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                    for ( int k = 0; k < 3; ++k ) {
+                      refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                    }
+                    sumWeights += weight;
                   }
-                  const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                  for ( int k = 0; k < 3; ++k ) {
-                    excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                  refinedColor /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( int i = 0; i < nNN; ++i ) {
+                      PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
+                      PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                      double        dist = ( sourceColor - refinedColor ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                      for ( int k = 0; k < 3; ++k ) {
+                        excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      }
+                      sumWeights += weight;
+                    }
+
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      refinedColor = excludeOutlierRefinedColor / sumWeights;
+                    }
                   }
-                  sumWeights += weight;
+                } else {
+                  for ( int i = 0; i < nNN; ++i ) {
+                    for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
+                  }
+                  refinedColor /= nNN;
                 }
-
-                if ( excludeCount != nNN && excludeCount != 0 ) {
-                  refinedColor = excludeOutlierRefinedColor / sumWeights;
+                for ( int k = 0; k < 3; ++k ) {
+                  refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
                 }
+                isDone = true;
+              } else {
+                --nNN;
               }
-            } else {
-              for ( int i = 0; i < nNN; ++i ) {
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
-              }
-              refinedColor /= nNN;
             }
-            for ( int k = 0; k < 3; ++k ) {
-              refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
-            }
-            isDone = true;
-          } else {
-            --nNN;
           }
         }
       }
-    }
-  }
+    } );
+  } );
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -1912,186 +2009,201 @@ bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
   std::vector<std::vector<DistColor>> refinedColorsDists2;
   refinedColorsDists2.resize( pointCountTarget );
   // populate refinedColorsDists2
+  std::vector<size_t> counts;
+  std::vector<size_t> indices;
+  std::vector<double> dists;
+  searchNeighbors( kdtreeTarget, source, numNeighborsColorTransferBwd, []( const size_t ) { return true; }, counts,
+                   indices, dists );
   for ( size_t index = 0; index < pointCountSource; ++index ) {
     const PCCColor16bit color = source.getColor16bit( index );
-    kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
+    const size_t* nnIndices = indices.data() + index * numNeighborsColorTransferBwd;
+    const double* nnDists   = dists.data() + index * numNeighborsColorTransferBwd;
     // keep the points that satisfy geometry dist threshold
-    for ( int i = 0; i < result.size(); ++i ) {
-      if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-        refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
+    for ( int i = 0; i < counts[index]; ++i ) {
+      if ( nnDists[i] <= maxGeometryDist2Bwd ) {
+        refinedColorsDists2[nnIndices[i]].push_back( DistColor{nnDists[i], color} );
       }
     }
   }
   // sort refinedColorsDists2 according to distance
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-               []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
-  // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
-    auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
-                                                                    // derived in backward
-                                                                    // direction
-    if ( colorsDists2.empty() || losslessAttribute ) {
-      target.setColor16bit( index, color1 );
-    } else {
-      bool              isDone = false;
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-        if ( colorsDists2[0].dist < 0.0001 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
-          for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-          isDone = true;
-        }
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      for ( size_t index = r.begin(); index < r.end(); ++index ) {
+        std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
+                   []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
       }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( colorsDists2.size() );
-        while ( nNN > 0 && !isDone ) {
-          nNN = static_cast<int>( colorsDists2.size() );
-          if ( nNN == 1 ) {
-            auto temp = colorsDists2[0];
-            colorsDists2.clear();
-            colorsDists2.push_back( temp );
-            for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-            isDone = true;
+    } );
+  } );
+  // compute centroid2
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& r ) {
+      std::vector<PCCVector3D> colors;
+      for ( size_t index = r.begin(); index < r.end(); ++index ) {
+        const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
+        auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
+                                                                        // derived in backward
+                                                                        // direction
+        if ( colorsDists2.empty() || losslessAttribute ) {
+          target.setColor16bit( index, color1 );
+        } else {
+          bool              isDone = false;
+          const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+          PCCVector3D       centroid2( 0.0 );
+          if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+            if ( colorsDists2[0].dist < 0.0001 ) {
+              auto temp = colorsDists2[0];
+              colorsDists2.clear();
+              colorsDists2.push_back( temp );
+              for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+              isDone = true;
+            }
           }
           if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
-            }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            int nNN = static_cast<int>( colorsDists2.size() );
+            while ( nNN > 0 && !isDone ) {
+              nNN = static_cast<int>( colorsDists2.size() );
+              if ( nNN == 1 ) {
+                auto temp = colorsDists2[0];
+                colorsDists2.clear();
+                colorsDists2.push_back( temp );
+                for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+                isDone = true;
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Bwd ) {
-              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-              if ( useDistWeightedAverageBwd ) {
-                double sumWeights{0.0};
-                for ( auto& i : colorsDists2 ) {
-                  const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                  sumWeights += weight;
+              if ( !isDone ) {
+                colors.resize( nNN );
+                for ( int i = 0; i < nNN; ++i ) {
+                  for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
                 }
-                centroid2 /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierCentroid2( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
-                  for ( auto& i : colorsDists2 ) {
-                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                    double      dist = ( sourceColor - centroid2 ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
-                    }
-                    const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
-                    sumWeights += weight;
+                double maxColorDist2 = std::numeric_limits<double>::min();
+                for ( int i = 0; i < nNN; ++i ) {
+                  for ( int j = i + 1; j < nNN; ++j ) {
+                    const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                    if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                   }
-
-                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
                 }
-              } else {
-                for ( auto& coldist : colorsDists2 ) {
-                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                if ( maxColorDist2 <= maxColorDist2Bwd ) {
+                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+                  if ( useDistWeightedAverageBwd ) {
+                    double sumWeights{0.0};
+                    for ( auto& i : colorsDists2 ) {
+                      const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                      for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
+                      sumWeights += weight;
+                    }
+                    centroid2 /= sumWeights;
+                    if ( excludeColorOutlier ) {
+                      PCCVector3D excludeOutlierCentroid2( 0.0 );
+                      size_t      excludeCount = 0;
+                      sumWeights               = 0.0;
+                      for ( auto& i : colorsDists2 ) {
+                        PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
+                        double      dist = ( sourceColor - centroid2 ).getNorm2();
+                        if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                          excludeCount += 1;
+                          continue;
+                        }
+                        const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                        for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                        sumWeights += weight;
+                      }
+
+                      if ( excludeCount != nNN && excludeCount != 0 ) {
+                        centroid2 = excludeOutlierCentroid2 / sumWeights;
+                      }
+                    }
+                  } else {
+                    for ( auto& coldist : colorsDists2 ) {
+                      for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                    }
+                    centroid2 /= colorsDists2.size();
+                  }
+                  isDone = true;
+                } else {
+                  colorsDists2.pop_back();
                 }
-                centroid2 /= colorsDists2.size();
               }
-              isDone = true;
-            } else {
-              colorsDists2.pop_back();
             }
           }
-        }
-      }
-      auto   H  = double( colorsDists2.size() );
-      double D2 = 0.0;
-      for ( const auto& color2dist : colorsDists2 ) {
-        auto color2 = color2dist.color;
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
-        }
-      }
-      const double r      = double( pointCountTarget ) / double( pointCountSource );
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
-
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
-
-        if ( !fixWeight ) {
-          const double alpha = D2 / delta2;
-          const double a     = H * r - 1.0;
-          const double c     = alpha * r - 1.0;
-          if ( fabs( a ) < eps ) {
-            w = -0.5 * c;
-          } else {
-            const double delta = 1.0 - a * c;
-            if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+          auto   H  = double( colorsDists2.size() );
+          double D2 = 0.0;
+          for ( const auto& color2dist : colorsDists2 ) {
+            auto color2 = color2dist.color;
+            for ( size_t k = 0; k < 3; ++k ) {
+              const double d2 = centroid2[k] - color2[k];
+              D2 += d2 * d2;
+            }
           }
-        }
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
-        }
-        const double rSource  = 1.0 / double( pointCountSource );
-        const double rTarget  = 1.0 / double( pointCountTarget );
-        const double maxValue = std::numeric_limits<uint16_t>::max();
-        double       minError = std::numeric_limits<double>::max();
-        PCCVector3D  bestColor( color0 );
-        PCCVector3D  color;
-        for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
-          color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
-          for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
-            color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
-            for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
-              color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
-
-              double e1 = 0.0;
-              for ( size_t k = 0; k < 3; ++k ) {
-                const double d = color[k] - color1[k];
-                e1 += d * d;
-              }
-              e1 *= rTarget;
-
-              double e2 = 0.0;
-              for ( const auto& color2dist : colorsDists2 ) {
-                auto color2 = color2dist.color;
-                for ( size_t k = 0; k < 3; ++k ) {
-                  const double d = color[k] - color2[k];
-                  e2 += d * d;
-                }
+          const double r      = double( pointCountTarget ) / double( pointCountSource );
+          const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+          const double eps    = 0.000001;
+
+          const bool fixWeight = true;        // m42538
+          if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+            double w = 0.0;
+
+            if ( !fixWeight ) {
+              const double alpha = D2 / delta2;
+              const double a     = H * r - 1.0;
+              const double c     = alpha * r - 1.0;
+              if ( fabs( a ) < eps ) {
+                w = -0.5 * c;
+              } else {
+                const double delta = 1.0 - a * c;
+                if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
               }
-              e2 *= rSource;
+            }
+            const double oneMinusW = 1.0 - w;
+            PCCVector3D  color0;
+            for ( size_t k = 0; k < 3; ++k ) {
+              color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
+            }
+            const double rSource  = 1.0 / double( pointCountSource );
+            const double rTarget  = 1.0 / double( pointCountTarget );
+            const double maxValue = std::numeric_limits<uint16_t>::max();
+            double       minError = std::numeric_limits<double>::max();
+            PCCVector3D  bestColor( color0 );
+            PCCVector3D  color;
+            for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
+              color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
+              for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
+                color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
+                for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
+                  color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
+
+                  double e1 = 0.0;
+                  for ( size_t k = 0; k < 3; ++k ) {
+                    const double d = color[k] - color1[k];
+                    e1 += d * d;
+                  }
+                  e1 *= rTarget;
+
+                  double e2 = 0.0;
+                  for ( const auto& color2dist : colorsDists2 ) {
+                    auto color2 = color2dist.color;
+                    for ( size_t k = 0; k < 3; ++k ) {
+                      const double d = color[k] - color2[k];
+                      e2 += d * d;
+                    }
+                  }
+                  e2 *= rSource;
 
-              const double error = std::max( e1, e2 );
-              if ( error < minError ) {
-                minError  = error;
-                bestColor = color;
+                  const double error = std::max( e1, e2 );
+                  if ( error < minError ) {
+                    minError  = error;
+                    bestColor = color;
+                  }
+                }
               }
             }
+            target.setColor16bit(
+                index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
+          } else {  // centroid2 == centroid1
+            target.setColor16bit( index, color1 );
           }
         }
-        target.setColor16bit(
-            index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor16bit( index, color1 );
       }
-    }
-  }
+    } );
+  } );
   return true;
 }
 bool PCCPointSet3::transferColorsFilter3( PCCPointSet3& target,
@@ -2338,7 +2450,8 @@ void PCCPointSet3::scaleNormals( const PCCPointSet3& sourceWithNormal ) {
     do {
       num_results += num_results_incr;
       kdtreeDst.search( sourceWithNormal.positions_[i], num_results, result );
-    } while ( result.dist( 0 ) == result.dist( num_results - 1 ) && num_results + num_results_incr <= num_results_max );
+    } while ( result.size() == num_results && result.dist( 0 ) == result.dist( num_results - 1 ) &&
+              num_results + num_results_incr <= num_results_max );
     for ( size_t j = 0; j < result.size(); ++j ) {
       if ( result.dist( 0 ) == result.dist( j ) ) {
         size_t index = result.indices( j );
@@ -2360,10 +2473,10 @@ void PCCPointSet3::scaleNormals( const PCCPointSet3& sourceWithNormal ) {
       do {
         num_results += num_results_incr;
         kdtreeSrc.search( positions_[i], num_results, result );
-      } while ( result.dist( 0 ) == result.dist( num_results - 1 ) &&
+      } while ( result.size() == num_results && result.dist( 0 ) == result.dist( num_results - 1 ) &&
                 num_results + num_results_incr <= num_results_max );
       size_t num = 0;
-      for ( size_t j = 0; j < num_results; ++j ) {
+      for ( size_t j = 0; j < result.size(); ++j ) {
         if ( result.dist( 0 ) == result.dist( j ) ) {
           size_t index = result.indices( j );
           normals_[i][0] += sourceWithNormal.normals_[index][0];
@@ -0,0 +1,178 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+#include <tbb/task_group.h>
+#include <tbb/task_scheduler_observer.h>
+#if defined( __linux__ )
+#include <sched.h>
+#endif
+#include "PCCTaskScheduler.h"
+
+using namespace pcc;
+
+namespace pcc {
+
+class PCCAffinityObserver : public tbb::task_scheduler_observer {
+ public:
+  PCCAffinityObserver( const std::vector<int>& cpus ) : cpus_( cpus ) { observe( true ); }
+  ~PCCAffinityObserver() { observe( false ); }
+  // only the worker threads are pinned: the threads of the application keep their affinity
+  void on_scheduler_entry( bool isWorker ) override {
+    if ( isWorker && !pin() && !failed_.exchange( true ) ) {
+      std::cerr << "PCCTaskScheduler: can't set cpu affinity of the worker threads" << std::endl;
+    }
+  }
+  bool pin() const {
+#if defined( __linux__ )
+    cpu_set_t cpuSet;
+    CPU_ZERO( &cpuSet );
+    for ( auto& cpu : cpus_ ) {
+      if ( cpu < CPU_SETSIZE ) { CPU_SET( cpu, &cpuSet ); }
+    }
+    return sched_setaffinity( 0, sizeof( cpu_set_t ), &cpuSet ) == 0;
+#else
+    return false;
+#endif
+  }
+
+ private:
+  std::vector<int>  cpus_;
+  std::atomic<bool> failed_{false};
+};
+
+}  // namespace pcc
+
+PCCTaskScheduler::PCCTaskScheduler() : threadCount_( 0 ), configured_( false ), executionCount_( 0 ) {}
+
+PCCTaskScheduler::~PCCTaskScheduler() { clear(); }
+
+PCCTaskScheduler& PCCTaskScheduler::getInstance() {
+  static PCCTaskScheduler instance;
+  return instance;
+}
+
+void PCCTaskScheduler::clear() {
+  arena_.reset();
+  observer_.reset();
+  globalControl_.reset();
+}
+
+bool PCCTaskScheduler::configure( const size_t nbThread, const std::string& cpuAffinity ) {
+  std::lock_guard<std::mutex> lock( mutex_ );
+  if ( configured_ && nbThread == threadCount_ && cpuAffinity == cpuAffinity_ ) { return true; }
+  if ( configured_ ) {
+    // the executions started from now wait on the mutex; the running ones keep the arena alive
+    configured_ = false;
+    if ( executionCount_ > 0 ) {
+      configured_ = true;
+      std::cerr << "PCCTaskScheduler: can't change the configuration while tasks are running: keeping "
+                << threadCount_ << " threads" << std::endl;
+      return false;
+    }
+  }
+  configureLocked( nbThread, cpuAffinity );
+  return true;
+}
+
+void PCCTaskScheduler::configureLocked( const size_t nbThread, const std::string& cpuAffinity ) {
+  clear();
+  std::vector<int> cpus;
+  if ( !cpuAffinity.empty() && !parseCpuList( cpuAffinity, cpus ) ) {
+    std::cerr << "PCCTaskScheduler: can't parse cpu affinity \"" << cpuAffinity << "\": pinning disabled" << std::endl;
+  }
+  size_t concurrency = nbThread;
+  if ( concurrency == 0 && !cpus.empty() ) { concurrency = cpus.size(); }
+  if ( concurrency > 0 ) {
+    globalControl_.reset( new tbb::global_control( tbb::global_control::max_allowed_parallelism, concurrency ) );
+  }
+  if ( !cpus.empty() ) { observer_.reset( new PCCAffinityObserver( cpus ) ); }
+  arena_.reset(
+      new tbb::task_arena( concurrency > 0 ? static_cast<int>( concurrency ) : tbb::task_arena::automatic ) );
+  arena_->initialize();
+  threadCount_ = nbThread;
+  cpuAffinity_ = cpuAffinity;
+  configured_  = true;
+}
+
+// The execution is counted before configured_ is read and configure() clears configured_ before
+// reading the count: either the execution sees the arena valid or configure() sees the execution.
+void PCCTaskScheduler::acquire() {
+  executionCount_++;
+  if ( configured_ ) { return; }
+  executionCount_--;
+  std::lock_guard<std::mutex> lock( mutex_ );
+  if ( !configured_ ) { configureLocked( 0, "" ); }
+  executionCount_++;
+}
+
+void PCCTaskScheduler::executeTasks( const std::vector<std::function<void()>>& tasks, const bool concurrent ) {
+#ifdef CONFORMANCE_TRACE
+  for ( auto& task : tasks ) { task(); }
+#else
+  if ( tasks.size() == 1 || !concurrent ) {
+    for ( auto& task : tasks ) { task(); }
+    return;
+  }
+  execute( [&] {
+    tbb::task_group group;
+    for ( auto& task : tasks ) { group.run( task ); }
+    group.wait();
+  } );
+#endif
+}
+
+bool PCCTaskScheduler::parseCpuList( const std::string& cpuList, std::vector<int>& cpus ) {
+  cpus.clear();
+  std::stringstream stream( cpuList );
+  std::string       range;
+  while ( std::getline( stream, range, ',' ) ) {
+    if ( range.empty() ) { continue; }
+    size_t separator = range.find( '-' );
+    int    first = 0, last = 0;
+    try {
+      first = std::stoi( range.substr( 0, separator ) );
+      last  = separator == std::string::npos ? first : std::stoi( range.substr( separator + 1 ) );
+    } catch ( ... ) {
+      cpus.clear();
+      return false;
+    }
+    if ( first < 0 || last < first ) {
+      cpus.clear();
+      return false;
+    }
+    for ( int cpu = first; cpu <= last; cpu++ ) { cpus.push_back( cpu ); }
+  }
+  std::sort( cpus.begin(), cpus.end() );
+  cpus.erase( std::unique( cpus.begin(), cpus.end() ), cpus.end() );
+  return !cpus.empty();
+}
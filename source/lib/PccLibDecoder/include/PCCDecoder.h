@@ -49,6 +49,7 @@ class PatchFrameGeometryParameterSet;
 class GeometryPatchParameterSet;
 class V3CParameterSet;
 class PLRData;
+class PCCVideoDecoder;
 
 template <typename T, size_t N>
 class PCCImage;
@@ -82,6 +83,15 @@ class PCCDecoder : public PCCCodec {
   void       createHlsAtlasTileLogFiles( PCCContext& context, int frameIndex );
   void       setConsitantFourCCCode( PCCContext& context, size_t atglIndex );
   PCCCodecId getCodedCodecId( PCCContext& context, const uint8_t codecCodecId, const std::string& videoDecoderPath );
+  void       decompressAttributeVideos( PCCContext&        context,
+                                        PCCVideoDecoder&   videoDecoder,
+                                        const std::string& path,
+                                        const int32_t      atlasIndex );
+  void       reconstructFrame( PCCContext&                           context,
+                               PCCPointSet3&                         reconstruct,
+                               const size_t                          frameIdx,
+                               const int32_t                         atlasIndex,
+                               const std::vector<std::vector<bool>>& absoluteT1List );
 
   PCCDecoderParameters     params_;
   std::vector<std::string> consitantFourCCCode_;
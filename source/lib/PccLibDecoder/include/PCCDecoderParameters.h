@@ -49,6 +49,7 @@ class PCCDecoderParameters {
   size_t            startFrameNumber_;
   std::string       compressedStreamPath_;
   std::string       reconstructedDataPath_;
+  bool              reconstructedDataInt16_;
   std::string       videoDecoderOccupancyPath_;
   std::string       videoDecoderGeometryPath_;
   std::string       videoDecoderAttributePath_;
@@ -59,6 +60,7 @@ class PCCDecoderParameters {
   std::string       colorSpaceConversionPath_;
   std::string       inverseColorSpaceConversionConfig_;
   size_t            nbThread_;
+  std::string       cpuAffinity_;
   bool              keepIntermediateFiles_;
   bool              patchColorSubsampling_;
   size_t            bestColorSearchRange_;
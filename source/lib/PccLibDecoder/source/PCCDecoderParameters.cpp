@@ -38,6 +38,7 @@ using namespace pcc;
 PCCDecoderParameters::PCCDecoderParameters() {
   compressedStreamPath_              = {};
   reconstructedDataPath_             = {};
+  reconstructedDataInt16_            = false;
   startFrameNumber_                  = 0;
   colorTransform_                    = COLOR_TRANSFORM_NONE;
   colorSpaceConversionPath_          = {};
@@ -49,6 +50,7 @@ PCCDecoderParameters::PCCDecoderParameters() {
   byteStreamVideoCoderGeometry_      = true;
   byteStreamVideoCoderAttribute_     = true;
   nbThread_                          = 1;
+  cpuAffinity_                       = {};
   keepIntermediateFiles_             = false;
   pixelDeinterleavingType_           = -1;
   pointLocalReconstructionType_      = -1;
@@ -69,9 +71,11 @@ void PCCDecoderParameters::print() {
   std::cout << "+ Parameters" << std::endl;
   std::cout << "\t compressedStreamPath                " << compressedStreamPath_ << std::endl;
   std::cout << "\t reconstructedDataPath               " << reconstructedDataPath_ << std::endl;
+  std::cout << "\t reconstructedDataInt16              " << reconstructedDataInt16_ << std::endl;
   std::cout << "\t startFrameNumber                    " << startFrameNumber_ << std::endl;
   std::cout << "\t colorTransform                      " << colorTransform_ << std::endl;
   std::cout << "\t nbThread                            " << nbThread_ << std::endl;
+  std::cout << "\t cpuAffinity                         " << cpuAffinity_ << std::endl;
   std::cout << "\t keepIntermediateFiles               " << keepIntermediateFiles_ << std::endl;
   std::cout << "\t video encoding" << std::endl;
   std::cout << "\t   colorSpaceConversionPath          " << colorSpaceConversionPath_ << std::endl;
@@ -100,7 +104,7 @@ bool PCCDecoderParameters::check() {
     inverseColorSpaceConversionConfig_ = "";
   }
 
-  if ( compressedStreamPath_.empty() || !exist( compressedStreamPath_ ) ) {
+  if ( compressedStreamPath_.empty() || ( compressedStreamPath_ != "-" && !exist( compressedStreamPath_ ) ) ) {
     ret = false;
     std::cerr << "compressedStreamPath not set or exist\n";
   }
@@ -51,8 +51,12 @@
 
 #include "PCCSHMAppVideoDecoder.h"
 
+#include <mutex>
+
 using namespace pcc;
 
+static std::mutex g_videoDecoderMutex;
+
 PCCVideoDecoder::PCCVideoDecoder()  = default;
 PCCVideoDecoder::~PCCVideoDecoder() = default;
 
@@ -75,6 +79,16 @@ bool PCCVideoDecoder::decompress( PCCVideo<T, 3>&    video,
   const std::string fileName    = path + type;
   const std::string binFileName = fileName + ".bin";
 
+  // The in-process codecs and color converters share global state: only one of them runs at a time, so with the
+  // HM, VTM and JM libraries or FFMPEG the sub-streams are coded one after the other. The external codec
+  // applications run concurrently.
+  bool serialize = PCCIsLibraryVideoCodec( codecId );
+#ifdef USE_HDRTOOLS
+  serialize |= !colorSpaceConversionPath.empty();
+#endif
+  std::unique_lock<std::mutex> lock( g_videoDecoderMutex, std::defer_lock );
+  if ( serialize ) { lock.lock(); }
+
   printf( "byteStreamVideoCoder = %d codecId = %d \n", byteStreamVideoCoder, codecId );
   fflush( stdout );
   if ( byteStreamVideoCoder ) {
@@ -63,7 +63,9 @@ typedef pcc::PCCImage<uint8_t, 3>  PCCImageOccupancyMap;
 typedef pcc::PCCImage<uint16_t, 3> PCCImageGeometry;
 typedef pcc::PCCImage<uint16_t, 3> PCCImageAttribute;
 struct PCCPatchSegmenter3Parameters;
+class PCCPatchSegmenter3;
 class PCCPatch;
+class PCCOccupancyCanvas;
 struct PCCBistreamPosition;
 
 struct SparseMatrixCoefficient {
@@ -107,6 +109,8 @@ typedef std::map<size_t, PCCPatch> unionPatch;  // unionPatch ------
                                                 // [TrackIndex, UnionPatch];
 typedef std::pair<size_t, size_t> SubContext;   // SubContext ------ [start,
                                                 // end);
+typedef std::pair<int32_t, size_t> PatchMatch;  // PatchMatch ------
+                                                // [bestMatchIdx, refAtlasFrameIndex];
 
 #define BAD_HEIGHT_THRESHOLD 1.10
 #define BAD_CONDITION_THRESHOLD 2
@@ -119,6 +123,12 @@ class PCCEncoder : public PCCCodec {
 
   int encode( const PCCGroupOfFrames& sources, PCCContext& context, PCCGroupOfFrames& reconstructs );
 
+  // The two parts of encode(), to process two groups of frames concurrently with two encoders:
+  // encodeAtlas() segments and packs the patches and returns the parameters adjusted for the group of
+  // frames; encodeVideo() codes the videos and reconstructs the frames with these parameters set.
+  int encodeAtlas( const PCCGroupOfFrames& sources, PCCContext& context, PCCEncoderParameters& gofParams );
+  int encodeVideo( const PCCGroupOfFrames& sources, PCCContext& context, PCCGroupOfFrames& reconstructs );
+
   void setPostProcessingSeiParameters( GeneratePointCloudParameters& params, PCCContext& context );
   void setGeneratePointCloudParameters( GeneratePointCloudParameters& gpcParams, PCCContext& context );
   void createPatchFrameDataStructure( PCCContext& context );
@@ -177,7 +187,9 @@ class PCCEncoder : public PCCCodec {
   //**patch segmentation**//
   bool generateSegments( const PCCGroupOfFrames& sources, PCCContext& context );
   bool generateSegments( const PCCPointSet3&                 source,
+                         const PCCKdTree&                    kdtree,
                          PCCAtlasFrameContext&               frameContext,
+                         PCCPatchSegmenter3&                 segmenter,
                          const PCCPatchSegmenter3Parameters& segmenterParams,
                          size_t                              frameIndex,
                          float&                              distanceSrcRec );
@@ -228,7 +240,7 @@ class PCCEncoder : public PCCCodec {
   void dilate( PCCFrameContext& frame, PCCImage<T, 3>& image, const PCCImage<T, 3>* reference = nullptr );
 
   // 3D geometry padding
-  void   dilate3DPadding( const PCCPointSet3&     source,
+  void   dilate3DPadding( const PCCKdTree&        kdtree,
                           PCCAtlasFrameContext&   frameInfo,
                           PCCFrameContext&        frame,
                           PCCImageGeometry&       image,
@@ -238,7 +250,7 @@ class PCCEncoder : public PCCCodec {
                                size_t            y,
                                uint16_t          mean_val,
                                PCCImageGeometry& image,
-                               PCCKdTree&        kdtree,
+                               const PCCKdTree&  kdtree,
                                PCCFrameContext&  frame );
 
   // Push-pull background filling
@@ -253,18 +265,21 @@ class PCCEncoder : public PCCCodec {
   void pushPullFill( PCCImage<T, 3>&              image,
                      const PCCImage<T, 3>&        mip,
                      const std::vector<uint32_t>& occupancyMap,
-                     int                          numIters );
+                     int                          numIters,
+                     PCCImage<T, 3>&              tmpImage );
   template <typename T>
   void dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>& image, int mapIdx = -1 );
   template <typename T>
   void dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<T, 3>& image );
   template <typename T>
-  void createCoarseLayer( PCCImage<T, 3>&        image,
-                          PCCImage<T, 3>&        mip,
-                          std::vector<uint32_t>& occupancyMap,
-                          std::vector<uint32_t>& mipOccupancyMap );
+  void createCoarseLayer( const PCCImage<T, 3>&        image,
+                          PCCImage<T, 3>&              mip,
+                          const std::vector<uint32_t>& occupancyMap,
+                          std::vector<uint32_t>&       mipOccupancyMap );
   template <typename T>
-  void regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes );
+  void regionFill( PCCImage<T, 3>&              image,
+                   const std::vector<uint32_t>& occupancyMap,
+                   const PCCImage<T, 3>&        imageLowRes );
 
   //**placing patches**//
   void packFlexible( PCCFrameContext& tile,
@@ -285,26 +300,26 @@ class PCCEncoder : public PCCCodec {
 
   size_t packRawPointsPatchSimple( PCCFrameContext& tile, size_t patchStartOffsetX = 0, size_t patchStartOffsetY = 0 );
 
-  size_t packRawPointsPatch( PCCFrameContext&   frame,
-                             std::vector<bool>& occupancyMap,
-                             size_t             width,
-                             size_t&            height,
-                             size_t             occupancySizeU,
-                             size_t             occupancySizeV,
-                             size_t             maxOccupancyRow );
-  void   packEOMAttributePointsPatch( PCCFrameContext&   frame,
-                                      std::vector<bool>& occupancyMap,
-                                      size_t             width,
-                                      size_t&            height,
-                                      size_t             occupancySizeU,
-                                      size_t             occupancySizeV,
-                                      size_t             maxOccupancyRow );
+  size_t packRawPointsPatch( PCCFrameContext&    frame,
+                             PCCOccupancyCanvas& occupancyMap,
+                             size_t              width,
+                             size_t&             height,
+                             size_t              occupancySizeU,
+                             size_t              occupancySizeV,
+                             size_t              maxOccupancyRow );
+  void   packEOMAttributePointsPatch( PCCFrameContext&    frame,
+                                      PCCOccupancyCanvas& occupancyMap,
+                                      size_t              width,
+                                      size_t&             height,
+                                      size_t              occupancySizeU,
+                                      size_t              occupancySizeV,
+                                      size_t              maxOccupancyRow );
   void   adjustReferenceAtlasFrames( PCCContext& context, size_t tileIndex );
-  double adjustReferenceAtlasFrame( PCCContext&            context,
-                                    PCCFrameContext&       tile,
-                                    size_t                 tileIndex,
-                                    size_t                 listIndex,
-                                    std::vector<PCCPatch>& tempPatchList );
+  double adjustReferenceAtlasFrame( PCCContext&              context,
+                                    PCCFrameContext&         tile,
+                                    size_t                   tileIndex,
+                                    size_t                   listIndex,
+                                    std::vector<PatchMatch>& patchMatches );
   void   spatialConsistencyPackFlexible( PCCFrameContext& tile,
                                          PCCFrameContext& prevFrame,
                                          int              packingStrategy,
@@ -388,16 +403,16 @@ class PCCEncoder : public PCCCodec {
                                  int         safeguard,
                                  bool        hasRefFrame );
   static void updatePatchInformation( PCCContext& context, size_t tileIndex, SubContext& subContext );
-  void        packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&          patch,
-                                                           size_t             i,
-                                                           size_t             icount,
-                                                           size_t&            occupancySizeU,
-                                                           size_t&            occupancySizeV,
-                                                           const size_t       safeguard,
-                                                           std::vector<bool>& occupancyMap,
-                                                           size_t&            heightGPA,
-                                                           size_t&            widthGPA,
-                                                           size_t&            maxOccupancyRow );
+  void        packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&           patch,
+                                                           size_t              i,
+                                                           size_t              icount,
+                                                           size_t&             occupancySizeU,
+                                                           size_t&             occupancySizeV,
+                                                           const size_t        safeguard,
+                                                           PCCOccupancyCanvas& occupancyMap,
+                                                           size_t&             heightGPA,
+                                                           size_t&             widthGPA,
+                                                           size_t&             maxOccupancyRow );
 
   void packingWithRefForFirstFrameNoglobalPatch( PCCPatch&                    patch,
                                                  const std::vector<PCCPatch>& prePatches,
@@ -407,7 +422,7 @@ class PCCEncoder : public PCCCodec {
                                                  size_t&                      occupancySizeU,
                                                  size_t&                      occupancySizeV,
                                                  const size_t                 safeguard,
-                                                 std::vector<bool>&           occupancyMap,
+                                                 PCCOccupancyCanvas&          occupancyMap,
                                                  size_t&                      heightGPA,
                                                  size_t&                      widthGPA,
                                                  size_t&                      maxOccupancyRow );
@@ -430,6 +445,7 @@ class PCCEncoder : public PCCCodec {
                    size_t           patchIndex );
   //**Additional Projection Plane**//
   void segmentationPartiallyAddtinalProjectionPlane( const PCCPointSet3&                 source,
+                                                     const PCCKdTree&                    kdtree,
                                                      PCCFrameContext&                    frameContext,
                                                      const PCCPatchSegmenter3Parameters& segmenterParams,
                                                      size_t                              frameIndex,
@@ -443,8 +459,12 @@ class PCCEncoder : public PCCCodec {
   PCCVector3D            calculateWeightNormal( size_t geometryBitDepth3D, const PCCPointSet3& source );
 
   //**print out**//
-  static void printMap( std::vector<bool> img, const size_t sizeU, const size_t sizeV );
-  static void printMapTetris( std::vector<bool> img, const size_t sizeU, const size_t sizeV, std::vector<int> horizon );
+  template <typename T>
+  static void printMap( const T& img, const size_t sizeU, const size_t sizeV );
+  static void printMapTetris( const PCCOccupancyCanvas& img,
+                              const size_t              sizeU,
+                              const size_t              sizeV,
+                              std::vector<int>          horizon );
 
   PCCEncoderParameters params_;
 };
@@ -71,6 +71,8 @@ class PCCEncoderParameters {
   std::string       colorSpaceConversionConfig_;
   std::string       inverseColorSpaceConversionConfig_;
   size_t            nbThread_;
+  std::string       cpuAffinity_;
+  size_t            gofPipelineDepth_;
   size_t            frameCount_;
   size_t            groupOfFramesSize_;
   std::string       uncompressedDataPath_;
@@ -107,6 +109,8 @@ class PCCEncoderParameters {
   size_t iterationCountRefineSegmentation_;
   size_t voxelDimensionRefineSegmentation_;
   size_t searchRadiusRefineSegmentation_;
+  bool   temporalRefineSegmentation_;
+  double maxDist2TemporalRefineSegmentation_;
   size_t occupancyResolution_;
   bool   enablePatchSplitting_;
   size_t maxPatchSize_;
@@ -76,7 +76,11 @@ class PCCNormalsGenerator3 {
   PCCNormalsGenerator3( const PCCNormalsGenerator3& ) = delete;
   PCCNormalsGenerator3& operator=( const PCCNormalsGenerator3& ) = delete;
   ~PCCNormalsGenerator3()                                        = default;
-  void                      clear() { normals_.resize( 0 ); }
+  void                      clear() {
+    normals_.resize( 0 );
+    neighbors_.resize( 0 );
+    neighborCounts_.resize( 0 );
+  }
   void                      init( const size_t pointCount, const PCCNormalsGenerator3Parameters& params );
   void                      compute( const PCCPointSet3&                   pointCloud,
                                      const PCCKdTree&                      kdtree,
@@ -101,6 +105,18 @@ class PCCNormalsGenerator3 {
   }
   size_t getNormalCount() const { return normals_.size(); }
 
+  // k-NN neighborhoods found by the normal estimation: getNeighborCount() slots per point, of which the
+  // first getNeighborCount( pos ) are set (fewer than k points may be found in small clouds).
+  size_t          getNeighborCount() const { return neighborCount_; }
+  size_t          getNeighborCount( const size_t pos ) const {
+    assert( pos < neighborCounts_.size() );
+    return neighborCounts_[pos];
+  }
+  const uint32_t* getNeighbors( const size_t pos ) const {
+    assert( ( pos + 1 ) * neighborCount_ <= neighbors_.size() );
+    return neighbors_.data() + pos * neighborCount_;
+  }
+
   void computeNormal( const size_t                          index,
                       const PCCPointSet3&                   pointCloud,
                       const PCCKdTree&                      kdtree,
@@ -128,6 +144,9 @@ class PCCNormalsGenerator3 {
   std::vector<PCCVector3D>             eigenvalues_;
   std::vector<PCCVector3D>             barycenters_;
   std::vector<uint32_t>                numberOfNearestNeighborsInNormalEstimation_;
+  std::vector<uint32_t>                neighbors_;
+  std::vector<uint32_t>                neighborCounts_;
+  size_t                               neighborCount_ = 0;
   std::vector<uint32_t>                visited_;
   std::priority_queue<PCCWeightedEdge> edges_;
   size_t                               nbThread_;
@@ -0,0 +1,100 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCPatchRectIndex_h
+#define PCCPatchRectIndex_h
+
+#include "PCCCommon.h"
+#include <map>
+
+namespace pcc {
+
+class PCCPatch;
+
+// Index of the rectangles (U1, V1, sizeU, sizeV) of a list of patches, to find the patch with the best IOU
+// with a patch of another frame without comparing the two lists pair by pair. Only the patches with the same
+// view and level of detail (and ROI) can match: the rectangles are grouped by these keys and each group is
+// stored in a packed R-tree. The index holds these descriptors and a matched flag per patch, the patches are
+// neither copied nor modified.
+class PCCPatchRectIndex {
+ public:
+  // isMatched( patch ): the patches already matched, which are not candidates.
+  template <typename IsMatched>
+  PCCPatchRectIndex( const std::vector<PCCPatch>& patches, IsMatched isMatched, const bool useRoiIndex = false ) {
+    init( patches, useRoiIndex );
+    for ( size_t i = 0; i < patches.size(); i++ ) {
+      if ( isMatched( patches[i] ) ) { setMatched( i ); }
+    }
+  }
+  ~PCCPatchRectIndex() = default;
+
+  void setMatched( const size_t index );
+
+  // true if a patch not matched yet has the view and level of detail (and ROI) of the patch.
+  bool hasCandidate( const PCCPatch& patch ) const;
+
+  // Index of the patch not matched yet with the same view and level of detail (and ROI) as the patch and the
+  // largest IOU with it, if larger than maxIou; the first one of the list in case of tie, as when the list is
+  // searched in order. Returns -1 if no rectangle improves maxIou.
+  int findBestMatch( const PCCPatch& patch, float& maxIou );
+
+ private:
+  struct Box {
+    int x0_;
+    int y0_;
+    int x1_;
+    int y1_;
+  };
+  // levels_[0][i] bounds the leaves [i * B, (i + 1) * B), levels_[l][i] the nodes [i * B, (i + 1) * B) of l - 1
+  struct Group {
+    std::vector<size_t>           indexes_;         // patch indexes, in the order of the leaves of the tree
+    std::vector<std::vector<Box>> levels_;          // bounding boxes of the nodes, from the leaves to the root
+    size_t                        candidateCount_;  // patches not matched yet
+  };
+  typedef std::array<size_t, 4> Key;
+
+  void init( const std::vector<PCCPatch>& patches, const bool useRoiIndex );
+  Key  getKey( const PCCPatch& patch ) const;
+  void build( Group& group );
+
+  bool                                   useRoiIndex_;
+  std::vector<Box>                       boxes_;
+  std::vector<bool>                      matched_;
+  std::vector<Group*>                    groupOfPatch_;
+  std::map<Key, Group>                   groups_;
+  std::vector<size_t>                    candidates_;
+  std::vector<std::pair<size_t, size_t>> stack_;  // (level, node) of the tree nodes to visit
+};
+
+}  // namespace pcc
+
+#endif /* PCCPatchRectIndex_h */
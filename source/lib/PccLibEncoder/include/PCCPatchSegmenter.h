@@ -35,6 +35,7 @@
 #define PCCPatchSegmenter_h
 
 #include "PCCCommon.h"
+#include "PCCPointSet.h"
 #include <set>
 
 namespace pcc {
@@ -55,6 +56,8 @@ struct PCCPatchSegmenter3Parameters {
   size_t           iterationCountRefineSegmentation_;
   size_t           voxelDimensionRefineSegmentation_;
   size_t           searchRadiusRefineSegmentation_;
+  bool             temporalRefineSegmentation_;
+  double           maxDist2TemporalRefineSegmentation_;
   size_t           occupancyResolution_;
   bool             enablePatchSplitting_;
   size_t           maxPatchSize_;
@@ -107,6 +110,7 @@ class PCCPatchSegmenter3 {
   void setNbThread( size_t nbThread );
 
   void compute( const PCCPointSet3&                 geometry,
+                const PCCKdTree&                    kdtree,
                 const size_t                        frameIndex,
                 const PCCPatchSegmenter3Parameters& params,
                 std::vector<PCCPatch>&              patches,
@@ -143,6 +147,8 @@ class PCCPatchSegmenter3 {
                              std::vector<std::vector<size_t>>& adj,
                              const size_t                      maxNNCount );
 
+  void computeAdjacencyInfo( const PCCNormalsGenerator3& normalsGen, std::vector<std::vector<size_t>>& adj );
+
   void computeAdjacencyInfoDist( const PCCPointSet3&               pointCloud,
                                  const PCCKdTree&                  kdtree,
                                  std::vector<std::vector<size_t>>& adj,
@@ -153,7 +159,8 @@ class PCCPatchSegmenter3 {
                                      const PCCKdTree&                    kdtree,
                                      std::vector<std::vector<uint32_t>>& adj,
                                      const size_t                        maxNNCount,
-                                     const size_t                        radius );
+                                     const size_t                        radius,
+                                     const std::vector<uint8_t>&         searchMask );
 
   bool colorSimilarity( PCCColor3B& colorD1candidate, PCCColor3B& colorD0, uint8_t threshold ) {
     bool bSimilarity = ( std::abs( colorD0[0] - colorD1candidate[0] ) < threshold ) &&
@@ -217,7 +224,8 @@ class PCCPatchSegmenter3 {
                            const size_t                maxNNCount,
                            const double                lambda,
                            const size_t                iterationCount,
-                           std::vector<size_t>&        partition );
+                           std::vector<size_t>&        partition,
+                           const std::vector<uint8_t>& refinePoints );
 
   void refineSegmentationGridBased( const PCCPointSet3&         pointCloud,
                                     const PCCNormalsGenerator3& normalsGen,
@@ -228,11 +236,19 @@ class PCCPatchSegmenter3 {
                                     const size_t                iterationCount,
                                     const size_t                voxDim,
                                     const size_t                searchRadiusRefineSegmentation,
-                                    std::vector<size_t>&        partition );
+                                    std::vector<size_t>&        partition,
+                                    const std::vector<uint8_t>& refinePoints );
+
+  void reusePreviousSegmentation( const PCCPointSet3&   pointCloud,
+                                  const double          maxDist2,
+                                  std::vector<size_t>&  partition,
+                                  std::vector<uint8_t>& refinePoints );
 
  private:
   size_t                nbThread_;
-  std::vector<PCCPatch> boxMinDepths_;  // box depth list
+  PCCPointSet3          previousGeometry_;   // points segmented in the previous frame
+  std::vector<size_t>   previousPartition_;  // refined partition of previousGeometry_
+  std::vector<PCCPatch> boxMinDepths_;       // box depth list
   std::vector<PCCPatch> boxMaxDepths_;  // box depth list
 
   void convert( size_t axis, size_t lod, PCCPoint3D input, PCCPoint3D& output ) {
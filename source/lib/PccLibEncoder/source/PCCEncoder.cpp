@@ -37,15 +37,18 @@
 #include "PCCFrameContext.h"
 #include "PCCPatch.h"
 #include "PCCPatchSegmenter.h"
+#include "PCCPatchRectIndex.h"
 #include "PCCVideoEncoder.h"
 #include "PCCGroupOfFrames.h"
 #include "PCCPointSet.h"
 #include "PCCEncoderParameters.h"
 #include "PCCKdTree.h"
+#include "PCCTaskScheduler.h"
 #include <tbb/tbb.h>
 #include "PCCChrono.h"
 #include "PCCEncoder.h"
 #include "PCCEncoderConstant.h"
+#include <mutex>
 
 using namespace std;
 using namespace pcc;
@@ -67,18 +70,28 @@ PCCEncoder::~PCCEncoder() = default;
 void PCCEncoder::setParameters( const PCCEncoderParameters& params ) { params_ = params; }
 
 int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PCCGroupOfFrames& reconstructs ) {
+  PCCEncoderParameters gofParams;
+  int                  ret = encodeAtlas( sources, context, gofParams );
+  if ( ret != 0 ) { return ret; }
+  std::swap( params_, gofParams );
+  ret = encodeVideo( sources, context, reconstructs );
+  std::swap( params_, gofParams );
+  return ret;
+}
+
+int PCCEncoder::encodeAtlas( const PCCGroupOfFrames& sources, PCCContext& context, PCCEncoderParameters& gofParams ) {
   size_t pointLocalReconstructionOriginal   = static_cast<size_t>( params_.pointLocalReconstruction_ );
   size_t layerCountMinus1Original           = params_.mapCountMinus1_;
   size_t singleMapPixelInterleavingOriginal = static_cast<size_t>( params_.singleMapPixelInterleaving_ );
-  if ( params_.nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( params_.nbThread_ ) ); }
+  PCCTaskScheduler::getInstance().configure( params_.nbThread_, params_.cpuAffinity_ );
 
+  gofParams = params_;
   if ( sources.getFrameCount() == 0 ) { return 0; }
   assert( sources.getFrameCount() < 256 );
   if ( ( params_.rawPointsPatch_ || params_.lossyRawPointsPatch_ ) && params_.tileSegmentationType_ > 0 &&
        params_.numMaxTilePerFrame_ > 1 ) {
     params_.numMaxTilePerFrame_ += 1;
   }
-  reconstructs.setFrameCount( sources.getFrameCount() );
   context.resizeAtlas( 1 );
   context.setAtlasIndex( 0 );
   context.resize( sources.getFrameCount() );
@@ -111,6 +124,18 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   }
   if ( params_.tileSegmentationType_ > 0 ) { replaceFrameContext( context ); }
 
+  // the segmentation can disable the point local reconstruction for this group of frames only
+  gofParams                           = params_;
+  params_.pointLocalReconstruction_   = ( pointLocalReconstructionOriginal != 0u );
+  params_.mapCountMinus1_             = layerCountMinus1Original;
+  params_.singleMapPixelInterleaving_ = ( singleMapPixelInterleavingOriginal != 0u );
+  return 0;
+}
+
+int PCCEncoder::encodeVideo( const PCCGroupOfFrames& sources, PCCContext& context, PCCGroupOfFrames& reconstructs ) {
+  if ( sources.getFrameCount() == 0 ) { return 0; }
+  reconstructs.setFrameCount( sources.getFrameCount() );
+  auto&           frames = context.getFrames();
   PCCVideoEncoder videoEncoder;
   videoEncoder.setLogger( *logger_ );
   size_t            atlasIndex = context.getAtlasIndex();
@@ -168,8 +193,6 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   generateGeometryVideo( sources, context );
 
   // ENCODE GEOMETRY IMAGE
-  TRACE_PICTURE( "Geometry\n" );
-  TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0\n" );
   if ( params_.use3dmc_ || params_.usePccRDO_ ) { create3DMotionEstimationFiles( context, path.str() ); }
   auto&  gi                      = context.getVps().getGeometryInformation( atlasIndex );
   size_t geometryVideoBitDepth   = gi.getGeometry2dBitdepthMinus1() + 1;
@@ -178,62 +201,43 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   size_t nbyteGeoMP              = ( geometryMPVideoBitDepth <= 8 ) ? 1 : 2;
   size_t internalBitDepth        = 10;
   if ( params_.rawPointsPatch_ ) { internalBitDepth = geometryVideoBitDepth; }
-  auto&       videoBitstreamD0 = params_.multipleStreams_ ? context.createVideoBitstream( VIDEO_GEOMETRY_D0 )
-                                                          : context.createVideoBitstream( VIDEO_GEOMETRY );
+  auto&      asps      = context.getAtlasSequenceParameterSet( atlasIndex );
+  const bool auxVideo  = asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag();
+  const bool predictD1 = params_.multipleStreams_ && !params_.absoluteD1_;
+  if ( params_.multipleStreams_ && params_.lossyRawPointsPatch_ ) {
+    std::cout << "Error: lossyRawPointsPatch has not been implemented for "
+                 "absoluteD1_ = 0 as "
+                 "yet. Exiting... "
+              << std::endl;
+    std::exit( -1 );
+  }
+  if ( auxVideo ) {
+    std::cout << "*******Video: Aux (Geometry) ********" << std::endl;
+    placeAuxiliaryPointsTiles( context );
+    generateRawPointsGeometryVideo( context );
+  }
+
+  // The geometry videos are independent, except D1 when it is predicted from the reconstructed D0: they are
+  // encoded concurrently. Their bitstreams are created first to keep the V3C unit order.
+  params_.multipleStreams_ ? context.createVideoBitstream( VIDEO_GEOMETRY_D0 )
+                           : context.createVideoBitstream( VIDEO_GEOMETRY );
+  if ( params_.multipleStreams_ ) { context.createVideoBitstream( VIDEO_GEOMETRY_D1 ); }
+  if ( auxVideo ) { context.createVideoBitstream( VIDEO_GEOMETRY_RAW ); }
+  auto&       videoBitstreamD0 =
+      context.getVideoBitstream( params_.multipleStreams_ ? VIDEO_GEOMETRY_D0 : VIDEO_GEOMETRY );
   auto&       videoGeometry    = context.getVideoGeometryMultiple()[0];
   std::string geometryConfigFile =
       params_.multipleStreams_
           ? params_.geometry0Config_
           : ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.geometryConfig_ ) : params_.geometryConfig_ );
-  videoEncoder.compress( videoGeometry,                             // video
-                         path.str(),                                // path
-                         params_.geometryQP_ + params_.deltaQPD0_,  // QP
-                         videoBitstreamD0,                          // bitstream
-                         geometryConfigFile,                        // config file
-                         params_.videoEncoderGeometryPath_,         // encoder path
-                         params_.videoEncoderGeometryCodecId_,      // Codec id
-                         params_.byteStreamVideoCoderGeometry_,     // byteStreamVideoCoder
-                         context,                                   // context
-                         nbyteGeo,                                  // nbyte
-                         false,                                     // use444CodecIo
-                         params_.use3dmc_,                          // use3dmv
-                         params_.usePccRDO_,                        // usePccRDO
-                         params_.shvcLayerIndex_,                   // SHVC layer index
-                         params_.shvcRateX_,                        // SHVC rate X
-                         params_.shvcRateY_,                        // SHVC rate Y
-                         internalBitDepth,                          // internalBitDepth
-                         false,                                     // useConversion
-                         params_.keepIntermediateFiles_ );          // keep intermediate
-  size_t sizeGeometryVideo = videoBitstreamD0.size();
-  std::cout << "sizeGeometryVideo: " << sizeGeometryVideo << std::endl;
-  if ( params_.multipleStreams_ ) {
-    if ( params_.lossyRawPointsPatch_ ) {
-      std::cout << "Error: lossyRawPointsPatch has not been implemented for "
-                   "absoluteD1_ = 0 as "
-                   "yet. Exiting... "
-                << std::endl;
-      std::exit( -1 );
-    }
-    if ( !params_.absoluteD1_ ) {
-      // Form differential video geometry1
-      for ( size_t f = 0; f < frames.size(); ++f ) {
-        auto& frame1 = context.getVideoGeometryMultiple()[1].getFrame( f );
-        predictGeometryFrame( frames[f].getTitleFrameContext(), videoGeometry.getFrame( f ), frame1 );
-        dilate3DPadding( sources[f], frames[f], frames[f].getTitleFrameContext(), frame1,
-                         videoOccupancyMap.getFrame( f ) );
-      }
-    }
-
-    // Compress geometry1
+  auto compressGeometryD0 = [&] {
     TRACE_PICTURE( "Geometry\n" );
-    TRACE_PICTURE( "MapIdx = 1, AuxiliaryVideoFlag = 0\n" );
-    auto& videoGeometryD1  = context.getVideoGeometryMultiple()[1];
-    auto& videoBitstreamD1 = context.createVideoBitstream( VIDEO_GEOMETRY_D1 );
-    videoEncoder.compress( videoGeometryD1,                           // video
+    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0\n" );
+    videoEncoder.compress( videoGeometry,                             // video
                            path.str(),                                // path
-                           params_.geometryQP_ + params_.deltaQPD1_,  // QP
-                           videoBitstreamD1,                          // bitstream
-                           params_.geometry1Config_,                  // config file
+                           params_.geometryQP_ + params_.deltaQPD0_,  // QP
+                           videoBitstreamD0,                          // bitstream
+                           geometryConfigFile,                        // config file
                            params_.videoEncoderGeometryPath_,         // encoder path
                            params_.videoEncoderGeometryCodecId_,      // Codec id
                            params_.byteStreamVideoCoderGeometry_,     // byteStreamVideoCoder
@@ -248,41 +252,80 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
                            internalBitDepth,                          // internalBitDepth
                            false,                                     // useConversion
                            params_.keepIntermediateFiles_ );          // keep intermediate
-    size_t sizeGeometryVideoD1 = videoBitstreamD1.size();
+  };
+  auto compressGeometryD1 = [&] {
+    TRACE_PICTURE( "Geometry\n" );
+    TRACE_PICTURE( "MapIdx = 1, AuxiliaryVideoFlag = 0\n" );
+    videoEncoder.compress( context.getVideoGeometryMultiple()[1],           // video
+                           path.str(),                                      // path
+                           params_.geometryQP_ + params_.deltaQPD1_,        // QP
+                           context.getVideoBitstream( VIDEO_GEOMETRY_D1 ),  // bitstream
+                           params_.geometry1Config_,                        // config file
+                           params_.videoEncoderGeometryPath_,               // encoder path
+                           params_.videoEncoderGeometryCodecId_,            // Codec id
+                           params_.byteStreamVideoCoderGeometry_,           // byteStreamVideoCoder
+                           context,                                         // context
+                           nbyteGeo,                                        // nbyte
+                           false,                                           // use444CodecIo
+                           params_.use3dmc_,                                // use3dmv
+                           params_.usePccRDO_,                              // usePccRDO
+                           params_.shvcLayerIndex_,                         // SHVC layer index
+                           params_.shvcRateX_,                              // SHVC rate X
+                           params_.shvcRateY_,                              // SHVC rate Y
+                           internalBitDepth,                                // internalBitDepth
+                           false,                                           // useConversion
+                           params_.keepIntermediateFiles_ );                // keep intermediate
+  };
+  auto compressGeometryAux = [&] {
+    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 1\n" );
+    videoEncoder.compress( context.getVideoRawPointsGeometry(),              // video,
+                           path.str(),                                       // path,
+                           params_.auxGeometryQP_,                           // qp,
+                           context.getVideoBitstream( VIDEO_GEOMETRY_RAW ),  // bitstream,
+                           params_.geometryAuxVideoConfig_,                  // encoderConfig,
+                           params_.videoEncoderGeometryPath_,                // encoderPath,
+                           params_.videoEncoderGeometryCodecId_,             // codecId,
+                           params_.byteStreamVideoCoderGeometry_,            // byteStreamVideoCoder,
+                           context,                                          // context
+                           nbyteGeoMP,                                       // nbyte
+                           false,                                            // use444CodecIo
+                           false,                                            // use3dmv
+                           false,                                            // usePccRDO
+                           params_.shvcLayerIndex_,                          // SHVC layer index
+                           params_.shvcRateX_,                               // SHVC rate X
+                           params_.shvcRateY_,                               // SHVC rate Y
+                           internalBitDepth,                                 // internalBitDepth
+                           false,                                            // useConversion
+                           params_.keepIntermediateFiles_ );                 // keepIntermediateFiles
+  };
+  // the codecs linked in the process run one at a time: only the external codecs code the videos concurrently
+  const bool concurrentGeometry = !PCCIsLibraryVideoCodec( params_.videoEncoderGeometryCodecId_ );
+  std::vector<std::function<void()>> geometryCompressions = {compressGeometryD0};
+  if ( params_.multipleStreams_ && !predictD1 ) { geometryCompressions.push_back( compressGeometryD1 ); }
+  if ( auxVideo && !predictD1 ) { geometryCompressions.push_back( compressGeometryAux ); }
+  PCCTaskScheduler::getInstance().executeTasks( geometryCompressions, concurrentGeometry );
+  size_t sizeGeometryVideo = videoBitstreamD0.size();
+  std::cout << "sizeGeometryVideo: " << sizeGeometryVideo << std::endl;
+  if ( predictD1 ) {
+    // Form differential video geometry1
+    for ( size_t f = 0; f < frames.size(); ++f ) {
+      auto& frame1 = context.getVideoGeometryMultiple()[1].getFrame( f );
+      predictGeometryFrame( frames[f].getTitleFrameContext(), videoGeometry.getFrame( f ), frame1 );
+      dilate3DPadding( sources.getKdTree( f ), frames[f], frames[f].getTitleFrameContext(), frame1,
+                       videoOccupancyMap.getFrame( f ) );
+    }
+    geometryCompressions = {compressGeometryD1};
+    if ( auxVideo ) { geometryCompressions.push_back( compressGeometryAux ); }
+    PCCTaskScheduler::getInstance().executeTasks( geometryCompressions, concurrentGeometry );
+  }
+  if ( params_.multipleStreams_ ) {
+    size_t sizeGeometryVideoD1 = context.getVideoBitstream( VIDEO_GEOMETRY_D1 ).size();
     std::cout << "sizeGeometryVideoD1: " << sizeGeometryVideoD1 << std::endl;
     std::cout << "geometryVideo ->" << ( sizeGeometryVideo + sizeGeometryVideoD1 ) << "=" << sizeGeometryVideo << "+"
               << sizeGeometryVideoD1 << " B ("
               << ( ( sizeGeometryVideo + sizeGeometryVideoD1 ) * 8.0 ) / ( 2 * frames.size() * pointCount ) << " bpp)"
               << std::endl;
   }
-  auto& asps = context.getAtlasSequenceParameterSet( atlasIndex );
-  if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() ) {
-    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 1\n" );
-    std::cout << "*******Video: Aux (Geometry) ********" << std::endl;
-    placeAuxiliaryPointsTiles( context );
-    auto& videoRawPointsGeometryBitstream = context.createVideoBitstream( VIDEO_GEOMETRY_RAW );
-    generateRawPointsGeometryVideo( context );
-    auto& videoRawPointsGeometry = context.getVideoRawPointsGeometry();
-    videoEncoder.compress( videoRawPointsGeometry,                 // video,
-                           path.str(),                             // path,
-                           params_.auxGeometryQP_,                 // qp,
-                           videoRawPointsGeometryBitstream,        // bitstream,
-                           params_.geometryAuxVideoConfig_,        // encoderConfig,
-                           params_.videoEncoderGeometryPath_,      // encoderPath,
-                           params_.videoEncoderGeometryCodecId_,   // codecId,
-                           params_.byteStreamVideoCoderGeometry_,  // byteStreamVideoCoder,
-                           context,                                // context
-                           nbyteGeoMP,                             // nbyte
-                           false,                                  // use444CodecIo
-                           false,                                  // use3dmv
-                           false,                                  // usePccRDO
-                           params_.shvcLayerIndex_,                // SHVC layer index
-                           params_.shvcRateX_,                     // SHVC rate X
-                           params_.shvcRateY_,                     // SHVC rate Y
-                           internalBitDepth,                       // internalBitDepth
-                           false,                                  // useConversion
-                           params_.keepIntermediateFiles_ );       // keepIntermediateFiles
-  }
   // Tile summary
   printf( "****TileInfo***Summary******************\n" );
   fflush( stdout );
@@ -337,8 +380,7 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
     generateAttributeVideo( sources, reconstructs, context, params_ );
     if ( params_.attributeBGFill_ < 3 ) {
       // ATTRIBUTE IMAGE PADDING
-      tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
-      limited.execute( [&] {
+      PCCTaskScheduler::getInstance().execute( [&] {
         tbb::parallel_for( size_t( 0 ), frames.size(), [&]( const size_t f ) {
           using namespace std::chrono;
           pcc::chrono::Stopwatch<std::chrono::steady_clock> clockPadding;
@@ -411,76 +453,39 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
       } );
     }
     // ENCODE ATTRIBUTE IMAGE
-    TRACE_PICTURE( "Attribute\n" );
+    // The attribute videos are encoded concurrently, except T1 when it is predicted from the reconstructed T0.
     std::cout << "attribute video " << std::endl;
-    auto&        videoBitstream = params_.multipleStreams_ ? context.createVideoBitstream( VIDEO_ATTRIBUTE_T0 )
-                                                           : context.createVideoBitstream( VIDEO_ATTRIBUTE );
-    const size_t nbyteAtt       = 1;
-    int attrPartitionIndex      = sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( 0 );
-    int attrTypeId              = sps.getAttributeInformation( atlasIndex ).getAttributeTypeId( 0 );
-    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0, AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d\n",
-                   attrPartitionIndex, attrTypeId );
+    const bool   predictT1  = params_.multipleStreams_ && !params_.absoluteT1_;
+    const size_t nbyteAtt   = 1;
+    const size_t nByteAttMP = 1;
+    int attrPartitionIndex  = sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( 0 );
+    int attrTypeId          = sps.getAttributeInformation( atlasIndex ).getAttributeTypeId( 0 );
+    if ( auxVideo ) {
+      std::cout << "*******Video: Aux (Attribute) ********" << std::endl;
+      generateRawPointsAttributeVideo( context );
+    }
+    params_.multipleStreams_ ? context.createVideoBitstream( VIDEO_ATTRIBUTE_T0 )
+                             : context.createVideoBitstream( VIDEO_ATTRIBUTE );
+    if ( params_.multipleStreams_ ) { context.createVideoBitstream( VIDEO_ATTRIBUTE_T1 ); }
+    if ( auxVideo ) { context.createVideoBitstream( VIDEO_ATTRIBUTE_RAW ); }
+    auto& videoBitstream =
+        context.getVideoBitstream( params_.multipleStreams_ ? VIDEO_ATTRIBUTE_T0 : VIDEO_ATTRIBUTE );
     auto encoderConfig0 = params_.multipleStreams_
                               ? ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ )
                                                                : params_.attribute0Config_ )
                               : ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ )
                                                                : params_.attributeConfig_ );
-    videoEncoder.compress( context.getVideoAttributesMultiple()[0],     // video,
-                           path.str(),                                  // path
-                           params_.attributeQP_ + params_.deltaQPT0_,   // qp
-                           videoBitstream,                              // bitstream
-                           encoderConfig0,                              // encoderConfig
-                           params_.videoEncoderAttributePath_,          // encoderPath
-                           params_.videoEncoderAttributeCodecId_,       // codecId
-                           params_.byteStreamVideoCoderAttribute_,      // byteStreamVideoCoder
-                           context,                                     // context
-                           nbyteAtt,                                    // nbyte
-                           params_.attributeVideo444_,                  // use444CodecIo
-                           params_.use3dmc_,                            // use3dmv
-                           params_.usePccRDO_,                          // usePccRDO
-                           params_.shvcLayerIndex_,                     // SHVC layer index
-                           params_.shvcRateX_,                          // SHVC rate X
-                           params_.shvcRateY_,                          // SHVC rate Y
-                           params_.rawPointsPatch_ ? 8 : 10,            // internalBitDepth
-                           !params_.rawPointsPatch_,                    // useConversion
-                           params_.keepIntermediateFiles_,              // keepIntermediateFiles
-                           params_.colorSpaceConversionConfig_,         // colorSpaceConversionConfig
-                           params_.inverseColorSpaceConversionConfig_,  // inverseColorSpaceConversionConfig
-                           params_.colorSpaceConversionPath_ );         // colorSpaceConversionPath
-
-    auto sizeAttributeVideo = videoBitstream.size();
-    std::cout << "attribute video ->" << sizeAttributeVideo << " B ("
-              << ( sizeAttributeVideo * 8.0 ) / ( 2 * frames.size() * pointCount ) << " bpp)" << std::endl;
-
-    if ( params_.multipleStreams_ ) {
-      // Form differential video attribute1
-      if ( !params_.absoluteT1_ ) {
-        for ( size_t f = 0; f < frames.size(); ++f ) {
-          auto& frame0 = context.getVideoAttributesMultiple()[0].getFrame( f );
-          auto& frame1 = context.getVideoAttributesMultiple()[1].getFrame( f );
-          predictAttributeFrame( frames[f].getTitleFrameContext(), frame0, frame1 );
-          switch ( params_.attributeBGFill_ ) {
-            case 0: dilate( frames[f].getTitleFrameContext(), frame1 ); break;
-            case 1: dilateSmoothedPushPull( frames[f].getTitleFrameContext(), frame1 ); break;
-            case 2: dilateHarmonicBackgroundFill( frames[f].getTitleFrameContext(), frame1 ); break;
-            default: std::cout << "Warning: no attribute padding applied!" << std::endl;
-          }
-        }
-        std::cout << "attribute prediction done " << std::endl;
-      }
-
-      // compress attribute1
+    auto encoderConfig1 =
+        params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ ) : params_.attribute1Config_;
+    auto compressAttributeT0 = [&] {
       TRACE_PICTURE( "Attribute\n" );
-      TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 1, AuxiliaryVideoFlag = 0\n",
+      TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0, AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d\n",
                      attrPartitionIndex, attrTypeId );
-      auto& videoBitstreamT1 = context.createVideoBitstream( VIDEO_ATTRIBUTE_T1 );
-      auto  encoderConfig1 =
-          params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ ) : params_.attribute1Config_;
-      videoEncoder.compress( context.getVideoAttributesMultiple()[1],     // video,
+      videoEncoder.compress( context.getVideoAttributesMultiple()[0],     // video,
                              path.str(),                                  // path
-                             params_.attributeQP_ + params_.deltaQPT1_,   // qp
-                             videoBitstreamT1,                            // bitstream
-                             encoderConfig1,                              // encoderConfig
+                             params_.attributeQP_ + params_.deltaQPT0_,   // qp
+                             videoBitstream,                              // bitstream
+                             encoderConfig0,                              // encoderConfig
                              params_.videoEncoderAttributePath_,          // encoderPath
                              params_.videoEncoderAttributeCodecId_,       // codecId
                              params_.byteStreamVideoCoderAttribute_,      // byteStreamVideoCoder
@@ -497,46 +502,105 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
                              params_.keepIntermediateFiles_,              // keepIntermediateFiles
                              params_.colorSpaceConversionConfig_,         // colorSpaceConversionConfig
                              params_.inverseColorSpaceConversionConfig_,  // inverseColorSpaceConversionConfig
-                             params_.colorSpaceConversionPath_ );         // keepIntermediateFiles
-      size_t sizeAttributeVideoT1 = videoBitstreamT1.size();
+                             params_.colorSpaceConversionPath_ );         // colorSpaceConversionPath
+    };
+    auto compressAttributeT1 = [&] {
+      TRACE_PICTURE( "Attribute\n" );
+      TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 1, AuxiliaryVideoFlag = 0\n",
+                     attrPartitionIndex, attrTypeId );
+      videoEncoder.compress( context.getVideoAttributesMultiple()[1],          // video,
+                             path.str(),                                       // path
+                             params_.attributeQP_ + params_.deltaQPT1_,        // qp
+                             context.getVideoBitstream( VIDEO_ATTRIBUTE_T1 ),  // bitstream
+                             encoderConfig1,                                   // encoderConfig
+                             params_.videoEncoderAttributePath_,               // encoderPath
+                             params_.videoEncoderAttributeCodecId_,            // codecId
+                             params_.byteStreamVideoCoderAttribute_,           // byteStreamVideoCoder
+                             context,                                          // context
+                             nbyteAtt,                                         // nbyte
+                             params_.attributeVideo444_,                       // use444CodecIo
+                             params_.use3dmc_,                                 // use3dmv
+                             params_.usePccRDO_,                               // usePccRDO
+                             params_.shvcLayerIndex_,                          // SHVC layer index
+                             params_.shvcRateX_,                               // SHVC rate X
+                             params_.shvcRateY_,                               // SHVC rate Y
+                             params_.rawPointsPatch_ ? 8 : 10,                 // internalBitDepth
+                             !params_.rawPointsPatch_,                         // useConversion
+                             params_.keepIntermediateFiles_,                   // keepIntermediateFiles
+                             params_.colorSpaceConversionConfig_,              // colorSpaceConversionConfig
+                             params_.inverseColorSpaceConversionConfig_,       // inverseColorSpaceConversionConfig
+                             params_.colorSpaceConversionPath_ );              // keepIntermediateFiles
+    };
+    auto compressAttributeAux = [&] {
+      TRACE_PICTURE( "Attribute\n" );
+      TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 0, AuxiliaryVideoFlag = 1\n",
+                     attrPartitionIndex, attrTypeId );
+      videoEncoder.compress( context.getVideoRawPointsAttribute(),              // video,
+                             path.str(),                                        // path
+                             params_.auxAttributeQP_,                           // qp
+                             context.getVideoBitstream( VIDEO_ATTRIBUTE_RAW ),  // bitstream
+                             params_.attributeAuxVideoConfig_,                  // encoderConfig
+                             params_.videoEncoderAttributePath_,                // encoderPath
+                             params_.videoEncoderAttributeCodecId_,             // codecId
+                             params_.byteStreamVideoCoderAttribute_,            // byteStreamVideoCoder
+                             context,                                           // context
+                             nByteAttMP,                                        // nbyte
+                             params_.attributeVideo444_,                        // use444CodecIo
+                             false,                                             // use3dmv
+                             false,                                             // usePccRDO
+                             params_.shvcLayerIndex_,                           // SHVC layer index
+                             params_.shvcRateX_,                                // SHVC rate X
+                             params_.shvcRateY_,                                // SHVC rate Y
+                             10,                                                // internalBitDepth
+                             !params_.rawPointsPatch_,                          // useConversion
+                             params_.keepIntermediateFiles_,                    // keepIntermediateFiles
+                             params_.colorSpaceConversionConfig_,               // colorSpaceConversionConfig
+                             params_.inverseColorSpaceConversionConfig_,        // inverseColorSpaceConversionConfig
+                             params_.colorSpaceConversionPath_ );               // colorSpaceConversionPath
+    };
+    bool concurrentAttribute = !PCCIsLibraryVideoCodec( params_.videoEncoderAttributeCodecId_ );
+#ifdef USE_HDRTOOLS
+    concurrentAttribute = concurrentAttribute && params_.colorSpaceConversionPath_.empty();
+#endif
+    std::vector<std::function<void()>> attributeCompressions = {compressAttributeT0};
+    if ( params_.multipleStreams_ && !predictT1 ) { attributeCompressions.push_back( compressAttributeT1 ); }
+    if ( auxVideo && !predictT1 ) { attributeCompressions.push_back( compressAttributeAux ); }
+    PCCTaskScheduler::getInstance().executeTasks( attributeCompressions, concurrentAttribute );
+
+    auto sizeAttributeVideo = videoBitstream.size();
+    std::cout << "attribute video ->" << sizeAttributeVideo << " B ("
+              << ( sizeAttributeVideo * 8.0 ) / ( 2 * frames.size() * pointCount ) << " bpp)" << std::endl;
+
+    if ( predictT1 ) {
+      // Form differential video attribute1
+      PCCTaskScheduler::getInstance().execute( [&] {
+        tbb::parallel_for( size_t( 0 ), frames.size(), [&]( const size_t f ) {
+          auto& frame0 = context.getVideoAttributesMultiple()[0].getFrame( f );
+          auto& frame1 = context.getVideoAttributesMultiple()[1].getFrame( f );
+          predictAttributeFrame( frames[f].getTitleFrameContext(), frame0, frame1 );
+          switch ( params_.attributeBGFill_ ) {
+            case 0: dilate( frames[f].getTitleFrameContext(), frame1 ); break;
+            case 1: dilateSmoothedPushPull( frames[f].getTitleFrameContext(), frame1 ); break;
+            case 2: dilateHarmonicBackgroundFill( frames[f].getTitleFrameContext(), frame1 ); break;
+            default: std::cout << "Warning: no attribute padding applied!" << std::endl;
+          }
+        } );
+      } );
+      std::cout << "attribute prediction done " << std::endl;
+      attributeCompressions = {compressAttributeT1};
+      if ( auxVideo ) { attributeCompressions.push_back( compressAttributeAux ); }
+      PCCTaskScheduler::getInstance().executeTasks( attributeCompressions, concurrentAttribute );
+    }
+    if ( params_.multipleStreams_ ) {
+      size_t sizeAttributeVideoT1 = context.getVideoBitstream( VIDEO_ATTRIBUTE_T1 ).size();
       std::cout << "attribute video ->" << ( sizeAttributeVideo + sizeAttributeVideoT1 ) << "=" << sizeAttributeVideo
                 << "+" << sizeAttributeVideoT1 << " B ("
                 << ( ( sizeAttributeVideo + sizeAttributeVideoT1 ) * 8.0 ) / ( 2 * frames.size() * pointCount )
                 << " bpp)" << std::endl;
     }
-
-    if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() ) {
-      TRACE_PICTURE( "Attribute\n" );
-      TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 0, AuxiliaryVideoFlag = 1\n",
-                     attrPartitionIndex, attrTypeId );
-      std::cout << "*******Video: Aux (Attribute) ********" << std::endl;
-      auto& videoBitstreamMP = context.createVideoBitstream( VIDEO_ATTRIBUTE_RAW );
-      generateRawPointsAttributeVideo( context );
-      auto&        videoRawPointsAttribute = context.getVideoRawPointsAttribute();
-      const size_t nByteAttMP              = 1;
-      videoEncoder.compress( videoRawPointsAttribute,                     // video,
-                             path.str(),                                  // path
-                             params_.auxAttributeQP_,                     // qp
-                             videoBitstreamMP,                            // bitstream
-                             params_.attributeAuxVideoConfig_,            // encoderConfig
-                             params_.videoEncoderAttributePath_,          // encoderPath
-                             params_.videoEncoderAttributeCodecId_,       // codecId
-                             params_.byteStreamVideoCoderAttribute_,      // byteStreamVideoCoder
-                             context,                                     // context
-                             nByteAttMP,                                  // nbyte
-                             params_.attributeVideo444_,                  // use444CodecIo
-                             false,                                       // use3dmv
-                             false,                                       // usePccRDO
-                             params_.shvcLayerIndex_,                     // SHVC layer index
-                             params_.shvcRateX_,                          // SHVC rate X
-                             params_.shvcRateY_,                          // SHVC rate Y
-                             10,                                          // internalBitDepth
-                             !params_.rawPointsPatch_,                    // useConversion
-                             params_.keepIntermediateFiles_,              // keepIntermediateFiles
-                             params_.colorSpaceConversionConfig_,         // colorSpaceConversionConfig
-                             params_.inverseColorSpaceConversionConfig_,  // inverseColorSpaceConversionConfig
-                             params_.colorSpaceConversionPath_ );         // colorSpaceConversionPath
+    if ( auxVideo ) {
       printf( "generateRawPointsAttributefromVideo \n" );
+      context.getVideoRawPointsAttribute().resize( context.size() );
       for ( size_t fi = 0; fi < context.size(); fi++ ) { generateRawPointsAttributefromVideo( context, fi ); }
     }
   }  // attribute
@@ -709,15 +773,13 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
     remove3DMotionEstimationFiles( path.str() );
   }
   createPatchFrameDataStructure( context );
-  params_.pointLocalReconstruction_   = ( pointLocalReconstructionOriginal != 0u );
-  params_.mapCountMinus1_             = layerCountMinus1Original;
-  params_.singleMapPixelInterleaving_ = ( singleMapPixelInterleavingOriginal != 0u );
   printf( "Done Encoder \n" );
   fflush( stdout );
   return 0;
 }
 
-void PCCEncoder::printMap( std::vector<bool> img, const size_t sizeU, const size_t sizeV ) {
+template <typename T>
+void PCCEncoder::printMap( const T& img, const size_t sizeU, const size_t sizeV ) {
   std::cout << std::endl;
   std::cout << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
   for ( size_t v = 0; v < sizeV; ++v ) {
@@ -727,10 +789,10 @@ void PCCEncoder::printMap( std::vector<bool> img, const size_t sizeU, const size
   std::cout << std::endl;
 }
 
-void PCCEncoder::printMapTetris( std::vector<bool> img,
-                                 const size_t      sizeU,
-                                 const size_t      sizeV,
-                                 std::vector<int>  horizon ) {
+void PCCEncoder::printMapTetris( const PCCOccupancyCanvas& img,
+                                 const size_t              sizeU,
+                                 const size_t              sizeV,
+                                 std::vector<int>          horizon ) {
   std::cout << std::endl;
   std::cout << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
   for ( int v = 0; v < sizeV; ++v ) {
@@ -994,37 +1056,51 @@ void PCCEncoder::modifyOccupancyMapEOM( PCCFrameContext& tile ) {
 void PCCEncoder::adjustReferenceAtlasFrames( PCCContext& context, size_t tileIndex ) {
   for ( size_t frameIdx = 2; frameIdx < context.getFrames().size(); frameIdx++ ) {
     std::cout << ":::::---- adjusting reference frames for frame " << frameIdx << "\ttile " << tileIndex << std::endl;
-    auto&                 tile         = context[frameIdx].getTile( tileIndex );
-    double                dMinListDist = 0;
-    std::vector<PCCPatch> bestPatchList;
-    size_t                bestListIdx = 0;
-    std::vector<PCCPatch> tempPatchList;
+    auto&                   tile         = context[frameIdx].getTile( tileIndex );
+    double                  dMinListDist = 0;
+    std::vector<PatchMatch> bestPatchMatches;
+    size_t                  bestListIdx = 0;
+    std::vector<PatchMatch> tempPatchMatches;
     for ( size_t listIdx = 0; listIdx < context.getNumOfRefAtlasFrameList(); listIdx++ ) {
-      tempPatchList.clear();
-      double dTempListDist = adjustReferenceAtlasFrame( context, tile, tileIndex, listIdx, tempPatchList );
+      double dTempListDist = adjustReferenceAtlasFrame( context, tile, tileIndex, listIdx, tempPatchMatches );
       if ( dTempListDist > dMinListDist ) {
-        dMinListDist  = dTempListDist;
-        bestListIdx   = listIdx;
-        bestPatchList = tempPatchList;
+        dMinListDist = dTempListDist;
+        bestListIdx  = listIdx;
+        bestPatchMatches.swap( tempPatchMatches );
       }
     }
     tile.setNumRefIdxActive( std::min( frameIdx, context.getSizeOfRefAtlasFrameList( bestListIdx ) ) );
     tile.setBestRefListIndexInAsps( bestListIdx );
     tile.setRefAfocList( context, bestListIdx );
-    tile.getPatches() = bestPatchList;
+    // the matches of the best list are applied to the patches of the tile; no list found means no patches
+    auto& patches = tile.getPatches();
+    if ( bestPatchMatches.empty() ) { patches.clear(); }
+    for ( size_t patchIdx = 0; patchIdx < bestPatchMatches.size(); patchIdx++ ) {
+      auto& patch = patches[patchIdx];
+      patch.setBestMatchIdx( bestPatchMatches[patchIdx].first );
+      patch.setRefAtlasFrameIndex( bestPatchMatches[patchIdx].second );
+      patch.setPatchType( static_cast<uint8_t>( bestPatchMatches[patchIdx].first != g_undefined_index ? P_INTER
+                                                                                                         : P_INTRA ) );
+    }
   }  // frame
 }
 
-double PCCEncoder::adjustReferenceAtlasFrame( PCCContext&            context,
-                                              PCCFrameContext&       tile,
-                                              size_t                 tileIndex,
-                                              size_t                 listIndex,
-                                              std::vector<PCCPatch>& tempPatchList ) {
+double PCCEncoder::adjustReferenceAtlasFrame( PCCContext&              context,
+                                              PCCFrameContext&         tile,
+                                              size_t                   tileIndex,
+                                              size_t                   listIndex,
+                                              std::vector<PatchMatch>& patchMatches ) {
   tile.setRefAfocList( context, listIndex );
   PCCBitstream tempBitStream;
-  auto         curPatches    = tile.getPatches();
+  const auto&  curPatches    = tile.getPatches();
   size_t       curPatchCount = curPatches.size();
   if ( curPatches.empty() ) { return -1; }
+  // the matches are evaluated without modifying the patches of the tile
+  patchMatches.resize( curPatchCount );
+  for ( size_t patchIdx = 0; patchIdx < curPatchCount; patchIdx++ ) {
+    patchMatches[patchIdx] =
+        PatchMatch( curPatches[patchIdx].getBestMatchIdx(), curPatches[patchIdx].getRefAtlasFrameIndex() );
+  }
   vector<double> maxIOUList;
   maxIOUList.resize( curPatchCount, -1.0F );
   double sumMaxIOU = 0;
@@ -1053,7 +1129,7 @@ double PCCEncoder::adjustReferenceAtlasFrame( PCCContext&            context,
   const size_t max3DCoordinate =
       size_t( 1 ) << ( params_.geometry3dCoordinatesBitdepth_ + ( params_.additionalProjectionPlaneMode_ > 0 ) );
   for ( size_t curId = 0; curId < curPatchCount; curId++ ) {
-    auto& curPatch = curPatches[curId];
+    const auto& curPatch = curPatches[curId];
     // intra
     float initSize = tempBitStream.size();
     tempBitStream.write( uint32_t( curPatch.getU0() ), bitMaxU0 );
@@ -1112,9 +1188,9 @@ double PCCEncoder::adjustReferenceAtlasFrame( PCCContext&            context,
     float bitCostInterA = ( curPatch.getBestMatchIdx() != -1 ) ? tempBitStream.size() : 0;
     float bitCostInter  = bitCostInterA - initSize;
 #endif
-    float bitCostIntra = bitCostIntraA - initSize;
-    maxIOUList[curId]  = 1 / bitCostIntra;
-    curPatch.setBestMatchIdx( -1 );
+    float bitCostIntra        = bitCostIntraA - initSize;
+    maxIOUList[curId]         = 1 / bitCostIntra;
+    patchMatches[curId].first = -1;
   }
 
   // loop over refPicture in the list
@@ -1129,9 +1205,9 @@ double PCCEncoder::adjustReferenceAtlasFrame( PCCContext&            context,
       float maxIou     = 0.0F;
       int   bestCurIdx = -1;
       for ( size_t curId = 0; curId < curPatchCount; curId++ ) {
-        auto& curPatch     = curPatches[curId];
-        bool  bMatchingRef = refPatch.getViewId() == curPatch.getViewId() &&
-                            refPatch.getPatchOrientation() == curPatch.getPatchOrientation();
+        const auto& curPatch     = curPatches[curId];
+        bool        bMatchingRef = refPatch.getViewId() == curPatch.getViewId() &&
+                                  refPatch.getPatchOrientation() == curPatch.getPatchOrientation();
         if ( bMatchingRef ) {
           float initSize = tempBitStream.size();
           tempBitStream.writeSvlc( int32_t( static_cast<int64_t>( refPatchId ) - curId ) );  // approx
@@ -1168,10 +1244,8 @@ double PCCEncoder::adjustReferenceAtlasFrame( PCCContext&            context,
         }  // end of if (patch.viewId == cpatch.viewId).
       }
       if ( bestCurIdx >= 0 && maxIou > maxIOUList[bestCurIdx] ) {
-        curPatches[bestCurIdx].setBestMatchIdx( refPatchId );    // the matched patch id in preivious frame.
-        curPatches[bestCurIdx].setRefAtlasFrameIndex( refIdx );  // the matched patch id in preivious frame.
-        curPatches[bestCurIdx].setPatchType( static_cast<uint8_t>( P_INTER ) );
-        maxIOUList[bestCurIdx] = maxIou;
+        patchMatches[bestCurIdx] = PatchMatch( refPatchId, refIdx );  // the matched patch id in preivious frame.
+        maxIOUList[bestCurIdx]   = maxIou;
       }
     }  // refPatch
   }    // refIdx
@@ -1179,19 +1253,18 @@ double PCCEncoder::adjustReferenceAtlasFrame( PCCContext&            context,
   // no reordering!
   size_t numInterPredictedPatches = 0;
   for ( size_t patchIdx = 0; patchIdx < curPatchCount; patchIdx++ ) {
-    if ( curPatches[patchIdx].getBestMatchIdx() != g_undefined_index ) {
-      curPatches[patchIdx].setPatchType( static_cast<uint8_t>( P_INTER ) );
+    if ( patchMatches[patchIdx].first != g_undefined_index ) {
       numInterPredictedPatches++;
       sumMaxIOU += maxIOUList[patchIdx];
-    } else {
-      curPatches[patchIdx].setPatchType( static_cast<uint8_t>( P_INTRA ) );
     }
-    tempPatchList.push_back( curPatches[patchIdx] );
   }
   tile.setNumMatchedPatches( numInterPredictedPatches );
   return sumMaxIOU;
 }
 
+// the patches already matched with a patch of the reference frame are not candidates of the matching
+static bool isMatchedPatch( const PCCPatch& patch ) { return patch.getBestMatchIdx() != g_invalidPatchIndex; }
+
 void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
                                                  PCCFrameContext& prevFrame,
                                                  int              packingStrategy,
@@ -1206,9 +1279,9 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
   if ( patches.empty() ) {
     if ( tile.getNumberOfRawPointsPatches() == 0 ) { return; }
     if ( tile.getUseRawPointsSeparateVideo() ) { return; }
-    std::vector<bool> occupancyMap;
-    size_t            occupancySizeU = presetWidth / params_.occupancyResolution_;
-    size_t            occupancySizeV = presetHeight / params_.occupancyResolution_;
+    PCCOccupancyCanvas occupancyMap;
+    size_t             occupancySizeU = presetWidth / params_.occupancyResolution_;
+    size_t             occupancySizeV = presetHeight / params_.occupancyResolution_;
     if ( presetWidth == 0 || presetHeight == 0 ) {
       auto& rawPointsPatch = tile.getRawPointsPatch( 0 );
       auto  rawPointsPatchBlocks =
@@ -1246,52 +1319,39 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
   } else {
     std::sort( patches.begin(), patches.end(), []( PCCPatch& a, PCCPatch& b ) { return a.gt( b ); } );
   }
-  int              id             = 0;
-  size_t           occupancySizeU = presetWidth / params_.occupancyResolution_;
-  size_t           occupancySizeV = (std::max)( patches[0].getSizeU0(), patches[0].getSizeV0() );
-  vector<PCCPatch> matchedPatches;
-  vector<PCCPatch> tmpPatches;
-  matchedPatches.clear();
-  float  thresholdIOU    = 0.2F;
-  size_t bestRefFrameIdx = 0;
+  int                 id             = 0;
+  size_t              occupancySizeU = presetWidth / params_.occupancyResolution_;
+  size_t              occupancySizeV = (std::max)( patches[0].getSizeU0(), patches[0].getSizeV0() );
+  std::vector<size_t> matchedPatches;  // indexes of the matched patches, in the order of the matches
+  PCCPatchRectIndex   rectIndex( patches, isMatchedPatch );
+  float               thresholdIOU    = 0.2F;
+  size_t              bestRefFrameIdx = 0;
   // main loop.
   for ( auto& patch : prevPatches ) {
     id++;
-    float maxIou  = 0.0F;
-    int   bestIdx = -1;
-    int   cId     = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == g_invalidPatchIndex ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() ) ) {
-        patch.setPatchType( static_cast<uint8_t>( P_INTRA ) );
-        Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
-        Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
-        float iou   = computeIOU( rect, crect );
-        if ( iou > maxIou ) {
-          maxIou  = iou;
-          bestIdx = cId;
-        }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
-    }
-
+    float maxIou = 0.0F;
+    if ( rectIndex.hasCandidate( patch ) ) { patch.setPatchType( static_cast<uint8_t>( P_INTRA ) ); }
+    int bestIdx = rectIndex.findBestMatch( patch, maxIou );
     if ( maxIou > thresholdIOU ) {
       // store the best match index
       patches[bestIdx].setBestMatchIdx( id - 1 );  // the matched patch id in preivious frame.
       patches[bestIdx].setPatchType( static_cast<uint8_t>( P_INTER ) );
       patches[bestIdx].setRefAtlasFrameIndex( bestRefFrameIdx );
-      matchedPatches.push_back( patches[bestIdx] );
+      rectIndex.setMatched( bestIdx );
+      matchedPatches.push_back( bestIdx );
     }
   }
 
   // generate new patch order.
-  vector<PCCPatch> newOrderPatches = matchedPatches;
-  for ( auto patch : patches ) {
+  vector<PCCPatch> newOrderPatches;
+  newOrderPatches.reserve( patches.size() );
+  for ( const auto& index : matchedPatches ) { newOrderPatches.push_back( std::move( patches[index] ) ); }
+  for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
     if ( patch.getBestMatchIdx() == g_invalidPatchIndex ) {
       patch.setPatchType( static_cast<uint8_t>( P_INTRA ) );
-      newOrderPatches.push_back( patch );
+      newOrderPatches.push_back( std::move( patch ) );
     }
   }
   tile.setNumMatchedPatches( matchedPatches.size() );
@@ -1301,7 +1361,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
     std::cout << "patches.size:" << patches.size() << ",reOrderedPatches.size:" << newOrderPatches.size()
               << ",matchedpatches.size:" << tile.getNumMatchedPatches() << std::endl;
   }
-  patches = newOrderPatches;
+  patches.swap( newOrderPatches );
   if ( g_printDetailedInfo ) {
     std::cout << "Patch order:" << std::endl;
     for ( auto& patch : patches ) {
@@ -1316,12 +1376,12 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
   if ( params_.enablePointCloudPartitioning_ ) {
     std::cout << "frame " << tile.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
   }
-  occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  int               numOrientations = packingStrategy == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  std::vector<bool> occupancyMap;
+  occupancySizeV                     = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  int                numOrientations = packingStrategy == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
+  PCCOccupancyCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
@@ -1342,13 +1402,15 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
                       << std::endl;
           }
         }
-        // if the patch couldn't fit, try to fit the patch in the top left position
+        // if the patch couldn't fit, try to fit the patch in the top left position, skipping the positions
+        // where it is known not to fit
         for ( int v = 0; v <= occupancySizeV && !locationFound; ++v ) {
-          for ( int u = 0; u <= occupancySizeU && !locationFound; ++u ) {
+          size_t span = 1;
+          for ( int u = 0; u <= occupancySizeU && !locationFound; u += int( span ) ) {
             patch.setU0( u );
             patch.setV0( v );
             if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                            safeguard ) ) {
+                                            safeguard, Tile(), &span ) ) {
               locationFound = true;
               if ( g_printDetailedInfo ) {
                 std::cout << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
@@ -1358,11 +1420,13 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
           }
         }
       } else {
-        // best effort
+        // best effort, a position is skipped when none of the orientations fits there
         for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-          for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
+          size_t span = 1;
+          for ( size_t u = 0; u < occupancySizeU && !locationFound; u += span ) {
             patch.setU0( u );
             patch.setV0( v );
+            span = occupancySizeU;
             for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound; orientationIdx++ ) {
               if ( packingStrategy == 0 )
                 patch.setPatchOrientation( PATCH_ORIENTATION_DEFAULT );
@@ -1373,14 +1437,16 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
                   patch.setPatchOrientation( g_orientationVertical[orientationIdx] );
                 }
               }
+              size_t orientationSpan = 1;
               if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                              safeguard ) ) {
+                                              safeguard, Tile(), &orientationSpan ) ) {
                 locationFound = true;
                 if ( g_printDetailedInfo ) {
                   std::cout << "Orientation " << patch.getPatchOrientation() << " selected for unmatched patch "
                             << patch.getIndex() << " (" << u << "," << v << ")" << std::endl;
                 }
               }
+              span = (std::min)( span, orientationSpan );
             }
           }
         }
@@ -1434,13 +1500,12 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
   auto& prevPatches = prevFrame.getPatches();
   if ( patches.empty() ) { return; }
   std::sort( patches.begin(), patches.end(), []( PCCPatch& a, PCCPatch& b ) { return a.gt( b ); } );
-  int              id             = 0;
-  size_t           occupancySizeU = presetWidth / params_.occupancyResolution_;
-  size_t           occupancySizeV = (std::max)( patches[0].getSizeU0(), patches[0].getSizeV0() );
-  vector<PCCPatch> matchedPatches;
-  vector<PCCPatch> tmpPatches;
-  matchedPatches.clear();
-  float thresholdIOU = 0.2F;
+  int                 id             = 0;
+  size_t              occupancySizeU = presetWidth / params_.occupancyResolution_;
+  size_t              occupancySizeV = (std::max)( patches[0].getSizeU0(), patches[0].getSizeV0() );
+  std::vector<size_t> matchedPatches;  // indexes of the matched patches, in the order of the matches
+  PCCPatchRectIndex   rectIndex( patches, isMatchedPatch );
+  float               thresholdIOU = 0.2F;
 
   // main loop.
   for ( auto& patch : prevPatches ) {
@@ -1448,35 +1513,24 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
     assert( patch.getSizeV0() <= occupancySizeV );
     id++;
     float maxIou  = 0.0;
-    int   bestIdx = -1;
-    int   cId     = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == -1 ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() ) ) {
-        Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
-        Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
-        float iou   = computeIOU( rect, crect );
-        if ( iou > maxIou ) {
-          maxIou  = iou;
-          bestIdx = cId;
-        }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
-    }
+    int   bestIdx = rectIndex.findBestMatch( patch, maxIou );
     if ( maxIou > thresholdIOU ) {
       // store the best match index
       patches[bestIdx].setBestMatchIdx( id - 1 );  // the matched patch id in preivious frame.
       patches[bestIdx].setPatchType( static_cast<uint8_t>( P_INTER ) );
-      matchedPatches.push_back( patches[bestIdx] );
+      rectIndex.setMatched( bestIdx );
+      matchedPatches.push_back( bestIdx );
     }
   }
 
   // generate new patch order.
-  vector<PCCPatch> newOrderPatches = matchedPatches;
-  for ( auto patch : patches ) {
+  vector<PCCPatch> newOrderPatches;
+  newOrderPatches.reserve( patches.size() );
+  for ( const auto& index : matchedPatches ) { newOrderPatches.push_back( std::move( patches[index] ) ); }
+  for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
-    if ( patch.getBestMatchIdx() == -1 ) { newOrderPatches.push_back( patch ); }
+    if ( patch.getBestMatchIdx() == -1 ) { newOrderPatches.push_back( std::move( patch ) ); }
   }
   frame.setNumMatchedPatches( matchedPatches.size() );
 
@@ -1485,7 +1539,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
     std::cout << "patches.size:" << patches.size() << ",reOrderedPatches.size:" << newOrderPatches.size()
               << ",matchedpatches.size:" << frame.getNumMatchedPatches() << std::endl;
   }
-  patches = newOrderPatches;
+  patches.swap( newOrderPatches );
   if ( g_printDetailedInfo ) {
     std::cout << "Patch order:" << std::endl;
     for ( auto& patch : patches ) {
@@ -1494,10 +1548,10 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
     }
   }
   for ( auto& patch : patches ) { occupancySizeU = (std::max)( occupancySizeU, patch.getSizeU0() + 1 ); }
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   std::vector<int> horizon;
   horizon.resize( occupancySizeU, 0 );
@@ -1664,29 +1718,15 @@ void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& tile, PCCFr
     return;
   }
 
-  vector<PCCPatch> matchedPatches;
-  int              id = 0;
-  matchedPatches.clear();
-  float thresholdIOU = 0.2F;
+  std::vector<size_t> matchedPatches;  // indexes of the matched patches, in the order of the matches
+  PCCPatchRectIndex   rectIndex( patches, isMatchedPatch );
+  int                 id           = 0;
+  float               thresholdIOU = 0.2F;
   // main loop.
   for ( auto& patch : prevPatches ) {
     id++;
     float maxIou  = 0.0F;
-    int   bestIdx = -1;
-    int   cId     = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == g_invalidPatchIndex ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() ) ) {
-        Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
-        Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
-        float iou   = computeIOU( rect, crect );
-        if ( iou > maxIou ) {
-          maxIou  = iou;
-          bestIdx = cId;
-        }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
-    }
+    int   bestIdx = rectIndex.findBestMatch( patch, maxIou );
     if ( maxIou > thresholdIOU ) {
       // checking the size of the matched patches
       auto&  curPatch = patches[bestIdx];
@@ -1709,17 +1749,20 @@ void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& tile, PCCFr
       } else {
         // store the best match index
         patches[bestIdx].setBestMatchIdx( id - 1 );  // the matched patch id in previous frame.
-        matchedPatches.push_back( patches[bestIdx] );
+        rectIndex.setMatched( bestIdx );
+        matchedPatches.push_back( bestIdx );
       }
     }
   }
   tile.setNumMatchedPatches( matchedPatches.size() );
-  vector<PCCPatch> newOrderPatches = matchedPatches;
-  for ( const auto& patch : patches ) {
-    if ( patch.getBestMatchIdx() == g_invalidPatchIndex ) { newOrderPatches.push_back( patch ); }
+  vector<PCCPatch> newOrderPatches;
+  newOrderPatches.reserve( patches.size() );
+  for ( const auto& index : matchedPatches ) { newOrderPatches.push_back( std::move( patches[index] ) ); }
+  for ( auto& patch : patches ) {
+    if ( patch.getBestMatchIdx() == g_invalidPatchIndex ) { newOrderPatches.push_back( std::move( patch ) ); }
   }
   tile.setNumMatchedPatches( matchedPatches.size() );
-  patches = newOrderPatches;
+  patches.swap( newOrderPatches );
   if ( g_printDetailedInfo ) {
     for ( int patchIdx = 0; patchIdx < patches.size(); patchIdx++ ) {
       auto& patch = patches[patchIdx];
@@ -1991,7 +2034,7 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context,
       }
       numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
 
-      std::vector<bool> occupancyMap;
+      PCCOccupancyCanvas occupancyMap;
       occupancyMap.resize( occupancySizeU * occupancySizeV, false );
       int indNextMatchedPatch = 0;
       // patch loop
@@ -2328,9 +2371,9 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
   if ( patches.empty() ) {
     if ( tile.getNumberOfRawPointsPatches() == 0 ) { return; }
     if ( tile.getUseRawPointsSeparateVideo() ) { return; }
-    std::vector<bool> occupancyMap;
-    size_t            occupancySizeU = presetWidth / params_.occupancyResolution_;
-    size_t            occupancySizeV = presetHeight / params_.occupancyResolution_;
+    PCCOccupancyCanvas occupancyMap;
+    size_t             occupancySizeU = presetWidth / params_.occupancyResolution_;
+    size_t             occupancySizeV = presetHeight / params_.occupancyResolution_;
     if ( presetWidth == 0 || presetHeight == 0 ) {
       auto& rawPointsPatch = tile.getRawPointsPatch( 0 );
       auto  rawPointsPatchBlocks =
@@ -2386,11 +2429,11 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
   int tileHeight  = int( tileWidth * params_.tileHeightToWidthRatio_ );
   if ( params_.enablePointCloudPartitioning_ )
     std::cout << "frame " << tile.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
-  occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  int               numOrientations = ( packingStrategy == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
+  occupancySizeV                     = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
+  int                numOrientations = ( packingStrategy == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
@@ -2398,10 +2441,13 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
     bool  locationFound = false;
     auto& occupancy     = patch.getOccupancy();
     while ( !locationFound ) {
+      // first fit, a position is skipped when none of the orientations fits there
       for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-        for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
+        size_t span = 1;
+        for ( size_t u = 0; u < occupancySizeU && !locationFound; u += span ) {
           patch.setU0( u );
           patch.setV0( v );
+          span = occupancySizeU;
           for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound; orientationIdx++ ) {
             if ( packingStrategy == 0 )
               patch.setPatchOrientation( PATCH_ORIENTATION_DEFAULT );
@@ -2412,14 +2458,16 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
                 patch.setPatchOrientation( g_orientationVertical[orientationIdx] );
               }
             }
+            size_t orientationSpan = 1;
             if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                            safeguard ) ) {
+                                            safeguard, Tile(), &orientationSpan ) ) {
               locationFound = true;
               if ( g_printDetailedInfo ) {
                 std::cout << "Orientation " << patch.getPatchOrientation() << " selected for patch " << patch.getIndex()
                           << " (" << u << "," << v << ")" << std::endl;
               }
             }
+            span = (std::min)( span, orientationSpan );
           }
         }
       }
@@ -2479,15 +2527,15 @@ void PCCEncoder::packMultipleTiles( PCCAtlasFrameContext& atlasFrame, int safegu
   int tileHeight = int( tileWidth * params_.tileHeightToWidthRatio_ );
   if ( params_.enablePointCloudPartitioning_ )
     std::cout << "frame " << frame.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
-  occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  occupancySizeV                     = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
-  std::vector<Tile> tilesNotAvailable;  // set of all tiles occupied by prev ROIs of current ROI
-  int               lastOccupiedTileIndex          = -1;
-  int               lastOccupiedTileIndexByPrevROI = -1;
+  std::vector<Tile>  tilesNotAvailable;  // set of all tiles occupied by prev ROIs of current ROI
+  int                lastOccupiedTileIndex          = -1;
+  int                lastOccupiedTileIndexByPrevROI = -1;
   // loop over ROIs
   for ( int roiIndex = 0; roiIndex < numROIs; ++roiIndex ) {
     tilesNotAvailable.clear();
@@ -2604,15 +2652,15 @@ void PCCEncoder::packFlexibleMultipleTiles( PCCAtlasFrameContext& atlasFrame, in
 
   // initializating the tile map to -1 (not assigned)
   partitionToTileMap.resize( numTilesHor * numTilesVer, -1 );
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  int               numOrientations = params_.useEightOrientations_ ? 8 : 2;
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
+  int                numOrientations = params_.useEightOrientations_ ? 8 : 2;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
-  std::vector<Tile> tilesNotAvailable;
-  int               lastOccupiedTileIndex          = -1;
-  int               lastOccupiedTileIndexByPrevROI = -1;
+  std::vector<Tile>  tilesNotAvailable;
+  int                lastOccupiedTileIndex          = -1;
+  int                lastOccupiedTileIndexByPrevROI = -1;
   // loop over ROIs
   for ( int roiIndex = 0; roiIndex < numROIs; ++roiIndex ) {
     // calculate the position which the tile group will start: top left available tile
@@ -2766,10 +2814,10 @@ void PCCEncoder::spatialConsistencyPackMultipleTiles( PCCAtlasFrameContext& atla
   size_t occupancySizeU = params_.minimumImageWidth_ / params_.occupancyResolution_;
   size_t occupancySizeV =
       (std::max)( params_.minimumImageHeight_ / params_.occupancyResolution_, patches[0].getSizeV0() );
-  vector<PCCPatch> matchedPatches, tmpPatches, newOrderPatches;
-  matchedPatches.clear();
-  newOrderPatches.clear();
-  float thresholdIOU = 0.2f;
+  std::vector<size_t> matchedPatches;  // indexes of the matched patches, in the order of the matches
+  vector<PCCPatch>    newOrderPatches;
+  PCCPatchRectIndex   rectIndex( patches, isMatchedPatch, true );
+  float               thresholdIOU = 0.2f;
 
   // main loop. (NOTICE: enforcing the match to be from the same ROI)
   for ( auto& patch : prevPatches ) {
@@ -2777,62 +2825,50 @@ void PCCEncoder::spatialConsistencyPackMultipleTiles( PCCAtlasFrameContext& atla
     assert( patch.getSizeV0() <= occupancySizeV );
     id++;
     float maxIou  = 0.0f;
-    int   bestIdx = -1, cId = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == g_invalidPatchIndex ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() ) &&
-           ( patch.getRoiIndex() == cpatch.getRoiIndex() ) ) {
-        Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
-        Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
-        float iou   = computeIOU( rect, crect );
-        if ( iou > maxIou ) {
-          maxIou  = iou;
-          bestIdx = cId;
-        }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
-    }
+    int   bestIdx = rectIndex.findBestMatch( patch, maxIou );
     if ( maxIou > thresholdIOU ) {
       // store the best match index
       patches[bestIdx].setBestMatchIdx( id - 1 );  // the matched patch id in previous frame.
       patches[bestIdx].setPatchType( (uint8_t)P_INTER );
-      matchedPatches.push_back( patches[bestIdx] );
+      rectIndex.setMatched( bestIdx );
+      matchedPatches.push_back( bestIdx );
     }
   }
 
   // generate new patch order.
-  newOrderPatches = matchedPatches;
-  for ( auto patch : patches ) {
+  newOrderPatches.reserve( patches.size() );
+  for ( const auto& index : matchedPatches ) { newOrderPatches.push_back( std::move( patches[index] ) ); }
+  for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
     if ( patch.getBestMatchIdx() == g_invalidPatchIndex ) {
       patch.setPatchType( (uint8_t)P_INTRA );  // P_TYPE_INTRA
-      newOrderPatches.push_back( patch );
+      newOrderPatches.push_back( std::move( patch ) );
     }
   }
 
   frame.setNumMatchedPatches( matchedPatches.size() );
   // remove the below logs when useless.
-  patches = newOrderPatches;
+  patches.swap( newOrderPatches );
   for ( auto& patch : patches ) { occupancySizeU = (std::max)( occupancySizeU, patch.getSizeU0() + 1 ); }
   int numTilesHor = params_.numTilesHor_;
   int tileWidth   = occupancySizeU / numTilesHor;
   int tileHeight  = int( tileWidth * params_.tileHeightToWidthRatio_ );
   if ( params_.enablePointCloudPartitioning_ )
     std::cout << "frame " << frame.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
-  occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  occupancySizeV                     = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
-  std::vector<Tile> tilesNotAvailable;
-  int               numROIs                        = params_.numROIs_;
-  int               lastOccupiedTileIndex          = -1;
-  int               lastOccupiedTileIndexHor       = -1;
-  int               lastOccupiedTileIndexVer       = -1;
-  int               lastOccupiedTileIndexByPrevROI = -1;
-  int               numTilesAvailable;
+  std::vector<Tile>  tilesNotAvailable;
+  int                numROIs                        = params_.numROIs_;
+  int                lastOccupiedTileIndex          = -1;
+  int                lastOccupiedTileIndexHor       = -1;
+  int                lastOccupiedTileIndexVer       = -1;
+  int                lastOccupiedTileIndexByPrevROI = -1;
+  int                numTilesAvailable;
   // loop over ROIs
   for ( size_t roiIndex = 0; roiIndex < numROIs; ++roiIndex ) {
     // find top left corner to start placing the tile group, and determine the maximum horizontal size
@@ -2925,46 +2961,35 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
   int              id             = 0;
   size_t           occupancySizeU = params_.minimumImageWidth_ / params_.occupancyResolution_;
   size_t           occupancySizeV = (std::max)( patches[0].getSizeU0(), patches[0].getSizeV0() );
-  vector<PCCPatch> matchedPatches, tmpPatches;
-  matchedPatches.clear();
-  float  thresholdIOU    = 0.2f;
-  size_t bestRefFrameIdx = 0;
+  std::vector<size_t> matchedPatches;  // indexes of the matched patches, in the order of the matches
+  PCCPatchRectIndex   rectIndex( patches, isMatchedPatch, true );
+  float               thresholdIOU    = 0.2f;
+  size_t              bestRefFrameIdx = 0;
   // main loop. (NOTE: enforcing the matches to be from the same ROI)
   for ( auto& patch : prevPatches ) {
     id++;
-    float maxIou  = 0.0f;
-    int   bestIdx = -1, cId = 0;
-    for ( auto& cpatch : patches ) {
-      if ( ( patch.getViewId() == cpatch.getViewId() ) && ( cpatch.getBestMatchIdx() == g_invalidPatchIndex ) &&
-           ( patch.getLodScaleX() == cpatch.getLodScaleX() && patch.getLodScaleY() == cpatch.getLodScaleY() &&
-             ( patch.getRoiIndex() == cpatch.getRoiIndex() ) ) ) {
-        patch.setPatchType( (uint8_t)P_INTRA );
-        Rect  rect  = Rect( patch.getU1(), patch.getV1(), patch.getSizeU(), patch.getSizeV() );
-        Rect  crect = Rect( cpatch.getU1(), cpatch.getV1(), cpatch.getSizeU(), cpatch.getSizeV() );
-        float iou   = computeIOU( rect, crect );
-        if ( iou > maxIou ) {
-          maxIou  = iou;
-          bestIdx = cId;
-        }
-      }  // end of if (patch.viewId == cpatch.viewId).
-      cId++;
-    }
+    float maxIou = 0.0f;
+    if ( rectIndex.hasCandidate( patch ) ) { patch.setPatchType( (uint8_t)P_INTRA ); }
+    int bestIdx = rectIndex.findBestMatch( patch, maxIou );
     if ( maxIou > thresholdIOU ) {
       // store the best match index
       patches[bestIdx].setBestMatchIdx( id - 1 );  // the matched patch id in preivious frame.
       patches[bestIdx].setPatchType( (uint8_t)P_INTER );
       patches[bestIdx].setRefAtlasFrameIndex( bestRefFrameIdx );
-      matchedPatches.push_back( patches[bestIdx] );
+      rectIndex.setMatched( bestIdx );
+      matchedPatches.push_back( bestIdx );
     }
   }
   // generate new patch order.
-  vector<PCCPatch> newOrderPatches = matchedPatches;
-  for ( auto patch : patches ) {
+  vector<PCCPatch> newOrderPatches;
+  newOrderPatches.reserve( patches.size() );
+  for ( const auto& index : matchedPatches ) { newOrderPatches.push_back( std::move( patches[index] ) ); }
+  for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
     if ( patch.getBestMatchIdx() == g_invalidPatchIndex ) {
       patch.setPatchType( (uint8_t)P_INTRA );
-      newOrderPatches.push_back( patch );
+      newOrderPatches.push_back( std::move( patch ) );
     }
   }
   frame.setNumMatchedPatches( matchedPatches.size() );
@@ -2973,7 +2998,7 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
     std::cout << "patches.size:" << patches.size() << ",reOrderedPatches.size:" << newOrderPatches.size()
               << ",matchedpatches.size:" << frame.getNumMatchedPatches() << std::endl;
   }
-  patches = newOrderPatches;
+  patches.swap( newOrderPatches );
   if ( g_printDetailedInfo ) {
     std::cout << "Patch order:" << std::endl;
     for ( auto& patch : patches ) {
@@ -2994,11 +3019,11 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
   int numTilesVer = occupancySizeV / tileHeight;
   // initializating the tile map to -1 (not assigned)
   partitionToTileMap.resize( numTilesHor * numTilesVer, -1 );
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  int               numOrientations = params_.useEightOrientations_ ? 8 : 2;
-  std::vector<bool> occupancyMap;
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  int                numOrientations = params_.useEightOrientations_ ? 8 : 2;
+  PCCOccupancyCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   // loop over ROIs
   for ( size_t roiIndex = 0; roiIndex < numROIs; ++roiIndex ) {
@@ -3233,10 +3258,10 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
   size_t occupancySizeU = presetWidth / params_.occupancyResolution_;
   size_t occupancySizeV = (std::max)( patches[0].getSizeV0(), patches[0].getSizeU0() );
   for ( auto& patch : patches ) { occupancySizeU = (std::max)( occupancySizeU, patch.getSizeU0() + 1 ); }
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  width                              = occupancySizeU * params_.occupancyResolution_;
+  height                             = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   std::vector<int> horizon;
   horizon.resize( occupancySizeU, 0 );
@@ -3355,13 +3380,13 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
   std::cout << "actualImageSize(packTetris) " << width << " x " << height << std::endl;
 }
 
-void PCCEncoder::packEOMAttributePointsPatch( PCCFrameContext&   frame,
-                                              std::vector<bool>& occupancyMap,
-                                              size_t             width,
-                                              size_t&            height,
-                                              size_t             occupancySizeU,
-                                              size_t             occupancySizeV,
-                                              size_t             maxOccupancyRow ) {
+void PCCEncoder::packEOMAttributePointsPatch( PCCFrameContext&    frame,
+                                              PCCOccupancyCanvas& occupancyMap,
+                                              size_t              width,
+                                              size_t&             height,
+                                              size_t              occupancySizeU,
+                                              size_t              occupancySizeV,
+                                              size_t              maxOccupancyRow ) {
   if ( !params_.useRawPointsSeparateVideo_ ) { assert( width == frame.getWidth() ); }
   auto&  eomPatches = frame.getEomPatches();
   size_t lastHeight = height;
@@ -3431,13 +3456,13 @@ size_t PCCEncoder::packRawPointsPatchSimple( PCCFrameContext& tile,
   return totalHeight;
 }
 
-size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&   tile,
-                                       std::vector<bool>& occupancyMap,
-                                       size_t             width,
-                                       size_t&            height,
-                                       size_t             occupancySizeU,
-                                       size_t             occupancySizeV,
-                                       size_t             maxOccupancyRow ) {
+size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&    tile,
+                                       PCCOccupancyCanvas& occupancyMap,
+                                       size_t              width,
+                                       size_t&             height,
+                                       size_t              occupancySizeU,
+                                       size_t              occupancySizeV,
+                                       size_t              maxOccupancyRow ) {
   size_t numberOfRawPointsPatches = tile.getNumberOfRawPointsPatches();
   size_t safeguard                = 0;
   for ( int i = 0; i < numberOfRawPointsPatches; i++ ) {
@@ -3482,11 +3507,12 @@ size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&   tile,
     while ( !locationFound ) {
       patch.setPatchOrientation( PATCH_ORIENTATION_DEFAULT );
       for ( int v = maxOccupancyRow; v <= occupancySizeV && !locationFound; ++v ) {
-        for ( int u = 0; u <= occupancySizeU && !locationFound; ++u ) {
+        size_t span = 1;
+        for ( int u = 0; u <= occupancySizeU && !locationFound; u += int( span ) ) {
           patch.setU0( u );
           patch.setV0( v );
           if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                          safeguard ) ) {
+                                          safeguard, Tile(), &span ) ) {
             locationFound = true;
           }
         }
@@ -3640,7 +3666,9 @@ bool PCCEncoder::generateScaledGeometry( PCCFrameContext& title ) {
 }
 
 bool PCCEncoder::generateSegments( const PCCPointSet3&                 source,
+                                   const PCCKdTree&                    kdtree,
                                    PCCAtlasFrameContext&               frameContext,
+                                   PCCPatchSegmenter3&                 segmenter,
                                    const PCCPatchSegmenter3Parameters& segmenterParams,
                                    size_t                              frameIndex,
                                    float&                              distanceSrcRec ) {
@@ -3649,12 +3677,10 @@ bool PCCEncoder::generateSegments( const PCCPointSet3&                 source,
   if ( segmenterParams.additionalProjectionPlaneMode_ != 5 ) {
     auto& patches = frame.getPatches();
     patches.reserve( 256 );
-    PCCPatchSegmenter3 segmenter;
-    segmenter.setNbThread( params_.nbThread_ );
-    segmenter.compute( source, frame.getFrameIndex(), segmenterParams, patches, frame.getSrcPointCloudByPatch(),
-                       distanceSrcRec );
+    segmenter.compute( source, kdtree, frame.getFrameIndex(), segmenterParams, patches,
+                       frame.getSrcPointCloudByPatch(), distanceSrcRec );
   } else {
-    segmentationPartiallyAddtinalProjectionPlane( source, frame, segmenterParams, frameIndex, distanceSrcRec );
+    segmentationPartiallyAddtinalProjectionPlane( source, kdtree, frame, segmenterParams, frameIndex, distanceSrcRec );
   }
   if ( frame.getRawPatchEnabledFlag() ) {
     generateRawPointsPatch( source, frame, segmenterParams.useEnhancedOccupancyMapCode_ );
@@ -4388,12 +4414,12 @@ void PCCEncoder::placeAuxiliaryPointsTiles( PCCContext& context ) {
     // set height
     for ( size_t tileIdx = 0; tileIdx < numTilesInSeg; tileIdx++ ) {
       for ( size_t frameIdx = firstFrame; frameIdx < lastFrame; frameIdx++ ) {
-        auto&             tile = context[frameIdx].getTile( tileIdx );
-        std::vector<bool> auxPointsOccupancyMap;
-        size_t            auxPointsOccupancySizeU = maxWidth / params_.occupancyResolution_;
-        size_t            auxPointsOccupancySizeV = 1;
-        size_t            auxPointsTileHeight     = 0;
-        size_t            auxPointsTileWidth      = maxWidth;
+        auto&              tile = context[frameIdx].getTile( tileIdx );
+        PCCOccupancyCanvas auxPointsOccupancyMap;
+        size_t             auxPointsOccupancySizeU = maxWidth / params_.occupancyResolution_;
+        size_t             auxPointsOccupancySizeV = 1;
+        size_t             auxPointsTileHeight     = 0;
+        size_t             auxPointsTileWidth      = maxWidth;
         auxPointsOccupancyMap.resize( auxPointsOccupancySizeU * auxPointsOccupancySizeV, false );
         if ( tile.getRawPointsPatches().size() == 0 ) {
           printf( "packRawPointsPatch[0/0]: none\n" );
@@ -4642,6 +4668,8 @@ bool PCCEncoder::generateSegments( const PCCGroupOfFrames& sources, PCCContext&
   params.iterationCountRefineSegmentation_    = params_.iterationCountRefineSegmentation_;
   params.voxelDimensionRefineSegmentation_    = params_.voxelDimensionRefineSegmentation_;
   params.searchRadiusRefineSegmentation_      = params_.searchRadiusRefineSegmentation_;
+  params.temporalRefineSegmentation_          = params_.temporalRefineSegmentation_;
+  params.maxDist2TemporalRefineSegmentation_  = params_.maxDist2TemporalRefineSegmentation_;
   params.occupancyResolution_                 = params_.occupancyResolution_;
   params.enablePatchSplitting_                = params_.enablePatchSplitting_;
   params.maxPatchSize_                        = params_.maxPatchSize_;
@@ -4685,10 +4713,13 @@ bool PCCEncoder::generateSegments( const PCCGroupOfFrames& sources, PCCContext&
   if ( params_.additionalProjectionPlaneMode_ == 0 || params_.additionalProjectionPlaneMode_ == 5 ) {
     params.weightNormal_ = calculateWeightNormal( params.geometryBitDepth3D_, sources[0] );
   }
+  // the segmenter is shared by the frames of the group so that they can reuse the segmentation of the previous one
+  PCCPatchSegmenter3 segmenter;
+  segmenter.setNbThread( params_.nbThread_ );
   float sumDistanceSrcRec = 0;
   for ( size_t i = 0; i < frames.size(); i++ ) {
     float distanceSrcRec = 0;
-    if ( !generateSegments( sources[i], frames[i], params, i, distanceSrcRec ) ) {
+    if ( !generateSegments( sources[i], sources.getKdTree( i ), frames[i], segmenter, params, i, distanceSrcRec ) ) {
       res = false;
       break;
     }
@@ -4899,9 +4930,9 @@ size_t PCCEncoder::generateTilesFromImage( PCCContext& context ) {
         tile.getEomPatches().push_back( eomPatch );
         // relocate eomPatches in the tile
         if ( !tile.getUseRawPointsSeparateVideo() ) {
-          std::vector<bool> occupancyMap;
-          size_t            occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
-          size_t            occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
+          PCCOccupancyCanvas occupancyMap;
+          size_t             occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
+          size_t             occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
           occupancyMap.resize( occupancySizeU * occupancySizeV );
           packEOMAttributePointsPatch( tile, occupancyMap, tile.getWidth(), tile.getHeight(), occupancySizeU,
                                        occupancySizeV, 0 );
@@ -4921,9 +4952,9 @@ size_t PCCEncoder::generateTilesFromImage( PCCContext& context ) {
       tile.getPatches().clear();
       tile.setWidth( frame.getWidth() );
       tile.setHeight( params_.tilePartitionHeight_ * 64 );
-      std::vector<bool> occupancyMap;
-      size_t            occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
-      size_t            occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
+      PCCOccupancyCanvas occupancyMap;
+      size_t             occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
+      size_t             occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
       occupancyMap.resize( occupancySizeU * occupancySizeV );
       if ( tile.getNumberOfRawPointsPatches() > 0 && !tile.getUseRawPointsSeparateVideo() ) {
         size_t height = tile.getHeight();
@@ -5338,121 +5369,129 @@ void PCCEncoder::pointLocalReconstructionSearch( PCCContext&
   size_t       nbOfOptimizationMode = context.getPointLocalReconstructionModeNumber();
   const size_t imageWidth           = videoMultiple[0].getWidth();
   const size_t imageHeight          = videoMultiple[0].getHeight();
-  for ( size_t patchIndex = 0; patchIndex < patchCount; ++patchIndex ) {
-    const size_t  patchIndexPlusOne = patchIndex + 1;
-    auto&         patch             = patches[patchIndex];
-    const size_t& patchSize         = patch.getSizeU0() * patch.getSizeV0();
-    if ( patchSize == 1 || patchSize <= params_.patchSize_ ) {
-      patch.getPointLocalReconstructionLevel()     = 1;
-      auto&                     srcPointCloudPatch = frame.getSrcPointCloudByPatch( patch.getOriginalIndex() );
-      std::vector<PCCPointSet3> reconstruct;
-      std::vector<float>        distance;
-      reconstruct.resize( nbOfOptimizationMode );
-      distance.resize( nbOfOptimizationMode );
-      size_t optimizationIndex    = 0;
-      size_t optimizationIndexMin = 0;
-      for ( size_t i = 0; i < nbOfOptimizationMode; i++ ) {
-        auto& mode = context.getPointLocalReconstructionMode( i );
-        for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
-          for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
-            const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
-            if ( blockToPatch[blockIndex] == patchIndexPlusOne ) {
-              for ( size_t v1 = 0; v1 < patch.getOccupancyResolution(); ++v1 ) {
-                const size_t v = v0 * patch.getOccupancyResolution() + v1;
-                for ( size_t u1 = 0; u1 < patch.getOccupancyResolution(); ++u1 ) {
-                  const size_t u = u0 * patch.getOccupancyResolution() + u1;
-                  size_t       x;
-                  size_t       y;
-                  const bool   occupancy = occupancyMap[patch.patch2Canvas( u, v, imageWidth, imageHeight, x, y )] != 0;
-                  if ( !occupancy ) { continue; }
-                  auto createdPoints = generatePoints( params, frame, videoMultiple, frameIndex, patchIndex, u, v, x, y,
-                                                       mode.interpolate_, mode.filling_, mode.minD1_, mode.neighbor_ );
-                  if ( !createdPoints.empty() ) {
-                    for ( const auto& createdPoint : createdPoints ) {
-                      reconstruct[optimizationIndex].addPoint( createdPoint );
-                    }
-                  }
-                }
+
+  // the patches only update their own PLR modes: they are evaluated in parallel. The scratch buffers are owned by
+  // the task of a patch, the nearest neighbor searches start nested parallel loops.
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( size_t( 0 ), patchCount, [&]( const size_t patchIndex ) {
+      const size_t            patchIndexPlusOne  = patchIndex + 1;
+      auto&                   patch              = patches[patchIndex];
+      const size_t            patchSize          = patch.getSizeU0() * patch.getSizeV0();
+      const size_t            resolution         = patch.getOccupancyResolution();
+      const auto&             srcPointCloudPatch = frame.getSrcPointCloudByPatch( patch.getOriginalIndex() );
+      std::vector<PCCPoint3D> createdPoints;
+      PCCPointSet3            reconstruct;
+      auto addBlockPoints = [&]( const PointLocalReconstructionMode& mode, const size_t u0, const size_t v0,
+                                 const bool rotate ) {
+        for ( size_t v1 = 0; v1 < resolution; ++v1 ) {
+          const size_t v = v0 * resolution + v1;
+          for ( size_t u1 = 0; u1 < resolution; ++u1 ) {
+            const size_t u = u0 * resolution + u1;
+            size_t       x;
+            size_t       y;
+            const bool   occupancy = occupancyMap[patch.patch2Canvas( u, v, imageWidth, imageHeight, x, y )] != 0;
+            if ( !occupancy ) { continue; }
+            generatePoints( params, frame, videoMultiple, frameIndex, patchIndex, u, v, x, y, createdPoints,
+                            mode.interpolate_, mode.filling_, mode.minD1_, mode.neighbor_ );
+            for ( const auto& createdPoint : createdPoints ) {
+              if ( !rotate || patch.getAxisOfAdditionalPlane() == 0 ) {
+                reconstruct.addPoint( createdPoint );
+              } else {
+                PCCVector3D tmp;
+                inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(), params.geometryBitDepth3D_,
+                                                     createdPoint, tmp );
+                reconstruct.addPoint( tmp );
               }
             }
           }
         }
+      };
+      // a mode is scored by the largest of its two distances to the source. The index of the source points is
+      // shared by the modes and the distance to it is computed first: when it already reaches the best distance,
+      // the mode is discarded without indexing its reconstruction.
+      auto isBetterMode = [&]( const PCCPointSet3& srcPointCloud, const PCCKdTree& srcKdTree, const bool first,
+                               float& distanceMin ) {
         float distancePSrcRec;
         float distancePRecSrc;
-        srcPointCloudPatch.distanceGeo( reconstruct[optimizationIndex], distancePSrcRec, distancePRecSrc );
-        distance[optimizationIndex] = (std::max)( distancePSrcRec, distancePRecSrc );
-        if ( optimizationIndex == 0 || distance[optimizationIndexMin] > distance[optimizationIndex] ) {
-          optimizationIndexMin = optimizationIndex;
-          patch.setPointLocalReconstructionMode( optimizationIndexMin );
+        reconstruct.distance( srcKdTree, distancePRecSrc );
+        if ( !first && reconstruct.getPointCount() > 0 && !( distanceMin > distancePRecSrc ) ) { return false; }
+        PCCKdTree recKdTree( reconstruct );
+        srcPointCloud.distance( recKdTree, distancePSrcRec );
+        const float distance = ( std::max )( distancePSrcRec, distancePRecSrc );
+        if ( first || distanceMin > distance ) {
+          distanceMin = distance;
+          return true;
+        }
+        return false;
+      };
+      if ( patchSize == 1 || patchSize <= params_.patchSize_ ) {
+        patch.getPointLocalReconstructionLevel() = 1;
+        const PCCKdTree srcKdTree( srcPointCloudPatch );
+        size_t          optimizationIndexMin = 0;
+        float           distanceMin          = 0.F;
+        for ( size_t optimizationIndex = 0; optimizationIndex < nbOfOptimizationMode; optimizationIndex++ ) {
+          auto& mode = context.getPointLocalReconstructionMode( optimizationIndex );
+          reconstruct.clear();
+          for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
+            for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
+              const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
+              if ( blockToPatch[blockIndex] == patchIndexPlusOne ) { addBlockPoints( mode, u0, v0, false ); }
+            }
+          }
+          if ( isBetterMode( srcPointCloudPatch, srcKdTree, optimizationIndex == 0, distanceMin ) ) {
+            optimizationIndexMin = optimizationIndex;
+          }
         }
-        optimizationIndex++;
-      }
-    } else {
-      patch.getPointLocalReconstructionLevel() = 0;
-      for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
-        for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
-          patch.setPointLocalReconstructionMode( u0, v0, 0 );
-          const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
-          if ( blockToPatch[blockIndex] == patchIndexPlusOne ) {
-            auto&        srcPointCloudPatch = frame.getSrcPointCloudByPatch( patch.getOriginalIndex() );
-            PCCPointSet3 blockSrcPointCloud;
-            const size_t xMin = u0 * patch.getOccupancyResolution() + patch.getU1();
-            const size_t yMin = v0 * patch.getOccupancyResolution() + patch.getV1();
-            for ( size_t i = 0; i < srcPointCloudPatch.getPointCount(); i++ ) {
-              if ( xMin <= srcPointCloudPatch[i][patch.getTangentAxis()] &&
-                   srcPointCloudPatch[i][patch.getTangentAxis()] < xMin + patch.getOccupancyResolution() &&
-                   yMin <= srcPointCloudPatch[i][patch.getBitangentAxis()] &&
-                   srcPointCloudPatch[i][patch.getBitangentAxis()] < yMin + patch.getOccupancyResolution() ) {
-                blockSrcPointCloud.addPoint( srcPointCloudPatch[i] );
-              }
+        patch.setPointLocalReconstructionMode( optimizationIndexMin );
+      } else {
+        patch.getPointLocalReconstructionLevel() = 0;
+        // source points of the patch sorted by block, in their order: blockPoints[blockStarts[b]..blockStarts[b+1]]
+        std::vector<size_t> blockStarts( patchSize + 1, 0 );
+        std::vector<size_t> pointBlocks( srcPointCloudPatch.getPointCount(), patchSize );
+        std::vector<size_t> blockPoints;
+        for ( size_t i = 0; i < srcPointCloudPatch.getPointCount(); i++ ) {
+          const int64_t u = int64_t( srcPointCloudPatch[i][patch.getTangentAxis()] ) - int64_t( patch.getU1() );
+          const int64_t v = int64_t( srcPointCloudPatch[i][patch.getBitangentAxis()] ) - int64_t( patch.getV1() );
+          if ( u < 0 || v < 0 ) { continue; }
+          const size_t u0 = size_t( u ) / resolution;
+          const size_t v0 = size_t( v ) / resolution;
+          if ( u0 >= patch.getSizeU0() || v0 >= patch.getSizeV0() ) { continue; }
+          pointBlocks[i] = v0 * patch.getSizeU0() + u0;
+          blockStarts[pointBlocks[i] + 1]++;
+        }
+        for ( size_t b = 0; b < patchSize; b++ ) { blockStarts[b + 1] += blockStarts[b]; }
+        blockPoints.resize( blockStarts[patchSize] );
+        std::vector<size_t> blockEnds( blockStarts.begin(), blockStarts.end() - 1 );
+        for ( size_t i = 0; i < pointBlocks.size(); i++ ) {
+          if ( pointBlocks[i] < patchSize ) { blockPoints[blockEnds[pointBlocks[i]]++] = i; }
+        }
+        PCCPointSet3 blockSrcPointCloud;
+        for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
+          for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
+            patch.setPointLocalReconstructionMode( u0, v0, 0 );
+            const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
+            if ( blockToPatch[blockIndex] != patchIndexPlusOne ) { continue; }
+            const size_t block = v0 * patch.getSizeU0() + u0;
+            blockSrcPointCloud.clear();
+            for ( size_t i = blockStarts[block]; i < blockStarts[block + 1]; i++ ) {
+              blockSrcPointCloud.addPoint( srcPointCloudPatch[blockPoints[i]] );
             }
-            std::vector<PCCPointSet3> reconstruct;
-            std::vector<float>        distance;
-            reconstruct.resize( nbOfOptimizationMode );
-            distance.resize( nbOfOptimizationMode );
-            size_t optimizationIndex    = 0;
-            size_t optimizationIndexMin = 0;
-            for ( size_t i = 0; i < nbOfOptimizationMode; i++ ) {
-              auto& mode = context.getPointLocalReconstructionMode( i );
-              for ( size_t v1 = 0; v1 < patch.getOccupancyResolution(); ++v1 ) {
-                const size_t v = v0 * patch.getOccupancyResolution() + v1;
-                for ( size_t u1 = 0; u1 < patch.getOccupancyResolution(); ++u1 ) {
-                  const size_t u = u0 * patch.getOccupancyResolution() + u1;
-                  size_t       x;
-                  size_t       y;
-                  const bool   occupancy = occupancyMap[patch.patch2Canvas( u, v, imageWidth, imageHeight, x, y )] != 0;
-                  if ( !occupancy ) { continue; }
-                  auto createdPoints = generatePoints( params, frame, videoMultiple, frameIndex, patchIndex, u, v, x, y,
-                                                       mode.interpolate_, mode.filling_, mode.minD1_, mode.neighbor_ );
-                  if ( !createdPoints.empty() ) {
-                    for ( const auto& createdPoint : createdPoints ) {
-                      if ( patch.getAxisOfAdditionalPlane() == 0 ) {
-                        reconstruct[optimizationIndex].addPoint( createdPoint );
-                      } else {
-                        PCCVector3D tmp;
-                        inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(),
-                                                             params.geometryBitDepth3D_, createdPoint, tmp );
-                        reconstruct[optimizationIndex].addPoint( tmp );
-                      }
-                    }
-                  }
-                }
-              }
-              float distancePSrcRec;
-              float distancePRecSrc;
-              blockSrcPointCloud.distanceGeo( reconstruct[optimizationIndex], distancePSrcRec, distancePRecSrc );
-              distance[optimizationIndex] = (std::max)( distancePSrcRec, distancePRecSrc );
-              if ( optimizationIndex == 0 || distance[optimizationIndexMin] > distance[optimizationIndex] ) {
+            const PCCKdTree srcKdTree( blockSrcPointCloud );
+            size_t          optimizationIndexMin = 0;
+            float           distanceMin          = 0.F;
+            for ( size_t optimizationIndex = 0; optimizationIndex < nbOfOptimizationMode; optimizationIndex++ ) {
+              reconstruct.clear();
+              addBlockPoints( context.getPointLocalReconstructionMode( optimizationIndex ), u0, v0, true );
+              if ( isBetterMode( blockSrcPointCloud, srcKdTree, optimizationIndex == 0, distanceMin ) ) {
                 optimizationIndexMin = optimizationIndex;
-                patch.setPointLocalReconstructionMode( u0, v0, optimizationIndexMin );
               }
-              optimizationIndex++;
             }
-          }  // if block is used
+            patch.setPointLocalReconstructionMode( u0, v0, optimizationIndexMin );
+          }
         }
       }
-    }
-  }  // patch
+    } );
+  } );
 }
 
 bool PCCEncoder::resizeGeometryVideo( PCCContext& context, PCCCodecId codecId ) {
@@ -5644,9 +5683,9 @@ bool PCCEncoder::generateGeometryVideo( const PCCGroupOfFrames& sources, PCCCont
       generateIntraImage( frameInfos[i], 0, frame0 );
       auto& frame1 = videoGeometryMultiple[1].getFrame( geometryVideoSize );
       generateIntraImage( frameInfos[i], 1, frame1 );
-      dilate3DPadding( sources[i], frameInfos[i], frame, frame0, videoOccupancyMap.getFrame( i ) );
+      dilate3DPadding( sources.getKdTree( i ), frameInfos[i], frame, frame0, videoOccupancyMap.getFrame( i ) );
       if ( params_.absoluteD1_ ) {
-        dilate3DPadding( sources[i], frameInfos[i], frame, frame1, videoOccupancyMap.getFrame( i ) );
+        dilate3DPadding( sources.getKdTree( i ), frameInfos[i], frame, frame1, videoOccupancyMap.getFrame( i ) );
       }
     } else {
       const size_t geometryVideoSize = videoGeometry.getFrameCount();
@@ -5658,7 +5697,7 @@ bool PCCEncoder::generateGeometryVideo( const PCCGroupOfFrames& sources, PCCCont
         dilate( frame, frame1 );
         PCCImageGeometry frame2;
         generateIntraImage( frameInfos[i], 1, frame2 );
-        dilate3DPadding( sources[i], frameInfos[i], frame, frame2, videoOccupancyMap.getFrame( i ) );
+        dilate3DPadding( sources.getKdTree( i ), frameInfos[i], frame, frame2, videoOccupancyMap.getFrame( i ) );
         for ( size_t x = 0; x < frame1.getWidth(); x++ ) {
           for ( size_t y = 0; y < frame1.getHeight(); y++ ) {
             if ( ( x + y ) % 2 == 1 ) { frame1.setValue( 0, x, y, frame2.getValue( 0, x, y ) ); }
@@ -5668,7 +5707,7 @@ bool PCCEncoder::generateGeometryVideo( const PCCGroupOfFrames& sources, PCCCont
         for ( size_t f = 0; f < mapCount; ++f ) {
           auto& geoImage = videoGeometry.getFrame( geometryVideoSize + f );
           generateIntraImage( frameInfos[i], f, geoImage );
-          dilate3DPadding( sources[i], frameInfos[i], frame, geoImage, videoOccupancyMap.getFrame( i ) );
+          dilate3DPadding( sources.getKdTree( i ), frameInfos[i], frame, geoImage, videoOccupancyMap.getFrame( i ) );
         }
       }
     }
@@ -5806,7 +5845,7 @@ size_t PCCEncoder::adjustDepth3DPadding( size_t            x,
                                          size_t            y,
                                          uint16_t          mean_val,
                                          PCCImageGeometry& image,
-                                         PCCKdTree&        kdtree,
+                                         const PCCKdTree&  kdtree,
                                          PCCFrameContext&  frame ) {
   auto&  blockToPatch = frame.getBlockToPatch();
   auto&  patches      = frame.getPatches();
@@ -5860,7 +5899,7 @@ size_t PCCEncoder::adjustDepth3DPadding( size_t            x,
   return 1;
 }
 
-void PCCEncoder::dilate3DPadding( const PCCPointSet3&     source,
+void PCCEncoder::dilate3DPadding( const PCCKdTree&        kdtree,
                                   PCCAtlasFrameContext&   frameInfo,
                                   PCCFrameContext&        frame,
                                   PCCImageGeometry&       image,
@@ -5877,7 +5916,6 @@ void PCCEncoder::dilate3DPadding( const PCCPointSet3&     source,
   std::vector<uint32_t> occupancyMapTemp;
   auto&                 occupancyMapOriginal = frame.getOccupancyMap();
   occupancyMapTemp.resize( image.getWidth() * image.getHeight(), 0 );
-  PCCKdTree kdtree( source );
   // fill in positions that are added to the sequence, because of occupancyMap video coding
   for ( size_t y_OM = 0; y_OM < occupancyMap.getHeight(); ++y_OM ) {
     for ( size_t x_OM = 0; x_OM < occupancyMap.getWidth(); ++x_OM ) {
@@ -6041,25 +6079,65 @@ void PCCEncoder::dilate3DPadding( const PCCPointSet3&     source,
   }
 }
 
+/* background filling workspaces */
+// Mip pyramids of the push-pull and harmonic background fills. The attribute frames are dilated
+// concurrently: each call takes a workspace from the pool and gives it back when done, so the
+// pyramid buffers are allocated once per thread and reused for the following frames.
+template <typename T>
+struct PCCDilationWorkspace {
+  std::vector<PCCImage<T, 3>>        mips_;
+  std::vector<std::vector<uint32_t>> mipOccupancyMaps_;
+  PCCImage<T, 3>                     tmpImage_;
+};
+
+template <typename T>
+class PCCDilationWorkspacePool {
+ public:
+  static std::unique_ptr<PCCDilationWorkspace<T>> acquire() {
+    auto&                       pool = getInstance();
+    std::lock_guard<std::mutex> lock( pool.mutex_ );
+    if ( pool.workspaces_.empty() ) { return std::unique_ptr<PCCDilationWorkspace<T>>( new PCCDilationWorkspace<T> ); }
+    auto workspace = std::move( pool.workspaces_.back() );
+    pool.workspaces_.pop_back();
+    return workspace;
+  }
+  static void release( std::unique_ptr<PCCDilationWorkspace<T>> workspace ) {
+    auto&                       pool = getInstance();
+    std::lock_guard<std::mutex> lock( pool.mutex_ );
+    pool.workspaces_.push_back( std::move( workspace ) );
+  }
+
+ private:
+  static PCCDilationWorkspacePool& getInstance() {
+    static PCCDilationWorkspacePool pool;
+    return pool;
+  }
+  std::mutex                                            mutex_;
+  std::vector<std::unique_ptr<PCCDilationWorkspace<T>>> workspaces_;
+};
+
 /* harmonic background filling algorithm */
 // interpolate using 5-point laplacian inpainting
 template <typename T>
 void PCCEncoder::dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<T, 3>& image ) {
-  auto                               occupancyMapTemp = frame.getOccupancyMap();
-  int                                i                = 0;
-  std::vector<PCCImage<T, 3>>        mipVec;
-  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
-  int                                miplev = 0;
+  const auto& occupancyMap       = frame.getOccupancyMap();
+  auto        workspace          = PCCDilationWorkspacePool<T>::acquire();
+  auto&       mipVec             = workspace->mips_;
+  auto&       mipOccupancyMapVec = workspace->mipOccupancyMaps_;
+  int         i                  = 0;
+  int         miplev             = 0;
 
   // create coarse image by dyadic sampling
   while ( true ) {
-    mipVec.resize( mipVec.size() + 1 );
-    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
+    if ( mipVec.size() <= miplev ) {
+      mipVec.resize( miplev + 1 );
+      mipOccupancyMapVec.resize( miplev + 1 );
+    }
     if ( miplev > 0 ) {
       createCoarseLayer( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1],
                          mipOccupancyMapVec[miplev] );
     } else {
-      createCoarseLayer( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
+      createCoarseLayer( image, mipVec[miplev], occupancyMap, mipOccupancyMapVec[miplev] );
     }
 
     if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
@@ -6072,49 +6150,100 @@ void PCCEncoder::dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<
     if ( i > 0 ) {
       regionFill( mipVec[i - 1], mipOccupancyMapVec[i - 1], mipVec[i] );
     } else {
-      regionFill( image, occupancyMapTemp, mipVec[i] );
+      regionFill( image, occupancyMap, mipVec[i] );
     }
   }
+  PCCDilationWorkspacePool<T>::release( std::move( workspace ) );
 }
 
 template <typename T>
-void PCCEncoder::createCoarseLayer( PCCImage<T, 3>&        image,
-                                    PCCImage<T, 3>&        mip,
-                                    std::vector<uint32_t>& occupancyMap,
-                                    std::vector<uint32_t>& mipOccupancyMap ) {
+void PCCEncoder::createCoarseLayer( const PCCImage<T, 3>&        image,
+                                    PCCImage<T, 3>&              mip,
+                                    const std::vector<uint32_t>& occupancyMap,
+                                    std::vector<uint32_t>&       mipOccupancyMap ) {
   int dyadicWidth = 1;
   while ( dyadicWidth < image.getWidth() ) { dyadicWidth *= 2; }
   int dyadicHeight = 1;
   while ( dyadicHeight < image.getHeight() ) { dyadicHeight *= 2; }
   // allocate the mipmap with half the resolution
   mip.resize( ( dyadicWidth / 2 ), ( dyadicHeight / 2 ), PCCCOLORFORMAT::YUV444 );
-  mipOccupancyMap.resize( ( dyadicWidth / 2 ) * ( dyadicHeight / 2 ), 0 );
-  int stride    = image.getWidth();
-  int newStride = ( dyadicWidth / 2 );
-  for ( size_t y = 0; y < mip.getHeight(); y++ ) {
-    for ( size_t x = 0; x < mip.getWidth(); x++ ) {
-      double num[3] = { 0.0, 0.0, 0.0 };
-      double den    = 0;
-      for ( size_t i = 0; i < 2; i++ ) {
-        for ( size_t j = 0; j < 2; j++ ) {
-          int row = ( 2 * y + i ) < 0 ? 0 : ( 2 * y + i ) >= image.getHeight() ? image.getHeight() - 1 : ( 2 * y + i );
-          int column = ( 2 * x + j ) < 0 ? 0 : ( 2 * x + j ) >= image.getWidth() ? image.getWidth() - 1 : ( 2 * x + j );
-          if ( occupancyMap[column + stride * row] == 1 ) {
-            den++;
-            for ( int cc = 0; cc < 3; cc++ ) { num[cc] += image.getValue( cc, column, row ); }
+  mipOccupancyMap.resize( ( dyadicWidth / 2 ) * ( dyadicHeight / 2 ) );
+  int                              stride    = image.getWidth();
+  int                              newStride = ( dyadicWidth / 2 );
+  const tbb::blocked_range<size_t> rows( 0, mip.getHeight(), 16 );
+  // the mip may come from the workspace: every pixel is written, the empty ones to 0
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( rows, [&]( const tbb::blocked_range<size_t>& r ) {
+      for ( size_t y = r.begin(); y < r.end(); y++ ) {
+        for ( size_t x = 0; x < mip.getWidth(); x++ ) {
+          double num[3] = { 0.0, 0.0, 0.0 };
+          double den    = 0;
+          for ( size_t i = 0; i < 2; i++ ) {
+            for ( size_t j = 0; j < 2; j++ ) {
+              int row =
+                  ( 2 * y + i ) < 0 ? 0 : ( 2 * y + i ) >= image.getHeight() ? image.getHeight() - 1 : ( 2 * y + i );
+              int column =
+                  ( 2 * x + j ) < 0 ? 0 : ( 2 * x + j ) >= image.getWidth() ? image.getWidth() - 1 : ( 2 * x + j );
+              if ( occupancyMap[column + stride * row] == 1 ) {
+                den++;
+                for ( int cc = 0; cc < 3; cc++ ) { num[cc] += image.getValue( cc, column, row ); }
+              }
+            }
+          }
+          if ( den > 0 ) {
+            mipOccupancyMap[x + newStride * y] = 1;
+            for ( int cc = 0; cc < 3; cc++ ) { mip.setValue( cc, x, y, std::round( num[cc] / den ) ); }
+          } else {
+            mipOccupancyMap[x + newStride * y] = 0;
+            for ( int cc = 0; cc < 3; cc++ ) { mip.setValue( cc, x, y, 0 ); }
           }
         }
       }
-      if ( den > 0 ) {
-        mipOccupancyMap[x + newStride * y] = 1;
-        for ( int cc = 0; cc < 3; cc++ ) { mip.setValue( cc, x, y, std::round( num[cc] / den ) ); }
+    } );
+  } );
+}
+
+// solves Ax=b in place, x holding the initial guess; the sparse rows of A are stored in order, the center
+// coefficient of each row last
+static void gaussSeidelRelaxation( const std::vector<uint32_t>& iSparse,
+                                   const std::vector<uint32_t>& jSparse,
+                                   const std::vector<double>&   valSparse,
+                                   const int                    numSparseElem,
+                                   const std::vector<double>&   b,
+                                   std::vector<double>&         x,
+                                   const int                    maxIteration,
+                                   const double                 maxError ) {
+  const int numElem = static_cast<int>( x.size() );
+  for ( int it = 0; it < maxIteration; it++ ) {
+    int    idxSparse = 0;
+    double error     = 0;
+    for ( int centerIdx = 0; centerIdx < numElem; centerIdx++ ) {
+      // add the b result
+      double val = b[centerIdx];
+      while ( ( idxSparse < numSparseElem ) && ( iSparse[idxSparse] == centerIdx ) ) {
+        if ( valSparse[idxSparse] < 0 ) {
+          val += x[jSparse[idxSparse]];
+          idxSparse++;
+        } else {
+          // final value
+          val /= valSparse[idxSparse];
+          // accumulate the error
+          error += ( val - x[centerIdx] ) * ( val - x[centerIdx] );
+          // update the value
+          x[centerIdx] = val;
+          idxSparse++;
+        }
       }
     }
+    error = error / numElem;
+    if ( error < maxError ) { break; }
   }
 }
 
 template <typename T>
-void PCCEncoder::regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes ) {
+void PCCEncoder::regionFill( PCCImage<T, 3>&              image,
+                             const std::vector<uint32_t>& occupancyMap,
+                             const PCCImage<T, 3>&        imageLowRes ) {
   int                   stride        = image.getWidth();
   int                   numElem       = 0;
   int                   numSparseElem = 0;
@@ -6224,33 +6353,12 @@ void PCCEncoder::regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occup
   }
   int    maxIteration = 1024;
   double maxError     = 0.00001;
-  for ( int cc = 0; cc < 3; cc++ ) {
-    int it = 0;
-    for ( ; it < maxIteration; it++ ) {
-      int    idxSparse = 0;
-      double error     = 0;
-      for ( int centerIdx = 0; centerIdx < numElem; centerIdx++ ) {
-        // add the b result
-        double val = b[cc][centerIdx];
-        while ( ( idxSparse < numSparseElem ) && ( iSparse[idxSparse] == centerIdx ) ) {
-          if ( valSparse[idxSparse] < 0 ) {
-            val += x[cc][jSparse[idxSparse]];
-            idxSparse++;
-          } else {
-            // final value
-            val /= valSparse[idxSparse];
-            // accumulate the error
-            error += ( val - x[cc][centerIdx] ) * ( val - x[cc][centerIdx] );
-            // update the value
-            x[cc][centerIdx] = val;
-            idxSparse++;
-          }
-        }
-      }
-      error = error / numElem;
-      if ( error < maxError ) { break; }
-    }
-  }
+  // the three components are solved independently
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( size_t( 0 ), size_t( 3 ), [&]( const size_t cc ) {
+      gaussSeidelRelaxation( iSparse, jSparse, valSparse, numSparseElem, b[cc], x[cc], maxIteration, maxError );
+    } );
+  } );
   // put the value back in the image
   idx = 0;
   for ( int row = 0; row < image.getHeight(); row++ ) {
@@ -6286,70 +6394,80 @@ void PCCEncoder::pushPullMip( const PCCImage<T, 3>&        image,
                               PCCImage<T, 3>&              mip,
                               const std::vector<uint32_t>& occupancyMap,
                               std::vector<uint32_t>&       mipOccupancyMap ) {
-  unsigned char w1;
-  unsigned char w2;
-  unsigned char w3;
-  unsigned char w4;
-  unsigned char val1;
-  unsigned char val2;
-  unsigned char val3;
-  unsigned char val4;
-  const size_t  width     = image.getWidth();
-  const size_t  height    = image.getHeight();
-  const size_t  newWidth  = ( ( width + 1 ) >> 1 );
-  const size_t  newHeight = ( ( height + 1 ) >> 1 );
+  const size_t width     = image.getWidth();
+  const size_t height    = image.getHeight();
+  const size_t newWidth  = ( ( width + 1 ) >> 1 );
+  const size_t newHeight = ( ( height + 1 ) >> 1 );
   // allocate the mipmap with half the resolution
   mip.resize( newWidth, newHeight, PCCCOLORFORMAT::YUV444 );
-  mipOccupancyMap.resize( newWidth * newHeight, 0 );
-  for ( size_t y = 0; y < newHeight; ++y ) {
-    const size_t yUp = y << 1;
-    for ( size_t x = 0; x < newWidth; ++x ) {
-      const size_t xUp = x << 1;
-      if ( occupancyMap[xUp + width * yUp] == 0 ) {
-        w1 = 0;
-      } else {
-        w1 = 255;
-      }
-      if ( ( xUp + 1 >= width ) || ( occupancyMap[xUp + 1 + width * yUp] == 0 ) ) {
-        w2 = 0;
-      } else {
-        w2 = 255;
-      }
-      if ( ( yUp + 1 >= height ) || ( occupancyMap[xUp + width * ( yUp + 1 )] == 0 ) ) {
-        w3 = 0;
-      } else {
-        w3 = 255;
-      }
-      if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) || ( occupancyMap[xUp + 1 + width * ( yUp + 1 )] == 0 ) ) {
-        w4 = 0;
-      } else {
-        w4 = 255;
-      }
-      if ( w1 + w2 + w3 + w4 > 0 ) {
-        for ( int cc = 0; cc < 3; cc++ ) {
-          val1 = image.getValue( cc, xUp, yUp );
-          if ( xUp + 1 >= width ) {
-            val2 = 0;
+  mipOccupancyMap.resize( newWidth * newHeight );
+  const tbb::blocked_range<size_t> rows( 0, newHeight, 16 );
+  // the mip may come from the workspace: every pixel is written, the empty ones to 0
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( rows, [&]( const tbb::blocked_range<size_t>& r ) {
+      unsigned char w1;
+      unsigned char w2;
+      unsigned char w3;
+      unsigned char w4;
+      unsigned char val1;
+      unsigned char val2;
+      unsigned char val3;
+      unsigned char val4;
+      for ( size_t y = r.begin(); y < r.end(); ++y ) {
+        const size_t yUp = y << 1;
+        for ( size_t x = 0; x < newWidth; ++x ) {
+          const size_t xUp = x << 1;
+          if ( occupancyMap[xUp + width * yUp] == 0 ) {
+            w1 = 0;
+          } else {
+            w1 = 255;
+          }
+          if ( ( xUp + 1 >= width ) || ( occupancyMap[xUp + 1 + width * yUp] == 0 ) ) {
+            w2 = 0;
           } else {
-            val2 = image.getValue( cc, xUp + 1, yUp );
+            w2 = 255;
           }
-          if ( yUp + 1 >= height ) {
-            val3 = 0;
+          if ( ( yUp + 1 >= height ) || ( occupancyMap[xUp + width * ( yUp + 1 )] == 0 ) ) {
+            w3 = 0;
           } else {
-            val3 = image.getValue( cc, xUp, yUp + 1 );
+            w3 = 255;
           }
-          if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) ) {
-            val4 = 0;
+          if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) ||
+               ( occupancyMap[xUp + 1 + width * ( yUp + 1 )] == 0 ) ) {
+            w4 = 0;
           } else {
-            val4 = image.getValue( cc, xUp + 1, yUp + 1 );
+            w4 = 255;
+          }
+          if ( w1 + w2 + w3 + w4 > 0 ) {
+            for ( int cc = 0; cc < 3; cc++ ) {
+              val1 = image.getValue( cc, xUp, yUp );
+              if ( xUp + 1 >= width ) {
+                val2 = 0;
+              } else {
+                val2 = image.getValue( cc, xUp + 1, yUp );
+              }
+              if ( yUp + 1 >= height ) {
+                val3 = 0;
+              } else {
+                val3 = image.getValue( cc, xUp, yUp + 1 );
+              }
+              if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) ) {
+                val4 = 0;
+              } else {
+                val4 = image.getValue( cc, xUp + 1, yUp + 1 );
+              }
+              T newVal = mean4w( val1, w1, val2, w2, val3, w3, val4, w4 );
+              mip.setValue( cc, x, y, newVal );
+            }
+            mipOccupancyMap[x + newWidth * y] = 1;
+          } else {
+            for ( int cc = 0; cc < 3; cc++ ) { mip.setValue( cc, x, y, 0 ); }
+            mipOccupancyMap[x + newWidth * y] = 0;
           }
-          T newVal = mean4w( val1, w1, val2, w2, val3, w3, val4, w4 );
-          mip.setValue( cc, x, y, newVal );
         }
-        mipOccupancyMap[x + newWidth * y] = 1;
       }
-    }
-  }
+    } );
+  } );
 }
 
 // interpolate using mipmap
@@ -6357,118 +6475,131 @@ template <typename T>
 void PCCEncoder::pushPullFill( PCCImage<T, 3>&              image,
                                const PCCImage<T, 3>&        mip,
                                const std::vector<uint32_t>& occupancyMap,
-                               int                          numIters ) {
+                               int                          numIters,
+                               PCCImage<T, 3>&              tmpImage ) {
   const size_t width    = mip.getWidth();
   const size_t height   = mip.getHeight();
   const size_t widthUp  = image.getWidth();
   const size_t heightUp = image.getHeight();
   assert( ( ( widthUp + 1 ) >> 1 ) == width );
   assert( ( ( heightUp + 1 ) >> 1 ) == height );
-  unsigned char w1;
-  unsigned char w2;
-  unsigned char w3;
-  unsigned char w4;
-  for ( int yUp = 0; yUp < heightUp; ++yUp ) {
-    int y = yUp >> 1;
-    for ( int xUp = 0; xUp < widthUp; ++xUp ) {
-      int x = xUp >> 1;
-      if ( occupancyMap[xUp + widthUp * yUp] == 0 ) {
-        if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 0 ) ) {
-          w1 = 144;
-          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x > 0 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val       = mip.getValue( cc, x, y );
-            T valLeft   = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
-            T valUp     = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
-            T valUpLeft = ( ( x > 0 && y > 0 ) ? mip.getValue( cc, x - 1, y - 1 ) : 0 );
-            T newVal    = mean4w( val, w1, valLeft, w2, valUp, w3, valUpLeft, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else if ( ( xUp % 2 == 1 ) && ( yUp % 2 == 0 ) ) {
-          w1 = 144;
-          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val        = mip.getValue( cc, x, y );
-            T valRight   = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
-            T valUp      = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
-            T valUpRight = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? mip.getValue( cc, x + 1, y - 1 ) : 0 );
-            T newVal     = mean4w( val, w1, valRight, w2, valUp, w3, valUpRight, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 1 ) ) {
-          w1 = 144;
-          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x > 0 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val         = mip.getValue( cc, x, y );
-            T valLeft     = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
-            T valDown     = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
-            T valDownLeft = ( ( x > 0 && ( y < height - 1 ) ) ? mip.getValue( cc, x - 1, y + 1 ) : 0 );
-            T newVal      = mean4w( val, w1, valLeft, w2, valDown, w3, valDownLeft, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else {
-          w1 = 144;
-          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val          = mip.getValue( cc, x, y );
-            T valRight     = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
-            T valDown      = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
-            T valDownRight = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? mip.getValue( cc, x + 1, y + 1 ) : 0 );
-            T newVal       = mean4w( val, w1, valRight, w2, valDown, w3, valDownRight, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
+  const tbb::blocked_range<size_t> rows( 0, heightUp, 16 );
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( rows, [&]( const tbb::blocked_range<size_t>& r ) {
+      unsigned char w1;
+      unsigned char w2;
+      unsigned char w3;
+      unsigned char w4;
+      for ( int yUp = r.begin(); yUp < r.end(); ++yUp ) {
+        int y = yUp >> 1;
+        for ( int xUp = 0; xUp < widthUp; ++xUp ) {
+          int x = xUp >> 1;
+          if ( occupancyMap[xUp + widthUp * yUp] == 0 ) {
+            if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 0 ) ) {
+              w1 = 144;
+              w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
+              w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
+              w4 = ( ( ( x > 0 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
+              for ( int cc = 0; cc < 3; cc++ ) {
+                T val       = mip.getValue( cc, x, y );
+                T valLeft   = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
+                T valUp     = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
+                T valUpLeft = ( ( x > 0 && y > 0 ) ? mip.getValue( cc, x - 1, y - 1 ) : 0 );
+                T newVal    = mean4w( val, w1, valLeft, w2, valUp, w3, valUpLeft, w4 );
+                image.setValue( cc, xUp, yUp, newVal );
+              }
+            } else if ( ( xUp % 2 == 1 ) && ( yUp % 2 == 0 ) ) {
+              w1 = 144;
+              w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
+              w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
+              w4 = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
+              for ( int cc = 0; cc < 3; cc++ ) {
+                T val        = mip.getValue( cc, x, y );
+                T valRight   = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
+                T valUp      = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
+                T valUpRight = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? mip.getValue( cc, x + 1, y - 1 ) : 0 );
+                T newVal     = mean4w( val, w1, valRight, w2, valUp, w3, valUpRight, w4 );
+                image.setValue( cc, xUp, yUp, newVal );
+              }
+            } else if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 1 ) ) {
+              w1 = 144;
+              w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
+              w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
+              w4 = ( ( ( x > 0 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
+              for ( int cc = 0; cc < 3; cc++ ) {
+                T val         = mip.getValue( cc, x, y );
+                T valLeft     = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
+                T valDown     = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
+                T valDownLeft = ( ( x > 0 && ( y < height - 1 ) ) ? mip.getValue( cc, x - 1, y + 1 ) : 0 );
+                T newVal      = mean4w( val, w1, valLeft, w2, valDown, w3, valDownLeft, w4 );
+                image.setValue( cc, xUp, yUp, newVal );
+              }
+            } else {
+              w1 = 144;
+              w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
+              w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
+              w4 = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
+              for ( int cc = 0; cc < 3; cc++ ) {
+                T val      = mip.getValue( cc, x, y );
+                T valRight = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
+                T valDown  = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
+                T valDownRight =
+                    ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? mip.getValue( cc, x + 1, y + 1 ) : 0 );
+                T newVal = mean4w( val, w1, valRight, w2, valDown, w3, valDownRight, w4 );
+                image.setValue( cc, xUp, yUp, newVal );
+              }
+            }
           }
         }
       }
-    }
-  }
-  auto tmpImage( image );
+    } );
+  } );
+  // smoothing passes: the empty pixels of each row only depend on the previous pass
+  tmpImage = image;
   for ( size_t n = 0; n < numIters; n++ ) {
-    for ( int y = 0; y < heightUp; y++ ) {
-      for ( int x = 0; x < widthUp; x++ ) {
-        if ( occupancyMap[x + widthUp * y] == 0 ) {
-          int x1 = ( x > 0 ) ? x - 1 : x;
-          int y1 = ( y > 0 ) ? y - 1 : y;
-          int x2 = ( x < widthUp - 1 ) ? x + 1 : x;
-          int y2 = ( y < heightUp - 1 ) ? y + 1 : y;
-          for ( size_t c = 0; c < 3; c++ ) {
-            int val = image.getValue( c, x1, y1 ) + image.getValue( c, x2, y1 ) + image.getValue( c, x1, y2 ) +
-                      image.getValue( c, x2, y2 ) + image.getValue( c, x1, y ) + image.getValue( c, x2, y ) +
-                      image.getValue( c, x, y1 ) + image.getValue( c, x, y2 );
-            tmpImage.setValue( c, x, y, ( val + 4 ) >> 3 );
+    PCCTaskScheduler::getInstance().execute( [&] {
+      tbb::parallel_for( rows, [&]( const tbb::blocked_range<size_t>& r ) {
+        for ( int y = r.begin(); y < r.end(); y++ ) {
+          for ( int x = 0; x < widthUp; x++ ) {
+            if ( occupancyMap[x + widthUp * y] == 0 ) {
+              int x1 = ( x > 0 ) ? x - 1 : x;
+              int y1 = ( y > 0 ) ? y - 1 : y;
+              int x2 = ( x < widthUp - 1 ) ? x + 1 : x;
+              int y2 = ( y < heightUp - 1 ) ? y + 1 : y;
+              for ( size_t c = 0; c < 3; c++ ) {
+                int val = image.getValue( c, x1, y1 ) + image.getValue( c, x2, y1 ) + image.getValue( c, x1, y2 ) +
+                          image.getValue( c, x2, y2 ) + image.getValue( c, x1, y ) + image.getValue( c, x2, y ) +
+                          image.getValue( c, x, y1 ) + image.getValue( c, x, y2 );
+                tmpImage.setValue( c, x, y, ( val + 4 ) >> 3 );
+              }
+            }
           }
         }
-      }
-    }
-    swap( image, tmpImage );
+      } );
+    } );
+    image.swap( tmpImage );
   }
 }
 
 template <typename T>
 void PCCEncoder::dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>& image, int mapIdx ) {
-  auto                               occupancyMapTemp = frame.getOccupancyMap();
-  int                                i                = 0;
-  std::vector<PCCImage<T, 3>>        mipVec;
-  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
-  int                                div    = 2;
-  int                                miplev = 0;
+  const auto& occupancyMap       = frame.getOccupancyMap();
+  auto        workspace          = PCCDilationWorkspacePool<T>::acquire();
+  auto&       mipVec             = workspace->mips_;
+  auto&       mipOccupancyMapVec = workspace->mipOccupancyMaps_;
+  int         i                  = 0;
+  int         miplev             = 0;
 
   // pull phase create the mipmap
   while ( true ) {
-    mipVec.resize( mipVec.size() + 1 );
-    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
-    div *= 2;
+    if ( mipVec.size() <= miplev ) {
+      mipVec.resize( miplev + 1 );
+      mipOccupancyMapVec.resize( miplev + 1 );
+    }
     if ( miplev > 0 ) {
       pushPullMip( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1], mipOccupancyMapVec[miplev] );
     } else {
-      pushPullMip( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
+      pushPullMip( image, mipVec[miplev], occupancyMap, mipOccupancyMapVec[miplev] );
     }
     if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
     ++miplev;
@@ -6486,9 +6617,9 @@ void PCCEncoder::dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>&
   int numIters = 4;
   for ( i = miplev - 1; i >= 0; --i ) {
     if ( i > 0 ) {
-      pushPullFill( mipVec[i - 1], mipVec[i], mipOccupancyMapVec[i - 1], numIters );
+      pushPullFill( mipVec[i - 1], mipVec[i], mipOccupancyMapVec[i - 1], numIters, workspace->tmpImage_ );
     } else {
-      pushPullFill( image, mipVec[i], occupancyMapTemp, numIters );
+      pushPullFill( image, mipVec[i], occupancyMap, numIters, workspace->tmpImage_ );
     }
     numIters = (std::min)( numIters + 1, 16 );
   }
@@ -6500,6 +6631,7 @@ void PCCEncoder::dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>&
     mipVec[k].write( filename, 1 );
   }
 #endif
+  PCCDilationWorkspacePool<T>::release( std::move( workspace ) );
 }
 
 void PCCEncoder::presmoothPointCloudColor( PCCPointSet3& reconstruct, const PCCEncoderParameters params ) {
@@ -6509,8 +6641,7 @@ void PCCEncoder::presmoothPointCloudColor( PCCPointSet3& reconstruct, const PCCE
   std::vector<PCCColor3B> temp;
   temp.resize( pointCount );
   for ( size_t m = 0; m < pointCount; ++m ) { temp[m] = reconstruct.getColor( m ); }
-  tbb::task_arena limited( static_cast<int>( params.nbThread_ ) );
-  limited.execute( [&] {
+  PCCTaskScheduler::getInstance().execute( [&] {
     tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
       //  for (size_t i = 0; i < pointCount; ++i) {
       PCCNNResult result;
@@ -6556,7 +6687,7 @@ void PCCEncoder::presmoothPointCloudColor( PCCPointSet3& reconstruct, const PCCE
     } );
   } );
 
-  limited.execute( [&] {
+  PCCTaskScheduler::getInstance().execute( [&] {
     tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
       // for (size_t i = 0; i < pointCount; ++i) {
       reconstruct.setColor( i, temp[i] );
@@ -6597,7 +6728,8 @@ bool PCCEncoder::generateAttributeVideo( const PCCGroupOfFrames&     sources,
         params_.maxColorDist2Fwd_,                         // maxColorDist2Fwd
         params_.maxColorDist2Bwd_,                         // maxColorDist2Bwd
         params_.excludeColorOutlier_,                      // excludeColorOutlier
-        params_.thresholdColorOutlierDist_                 // thresholdColorOutlierDist
+        params_.thresholdColorOutlierDist_,                // thresholdColorOutlierDist
+        &sources.getKdTree( i )                            // sourceKdTree
     );
     // color pre-smoothing
     if ( params_.flagColorPreSmoothing_ ) { presmoothPointCloudColor( reconstructs[i], params ); }
@@ -6907,6 +7039,8 @@ void PCCEncoder::generateGlobalPatches( PCCContext&    context,
                                         size_t         preIndex ) {
   auto& curPatches = context[frameIndex].getTile( tileIndex ).getPatches();
   assert( !curPatches.empty() );
+  PCCPatchRectIndex rectIndex( curPatches,
+                               []( const PCCPatch& patch ) { return patch.getCurGPAPatchData().isMatched_; } );
   for ( auto& globalPatchTrack : globalPatchTracks ) {
     auto& trackPatches = globalPatchTrack.second;  // !!!< <frameIndex, patchIndex> >;
     if ( trackPatches.empty() ) { continue; }
@@ -6914,24 +7048,11 @@ void PCCEncoder::generateGlobalPatches( PCCContext&    context,
     const auto& prePatch       = context[preGlobalPatch.first].getTile( tileIndex ).getPatches()[preGlobalPatch.second];
     float       thresholdIOU   = 0.2F;
     float       maxIou         = 0.0F;
-    int32_t     bestIdx        = -1;       // best matched patch index in curPatches;
-    int32_t     cId            = 0;        // patch index in curPatches;
-    for ( auto& curPatch : curPatches ) {  // curPatches; may be modified;
-      if ( prePatch.getViewId() == curPatch.getViewId() && !( curPatch.getCurGPAPatchData().isMatched_ ) &&
-           ( prePatch.getLodScaleX() == curPatch.getLodScaleX() &&
-             prePatch.getLodScaleY() == curPatch.getLodScaleY() ) ) {
-        Rect  preRect = Rect( prePatch.getU1(), prePatch.getV1(), prePatch.getSizeU(), prePatch.getSizeV() );
-        Rect  curRect = Rect( curPatch.getU1(), curPatch.getV1(), curPatch.getSizeU(), curPatch.getSizeV() );
-        float iou     = computeIOU( preRect, curRect );
-        if ( iou > maxIou ) {
-          maxIou  = iou;
-          bestIdx = cId;
-        }
-      }
-      cId++;
-    }
+    // best matched patch index in curPatches;
+    int32_t bestIdx = rectIndex.findBestMatch( prePatch, maxIou );
     if ( maxIou > thresholdIOU ) {                                 // !!!best match found;
       curPatches[bestIdx].getCurGPAPatchData().isMatched_ = true;  // indicating the patch is already matched;
+      rectIndex.setMatched( bestIdx );
       trackPatches.emplace_back( std::make_pair( frameIndex, bestIdx ) );
     } else {
       trackPatches.clear();
@@ -7032,11 +7153,11 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
     occupancySizeU            = std::max<size_t>( occupancySizeU, curPatchUnion.getSizeU0() + 1 );
     occupancySizeV            = std::max<size_t>( occupancySizeV, curPatchUnion.getSizeV0() + 1 );
   }
-  size_t            width           = occupancySizeU * params_.occupancyResolution_;
-  size_t            height          = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  int               numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
+  size_t             width           = occupancySizeU * params_.occupancyResolution_;
+  size_t             height          = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  PCCOccupancyCanvas occupancyMap;
+  int                numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   for ( auto& iter : unionPatchTemp ) {
     auto& curPatchUnion = iter.second;  // [u0, v0] may be modified;
@@ -7135,13 +7256,14 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
   size_t           occupancySizeV = 0;
   for ( auto& p : patches ) { occupancySizeV = std::max( occupancySizeV, std::max( p.getSizeU0(), p.getSizeV0() ) ); }
   for ( auto& patch : patches ) { occupancySizeU = (std::max)( occupancySizeU, patch.getSizeU0() + 1 ); }
-  auto& widthGPA                    = tile.getCurPCCGPAFrameSize().widthGPA_;
-  auto& heithGPA                    = tile.getCurPCCGPAFrameSize().heightGPA_;
-  widthGPA                          = occupancySizeU * params_.occupancyResolution_;
-  heithGPA                          = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  int               numOrientations = ( params_.packingStrategy_ == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  std::vector<bool> occupancyMap;
+  auto& widthGPA                     = tile.getCurPCCGPAFrameSize().widthGPA_;
+  auto& heithGPA                     = tile.getCurPCCGPAFrameSize().heightGPA_;
+  widthGPA                           = occupancySizeU * params_.occupancyResolution_;
+  heithGPA                           = occupancySizeV * params_.occupancyResolution_;
+  size_t             maxOccupancyRow = 0;
+  int                numOrientations =
+      ( params_.packingStrategy_ == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
+  PCCOccupancyCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
@@ -7449,10 +7571,10 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
     for ( auto& patch : patches ) {
       occupancySizeU = (std::max)( occupancySizeU, patch.getCurGPAPatchData().sizeU0_ + 1 );
     }
-    widthGPA                          = occupancySizeU * params_.occupancyResolution_;
-    heightGPA                         = occupancySizeV * params_.occupancyResolution_;
-    size_t            maxOccupancyRow = 0;
-    std::vector<bool> occupancyMap;
+    widthGPA                           = occupancySizeU * params_.occupancyResolution_;
+    heightGPA                          = occupancySizeV * params_.occupancyResolution_;
+    size_t             maxOccupancyRow = 0;
+    PCCOccupancyCanvas occupancyMap;
     occupancyMap.resize( occupancySizeU * occupancySizeV, false );
     // !!!packing global matched patch;
     for ( auto& patch : patches ) {
@@ -7508,7 +7630,7 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
       // disabled.
       if ( ( i == 0 ) || ( ( i == subContext.first ) && ( !useRefFrame ) ) ) {  // not use ref.
         packingWithoutRefForFirstFrameNoglobalPatch( patch, i, icount, occupancySizeU, occupancySizeV, safeguard,
-                                                     occupancyMap, heightGPA, widthGPA, maxOccupancyRow );
+                                                     occupancyMap, heightGPA, widthGPA,                maxOccupancyRow );
       } else {
         // PCCPatch prePatch = prePatches[patch.getBestMatchIdx()];
         packingWithRefForFirstFrameNoglobalPatch( patch, prePatches, subContext.first, i, icount, occupancySizeU,
@@ -7545,16 +7667,16 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
   if ( exceedMinimumImageHeight || badCondition > BAD_CONDITION_THRESHOLD ) { badGPAPacking = true; }
 }
 
-void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&          patch,
-                                                              size_t             ii,
-                                                              size_t             icount,
-                                                              size_t&            occupancySizeU,
-                                                              size_t&            occupancySizeV,
-                                                              const size_t       safeguard,
-                                                              std::vector<bool>& occupancyMap,
-                                                              size_t&            heightGPA,
-                                                              size_t&            widthGPA,
-                                                              size_t&            maxOccupancyRow ) {
+void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&           patch,
+                                                              size_t              ii,
+                                                              size_t              icount,
+                                                              size_t&             occupancySizeU,
+                                                              size_t&             occupancySizeV,
+                                                              const size_t        safeguard,
+                                                              PCCOccupancyCanvas& occupancyMap,
+                                                              size_t&             heightGPA,
+                                                              size_t&             widthGPA,
+                                                              size_t&             maxOccupancyRow ) {
   int           numOrientations = ( params_.packingStrategy_ == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
   GPAPatchData& curGPAPatchData = patch.getCurGPAPatchData();
   assert( curGPAPatchData.sizeU0_ <= occupancySizeU );
@@ -7639,7 +7761,7 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
                                                            size_t&                      occupancySizeU,
                                                            size_t&                      occupancySizeV,
                                                            const size_t                 safeguard,
-                                                           std::vector<bool>&           occupancyMap,
+                                                           PCCOccupancyCanvas&          occupancyMap,
                                                            size_t&                      heightGPA,
                                                            size_t&                      widthGPA,
                                                            size_t&                      maxOccupancyRow ) {
@@ -8737,6 +8859,7 @@ void PCCEncoder::createHashSEI( PCCContext& context, size_t frameIndex, AtlasTil
 }
 
 void PCCEncoder::segmentationPartiallyAddtinalProjectionPlane( const PCCPointSet3&                 source,
+                                                               const PCCKdTree&                    kdtree,
                                                                PCCFrameContext&                    frame,
                                                                const PCCPatchSegmenter3Parameters& segmenterParams,
                                                                size_t                              frameIndex,
@@ -8788,7 +8911,7 @@ void PCCEncoder::segmentationPartiallyAddtinalProjectionPlane( const PCCPointSet
     Orthogonal.reserve( 256 );
     float distanceSrcRecA;
     segmenter.setNbThread( params_.nbThread_ );
-    segmenter.compute( source, frame.getFrameIndex(), local, Orthogonal, frame.getSrcPointCloudByPatch(),
+    segmenter.compute( source, kdtree, frame.getFrameIndex(), local, Orthogonal, frame.getSrcPointCloudByPatch(),
                        distanceSrcRecA );
     distanceSrcRec                  = distanceSrcRecA;
     frame.getSrcPointCloudByPatch() = tmp;
@@ -8804,9 +8927,10 @@ void PCCEncoder::segmentationPartiallyAddtinalProjectionPlane( const PCCPointSet
     PCCPatchSegmenter3 segmenter;
     Additional.reserve( 256 );
     float distanceSrcRecA;
+    PCCKdTree kdtreePartial( partial );
     segmenter.setNbThread( params_.nbThread_ );
-    segmenter.compute( partial, frame.getFrameIndex(), local, Additional, frame.getSrcPointCloudByPatch(),
-                       distanceSrcRecA );
+    segmenter.compute( partial, kdtreePartial, frame.getFrameIndex(), local, Additional,
+                       frame.getSrcPointCloudByPatch(), distanceSrcRecA );
     distanceSrcRec                  = distanceSrcRecA;
     frame.getSrcPointCloudByPatch() = tmp;
 
@@ -65,6 +65,8 @@ PCCEncoderParameters::PCCEncoderParameters() {
   iterationCountRefineSegmentation_    = gridBasedRefineSegmentation_ ? ( gridBasedSegmentation_ ? 5 : 10 ) : 100;
   voxelDimensionRefineSegmentation_    = gridBasedSegmentation_ ? 2 : 4;
   searchRadiusRefineSegmentation_      = gridBasedSegmentation_ ? 128 : 192;
+  temporalRefineSegmentation_          = false;
+  maxDist2TemporalRefineSegmentation_  = 0.0;
   occupancyResolution_                 = 16;
   enablePatchSplitting_                = true;
   maxPatchSize_                        = 1024;
@@ -134,6 +136,8 @@ PCCEncoderParameters::PCCEncoderParameters() {
   geometryAuxVideoConfig_                  = {};
   attributeAuxVideoConfig_                 = {};
   nbThread_                                = 1;
+  cpuAffinity_                             = {};
+  gofPipelineDepth_                        = 2;
   keepIntermediateFiles_                   = false;
   absoluteD1_                              = false;
   absoluteT1_                              = false;
@@ -334,6 +338,8 @@ void PCCEncoderParameters::print() {
   std::cout << "\t groupOfFramesSize                          " << groupOfFramesSize_ << std::endl;
   std::cout << "\t colorTransform                             " << colorTransform_ << std::endl;
   std::cout << "\t nbThread                                   " << nbThread_ << std::endl;
+  std::cout << "\t cpuAffinity                                " << cpuAffinity_ << std::endl;
+  std::cout << "\t gofPipelineDepth                           " << gofPipelineDepth_ << std::endl;
   std::cout << "\t keepIntermediateFiles                      " << keepIntermediateFiles_ << std::endl;
   std::cout << "\t multipleStreams                            " << multipleStreams_ << std::endl;
   std::cout << "\t multipleStreams                            " << multipleStreams_ << std::endl;
@@ -359,6 +365,8 @@ void PCCEncoderParameters::print() {
   std::cout << "\t   iterationCountRefineSegmentation         " << iterationCountRefineSegmentation_ << std::endl;
   std::cout << "\t   voxelDimensionRefineSegmentation         " << voxelDimensionRefineSegmentation_ << std::endl;
   std::cout << "\t   searchRadiusRefineSegmentation           " << searchRadiusRefineSegmentation_ << std::endl;
+  std::cout << "\t   temporalRefineSegmentation               " << temporalRefineSegmentation_ << std::endl;
+  std::cout << "\t   maxDist2TemporalRefineSegmentation       " << maxDist2TemporalRefineSegmentation_ << std::endl;
   std::cout << "\t   occupancyResolution                      " << occupancyResolution_ << std::endl;
   std::cout << "\t   enablePatchSplitting                     " << enablePatchSplitting_ << std::endl;
   std::cout << "\t   maxPatchSize                             " << maxPatchSize_ << std::endl;
@@ -33,10 +33,12 @@
 #include "PCCCommon.h"
 
 #include "PCCKdTree.h"
+#include "PCCTaskScheduler.h"
 #include "tbb/tbb.h"
 #include "PCCNormalsGenerator.h"
 
 #include "PCCImage.h"
+#include <numeric>
 
 using namespace pcc;
 
@@ -57,6 +59,10 @@ void PCCNormalsGenerator3::init( const size_t pointCount, const PCCNormalsGenera
   } else {
     barycenters_.resize( 0 );
   }
+  // the neighborhoods are kept so that the orientation and the segmentation do not search them again
+  neighborCount_ = params.numberOfNearestNeighborsInNormalEstimation_;
+  neighbors_.resize( pointCount * neighborCount_ );
+  neighborCounts_.resize( pointCount );
 }
 void PCCNormalsGenerator3::compute( const PCCPointSet3&                   pointCloud,
                                     const PCCKdTree&                      kdtree,
@@ -80,6 +86,11 @@ void PCCNormalsGenerator3::computeNormal( const size_t
   PCCMatrix3D Q;
   PCCMatrix3D D;
   kdtree.search( pointCloud[index], params.numberOfNearestNeighborsInNormalEstimation_, nNResult );
+  if ( !neighbors_.empty() ) {
+    uint32_t* neighbors    = neighbors_.data() + index * neighborCount_;
+    neighborCounts_[index] = static_cast<uint32_t>( nNResult.count() );
+    for ( size_t i = 0; i < nNResult.count(); ++i ) { neighbors[i] = static_cast<uint32_t>( nNResult.indices( i ) ); }
+  }
   if ( nNResult.count() > 1 ) {
     bary = 0.0;
     for ( size_t i = 0; i < nNResult.count(); ++i ) { bary += pointCloud[nNResult.indices( i )]; }
@@ -163,8 +174,7 @@ void PCCNormalsGenerator3::computeNormals( const PCCPointSet3&
   std::vector<size_t> subRanges;
   const size_t        chunckCount = 64;
   PCCDivideRange( 0, pointCount, chunckCount, subRanges );
-  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
-  limited.execute( [&] {
+  PCCTaskScheduler::getInstance().execute( [&] {
     tbb::parallel_for( size_t( 0 ), subRanges.size() - 1, [&]( const size_t i ) {
       const size_t start = subRanges[i];
       const size_t end   = subRanges[i + 1];
@@ -224,13 +234,24 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
         }
       }
     }
-    size_t negNormalCount = 0;
-    for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) {
-      negNormalCount +=
-          static_cast<unsigned long long>( normals_[ptIndex] * ( params.viewPoint_ - pointCloud[ptIndex] ) < 0.0 );
-    }
+    std::vector<size_t> subRanges;
+    const size_t        chunckCount = 64;
+    PCCDivideRange( 0, pointCount, chunckCount, subRanges );
+    std::vector<size_t> negNormalCounts( subRanges.size() - 1, 0 );
+    PCCTaskScheduler::getInstance().execute( [&] {
+      tbb::parallel_for( size_t( 0 ), subRanges.size() - 1, [&]( const size_t i ) {
+        for ( size_t ptIndex = subRanges[i]; ptIndex < subRanges[i + 1]; ++ptIndex ) {
+          negNormalCounts[i] +=
+              static_cast<size_t>( normals_[ptIndex] * ( params.viewPoint_ - pointCloud[ptIndex] ) < 0.0 );
+        }
+      } );
+    } );
+    const size_t negNormalCount = std::accumulate( negNormalCounts.begin(), negNormalCounts.end(), size_t( 0 ) );
     if ( negNormalCount > ( pointCount + 1 ) / 2 ) {
-      for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) { normals_[ptIndex] = -normals_[ptIndex]; }
+      PCCTaskScheduler::getInstance().execute( [&] {
+        tbb::parallel_for( size_t( 0 ), pointCount,
+                           [&]( const size_t ptIndex ) { normals_[ptIndex] = -normals_[ptIndex]; } );
+      } );
     }
 #ifdef DEBUG_NORMAL
     // save mesh
@@ -243,8 +264,7 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
 #endif
   } else if ( params.orientationStrategy_ == PCC_NORMALS_GENERATOR_ORIENTATION_VIEW_POINT ) {
     const size_t    pointCount = pointCloud.getPointCount();
-    tbb::task_arena limited( static_cast<int>( nbThread_ ) );
-    limited.execute( [&] {
+    PCCTaskScheduler::getInstance().execute( [&] {
       tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t ptIndex ) {
         if ( normals_[ptIndex] * ( params.viewPoint_ - pointCloud[ptIndex] ) < 0.0 ) {
           normals_[ptIndex] = -normals_[ptIndex];
@@ -511,15 +531,9 @@ void PCCNormalsGenerator3::addNeighbors( const uint32_t      current,
                                          size_t&             numberOfNormals ) {
   accumulatedNormals = 0.0;
   numberOfNormals    = 0;
-  if ( nNQuery.radius > 32768.0 ) {
-    kdtree.search( pointCloud[current], nNQuery.nearestNeighborCount, nNResult );
-  } else {
-    kdtree.searchRadius( pointCloud[current], nNQuery.nearestNeighborCount, nNQuery.radius, nNResult );
-  }
-  PCCWeightedEdge newEdge;
-  for ( size_t i = 0; i < nNResult.count(); ++i ) {
-    uint32_t index = static_cast<uint32_t>( nNResult.indices( i ) );
+  auto addNeighbor = [&]( const uint32_t index ) {
     if ( visited_[index] == 0u ) {
+      PCCWeightedEdge newEdge;
       newEdge.weight_ = fabs( normals_[current] * normals_[index] );
       newEdge.end_    = index;
       newEdge.start_  = current;
@@ -528,6 +542,18 @@ void PCCNormalsGenerator3::addNeighbors( const uint32_t      current,
       accumulatedNormals += normals_[index];
       ++numberOfNormals;
     }
+  };
+  if ( nNQuery.radius > 32768.0 && nNQuery.nearestNeighborCount == neighborCount_ && !neighbors_.empty() ) {
+    // same query as the normal estimation: reuse its neighborhood
+    const uint32_t* neighbors = getNeighbors( current );
+    for ( size_t i = 0; i < getNeighborCount( current ); ++i ) { addNeighbor( neighbors[i] ); }
+  } else {
+    if ( nNQuery.radius > 32768.0 ) {
+      kdtree.search( pointCloud[current], nNQuery.nearestNeighborCount, nNResult );
+    } else {
+      kdtree.searchRadius( pointCloud[current], nNQuery.nearestNeighborCount, nNQuery.radius, nNResult );
+    }
+    for ( size_t i = 0; i < nNResult.count(); ++i ) { addNeighbor( static_cast<uint32_t>( nNResult.indices( i ) ) ); }
   }
 }
 void PCCNormalsGenerator3::smoothNormals( const PCCPointSet3&                   pointCloud,
@@ -536,20 +562,19 @@ void PCCNormalsGenerator3::smoothNormals( const PCCPointSet3&
   const double        w2         = params.weightNormalSmoothing_;
   const double        w0         = ( 1 - w2 );
   const size_t        pointCount = pointCloud.getPointCount();
-  PCCVector3D         n0;
-  PCCVector3D         n1;
-  PCCVector3D         n2;
   std::vector<size_t> subRanges;
   const size_t        chunckCount = 64;
   PCCDivideRange( 0, pointCount, chunckCount, subRanges );
   const double radius = params.radiusNormalSmoothing_ * params.radiusNormalSmoothing_;
   for ( size_t it = 0; it < params.numberOfIterationsInNormalSmoothing_; ++it ) {
-    tbb::task_arena limited( static_cast<int>( nbThread_ ) );
-    limited.execute( [&] {
+    PCCTaskScheduler::getInstance().execute( [&] {
       tbb::parallel_for( size_t( 0 ), subRanges.size() - 1, [&]( const size_t i ) {
         const size_t start = subRanges[i];
         const size_t end   = subRanges[i + 1];
         PCCNNResult  result;
+        PCCVector3D  n0;
+        PCCVector3D  n1;
+        PCCVector3D  n2;
         for ( size_t ptIndex = start; ptIndex < end; ++ptIndex ) {
           kdtree.searchRadius( pointCloud[ptIndex], params.numberOfNearestNeighborsInNormalSmoothing_, radius, result );
           n0 = normals_[ptIndex];
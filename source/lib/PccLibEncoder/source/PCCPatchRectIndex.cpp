@@ -0,0 +1,173 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+#include "PCCPatch.h"
+#include "PCCPatchSegmenter.h"
+#include "PCCPatchRectIndex.h"
+
+using namespace pcc;
+
+// number of children of the nodes of the trees
+static const size_t g_rectIndexNodeSize = 8;
+
+// the rectangles overlap on a non empty area: the other pairs have an IOU of 0
+static inline bool overlap( const int x0, const int y0, const int x1, const int y1, const int u0, const int v0,
+                            const int u1, const int v1 ) {
+  return x0 < u1 && u0 < x1 && y0 < v1 && v0 < y1;
+}
+
+void PCCPatchRectIndex::init( const std::vector<PCCPatch>& patches, const bool useRoiIndex ) {
+  useRoiIndex_ = useRoiIndex;
+  boxes_.resize( patches.size() );
+  matched_.assign( patches.size(), false );
+  groupOfPatch_.resize( patches.size() );
+  for ( size_t i = 0; i < patches.size(); i++ ) {
+    const auto& patch = patches[i];
+    auto&       box   = boxes_[i];
+    box.x0_           = int( patch.getU1() );
+    box.y0_           = int( patch.getV1() );
+    box.x1_           = box.x0_ + int( patch.getSizeU() );
+    box.y1_           = box.y0_ + int( patch.getSizeV() );
+    auto& group       = groups_[getKey( patch )];
+    group.indexes_.push_back( i );
+    groupOfPatch_[i] = &group;
+  }
+  for ( auto& group : groups_ ) {
+    group.second.candidateCount_ = group.second.indexes_.size();
+    build( group.second );
+  }
+}
+
+PCCPatchRectIndex::Key PCCPatchRectIndex::getKey( const PCCPatch& patch ) const {
+  return {{patch.getViewId(), patch.getLodScaleX(), patch.getLodScaleY(), useRoiIndex_ ? patch.getRoiIndex() : 0}};
+}
+
+// Sort-Tile-Recursive packing: the leaves are sorted in vertical slices by x then by y in each slice, so the
+// nodes group close rectangles.
+void PCCPatchRectIndex::build( Group& group ) {
+  auto&        indexes    = group.indexes_;
+  const size_t count      = indexes.size();
+  const size_t leafCount  = ( count + g_rectIndexNodeSize - 1 ) / g_rectIndexNodeSize;
+  const size_t sliceCount = static_cast<size_t>( std::ceil( std::sqrt( static_cast<double>( leafCount ) ) ) );
+  const size_t sliceSize  = sliceCount * g_rectIndexNodeSize;
+  std::sort( indexes.begin(), indexes.end(), [&]( size_t a, size_t b ) {
+    return boxes_[a].x0_ + boxes_[a].x1_ < boxes_[b].x0_ + boxes_[b].x1_;
+  } );
+  for ( size_t start = 0; start < count; start += sliceSize ) {
+    std::sort( indexes.begin() + start, indexes.begin() + ( std::min )( start + sliceSize, count ),
+               [&]( size_t a, size_t b ) { return boxes_[a].y0_ + boxes_[a].y1_ < boxes_[b].y0_ + boxes_[b].y1_; } );
+  }
+  auto merge = []( Box& box, const Box& child, const bool first ) {
+    if ( first ) {
+      box = child;
+    } else {
+      box.x0_ = ( std::min )( box.x0_, child.x0_ );
+      box.y0_ = ( std::min )( box.y0_, child.y0_ );
+      box.x1_ = ( std::max )( box.x1_, child.x1_ );
+      box.y1_ = ( std::max )( box.y1_, child.y1_ );
+    }
+  };
+  group.levels_.clear();
+  group.levels_.emplace_back( leafCount );
+  for ( size_t i = 0; i < count; i++ ) {
+    merge( group.levels_[0][i / g_rectIndexNodeSize], boxes_[indexes[i]], i % g_rectIndexNodeSize == 0 );
+  }
+  while ( group.levels_.back().size() > 1 ) {
+    const size_t     childCount = group.levels_.back().size();
+    std::vector<Box> level( ( childCount + g_rectIndexNodeSize - 1 ) / g_rectIndexNodeSize );
+    for ( size_t i = 0; i < childCount; i++ ) {
+      merge( level[i / g_rectIndexNodeSize], group.levels_.back()[i], i % g_rectIndexNodeSize == 0 );
+    }
+    group.levels_.push_back( std::move( level ) );
+  }
+}
+
+void PCCPatchRectIndex::setMatched( const size_t index ) {
+  if ( !matched_[index] ) {
+    matched_[index] = true;
+    groupOfPatch_[index]->candidateCount_--;
+  }
+}
+
+bool PCCPatchRectIndex::hasCandidate( const PCCPatch& patch ) const {
+  const auto it = groups_.find( getKey( patch ) );
+  return it != groups_.end() && it->second.candidateCount_ > 0;
+}
+
+int PCCPatchRectIndex::findBestMatch( const PCCPatch& patch, float& maxIou ) {
+  const auto it = groups_.find( getKey( patch ) );
+  if ( it == groups_.end() || it->second.candidateCount_ == 0 ) { return -1; }
+  const auto& group = it->second;
+  const int   u0    = int( patch.getU1() );
+  const int   v0    = int( patch.getV1() );
+  const int   u1    = u0 + int( patch.getSizeU() );
+  const int   v1    = v0 + int( patch.getSizeV() );
+  candidates_.clear();
+  stack_.clear();
+  const size_t top = group.levels_.size() - 1;
+  for ( size_t i = 0; i < group.levels_[top].size(); i++ ) { stack_.emplace_back( top, i ); }
+  while ( !stack_.empty() ) {
+    const size_t level = stack_.back().first;
+    const size_t node  = stack_.back().second;
+    stack_.pop_back();
+    const auto& box = group.levels_[level][node];
+    if ( !overlap( box.x0_, box.y0_, box.x1_, box.y1_, u0, v0, u1, v1 ) ) { continue; }
+    const size_t first = node * g_rectIndexNodeSize;
+    if ( level == 0 ) {
+      const size_t last = ( std::min )( first + g_rectIndexNodeSize, group.indexes_.size() );
+      for ( size_t i = first; i < last; i++ ) {
+        const size_t index = group.indexes_[i];
+        const auto&  leaf  = boxes_[index];
+        if ( !matched_[index] && overlap( leaf.x0_, leaf.y0_, leaf.x1_, leaf.y1_, u0, v0, u1, v1 ) ) {
+          candidates_.push_back( index );
+        }
+      }
+    } else {
+      const size_t last = ( std::min )( first + g_rectIndexNodeSize, group.levels_[level - 1].size() );
+      for ( size_t i = first; i < last; i++ ) { stack_.emplace_back( level - 1, i ); }
+    }
+  }
+  // the candidates are compared in the order of the list: the first of the best ones is kept
+  std::sort( candidates_.begin(), candidates_.end() );
+  int  bestIndex = -1;
+  Rect rect( u0, v0, int( patch.getSizeU() ), int( patch.getSizeV() ) );
+  for ( const auto& index : candidates_ ) {
+    const auto& box = boxes_[index];
+    const float iou = computeIOU( rect, Rect( box.x0_, box.y0_, box.x1_ - box.x0_, box.y1_ - box.y0_ ) );
+    if ( iou > maxIou ) {
+      maxIou    = iou;
+      bestIndex = int( index );
+    }
+  }
+  return bestIndex;
+}
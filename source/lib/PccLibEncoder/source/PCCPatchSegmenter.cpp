@@ -34,6 +34,8 @@
 #include "PCCCommon.h"
 
 #include "PCCKdTree.h"
+#include "PCCSparseGridIndex.h"
+#include "PCCTaskScheduler.h"
 #include "PCCNormalsGenerator.h"
 #include "tbb/tbb.h"
 #include "PCCPatchSegmenter.h"
@@ -41,12 +43,10 @@
 
 using namespace pcc;
 
-void PCCPatchSegmenter3::setNbThread( size_t nbThread ) {
-  nbThread_ = nbThread;
-  if ( nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( nbThread ) ); }
-}
+void PCCPatchSegmenter3::setNbThread( size_t nbThread ) { nbThread_ = nbThread; }
 
 void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
+                                  const PCCKdTree&                    kdtree,
                                   const size_t                        frameIndex,
                                   const PCCPatchSegmenter3Parameters& params,
                                   std::vector<PCCPatch>&              patches,
@@ -73,16 +73,19 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
   std::cout << std::endl << "============= FRAME " << frameIndex << " ============= " << std::endl;
   PCCPointSet3 geometryVox;
   Voxels       voxels;
+  PCCKdTree    kdtreeVox;
   if ( params.gridBasedSegmentation_ ) {
     std::cout << "  Converting points to voxels... ";
     convertPointsToVoxels( geometry, params.geometryBitDepth3D_, params.voxelDimensionGridBasedSegmentation_,
                            geometryVox, voxels );
+    kdtreeVox.init( geometryVox );
     std::cout << "[done]" << std::endl;
   } else {
     geometryVox = geometry;
   }
+  // the k-d tree of the frame is shared with the other stages, it is only rebuilt for the voxels.
+  const PCCKdTree& kdtreeNormals = params.gridBasedSegmentation_ ? kdtreeVox : kdtree;
   std::cout << "  Computing normals for original point cloud... ";
-  PCCKdTree            kdtree( geometryVox );
   PCCNNResult          result;
   PCCNormalsGenerator3 normalsGen;
   auto                 normalsOrientation = static_cast<PCCNormalsGeneratorOrientation>( params.normalOrientation_ );
@@ -100,7 +103,7 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
                                                            false,
                                                            false};
   // PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_TREE,
-  normalsGen.compute( geometryVox, kdtree, normalsGenParams, nbThread_ );
+  normalsGen.compute( geometryVox, kdtreeNormals, normalsGenParams, nbThread_ );
   std::cout << "[done]" << std::endl;
 
   std::cout << "  Computing initial segmentation... ";
@@ -113,26 +116,36 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
   }
   std::cout << "[done]" << std::endl;
 
+  std::vector<uint8_t> refinePoints;
+  if ( params.temporalRefineSegmentation_ && !previousPartition_.empty() ) {
+    std::cout << "  Reusing segmentation of previous frame... ";
+    reusePreviousSegmentation( geometryVox, params.maxDist2TemporalRefineSegmentation_, partition, refinePoints );
+    std::cout << "[done]" << std::endl;
+  }
+
   if ( params.gridBasedRefineSegmentation_ ) {
     std::cout << "  Refining segmentation (grid-based)... ";
     refineSegmentationGridBased( geometryVox, normalsGen, orientations, orientationCount,
                                  params.maxNNCountRefineSegmentation_, params.lambdaRefineSegmentation_,
                                  params.iterationCountRefineSegmentation_, params.voxelDimensionRefineSegmentation_,
-                                 params.searchRadiusRefineSegmentation_, partition );
+                                 params.searchRadiusRefineSegmentation_, partition, refinePoints );
   } else {
     std::cout << "  Refining segmentation... ";
-    refineSegmentation( geometryVox, kdtree, normalsGen, orientations, orientationCount,
+    refineSegmentation( geometryVox, kdtreeNormals, normalsGen, orientations, orientationCount,
                         params.maxNNCountRefineSegmentation_, params.lambdaRefineSegmentation_,
-                        params.iterationCountRefineSegmentation_, partition );
+                        params.iterationCountRefineSegmentation_, partition, refinePoints );
   }
   std::cout << "[done]" << std::endl;
+  if ( params.temporalRefineSegmentation_ ) {
+    previousGeometry_  = geometryVox;
+    previousPartition_ = partition;
+  }
 
   if ( params.gridBasedSegmentation_ ) {
     std::cout << "  Applying voxels' data to points... ";
     applyVoxelsDataToPoints( geometry.getPointCount(), params.geometryBitDepth3D_,
                              params.voxelDimensionGridBasedSegmentation_, voxels, geometryVox, normalsGen, partition );
     std::cout << "[done]" << std::endl;
-    kdtree.init( geometry );
   }
   std::cout << "  Patch segmentation... ";
   PCCPointSet3        resampled;
@@ -234,8 +247,7 @@ void PCCPatchSegmenter3::initialSegmentation( const PCCPointSet3&         geomet
   weightValue[0] = weightValue[3] = axisWeight[0];
   weightValue[1] = weightValue[4] = axisWeight[1];
   weightValue[2] = weightValue[5] = axisWeight[2];
-  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
-  limited.execute( [&] {
+  PCCTaskScheduler::getInstance().execute( [&] {
     tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
       const PCCVector3D normal       = normalsGen.getNormal( i );
       size_t            clusterIndex = 0;
@@ -258,8 +270,7 @@ void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3&
                                                const size_t                      maxNNCount ) {
   const size_t pointCount = pointCloud.getPointCount();
   adj.resize( pointCount );
-  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
-  limited.execute( [&] {
+  PCCTaskScheduler::getInstance().execute( [&] {
     tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
       PCCNNResult result;
       kdtree.search( pointCloud[i], maxNNCount, result );
@@ -270,16 +281,29 @@ void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3&
   } );
 }
 
+void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCNormalsGenerator3&       normalsGen,
+                                               std::vector<std::vector<size_t>>& adj ) {
+  const size_t pointCount = normalsGen.getNormalCount();
+  adj.resize( pointCount );
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+      const uint32_t* neighbors = normalsGen.getNeighbors( i );
+      adj[i].assign( neighbors, neighbors + normalsGen.getNeighborCount( i ) );
+    } );
+  } );
+}
+
 void PCCPatchSegmenter3::computeAdjacencyInfoInRadius( const PCCPointSet3&                 pointCloud,
                                                        const PCCKdTree&                    kdtree,
                                                        std::vector<std::vector<uint32_t>>& adj,
                                                        const size_t                        maxNNCount,
-                                                       const size_t                        radius ) {
+                                                       const size_t                        radius,
+                                                       const std::vector<uint8_t>&         searchMask ) {
   const size_t pointCount = pointCloud.getPointCount();
   adj.resize( pointCount );
-  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
-  limited.execute( [&] {
+  PCCTaskScheduler::getInstance().execute( [&] {
     tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+      if ( !searchMask.empty() && searchMask[i] == 0u ) { return; }
       PCCNNResult result;
       kdtree.searchRadius( pointCloud[i], maxNNCount, radius, result );
       std::vector<uint32_t>& neighbors = adj[i];
@@ -297,8 +321,7 @@ void PCCPatchSegmenter3::computeAdjacencyInfoDist( const PCCPointSet3&
   const size_t pointCount = pointCloud.getPointCount();
   adj.resize( pointCount );
   adjDist.resize( pointCount );
-  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
-  limited.execute( [&] {
+  PCCTaskScheduler::getInstance().execute( [&] {
     tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
       PCCNNResult result;
       kdtree.search( pointCloud[i], maxNNCount, result );
@@ -580,7 +603,13 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
     flagExp.resize( pointCount, false );
   } else {
     if ( !enablePointCloudPartitioning ) {
-      computeAdjacencyInfo( points, kdtree, adj, maxNNCount );
+      if ( !params.gridBasedSegmentation_ && normalsGen.getNormalCount() == pointCount &&
+           normalsGen.getNeighborCount() == maxNNCount ) {
+        // the normals were estimated on the same points with the same k-NN query
+        computeAdjacencyInfo( normalsGen, adj );
+      } else {
+        computeAdjacencyInfo( points, kdtree, adj, maxNNCount );
+      }
     } else {
       numROIs = static_cast<int>( roiBoundingBoxMinX.size() );
       std::vector<std::vector<size_t>> numCutsPerAxis;  // number of cuts per axis for each ROI
@@ -1283,6 +1312,28 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
   distanceSrcRec = meanYAB + meanUAB + meanVAB + meanYBA + meanUBA + meanVBA;
 }
 
+void PCCPatchSegmenter3::reusePreviousSegmentation( const PCCPointSet3&   pointCloud,
+                                                    const double          maxDist2,
+                                                    std::vector<size_t>&  partition,
+                                                    std::vector<uint8_t>& refinePoints ) {
+  // the points close enough to a point of the previous frame take its refined partition and are not refined again
+  const size_t pointCount = pointCloud.getPointCount();
+  PCCKdTree    kdtree( previousGeometry_ );
+  refinePoints.resize( pointCount );
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+      PCCNNResult result;
+      kdtree.search( pointCloud[i], 1, result );
+      if ( result.dist( 0 ) <= maxDist2 ) {
+        partition[i]    = previousPartition_[result.indices( 0 )];
+        refinePoints[i] = 0;
+      } else {
+        refinePoints[i] = 1;
+      }
+    } );
+  } );
+}
+
 void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCloud,
                                              const PCCKdTree&            kdtree,
                                              const PCCNormalsGenerator3& normalsGen,
@@ -1291,29 +1342,43 @@ void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCl
                                              const size_t                maxNNCount,
                                              const double                lambda,
                                              const size_t                iterationCount,
-                                             std::vector<size_t>&        partition ) {
+                                             std::vector<size_t>&        partition,
+                                             const std::vector<uint8_t>& refinePoints ) {
   assert( orientations );
-  std::vector<std::vector<size_t>> adj;
-  computeAdjacencyInfo( pointCloud, kdtree, adj, maxNNCount );
-  const size_t                     pointCount = pointCloud.getPointCount();
-  const double                     weight     = lambda / maxNNCount;
-  std::vector<size_t>              tempPartition( pointCount );
-  std::vector<std::vector<size_t>> scoresSmooth( pointCount, std::vector<size_t>( orientationCount ) );
+  // only the points flagged in refinePoints are refined, all of them when it is empty
+  const size_t        pointCount = pointCloud.getPointCount();
+  std::vector<size_t> indices;
+  indices.reserve( pointCount );
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    if ( refinePoints.empty() || refinePoints[i] != 0u ) { indices.push_back( i ); }
+  }
+  const size_t                     refineCount = indices.size();
+  std::vector<std::vector<size_t>> adj( refineCount );
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( size_t( 0 ), refineCount, [&]( const size_t i ) {
+      PCCNNResult result;
+      kdtree.search( pointCloud[indices[i]], maxNNCount, result );
+      adj[i].assign( result.indices(), result.indices() + result.count() );
+    } );
+  } );
+  const double                     weight = lambda / maxNNCount;
+  std::vector<size_t>              tempPartition( partition );
+  std::vector<std::vector<size_t>> scoresSmooth( refineCount, std::vector<size_t>( orientationCount ) );
   for ( size_t k = 0; k < iterationCount; ++k ) {
-    tbb::task_arena limited( static_cast<int>( nbThread_ ) );
-    limited.execute( [&] {
-      tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+    PCCTaskScheduler::getInstance().execute( [&] {
+      tbb::parallel_for( size_t( 0 ), refineCount, [&]( const size_t i ) {
         auto& scoreSmooth = scoresSmooth[i];
         std::fill( scoreSmooth.begin(), scoreSmooth.end(), 0 );
         for ( auto& neighbor : adj[i] ) { ++scoreSmooth[partition[neighbor]]; }
       } );
     } );
-    limited.execute( [&] {
-      tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+    PCCTaskScheduler::getInstance().execute( [&] {
+      tbb::parallel_for( size_t( 0 ), refineCount, [&]( const size_t n ) {
+        const size_t      i            = indices[n];
         const PCCVector3D normal       = normalsGen.getNormal( i );
         size_t            clusterIndex = partition[i];
         double            bestScore    = 0.0;
-        const auto&       scoreSmooth  = scoresSmooth[i];
+        const auto&       scoreSmooth  = scoresSmooth[n];
         for ( size_t j = 0; j < orientationCount; ++j ) {
           const double scoreNormal = normal * orientations[j];
           const double score       = scoreNormal + weight * scoreSmooth[j];
@@ -1340,7 +1405,8 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
                                                       const size_t                iterationCount,
                                                       const size_t                voxDim,
                                                       const size_t                searchRadius,
-                                                      std::vector<size_t>&        partition ) {
+                                                      std::vector<size_t>&        partition,
+                                                      const std::vector<uint8_t>& refinePoints ) {
   const size_t pointCount = pointCloud.getPointCount();
   auto         geoMax     = pointCloud[0][0];
   for ( size_t i = 0; i < pointCount; ++i ) {
@@ -1362,9 +1428,11 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
 
   auto subToInd = [&]( size_t x, size_t y, size_t z ) { return x + ( y << gridDimShift ) + ( z << gridDimShiftSqr ); };
 
-  PCCPointSet3                                                        gridCenters;
-  std::unordered_map<size_t, std::unique_ptr<PointIndicesOfGridCell>> gridWithPointIndices;
-  std::unordered_map<size_t, std::unique_ptr<AttributeOfGridCell>>    gridWithAttributes;
+  // the occupied voxels are numbered in the order of their first point, the cells are stored by value
+  PCCPointSet3                        gridCenters;
+  PCCSparseGridIndex<int64_t>         voxelIndex;
+  std::vector<PointIndicesOfGridCell> pointIndicesOfVox;
+  std::vector<AttributeOfGridCell>    attributeOfVox;
 
   const uint32_t uiMaxNumPointsInOneVox = voxDim * voxDim * voxDim;
   for ( size_t i = 0; i < pointCount; ++i ) {
@@ -1372,37 +1440,32 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
     const size_t x0  = ( ( static_cast<size_t>( pos[0] ) + voxDimHalf ) ) >> voxDimShift;
     const size_t y0  = ( ( static_cast<size_t>( pos[1] ) + voxDimHalf ) ) >> voxDimShift;
     const size_t z0  = ( ( static_cast<size_t>( pos[2] ) + voxDimHalf ) ) >> voxDimShift;
-    size_t       p   = subToInd( x0, y0, z0 );
-    if ( gridWithPointIndices.count( p ) == 0u ) {
+    const int    p   = voxelIndex.insert( static_cast<int64_t>( subToInd( x0, y0, z0 ) ) );
+    if ( p == static_cast<int>( pointIndicesOfVox.size() ) ) {
       gridCenters.addPoint( PCCVector3D( x0, y0, z0 ) );
-      gridWithPointIndices.emplace( p, std::make_unique<PointIndicesOfGridCell>( uiMaxNumPointsInOneVox ) );
-      gridWithAttributes.emplace( p, std::make_unique<AttributeOfGridCell>( orientationCount ) );
+      pointIndicesOfVox.emplace_back( uiMaxNumPointsInOneVox );
+      attributeOfVox.emplace_back( orientationCount );
     }
-    gridWithPointIndices[p]->addPointIndex( (uint32_t)i );
+    pointIndicesOfVox[p].addPointIndex( (uint32_t)i );
   }
 
   const uint64_t uiTotalNumOfVoxs = gridCenters.getPointCount();
 
   // pre-processing steps [m56635]
-  std::vector<PointIndicesOfGridCell*> pointIndicesOfVox;
-  pointIndicesOfVox.reserve( uiTotalNumOfVoxs );
-
-  std::vector<AttributeOfGridCell*> attributeOfVox;
-  attributeOfVox.reserve( uiTotalNumOfVoxs );
-
   for ( size_t i = 0; i < uiTotalNumOfVoxs; ++i ) {
-    auto& p = gridCenters[i];
-
-    PointIndicesOfGridCell* pPI   = gridWithPointIndices[subToInd( p[0], p[1], p[2] )].get();
-    AttributeOfGridCell*    pAttr = gridWithAttributes[subToInd( p[0], p[1], p[2] )].get();
-
-    pAttr->setNumOfTotalPoints( pPI->getPointCount() );
+    attributeOfVox[i].setNumOfTotalPoints( pointIndicesOfVox[i].getPointCount() );
 
     // 1st voxel classification [m56635]
-    pAttr->updateScores( *( pPI->getPointIndices() ), partition );
+    attributeOfVox[i].updateScores( *( pointIndicesOfVox[i].getPointIndices() ), partition );
+  }
 
-    pointIndicesOfVox.push_back( pPI );
-    attributeOfVox.push_back( pAttr );
+  // a voxel is refined when one of its points is flagged in refinePoints, all of them when it is empty
+  std::vector<uint8_t> refineVoxels;
+  if ( !refinePoints.empty() ) {
+    refineVoxels.resize( uiTotalNumOfVoxs, 0 );
+    for ( size_t i = 0; i < uiTotalNumOfVoxs; ++i ) {
+      for ( const auto& j : *( pointIndicesOfVox[i].getPointIndices() ) ) { refineVoxels[i] |= refinePoints[j]; }
+    }
   }
 
   // a step for searching adjacents voxels of each voxel within the voxSearchRadius
@@ -1411,7 +1474,7 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
   const size_t                       maxNeighborCount = ( std::numeric_limits<int16_t>::max )();
   std::vector<std::vector<uint32_t>> adj( gridCenters.getPointCount() );
 
-  computeAdjacencyInfoInRadius( gridCenters, kdtree, adj, maxNeighborCount, voxSearchRadius );
+  computeAdjacencyInfoInRadius( gridCenters, kdtree, adj, maxNeighborCount, voxSearchRadius, refineVoxels );
 
   // candidates for the indirect edge voxels from [m56635]
   std::vector<std::vector<uint32_t>> adjDEV( uiTotalNumOfVoxs );
@@ -1423,6 +1486,10 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
 
   // for each cell of the grid
   for ( size_t i = 0; i < uiTotalNumOfVoxs; ++i ) {
+    if ( !refineVoxels.empty() && refineVoxels[i] == 0u ) {
+      weights.push_back( 0.0 );
+      continue;
+    }
     auto& p = gridCenters[i];
     adjDEV[i].reserve( 128 );
 
@@ -1438,7 +1505,7 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
       if ( xAbs <= idvSearchRange && yAbs <= idvSearchRange && zAbs <= idvSearchRange ) {
         adjDEV[i].push_back( *iter );
       }
-      nnPointCount += pointIndicesOfVox[*iter]->getPointCount();
+      nnPointCount += pointIndicesOfVox[*iter].getPointCount();
       if ( nnPointCount >= maxNNCount ) { break; }
     }
 
@@ -1452,41 +1519,72 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
   std::vector<double> scores;
   scores.resize( orientationCount, 0.0 );
 
-  ScoresVector_t scoreSmooth( orientationCount, 0 );
+  // the sums of the adjacent scores are kept from an iteration to the next one: scoresSmoothIter[i] is the
+  // iteration of the sum of the voxel i, scoresChangeIter[j] the first iteration that sees the new scores of j
+  std::vector<uint16_t> scoresSmooth( uiTotalNumOfVoxs * orientationCount, 0 );
+  std::vector<int>      scoresSmoothIter( uiTotalNumOfVoxs, -1 );
+  std::vector<int>      scoresChangeIter( uiTotalNumOfVoxs, 0 );
+  std::vector<size_t>   updatedVoxels;
+  ScoresVector_t        previousScores( orientationCount, 0 );
+
+  auto computeScoreSmooth = [&]( const size_t i, const int iter ) {
+    uint16_t*   scoreSmooth   = scoresSmooth.data() + i * orientationCount;
+    const auto& currentAdjOfI = adj[i];
+    if ( scoresSmoothIter[i] == iter ) { return scoreSmooth; }
+    if ( scoresSmoothIter[i] >= 0 &&
+         std::none_of( currentAdjOfI.begin(), currentAdjOfI.end(),
+                       [&]( const uint32_t j ) { return scoresChangeIter[j] > scoresSmoothIter[i]; } ) ) {
+      scoresSmoothIter[i] = iter;
+      return scoreSmooth;
+    }
+    std::fill( scoreSmooth, scoreSmooth + orientationCount, 0 );
+    for ( const auto& j : currentAdjOfI ) {
+      const auto& scoreSmoothOfAdj = *( attributeOfVox[j].getScoreSmooth() );
+      for ( size_t k = 0; k < orientationCount; ++k ) { scoreSmooth[k] += scoreSmoothOfAdj[k]; }
+    }
+    scoresSmoothIter[i] = iter;
+    return scoreSmooth;
+  };
 
   size_t iter = 0;
   do {
+    // the scores don't change during an iteration: the sums of the edge voxels are computed in parallel
+    // and the voxels that become indirect edges in the loop below get theirs on demand
+    PCCTaskScheduler::getInstance().execute( [&] {
+      tbb::parallel_for( size_t( 0 ), size_t( uiTotalNumOfVoxs ), [&]( const size_t i ) {
+        if ( attributeOfVox[i].getEdge() == NO_EDGE ) { return; }
+        if ( !refineVoxels.empty() && refineVoxels[i] == 0u ) { return; }
+        computeScoreSmooth( i, static_cast<int>( iter ) );
+      } );
+    } );
+
+    updatedVoxels.clear();
     for ( size_t i = 0; i < uiTotalNumOfVoxs; ++i ) {
       // if the current voxel belongs to N-EV(No edge-voxel), then refining steps are skipped. [m56635]
-      uint8_t edgeOfI = attributeOfVox[i]->getEdge();
+      uint8_t edgeOfI = attributeOfVox[i].getEdge();
       if ( edgeOfI == NO_EDGE ) { continue; }
+      if ( !refineVoxels.empty() && refineVoxels[i] == 0u ) { continue; }
 
-      std::fill( scoreSmooth.begin(), scoreSmooth.end(), 0 );
-
-      auto& currentAdjOfI = adj[i];
-      for ( const auto& j : currentAdjOfI ) {
-        ScoresVector_t* scoreSmoothOfAdj = attributeOfVox[j]->getScoreSmooth();
-        for ( size_t k = 0; k < orientationCount; ++k ) { scoreSmooth[k] += ( *scoreSmoothOfAdj )[k]; }
-      }
+      const uint16_t* scoreSmooth = computeScoreSmooth( i, static_cast<int>( iter ) );
 
       // 2nd voxel classification (indirect edge-voxel)  [m56635]
-      const auto& maxEleOfScoreSmooth = std::max_element( scoreSmooth.begin(), scoreSmooth.end() );
-      size_t      ppiOfScoreSmooth    = std::distance( scoreSmooth.begin(), maxEleOfScoreSmooth );
+      const auto& maxEleOfScoreSmooth = std::max_element( scoreSmooth, scoreSmooth + orientationCount );
+      size_t      ppiOfScoreSmooth    = std::distance( scoreSmooth, maxEleOfScoreSmooth );
 
       for ( auto& j : adjDEV[i] ) {
-        uint8_t edgeOfAdj = attributeOfVox[j]->getEdge();
-        uint8_t ppi       = attributeOfVox[j]->getPPI();
-        if ( edgeOfAdj == NO_EDGE && ppi != ppiOfScoreSmooth ) { attributeOfVox[j]->updateEdge( INDIRECT_EDGE ); }
+        uint8_t edgeOfAdj = attributeOfVox[j].getEdge();
+        uint8_t ppi       = attributeOfVox[j].getPPI();
+        if ( edgeOfAdj == NO_EDGE && ppi != ppiOfScoreSmooth ) { attributeOfVox[j].updateEdge( INDIRECT_EDGE ); }
       }  // for (auto& j : adjDEV[i])
 
       if ( edgeOfI != M_DIRECT_EDGE ) {  // S_DIRECT_EDGE or INDIRECT_EDGE
-        size_t validNumOfScores = orientationCount - std::count( scoreSmooth.begin(), scoreSmooth.end(), 0 );
-        size_t voxPPI           = attributeOfVox[i]->getPPI();
+        size_t validNumOfScores = orientationCount - std::count( scoreSmooth, scoreSmooth + orientationCount, 0 );
+        size_t voxPPI           = attributeOfVox[i].getPPI();
 
         if ( validNumOfScores == 1 && scoreSmooth[voxPPI] > 0 ) { continue; }
       }
 
-      const auto& pI = *( pointIndicesOfVox[i]->getPointIndices() );
+      const auto& pI = *( pointIndicesOfVox[i].getPointIndices() );
 
       // for each point in a grid cell of i
       for ( const auto& j : pI ) {
@@ -1498,12 +1596,17 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
         partition[j]       = std::distance( scores.begin(), result );
       }
 
-      attributeOfVox[i]->setUpdatedFlag();
+      attributeOfVox[i].setUpdatedFlag();
+      updatedVoxels.push_back( i );
     }  // for (size_t i = 0; i < uiTotalNumOfVoxs; ++i)
 
-    // restarts the values of score smooth by checking to which partition points now is part of
-    for ( size_t i = 0; i < uiTotalNumOfVoxs; ++i ) {
-      attributeOfVox[i]->updateScores( *( pointIndicesOfVox[i]->getPointIndices() ), partition );
+    // restarts the values of score smooth by checking to which partition points now is part of, only the
+    // points of the updated voxels may have moved to another partition
+    for ( const auto& i : updatedVoxels ) {
+      auto& scoreSmoothOfI = *( attributeOfVox[i].getScoreSmooth() );
+      previousScores       = scoreSmoothOfI;
+      attributeOfVox[i].updateScores( *( pointIndicesOfVox[i].getPointIndices() ), partition );
+      if ( scoreSmoothOfI != previousScores ) { scoresChangeIter[i] = static_cast<int>( iter ) + 1; }
     }
   } while ( ++iter < iterationCount );
 }
@@ -45,8 +45,12 @@
 #include "PCCHDRToolsAppColorConverter.h"
 #endif
 
+#include <mutex>
+
 using namespace pcc;
 
+static std::mutex g_videoEncoderMutex;
+
 PCCVideoEncoder::PCCVideoEncoder() = default;
 
 PCCVideoEncoder::~PCCVideoEncoder() = default;
@@ -323,6 +327,16 @@ bool PCCVideoEncoder::compress( PCCVideo<T, 3>&    video,
       addVideoFormat( fileName + "_rec", width, height, !use444CodecIo, !use444CodecIo, bitdepth );
   const bool yuvVideo = colorSpaceConversionConfig.empty() || use444CodecIo;
 
+  // The in-process codecs and color converters share global state: only one of them runs at a time, so with the
+  // HM, VTM and JM libraries or FFMPEG the sub-streams are coded one after the other. The external codec
+  // applications run concurrently.
+  bool serialize = PCCIsLibraryVideoCodec( codecId );
+#ifdef USE_HDRTOOLS
+  serialize |= !colorSpaceConversionPath.empty();
+#endif
+  std::unique_lock<std::mutex> lock( g_videoEncoderMutex, std::defer_lock );
+  if ( serialize ) { lock.lock(); }
+
   std::shared_ptr<PCCVirtualColorConverter<T>> converter;
   std::string                                  configInverseColorSpace, configColorSpace;
   if ( colorSpaceConversionPath.empty() ) {
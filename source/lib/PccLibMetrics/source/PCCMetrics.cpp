@@ -34,6 +34,7 @@
 #include "PCCGroupOfFrames.h"
 #include "PCCPointSet.h"
 #include "PCCKdTree.h"
+#include "PCCTaskScheduler.h"
 #include <tbb/tbb.h>
 
 #include "PCCMetrics.h"
@@ -47,13 +48,18 @@ float getPSNR( float dist, float p, float factor = 1.0 ) {
   return psnr;
 }
 
-void convertRGBtoYUVBT709( const PCCColor3B& rgb, std::vector<float>& yuv ) {
-  yuv.resize( 3 );
+void convertRGBtoYUVBT709( const PCCColor3B& rgb, float* yuv ) {
   yuv[0] = float( ( 0.2126 * rgb[0] + 0.7152 * rgb[1] + 0.0722 * rgb[2] ) / 255.0 );
   yuv[1] = float( ( -0.1146 * rgb[0] - 0.3854 * rgb[1] + 0.5000 * rgb[2] ) / 255.0 + 0.5000 );
   yuv[2] = float( ( 0.5000 * rgb[0] - 0.4542 * rgb[1] - 0.0458 * rgb[2] ) / 255.0 + 0.5000 );
 }
 
+void convertRGBtoYUVBT709( const PCCPointSet3& pointcloud, std::vector<float>& yuv ) {
+  const size_t pointCount = pointcloud.getPointCount();
+  yuv.resize( 3 * pointCount );
+  for ( size_t i = 0; i < pointCount; i++ ) { convertRGBtoYUVBT709( pointcloud.getColor( i ), yuv.data() + 3 * i ); }
+}
+
 QualityMetrics::QualityMetrics() :
     c2cMse_( 0.0F ),
     c2cHausdorff_( 0.0F ),
@@ -84,121 +90,144 @@ void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet
   psnr_ = params_.resolution_;
 
   PCCKdTree    kdtree( pointcloudB );
-  PCCNNResult  result;
-  const size_t num_results_max  = 30;
-  const size_t num_results_incr = 5;
+  const size_t num_results_max    = 30;
+  const size_t num_results_min    = 5;
+  const size_t pointCount         = pointcloudA.getPointCount();
+  const bool   computeC2p         = params_.computeC2p_ && pointcloudB.hasNormals() && pointcloudA.hasNormals();
+  const bool   computeColor       = params_.computeColor_ && pointcloudA.hasColors() && pointcloudB.hasColors();
+  const bool   computeReflectance = params_.computeReflectance_ && pointcloudA.hasReflectances() &&
+                                    pointcloudB.hasReflectances();
 
-  auto& normalsB = pointcloudB.getNormals();
-  for ( size_t indexA = 0; indexA < pointcloudA.getPointCount(); indexA++ ) {
-    // For point 'i' in A, find its nearest neighbor in B. store it in 'j'
-    size_t num_results = 0;
-    do {
-      num_results += num_results_incr;
-      kdtree.search( pointcloudA[indexA], num_results, result );
-    } while ( result.dist( 0 ) == result.dist( num_results - 1 ) && num_results + num_results_incr <= num_results_max );
+  // The colors are converted once for all the points.
+  std::vector<float> yuvA;
+  std::vector<float> yuvB;
+  if ( computeColor ) {
+    convertRGBtoYUVBT709( pointcloudA, yuvA );
+    convertRGBtoYUVBT709( pointcloudB, yuvB );
+  }
 
-    // Compute point-to-point, which should be equal to sqrt( dist[0] )
-    double distProjC2c = result.dist( 0 );
+  // The distances of the points are computed in parallel and accumulated afterwards in the order of the
+  // points, so the results do not depend on the number of threads.
+  std::vector<double> distC2c( params_.computeC2c_ ? pointCount : 0, 0.0 );
+  std::vector<double> distC2p( params_.computeC2p_ ? pointCount : 0, 0.0 );
+  std::vector<double> distColor( params_.computeColor_ ? 3 * pointCount : 0, 0.0 );
+  std::vector<double> distReflectance( computeReflectance ? pointCount : 0, 0.0 );
 
-    // Build the list of all the points of same distances.
-    std::vector<size_t> sameDistList;
-    if ( params_.computeColor_ || params_.computeC2p_ ) {
-      for ( size_t j = 0; j < num_results && ( fabs( result.dist( 0 ) - result.dist( j ) ) < 1e-8 ); j++ ) {
-        sameDistList.push_back( result.indices( j ) );
-      }
-    }
-    std::sort( sameDistList.begin(), sameDistList.end() );
+  auto&                            normalsB = pointcloudB.getNormals();
+  const tbb::blocked_range<size_t> blocks( 0, pointCount, 1024 );
+  PCCTaskScheduler::getInstance().execute( [&] {
+    tbb::parallel_for( blocks, [&]( const tbb::blocked_range<size_t>& block ) {
+      PCCNNResult         result;
+      std::vector<size_t> sameDistList;
+      sameDistList.reserve( num_results_max );
+      for ( size_t indexA = block.begin(); indexA < block.end(); indexA++ ) {
+        // For point 'i' in A, find its nearest neighbor in B. store it in 'j'. The search is extended to
+        // num_results_max neighbors only when all the nearest ones are at the same distance. B may have
+        // fewer points than requested, the search then returns all of them.
+        kdtree.search( pointcloudA[indexA], num_results_min, result );
+        if ( result.size() == num_results_min && result.dist( 0 ) == result.dist( num_results_min - 1 ) ) {
+          kdtree.search( pointcloudA[indexA], num_results_max, result );
+        }
 
-    // Compute point-to-plane, normals in B will be used for point-to-plane
-    double distProjC2p = 0.0;
-    if ( params_.computeC2p_ && pointcloudB.hasNormals() && pointcloudA.hasNormals() ) {
-      for ( auto& indexB : sameDistList ) {
-        std::vector<double> errVector( 3 );
-        for ( size_t j = 0; j < 3; j++ ) { errVector[j] = pointcloudA[indexA][j] - pointcloudB[indexB][j]; }
-        double dist = pow( errVector[0] * normalsB[indexB][0] + errVector[1] * normalsB[indexB][1] +
-                               errVector[2] * normalsB[indexB][2],
-                           2.F );
-        distProjC2p += dist;
-      }
-      distProjC2p /= sameDistList.size();
-    }
+        // Compute point-to-point, which should be equal to sqrt( dist[0] )
+        if ( params_.computeC2c_ ) { distC2c[indexA] = result.dist( 0 ); }
+
+        // Build the list of all the points of same distances.
+        sameDistList.clear();
+        if ( params_.computeColor_ || params_.computeC2p_ ) {
+          for ( size_t j = 0; j < result.size() && ( fabs( result.dist( 0 ) - result.dist( j ) ) < 1e-8 ); j++ ) {
+            sameDistList.push_back( result.indices( j ) );
+          }
+        }
+        std::sort( sameDistList.begin(), sameDistList.end() );
+
+        // Compute point-to-plane, normals in B will be used for point-to-plane
+        if ( computeC2p ) {
+          double distProjC2p = 0.0;
+          for ( auto& indexB : sameDistList ) {
+            double errVector[3];
+            for ( size_t j = 0; j < 3; j++ ) { errVector[j] = pointcloudA[indexA][j] - pointcloudB[indexB][j]; }
+            double dist = pow( errVector[0] * normalsB[indexB][0] + errVector[1] * normalsB[indexB][1] +
+                                   errVector[2] * normalsB[indexB][2],
+                               2.F );
+            distProjC2p += dist;
+          }
+          distC2p[indexA] = distProjC2p / sameDistList.size();
+        }
 
-    size_t indexB = result.indices( 0 );
-    double distColor[3];
-    distColor[0] = distColor[1] = distColor[2] = 0.0;
-    if ( params_.computeColor_ && pointcloudA.hasColors() && pointcloudB.hasColors() ) {
-      std::vector<float> yuvA;
-      std::vector<float> yuvB;
-      PCCColor3B         rgb;
-      convertRGBtoYUVBT709( pointcloudA.getColor( indexA ), yuvA );
-      if ( params_.neighborsProc_ != 0 ) {
-        switch ( params_.neighborsProc_ ) {
-          case 0: break;
-          case 1:  // Average
-          case 2:  // Weighted average
-          {
-            int          nbdupcumul = 0;
-            unsigned int r          = 0;
-            unsigned int g          = 0;
-            unsigned int b          = 0;
-            for ( unsigned long long i : sameDistList ) {
-              int nbdup = 1;  // pointcloudB.xyz.nbdup[ indices_sameDst[n] ];
-              r += nbdup * pointcloudB.getColor( i )[0];
-              g += nbdup * pointcloudB.getColor( i )[1];
-              b += nbdup * pointcloudB.getColor( i )[2];
-              nbdupcumul += nbdup;
-            }
-            rgb[0] = static_cast<unsigned char>( round( static_cast<double>( r ) / nbdupcumul ) );
-            rgb[1] = static_cast<unsigned char>( round( static_cast<double>( g ) / nbdupcumul ) );
-            rgb[2] = static_cast<unsigned char>( round( static_cast<double>( b ) / nbdupcumul ) );
-            convertRGBtoYUVBT709( rgb, yuvB );
-            for ( size_t i = 0; i < 3; i++ ) { distColor[i] = pow( yuvA[i] - yuvB[i], 2.F ); }
-          } break;
-          case 3:  // Min
-          case 4:  // Max
-          {
-            float  distBest  = 0;
-            size_t indexBest = 0;
-            for ( auto index : sameDistList ) {
-              convertRGBtoYUVBT709( pointcloudB.getColor( index ), yuvB );
-              float dist =
-                  pow( yuvA[0] - yuvB[0], 2.F ) + pow( yuvA[1] - yuvB[1], 2.F ) + pow( yuvA[2] - yuvB[2], 2.F );
-              if ( ( ( params_.neighborsProc_ == 3 ) && ( dist < distBest ) ) ||
-                   ( ( params_.neighborsProc_ == 4 ) && ( dist > distBest ) ) ) {
-                distBest  = dist;
-                indexBest = index;
+        size_t indexB = result.indices( 0 );
+        if ( computeColor ) {
+          const float* colorA = yuvA.data() + 3 * indexA;
+          const float* colorB = yuvB.data() + 3 * indexB;
+          float        yuvAverage[3];
+          switch ( params_.neighborsProc_ ) {
+            case 0: break;
+            case 1:  // Average
+            case 2:  // Weighted average
+            {
+              int          nbdupcumul = 0;
+              unsigned int r          = 0;
+              unsigned int g          = 0;
+              unsigned int b          = 0;
+              PCCColor3B   rgb;
+              for ( unsigned long long i : sameDistList ) {
+                int nbdup = 1;  // pointcloudB.xyz.nbdup[ indices_sameDst[n] ];
+                r += nbdup * pointcloudB.getColor( i )[0];
+                g += nbdup * pointcloudB.getColor( i )[1];
+                b += nbdup * pointcloudB.getColor( i )[2];
+                nbdupcumul += nbdup;
               }
-            }
-            convertRGBtoYUVBT709( pointcloudB.getColor( indexBest ), yuvB );
-          } break;
+              rgb[0] = static_cast<unsigned char>( round( static_cast<double>( r ) / nbdupcumul ) );
+              rgb[1] = static_cast<unsigned char>( round( static_cast<double>( g ) / nbdupcumul ) );
+              rgb[2] = static_cast<unsigned char>( round( static_cast<double>( b ) / nbdupcumul ) );
+              convertRGBtoYUVBT709( rgb, yuvAverage );
+              colorB = yuvAverage;
+            } break;
+            case 3:  // Min
+            case 4:  // Max
+            {
+              float  distBest  = 0;
+              size_t indexBest = 0;
+              for ( auto index : sameDistList ) {
+                const float* yuv  = yuvB.data() + 3 * index;
+                const float  dist =
+                    pow( colorA[0] - yuv[0], 2.F ) + pow( colorA[1] - yuv[1], 2.F ) + pow( colorA[2] - yuv[2], 2.F );
+                if ( ( ( params_.neighborsProc_ == 3 ) && ( dist < distBest ) ) ||
+                     ( ( params_.neighborsProc_ == 4 ) && ( dist > distBest ) ) ) {
+                  distBest  = dist;
+                  indexBest = index;
+                }
+              }
+              colorB = yuvB.data() + 3 * indexBest;
+            } break;
+          }
+          for ( size_t i = 0; i < 3; i++ ) { distColor[3 * indexA + i] = pow( colorA[i] - colorB[i], 2.F ); }
+        }
+
+        if ( computeReflectance ) {
+          distReflectance[indexA] =
+              pow( pointcloudA.getReflectance( indexA ) - pointcloudB.getReflectance( indexB ), 2.F );
         }
-      } else {
-        convertRGBtoYUVBT709( pointcloudB.getColor( indexB ), yuvB );
       }
-      for ( size_t i = 0; i < 3; i++ ) { distColor[i] = pow( yuvA[i] - yuvB[i], 2.F ); }
-    }
+    } );
+  } );
 
-    double distReflectance = 0.0;
-    if ( params_.computeReflectance_ && pointcloudA.hasReflectances() && pointcloudB.hasReflectances() ) {
-      distReflectance = pow( pointcloudA.getReflectance( indexA ) - pointcloudB.getReflectance( indexB ), 2.F );
-    }
+  for ( size_t indexA = 0; indexA < pointCount; indexA++ ) {
     num++;
 
     // mean square distance
     if ( params_.computeC2c_ ) {
-      sseC2c += distProjC2c;
-      if ( distProjC2c > maxC2c ) { maxC2c = distProjC2c; }
+      sseC2c += distC2c[indexA];
+      if ( distC2c[indexA] > maxC2c ) { maxC2c = distC2c[indexA]; }
     }
     if ( params_.computeC2p_ ) {
-      sseC2p += distProjC2p;
-      if ( distProjC2p > maxC2p ) { maxC2p = distProjC2p; }
+      sseC2p += distC2p[indexA];
+      if ( distC2p[indexA] > maxC2p ) { maxC2p = distC2p[indexA]; }
     }
     if ( params_.computeColor_ ) {
-      for ( size_t i = 0; i < 3; i++ ) { sseColor[i] += distColor[i]; }
-    }
-    if ( params_.computeReflectance_ && pointcloudA.hasReflectances() && pointcloudB.hasReflectances() ) {
-      sseReflectance += distReflectance;
+      for ( size_t i = 0; i < 3; i++ ) { sseColor[i] += distColor[3 * indexA + i]; }
     }
+    if ( computeReflectance ) { sseReflectance += distReflectance[indexA]; }
   }
 
   if ( params_.computeC2c_ ) {
@@ -368,9 +397,9 @@ void PCCMetrics::compute( PCCPointSet3& source, PCCPointSet3& reconstruct, const
   QualityMetrics q1;
   QualityMetrics q2;
   q1.setParameters( params_ );
-  q1.compute( source, reconstruct );
   q2.setParameters( params_ );
-  q2.compute( reconstruct, source );
+  PCCTaskScheduler::getInstance().executeTasks(
+      {[&] { q1.compute( source, reconstruct ); }, [&] { q2.compute( reconstruct, source ); }} );
   quality1_.push_back( q1 );
   quality2_.push_back( q2 );
   qualityF_.push_back( q1 + q2 );
@@ -58,9 +58,8 @@ PCCHMLibVideoDecoderImpl<T>::~PCCHMLibVideoDecoderImpl() {
 
 template <typename T>
 void PCCHMLibVideoDecoderImpl<T>::decode( PCCVideoBitstream& bitstream, size_t outputBitDepth, PCCVideo<T, 3>& video ) {
-  std::string                         s( reinterpret_cast<char*>( bitstream.buffer() ), bitstream.size() );
-  std::istringstream                  iss( s );
-  std::istream&                       bitstreamFile = iss;
+  PCCVideoBitstreamInputBuffer        buffer( bitstream );
+  std::istream                        bitstreamFile( &buffer );
   Int                                 poc;
   pcc_hm::TComList<pcc_hm::TComPic*>* pcListPic = NULL;
   pcc_hm::InputByteStream             bytestream( bitstreamFile );
@@ -50,11 +50,10 @@ template <typename T>
 uint32_t PCCVTMLibVideoDecoderImpl<T>::decode( PCCVideoBitstream& bitstream,
                                                size_t             outputBitDepth,
                                                PCCVideo<T, 3>&    video ) {
-  std::string        s( reinterpret_cast<char*>( bitstream.buffer() ), bitstream.size() );
-  std::istringstream iss( s );
-  std::istream&      bitstreamFile = iss;
-  int                poc;
-  PicList*           pcListPic = NULL;
+  PCCVideoBitstreamInputBuffer buffer( bitstream );
+  std::istream                 bitstreamFile( &buffer );
+  int                          poc;
+  PicList*                     pcListPic = NULL;
 
   InputByteStream bytestream( bitstreamFile );
   if ( outputBitDepth ) {
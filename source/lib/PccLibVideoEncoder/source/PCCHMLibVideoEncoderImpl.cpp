@@ -58,11 +58,12 @@ Void PCCHMLibVideoEncoderImpl<T>::encode( PCCVideo<T, 3>&    videoSrc,
                                           std::string        arguments,
                                           PCCVideoBitstream& bitstream,
                                           PCCVideo<T, 3>&    videoRec ) {
-  std::ostringstream oss( ostringstream::binary | ostringstream::out );
-  std::ostream&      bitstreamFile = oss;
-  std::istringstream iss( arguments );
-  std::string        token;
-  std::vector<char*> args;
+  bitstream.vector().clear();
+  PCCVideoBitstreamOutputBuffer buffer( bitstream );
+  std::ostream                  bitstreamFile( &buffer );
+  std::istringstream            iss( arguments );
+  std::string                   token;
+  std::vector<char*>            args;
   while ( iss >> token ) {
     char* arg = new char[token.size() + 1];
     copy( token.begin(), token.end(), arg );
@@ -172,9 +173,6 @@ Void PCCHMLibVideoEncoderImpl<T>::encode( PCCVideo<T, 3>&    videoSrc,
   xDeleteBuffer();
   m_cTEncTop.destroy();
   printRateSummary();
-  auto buffer = oss.str();
-  bitstream.resize( buffer.size() );
-  std::copy( buffer.data(), buffer.data() + buffer.size(), bitstream.vector().begin() );
   return;
 }
 
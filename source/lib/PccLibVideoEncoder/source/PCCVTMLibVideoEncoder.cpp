@@ -89,9 +89,10 @@ void PCCVTMLibVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
   fprintf( stdout, NVM_BITS );
   fprintf( stdout, "\n" );
 
-  std::ostringstream oss( ostringstream::binary | ostringstream::out );
-  std::ostream&      bitstreamFile = oss;
-  EncLibCommon       encLibCommon;
+  bitstream.vector().clear();
+  PCCVideoBitstreamOutputBuffer buffer( bitstream );
+  std::ostream                  bitstreamFile( &buffer );
+  EncLibCommon                  encLibCommon;
 
   initROM();
   TComHash::initBlockSizeToIndex();
@@ -170,10 +171,6 @@ void PCCVTMLibVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
     }
   }
 
-  auto buffer = oss.str();
-  bitstream.resize( buffer.size() );
-  std::copy( buffer.data(), buffer.data() + buffer.size(), bitstream.vector().begin() );
-
   clock_t     endClock = clock();
   auto        endTime  = std::chrono::steady_clock::now();
   std::time_t endTime2 = std::chrono::system_clock::to_time_t( std::chrono::system_clock::now() );